@@ -24,18 +24,25 @@
 
 #include <mrpt/3rdparty/tclap/CmdLine.h>
 #include <mrpt/containers/yaml.h>
+#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/core/exceptions.h>
 #include <mrpt/math/CMatrixFixed.h>
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/string_utils.h>  // tokenize()
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <optional>
+#include <thread>
 
 // Declare supported cli switches ===========
 struct Cli
@@ -56,8 +63,9 @@ struct Cli
     TCLAP::ValueArg<std::string> arg_result_path{
         "r",
         "result-tum-path",
-        "File to evaluate, in TUM format",
-        true,
+        "File to evaluate, in TUM format. Required unless running "
+        "--benchmark.",
+        false,
         "result.txt|result_%02i.txt",
         "result.txt",
         cmd};
@@ -107,12 +115,35 @@ struct Cli
         "format instead of in TUM format",
         cmd};
 
+    TCLAP::ValueArg<unsigned int> argNumThreads{
+        "",
+        "num-threads",
+        "Number of threads to evaluate the sequences and segments in "
+        "parallel. Default (0) means using as many as hardware cores.",
+        false,
+        0,
+        "0",
+        cmd};
+
+    TCLAP::ValueArg<int> argBenchmark{
+        "",
+        "benchmark",
+        "Instead of evaluating any file, generate a synthetic trajectory with "
+        "this number of poses and benchmark the evaluation of the KITTI "
+        "metrics against the original (serial) algorithm, checking that both "
+        "results are identical.",
+        false,
+        100000,
+        "100000",
+        cmd};
+
     std::string kitti_basedir;
 };
 
 // points to CPose3D path from odometry/slam
 
 static bool eval(Cli& cli);
+static void run_benchmark(Cli& cli);
 
 static void do_kitti_eval_error(Cli& cli)
 {
@@ -150,6 +181,17 @@ int main(int argc, char** argv)
         Cli cli;
 
         if (!cli.cmd.parse(argc, argv)) return 1;  // should exit.
+
+        if (cli.argBenchmark.isSet())
+        {
+            run_benchmark(cli);
+            return 0;
+        }
+
+        if (!cli.arg_result_path.isSet())
+            throw std::runtime_error(
+                "Error: Missing required argument --result-tum-path");
+
         do_kitti_eval_error(cli);
         return 0;
     }
@@ -315,14 +357,14 @@ std::vector<Matrix> loadPoses(string file_name)
     return poses;
 }
 
-vector<float> trajectoryDistances(vector<Matrix>& poses)
+vector<float> trajectoryDistances(const vector<Matrix>& poses)
 {
     vector<float> dist;
     dist.push_back(0);
     for (int32_t i = 1; i < poses.size(); i++)
     {
-        Matrix P1 = poses[i - 1];
-        Matrix P2 = poses[i];
+        const Matrix& P1 = poses[i - 1];
+        const Matrix& P2 = poses[i];
         float  dx = P1(0, 3) - P2(0, 3);
         float  dy = P1(1, 3) - P2(1, 3);
         float  dz = P1(2, 3) - P2(2, 3);
@@ -332,14 +374,17 @@ vector<float> trajectoryDistances(vector<Matrix>& poses)
 }
 
 int32_t lastFrameFromSegmentLength(
-    vector<float>& dist, int32_t first_frame, float len)
+    const vector<float>& dist, int32_t first_frame, float len)
 {
-    for (int32_t i = first_frame; i < dist.size(); i++)
-        if (dist[i] > dist[first_frame] + len) return i;
-    return -1;
+    // dist[] is the (non-decreasing) accumulated distance, so binary search
+    // the first frame farther than "len", in O(log n):
+    const auto it = std::upper_bound(
+        dist.begin() + first_frame, dist.end(), dist[first_frame] + len);
+    if (it == dist.end()) return -1;
+    return static_cast<int32_t>(it - dist.begin());
 }
 
-inline float rotationError(Matrix& pose_error)
+inline float rotationError(const Matrix& pose_error)
 {
     float a = pose_error(0, 0);
     float b = pose_error(1, 1);
@@ -348,7 +393,7 @@ inline float rotationError(Matrix& pose_error)
     return acos(max(min(d, 1.0f), -1.0f));
 }
 
-inline float translationError(Matrix& pose_error)
+inline float translationError(const Matrix& pose_error)
 {
     float dx = pose_error(0, 3);
     float dy = pose_error(1, 3);
@@ -356,21 +401,31 @@ inline float translationError(Matrix& pose_error)
     return sqrt(dx * dx + dy * dy + dz * dz);
 }
 
+// Original linear search, only kept for benchmarking:
+int32_t lastFrameFromSegmentLengthLinear(
+    const vector<float>& dist, int32_t first_frame, float len)
+{
+    for (int32_t i = first_frame; i < dist.size(); i++)
+        if (dist[i] > dist[first_frame] + len) return i;
+    return -1;
+}
+
+using last_frame_fn_t = int32_t (*)(const vector<float>&, int32_t, float);
+
+// Errors for all segments starting at first frames in the range
+// [first_frame_begin, first_frame_end), in steps of "step_size":
 vector<errors> calcSequenceErrors(
-    vector<Matrix>& poses_gt, vector<Matrix>& poses_result)
+    const vector<Matrix>& poses_gt, const vector<Matrix>& poses_result,
+    const vector<float>& dist, int32_t first_frame_begin,
+    int32_t first_frame_end, int32_t step_size,
+    last_frame_fn_t lastFrame = &lastFrameFromSegmentLength)
 {
     // error vector
     vector<errors> err;
 
-    // parameters
-    int32_t step_size = 10;  // every second
-
-    // pre-compute distances (from ground truth as reference)
-    vector<float> dist = trajectoryDistances(poses_gt);
-
     // for all start positions do
-    for (int32_t first_frame = 0; first_frame < poses_gt.size();
-         first_frame += step_size)
+    for (int32_t first_frame = first_frame_begin;
+         first_frame < first_frame_end; first_frame += step_size)
     {
         // for all segment lengths do
         for (int32_t i = 0; i < num_lengths; i++)
@@ -379,8 +434,7 @@ vector<errors> calcSequenceErrors(
             float len = lengths[i];
 
             // compute last frame
-            int32_t last_frame =
-                lastFrameFromSegmentLength(dist, first_frame, len);
+            int32_t last_frame = lastFrame(dist, first_frame, len);
 
             // continue, if sequence not long enough
             if (last_frame == -1) continue;
@@ -408,6 +462,56 @@ vector<errors> calcSequenceErrors(
     return err;
 }
 
+// Evaluation of the errors of one sequence, split into chunks of first
+// frames which are evaluated in parallel. Results are gathered in order, so
+// they are identical to those of a serial evaluation.
+class SequenceErrorsTask
+{
+   public:
+    SequenceErrorsTask(
+        mrpt::WorkerThreadsPool& pool, const vector<Matrix>& poses_gt,
+        const vector<Matrix>& poses_result)
+    {
+        // parameters
+        const int32_t step_size = 10;  // every second
+        const int32_t chunk_len = 64 * step_size;
+
+        // pre-compute distances (from ground truth as reference)
+        dist_ = trajectoryDistances(poses_gt);
+
+        const auto n = static_cast<int32_t>(poses_gt.size());
+        for (int32_t first = 0; first < n; first += chunk_len)
+        {
+            const int32_t last = std::min(n, first + chunk_len);
+            chunks_.emplace_back(pool.enqueue(
+                [&poses_gt, &poses_result, this, first, last, step_size]()
+                {
+                    return calcSequenceErrors(
+                        poses_gt, poses_result, dist_, first, last, step_size);
+                }));
+        }
+    }
+
+    // Running tasks refer to dist_:
+    SequenceErrorsTask(const SequenceErrorsTask&)            = delete;
+    SequenceErrorsTask& operator=(const SequenceErrorsTask&) = delete;
+
+    vector<errors> get()
+    {
+        vector<errors> err;
+        for (auto& chunk : chunks_)
+        {
+            const auto e = chunk.get();
+            err.insert(err.end(), e.begin(), e.end());
+        }
+        return err;
+    }
+
+   private:
+    vector<float>                            dist_;
+    std::vector<std::future<vector<errors>>> chunks_;
+};
+
 void saveSequenceErrors(vector<errors>& err, string file_name)
 {
     // open file
@@ -428,7 +532,8 @@ void saveSequenceErrors(vector<errors>& err, string file_name)
 }
 
 void savePathPlot(
-    vector<Matrix>& poses_gt, vector<Matrix>& poses_result, string file_name)
+    const vector<Matrix>& poses_gt, const vector<Matrix>& poses_result,
+    string file_name)
 {
     // parameters
     int32_t step_size = 3;
@@ -447,15 +552,14 @@ void savePathPlot(
 }
 
 vector<int32_t> computeRoi(
-    vector<Matrix>& poses_gt, vector<Matrix>& poses_result)
+    const vector<Matrix>& poses_gt, const vector<Matrix>& poses_result)
 {
     float x_min = static_cast<float>(numeric_limits<int32_t>::max());
     float x_max = static_cast<float>(numeric_limits<int32_t>::min());
     float z_min = static_cast<float>(numeric_limits<int32_t>::max());
     float z_max = static_cast<float>(numeric_limits<int32_t>::min());
 
-    for (vector<Matrix>::iterator it = poses_gt.begin(); it != poses_gt.end();
-         it++)
+    for (auto it = poses_gt.begin(); it != poses_gt.end(); it++)
     {
         float x = it->coeff(0, 3);
         float z = it->coeff(2, 3);
@@ -465,8 +569,7 @@ vector<int32_t> computeRoi(
         if (z > z_max) z_max = z;
     }
 
-    for (vector<Matrix>::iterator it = poses_result.begin();
-         it != poses_result.end(); it++)
+    for (auto it = poses_result.begin(); it != poses_result.end(); it++)
     {
         float x = it->coeff(0, 3);
         float z = it->coeff(2, 3);
@@ -873,11 +976,19 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
         }
     }
 
-    // for all sequences do
-    for (const auto& seq : seqs)
+    // Load all sequences first:
+    struct SeqPoses
     {
         vector<Matrix> poses_result;
         vector<Matrix> poses_gt;
+    };
+    std::deque<SeqPoses> seqPoses;
+
+    for (const auto& seq : seqs)
+    {
+        auto& sp           = seqPoses.emplace_back();
+        auto& poses_result = sp.poses_result;
+        auto& poses_gt     = sp.poses_gt;
 
         if (cli.argResultInKittiFormat.isSet())
         {
@@ -904,6 +1015,36 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
             }
         }
 
+        // check for errors
+        // (reported below, after the output of all previous sequences)
+        if (poses_gt.size() == 0 || poses_result.size() != poses_gt.size())
+            break;
+    }
+
+    // Evaluate errors of all sequences, in parallel.
+    // (declared in this order so the pool is stopped before destroying tasks)
+    std::deque<SequenceErrorsTask> seqTasks;
+
+    mrpt::WorkerThreadsPool pool(
+        cli.argNumThreads.getValue() != 0
+            ? cli.argNumThreads.getValue()
+            : std::max(1U, std::thread::hardware_concurrency()),
+        mrpt::WorkerThreadsPool::POLICY_FIFO, "kitti-metrics-eval");
+
+    for (const auto& sp : seqPoses)
+    {
+        if (sp.poses_gt.empty() || sp.poses_result.size() != sp.poses_gt.size())
+            break;
+        seqTasks.emplace_back(pool, sp.poses_gt, sp.poses_result);
+    }
+
+    // for all sequences do
+    for (size_t seqIdx = 0; seqIdx < seqPoses.size(); seqIdx++)
+    {
+        const auto& seq          = seqs.at(seqIdx);
+        const auto& poses_result = seqPoses.at(seqIdx).poses_result;
+        const auto& poses_gt     = seqPoses.at(seqIdx).poses_gt;
+
         // plot status
         printf(
             "Processing: %s, poses: %ld/%ld\n", seq.file_name.c_str(),
@@ -913,7 +1054,7 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
         printf("-- poses_result: %lu entries\n", poses_result.size());
 
         // check for errors
-        if (poses_gt.size() == 0 || poses_result.size() != poses_gt.size())
+        if (seqIdx >= seqTasks.size())
         {
             printf(
                 "ERROR: Couldn't read (all) poses of: %s\n",
@@ -922,7 +1063,7 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
         }
 
         // compute sequence errors
-        vector<errors> seq_err = calcSequenceErrors(poses_gt, poses_result);
+        vector<errors> seq_err = seqTasks.at(seqIdx).get();
         saveSequenceErrors(seq_err, error_dir + "/" + seq.file_name);
 
         // add to total errors
@@ -942,7 +1083,6 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
             plotErrorPlots(cli, plot_error_dir, seq.file_name.c_str());
         }
     }
-
     // save + plot total errors + summary statistics
     if (total_err.size() > 0)
     {
@@ -956,3 +1096,89 @@ bool eval(Cli& cli)  // string result_sha,Mail* mail)
     // success
     return true;
 }
+
+void run_benchmark(Cli& cli)
+{
+    const int32_t n = cli.argBenchmark.getValue();
+    ASSERT_GT_(n, 0);
+
+    // Synthetic ground truth: a vehicle driving at random speeds, and a
+    // drifting estimate of it:
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    vector<Matrix> poses_gt, poses_result;
+    poses_gt.reserve(n);
+    poses_result.reserve(n);
+
+    mrpt::poses::CPose3D gt, result;
+    for (int32_t i = 0; i < n; i++)
+    {
+        const double speed = rng.drawUniform(0.1, 1.0);  // [m/frame]
+        const double dYaw  = rng.drawGaussian1D(0, 0.01);
+
+        gt = gt + mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                      speed, 0, 0, dYaw, 0, 0);
+        result = result + mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                              speed * 1.01, 0, 0, dYaw + 1e-4, 0, 0);
+
+        poses_gt.push_back(gt.getHomogeneousMatrixVal<Matrix>());
+        poses_result.push_back(result.getHomogeneousMatrixVal<Matrix>());
+    }
+
+    mrpt::system::CTicTac tictac;
+
+    // Original algorithm: serial, linear search of last frames:
+    tictac.Tic();
+    const auto dist   = trajectoryDistances(poses_gt);
+    const auto errRef = calcSequenceErrors(
+        poses_gt, poses_result, dist, 0, n, 10,
+        &lastFrameFromSegmentLengthLinear);
+    const double tRef = tictac.Tac();
+
+    // Serial, binary search:
+    tictac.Tic();
+    const auto errSerial =
+        calcSequenceErrors(poses_gt, poses_result, dist, 0, n, 10);
+    const double tSerial = tictac.Tac();
+
+    // Parallel, binary search:
+    const unsigned int nThreads =
+        cli.argNumThreads.getValue() != 0
+            ? cli.argNumThreads.getValue()
+            : std::max(1U, std::thread::hardware_concurrency());
+
+    mrpt::WorkerThreadsPool pool(
+        nThreads, mrpt::WorkerThreadsPool::POLICY_FIFO, "kitti-metrics-eval");
+
+    tictac.Tic();
+    const auto errParallel =
+        SequenceErrorsTask(pool, poses_gt, poses_result).get();
+    const double tParallel = tictac.Tac();
+
+    const auto lambdaIdentical =
+        [](const vector<errors>& a, const vector<errors>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++)
+            if (a[i].first_frame != b[i].first_frame ||
+                a[i].r_err != b[i].r_err || a[i].t_err != b[i].t_err ||
+                a[i].len != b[i].len || a[i].speed != b[i].speed)
+                return false;
+        return true;
+    };
+
+    printf("Benchmark with %d poses, %zu segments:\n", n, errRef.size());
+    printf(" - Original (serial, linear search): %.03f s\n", tRef);
+    printf(" - Serial, binary search           : %.03f s\n", tSerial);
+    printf(
+        " - Parallel (%u threads)           : %.03f s\n", nThreads,
+        tParallel);
+
+    ASSERTMSG_(
+        lambdaIdentical(errRef, errSerial) &&
+            lambdaIdentical(errRef, errParallel),
+        "Results differ from the original algorithm!");
+
+    printf("Results are identical.\n");
+}
@@ -31,6 +31,8 @@
 #include <tf2_ros/transform_broadcaster.h>
 #include <tf2_ros/transform_listener.h>
 
+#include <functional>
+#include <map>
 #include <nav_msgs/msg/odometry.hpp>
 #include <optional>
 #include <sensor_msgs/msg/image.hpp>
@@ -228,8 +230,10 @@ class BridgeROS2 : public RawDataSourceBase, public mola::RawDataConsumer
     {
         // MOLA subscribers:
         std::set<mola::RawDataSourceBase::Ptr>                  dataSources;
-        std::set<std::shared_ptr<mola::LocalizationSourceBase>> locSources;
-        std::set<std::shared_ptr<mola::MapSourceBase>>          mapSources;
+        // Subscription handles, to unsubscribe in our dtor:
+        std::map<std::shared_ptr<mola::LocalizationSourceBase>, mola::subscription_id_t>
+            locSources;
+        std::map<std::shared_ptr<mola::MapSourceBase>, mola::subscription_id_t> mapSources;
         std::set<std::shared_ptr<mola::Relocalization>>         relocalization;
         std::set<std::shared_ptr<mola::MapServer>>              mapServers;
     };
@@ -251,13 +255,27 @@ class BridgeROS2 : public RawDataSourceBase, public mola::RawDataConsumer
         const std::shared_ptr<mola_msgs::srv::RelocalizeNearPose::Request> request,
         std::shared_ptr<mola_msgs::srv::RelocalizeNearPose::Response>      response);
 
+    // Map load/save requests are served in the background, by the MapServer
+    // asynchronous API, and responded when done:
     void service_map_load(
-        const std::shared_ptr<mola_msgs::srv::MapLoad::Request> request,
-        std::shared_ptr<mola_msgs::srv::MapLoad::Response>      response);
+        const rclcpp::Service<mola_msgs::srv::MapLoad>::SharedPtr handle,
+        const std::shared_ptr<rmw_request_id_t>                   header,
+        const std::shared_ptr<mola_msgs::srv::MapLoad::Request>   request);
 
     void service_map_save(
-        const std::shared_ptr<mola_msgs::srv::MapSave::Request> request,
-        std::shared_ptr<mola_msgs::srv::MapSave::Response>      response);
+        const rclcpp::Service<mola_msgs::srv::MapSave>::SharedPtr handle,
+        const std::shared_ptr<rmw_request_id_t>                   header,
+        const std::shared_ptr<mola_msgs::srv::MapSave::Request>   request);
+
+    mola::MapServer::AsyncCallbacks mapOperationCallbacks(
+        const std::string&                                         description,
+        std::function<void(const mola::MapServer::ReturnStatus&)> sendResponse);
+
+    /// Map load/save operations in progress, cancelled in the destructor
+    std::vector<mola::MapServer::Operation::Ptr> mapOps_;
+    std::mutex                                   mapOpsMtx_;
+
+    void addMapOperation(const mola::MapServer::Operation::Ptr& op);
 
     void onNewLocalization(const mola::LocalizationSourceBase::LocalizationUpdate& l);
 
@@ -19,6 +19,7 @@
 #include <mola_bridge_ros2/BridgeROS2.h>
 
 // MOLA/MRPT:
+#include <mola_kernel/ObservationPools.h>
 #include <mola_kernel/pretty_print_exception.h>
 #include <mola_yaml/yaml_helpers.h>
 #include <mrpt/containers/yaml.h>
@@ -46,6 +47,8 @@
 #include <rclcpp/node.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.hpp>
 
+#include <algorithm>
+
 using namespace mola;
 
 // arguments: class_name, parent_class, class namespace
@@ -59,6 +62,23 @@ BridgeROS2::~BridgeROS2()
 {
     try
     {
+        // Make sure no more callbacks arrive from MOLA delivery threads:
+        {
+            auto lck = mrpt::lockHelper(molaSubsMtx_);
+            for (auto& [loc, id] : molaSubs_.locSources)
+                loc->unsubscribeFromLocalizationUpdates(id);
+            for (auto& [ms, id] : molaSubs_.mapSources) ms->unsubscribeFromMapUpdates(id);
+        }
+
+        // Map operations in progress would send their responses to us:
+        std::vector<mola::MapServer::Operation::Ptr> ops;
+        {
+            auto lck = mrpt::lockHelper(mapOpsMtx_);
+            ops.swap(mapOps_);
+        }
+        for (auto& op : ops) op->cancel();
+        for (auto& op : ops) op->future().wait();
+
         rclcpp::shutdown();
         if (rosNodeThread_.joinable()) rosNodeThread_.join();
     }
@@ -220,11 +240,14 @@ void BridgeROS2::callbackOnPointCloud2(
 
     const std::set<std::string> fields = mrpt::ros2bridge::extractFields(o);
 
+    // Pooled objects, recycled once all MOLA modules are done with them:
+    auto& pools = mola::ObservationPools::Instance();
+
     mrpt::maps::CPointsMap::Ptr mapPtr;
 
     if (fields.count("time") || fields.count("timestamp") || fields.count("ring"))
     {
-        auto p = mrpt::maps::CPointsMapXYZIRT::Create();
+        auto p = pools.acquire<mrpt::maps::CPointsMapXYZIRT>();
         if (!mrpt::ros2bridge::fromROS(o, *p))
             throw std::runtime_error("Error converting ros->mrpt(?)");
 
@@ -232,7 +255,7 @@ void BridgeROS2::callbackOnPointCloud2(
     }
     else if (fields.count("intensity"))
     {
-        auto p = mrpt::maps::CPointsMapXYZI::Create();
+        auto p = pools.acquire<mrpt::maps::CPointsMapXYZI>();
         if (!mrpt::ros2bridge::fromROS(o, *p))
             throw std::runtime_error("Error converting ros->mrpt(?)");
 
@@ -240,14 +263,14 @@ void BridgeROS2::callbackOnPointCloud2(
     }
     else
     {
-        auto p = mrpt::maps::CSimplePointsMap::Create();
+        auto p = pools.acquire<mrpt::maps::CSimplePointsMap>();
         if (!mrpt::ros2bridge::fromROS(o, *p))
             throw std::runtime_error("Error converting ros->mrpt(?)");
 
         mapPtr = p;
     }
 
-    auto obs_pc         = mrpt::obs::CObservationPointCloud::Create();
+    auto obs_pc         = pools.acquire<mrpt::obs::CObservationPointCloud>();
     obs_pc->timestamp   = mrpt::ros2bridge::fromROS(o.header.stamp);
     obs_pc->sensorLabel = outSensorLabel;
     obs_pc->pointcloud  = mapPtr;
@@ -874,8 +897,8 @@ void BridgeROS2::doLookForNewMolaSubs()
                 << module->getModuleInstanceName() << "'");
 
             // a new one:
-            molaSubs_.locSources.insert(loc);
-            loc->subscribeToLocalizationUpdates([this](const auto& l) { onNewLocalization(l); });
+            molaSubs_.locSources[loc] = loc->subscribeToLocalizationUpdates(
+                [this](const auto& l) { onNewLocalization(l); });
         }
     }
 
@@ -893,8 +916,8 @@ void BridgeROS2::doLookForNewMolaSubs()
                                                           << "'");
 
             // a new one:
-            molaSubs_.mapSources.insert(ms);
-            ms->subscribeToMapUpdates([this](const auto& m) { onNewMap(m); });
+            molaSubs_.mapSources[ms] =
+                ms->subscribeToMapUpdates([this](const auto& m) { onNewMap(m); });
         }
     }
 
@@ -961,10 +984,10 @@ void BridgeROS2::doLookForNewMolaSubs()
         using namespace std::placeholders;
 
         srvMapLoad_ = rosNode_->create_service<mola_msgs::srv::MapLoad>(
-            "map_load", std::bind(&BridgeROS2::service_map_load, this, _1, _2));
+            "map_load", std::bind(&BridgeROS2::service_map_load, this, _1, _2, _3));
 
         srvMapSave_ = rosNode_->create_service<mola_msgs::srv::MapSave>(
-            "map_save", std::bind(&BridgeROS2::service_map_save, this, _1, _2));
+            "map_save", std::bind(&BridgeROS2::service_map_save, this, _1, _2, _3));
     }
 }
 
@@ -1003,46 +1026,106 @@ void BridgeROS2::service_relocalize_near_pose(
     response->accepted = true;
 }
 
+void BridgeROS2::addMapOperation(const mola::MapServer::Operation::Ptr& op)
+{
+    auto lck = mrpt::lockHelper(mapOpsMtx_);
+    mapOps_.erase(
+        std::remove_if(mapOps_.begin(), mapOps_.end(), [](const auto& o) { return o->done(); }),
+        mapOps_.end());
+    mapOps_.push_back(op);
+}
+
+mola::MapServer::AsyncCallbacks BridgeROS2::mapOperationCallbacks(
+    const std::string&                                         description,
+    std::function<void(const mola::MapServer::ReturnStatus&)> sendResponse)
+{
+    MRPT_LOG_INFO_STREAM(description << "...");
+
+    mola::MapServer::AsyncCallbacks cbs;
+
+    // Log every 10% of progress, at most:
+    cbs.on_progress = [this, description, lastDecile = -1](const auto& p) mutable {
+        const int decile = static_cast<int>(p.fraction * 10);
+        if (decile <= lastDecile) return;
+        lastDecile = decile;
+        MRPT_LOG_INFO_FMT(
+            "%s: %3.0f%% (%.02f MB) %s", description.c_str(), p.fraction * 100.0,
+            static_cast<double>(p.bytes) / (1024.0 * 1024.0), p.stage.c_str());
+    };
+
+    cbs.on_done = [this, description, sendResponse](const auto& r) {
+        if (r.success)
+            MRPT_LOG_INFO_STREAM(description << ": done.");
+        else
+            MRPT_LOG_ERROR_STREAM(description << ": failed: " << r.error_message);
+
+        sendResponse(r);
+    };
+    return cbs;
+}
+
 void BridgeROS2::service_map_load(
-    const std::shared_ptr<mola_msgs::srv::MapLoad::Request> request,
-    std::shared_ptr<mola_msgs::srv::MapLoad::Response>      response)
+    const rclcpp::Service<mola_msgs::srv::MapLoad>::SharedPtr handle,
+    const std::shared_ptr<rmw_request_id_t>                   header,
+    const std::shared_ptr<mola_msgs::srv::MapLoad::Request>   request)
 {
-    auto lck = mrpt::lockHelper(rosPubsMtx_);
-    if (molaSubs_.relocalization.empty())
+    std::shared_ptr<mola::MapServer> m;
     {
-        response->success       = false;
-        response->error_message = "No MOLA module with MapServer interface is running.";
-        MRPT_LOG_WARN(response->error_message);
-        return;
+        auto lck = mrpt::lockHelper(rosPubsMtx_);
+        if (!molaSubs_.mapServers.empty()) m = *molaSubs_.mapServers.begin();
     }
 
-    auto& m = *molaSubs_.mapServers.begin();
-    ASSERT_(m);
-    const auto& r = m->map_load(request->map_path);
+    const auto sendResponse = [handle, header](const mola::MapServer::ReturnStatus& r) {
+        mola_msgs::srv::MapLoad::Response response;
+        response.success       = r.success;
+        response.error_message = r.error_message;
+        handle->send_response(*header, response);
+    };
+
+    if (!m)
+    {
+        mola::MapServer::ReturnStatus r;
+        r.error_message = "No MOLA module with MapServer interface is running.";
+        MRPT_LOG_WARN(r.error_message);
+        sendResponse(r);
+        return;
+    }
 
-    response->success       = r.success;
-    response->error_message = r.error_message;
+    addMapOperation(m->map_load_async(
+        request->map_path,
+        mapOperationCallbacks("Loading map '" + request->map_path + "'", sendResponse)));
 }
 
 void BridgeROS2::service_map_save(
-    const std::shared_ptr<mola_msgs::srv::MapSave::Request> request,
-    std::shared_ptr<mola_msgs::srv::MapSave::Response>      response)
+    const rclcpp::Service<mola_msgs::srv::MapSave>::SharedPtr handle,
+    const std::shared_ptr<rmw_request_id_t>                   header,
+    const std::shared_ptr<mola_msgs::srv::MapSave::Request>   request)
 {
-    auto lck = mrpt::lockHelper(rosPubsMtx_);
-    if (molaSubs_.relocalization.empty())
+    std::shared_ptr<mola::MapServer> m;
     {
-        response->success       = false;
-        response->error_message = "No MOLA module with MapServer interface is running.";
-        MRPT_LOG_WARN(response->error_message);
-        return;
+        auto lck = mrpt::lockHelper(rosPubsMtx_);
+        if (!molaSubs_.mapServers.empty()) m = *molaSubs_.mapServers.begin();
     }
 
-    auto& m = *molaSubs_.mapServers.begin();
-    ASSERT_(m);
-    const auto& r = m->map_save(request->map_path);
+    const auto sendResponse = [handle, header](const mola::MapServer::ReturnStatus& r) {
+        mola_msgs::srv::MapSave::Response response;
+        response.success       = r.success;
+        response.error_message = r.error_message;
+        handle->send_response(*header, response);
+    };
+
+    if (!m)
+    {
+        mola::MapServer::ReturnStatus r;
+        r.error_message = "No MOLA module with MapServer interface is running.";
+        MRPT_LOG_WARN(r.error_message);
+        sendResponse(r);
+        return;
+    }
 
-    response->success       = r.success;
-    response->error_message = r.error_message;
+    addMapOperation(m->map_save_async(
+        request->map_path,
+        mapOperationCallbacks("Saving map '" + request->map_path + "'", sendResponse)));
 }
 
 rclcpp::Time BridgeROS2::myNow(const mrpt::Clock::time_point& observationStamp)
@@ -55,12 +55,25 @@ class IMUIntegrationParams
     IMUIntegrationParams()  = default;
     ~IMUIntegrationParams() = default;
 
-    /// Loads all parameters from a YAML map node.
+    /** Loads all parameters from a YAML map node.
+     *
+     * The node must contain all the entries expected by
+     * RotationIntegrationParams::load_from(), plus these optional ones:
+     * - `accBias`: `[bx, by, bz]` accelerometer bias (m/s²).
+     * - `gravityVector`: `[gx, gy, gz]` (m/s²).
+     * - `gyroNoiseDensity`: gyroscope white noise sigma (rad/s/√Hz).
+     * - `accNoiseDensity`: accelerometer white noise sigma (m/s²/√Hz).
+     * - `integrationSigma`: sigma of the integration (jerk) noise.
+     */
     void loadFrom(const mrpt::containers::yaml& cfg);
 
     /// Parameters for gyroscope integration:
     RotationIntegrationParams rotationParams;
 
+    /// Accelerometer (initial or constant) bias, in the local IMU frame of
+    /// reference (units: m/s²).
+    mrpt::math::TVector3D accBias = {.0, .0, .0};
+
     /// Gravity vector (units are m/s²), in the global frame of coordinates.
     mrpt::math::TVector3D gravityVector = {0, 0, -9.81};
 
@@ -0,0 +1,82 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ImuMeasurementBatch.h
+ * @brief  Buffer of IMU readings stored as contiguous arrays.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/math/TPoint3D.h>
+
+#include <vector>
+
+namespace mola
+{
+/** A buffer of IMU readings, stored as a structure of arrays (one contiguous
+ * array per component) for efficient batched processing.
+ *
+ * All arrays must have the same length.
+ *
+ * \sa ImuPreintegrator::integrate_measurements()
+ * \ingroup mola_imu_preintegration_grp
+ */
+struct ImuMeasurementBatch
+{
+    ImuMeasurementBatch() = default;
+
+    /// Timestamps [s], in ascending order
+    std::vector<double> t;
+
+    /// Angular velocity readings [rad/s], in the IMU frame
+    std::vector<double> wx, wy, wz;
+
+    /// Accelerometer (specific force) readings [m/s²], in the IMU frame
+    std::vector<double> ax, ay, az;
+
+    size_t size() const { return t.size(); }
+    bool   empty() const { return t.empty(); }
+
+    void clear()
+    {
+        for (auto* v : {&t, &wx, &wy, &wz, &ax, &ay, &az}) v->clear();
+    }
+
+    void reserve(size_t n)
+    {
+        for (auto* v : {&t, &wx, &wy, &wz, &ax, &ay, &az}) v->reserve(n);
+    }
+
+    void push_back(
+        double time, const mrpt::math::TVector3D& acc,
+        const mrpt::math::TVector3D& w)
+    {
+        t.push_back(time);
+        wx.push_back(w.x);
+        wy.push_back(w.y);
+        wz.push_back(w.z);
+        ax.push_back(acc.x);
+        ay.push_back(acc.y);
+        az.push_back(acc.z);
+    }
+};
+
+}  // namespace mola
@@ -49,7 +49,7 @@ namespace mola
  *
  * \note Initially based in part on GTSAM sources gtsam::PreintegratedRotation.
  *
- * \sa IMUIntegrator
+ * \sa ImuPreintegrator
  * \ingroup mola_imu_preintegration_grp
  */
 class RotationIntegrator
@@ -71,9 +71,8 @@ class RotationIntegrator
             mrpt::math::CMatrixDouble33::Identity();
 
         /// Jacobian of preintegrated rotation w.r.t. angular rate bias
-        // (TODO)
-        // mrpt::math::CMatrixDouble33 delRdelBiasOmega_ =
-        // mrpt::math::CMatrixDouble33::Zero();
+        mrpt::math::CMatrixDouble33 delRdelBiasOmega_ =
+            mrpt::math::CMatrixDouble33::Zero();
     };
 
     /** \name Main API
@@ -115,6 +114,9 @@ class RotationIntegrator
  *
  *  Rot = Exp((ω-ω_{bias})·dt)
  *
+ * If provided, D_incrR_integratedOmega is filled in with the right Jacobian
+ * of SO(3) evaluated at the integrated (bias-corrected) angle (ω-ω_{bias})·dt.
+ *
  * \ingroup mola_imu_preintegration_grp
  */
 mrpt::math::CMatrixDouble33 incremental_rotation(
@@ -123,4 +125,13 @@ mrpt::math::CMatrixDouble33 incremental_rotation(
     const mrpt::optional_ref<mrpt::math::CMatrixDouble33>&
         D_incrR_integratedOmega = std::nullopt);
 
+/** Right Jacobian of SO(3), Jr(θ), such that:
+ *
+ *  Exp(θ+δθ) ≃ Exp(θ)·Exp(Jr(θ)·δθ)
+ *
+ * \ingroup mola_imu_preintegration_grp
+ */
+mrpt::math::CMatrixDouble33 so3_right_jacobian(
+    const mrpt::math::TVector3D& theta);
+
 }  // namespace mola
@@ -25,5 +25,38 @@
  */
 
 #include <mola_imu_preintegration/IMUIntegrationParams.h>
+#include <mrpt/core/bits_math.h>
 
 using namespace mola;
+
+void IMUIntegrationParams::loadFrom(const mrpt::containers::yaml& cfg)
+{
+    rotationParams.load_from(cfg);
+
+    if (cfg.has("accBias"))
+        accBias = mrpt::math::TVector3D::FromVector(
+            cfg["accBias"].toStdVector<double>());
+
+    if (cfg.has("gravityVector"))
+        gravityVector = mrpt::math::TVector3D::FromVector(
+            cfg["gravityVector"].toStdVector<double>());
+
+    if (cfg.has("gyroNoiseDensity"))
+    {
+        const double sigma = cfg["gyroNoiseDensity"].as<double>();
+        rotationParams.gyroCov = mrpt::math::CMatrixDouble33(
+            mrpt::math::CMatrixDouble33::Identity() * mrpt::square(sigma));
+    }
+    if (cfg.has("accNoiseDensity"))
+    {
+        const double sigma = cfg["accNoiseDensity"].as<double>();
+        accCov = mrpt::math::CMatrixDouble33(
+            mrpt::math::CMatrixDouble33::Identity() * mrpt::square(sigma));
+    }
+    if (cfg.has("integrationSigma"))
+    {
+        const double sigma = cfg["integrationSigma"].as<double>();
+        integrationCov = mrpt::math::CMatrixDouble33(
+            mrpt::math::CMatrixDouble33::Identity() * mrpt::square(sigma));
+    }
+}
@@ -0,0 +1,280 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ImuPreintegrator.cpp
+ * @brief  Preintegration of IMU accelerations and angular velocity readings.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_imu_preintegration/ImuPreintegrator.h>
+#include <mola_imu_preintegration/RotationIntegrator.h>
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/poses/Lie/SO.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <future>
+#include <vector>
+
+#include "imu_preintegration_kernels.h"
+
+using namespace mola;
+
+namespace
+{
+Eigen::Vector3d toEigen(const mrpt::math::TVector3D& v)
+{
+    return {v.x, v.y, v.z};
+}
+
+mrpt::math::TVector3D fromEigen(const Eigen::Vector3d& v)
+{
+    return {v.x(), v.y(), v.z()};
+}
+
+internal::PreintegrationModel toModel(
+    const IMUIntegrationParams&               p,
+    const ImuPreintegrator::IntegrationState& s)
+{
+    internal::PreintegrationModel m;
+    if (p.rotationParams.sensorPose.has_value())
+        m.Rs = p.rotationParams.sensorPose->getRotationMatrix().asEigen();
+    m.accCov         = p.accCov.asEigen();
+    m.gyroCov        = p.rotationParams.gyroCov.asEigen();
+    m.integrationCov = p.integrationCov.asEigen();
+    m.biasGyro       = toEigen(s.biasGyro_);
+    m.biasAcc        = toEigen(s.biasAcc_);
+    return m;
+}
+
+internal::PreintegrationDelta toDelta(
+    const ImuPreintegrator::IntegrationState& s)
+{
+    internal::PreintegrationDelta d;
+    d.deltaT = s.deltaTij_;
+    d.dR     = s.deltaRij_.asEigen();
+    d.dV     = toEigen(s.deltaVij_);
+    d.dP     = toEigen(s.deltaPij_);
+    d.cov    = s.preintMeasCov_.asEigen();
+    d.dRdbg  = s.delRdelBiasOmega_.asEigen();
+    d.dVdbg  = s.delVdelBiasOmega_.asEigen();
+    d.dVdba  = s.delVdelBiasAcc_.asEigen();
+    d.dPdbg  = s.delPdelBiasOmega_.asEigen();
+    d.dPdba  = s.delPdelBiasAcc_.asEigen();
+    return d;
+}
+
+void fromDelta(
+    const internal::PreintegrationDelta& d,
+    ImuPreintegrator::IntegrationState&  s)
+{
+    s.deltaTij_         = d.deltaT;
+    s.deltaRij_         = mrpt::math::CMatrixDouble33(d.dR);
+    s.deltaVij_         = fromEigen(d.dV);
+    s.deltaPij_         = fromEigen(d.dP);
+    s.preintMeasCov_    = ImuPreintegrator::CMatrixDouble99(d.cov);
+    s.delRdelBiasOmega_ = mrpt::math::CMatrixDouble33(d.dRdbg);
+    s.delVdelBiasOmega_ = mrpt::math::CMatrixDouble33(d.dVdbg);
+    s.delVdelBiasAcc_   = mrpt::math::CMatrixDouble33(d.dVdba);
+    s.delPdelBiasOmega_ = mrpt::math::CMatrixDouble33(d.dPdbg);
+    s.delPdelBiasAcc_   = mrpt::math::CMatrixDouble33(d.dPdba);
+}
+}  // namespace
+
+void ImuPreintegrator::initialize(const mrpt::containers::yaml& cfg)
+{
+    // Load params:
+    params_.loadFrom(cfg);
+
+    reset_integration();
+}
+
+void ImuPreintegrator::reset_integration()
+{
+    // reset:
+    state_ = IntegrationState();
+
+    // Take the current biases as linearization point:
+    state_.biasGyro_ = params_.rotationParams.gyroBias;
+    state_.biasAcc_  = params_.accBias;
+}
+
+void ImuPreintegrator::integrate_measurement(
+    const mrpt::math::TVector3D& acc, const mrpt::math::TVector3D& w,
+    double dt)
+{
+    ASSERT_GT_(dt, .0);
+
+    const internal::PreintegrationModel m = toModel(params_, state_);
+
+    // Corrected (bias-free) acceleration, in the vehicle frame:
+    const Eigen::Vector3d a = m.Rs * (toEigen(acc) - m.biasAcc);
+
+    // Rotation increment, using the linearization bias:
+    RotationIntegrationParams rp = params_.rotationParams;
+    rp.gyroBias                  = state_.biasGyro_;
+
+    mrpt::math::CMatrixDouble33 Jr;
+    const mrpt::math::CMatrixDouble33 incrR =
+        mola::incremental_rotation(w, rp, dt, Jr);
+
+    internal::PreintegrationDelta d = toDelta(state_);
+    internal::preintegration_step(
+        d, m, a, incrR.asEigen(), Jr.asEigen(), dt, true /*covariance*/);
+    fromDelta(d, state_);
+}
+
+void ImuPreintegrator::integrate_measurements(
+    const ImuMeasurementBatch& batch, double t_end, const BatchOptions& opts)
+{
+    const size_t n = batch.size();
+    if (n == 0) return;
+
+    ASSERT_EQUAL_(batch.wx.size(), n);
+    ASSERT_EQUAL_(batch.wy.size(), n);
+    ASSERT_EQUAL_(batch.wz.size(), n);
+    ASSERT_EQUAL_(batch.ax.size(), n);
+    ASSERT_EQUAL_(batch.ay.size(), n);
+    ASSERT_EQUAL_(batch.az.size(), n);
+    ASSERT_GE_(t_end, batch.t.back());
+    // Repeated timestamps are fine (zero-length steps integrate nothing), but
+    // time must not go backwards:
+    ASSERTMSG_(
+        std::is_sorted(batch.t.begin(), batch.t.end()),
+        "IMU batch timestamps must be non-decreasing");
+
+    const internal::PreintegrationModel m = toModel(params_, state_);
+
+    internal::ImuBatchView b;
+    b.t     = batch.t.data();
+    b.wx    = batch.wx.data();
+    b.wy    = batch.wy.data();
+    b.wz    = batch.wz.data();
+    b.ax    = batch.ax.data();
+    b.ay    = batch.ay.data();
+    b.az    = batch.az.data();
+    b.n     = n;
+    b.t_end = t_end;
+
+    const bool withCov = opts.compute_covariance;
+
+    // Number of chunks for the parallel prefix-composition mode:
+    const size_t minPerChunk = std::max<size_t>(1, opts.min_samples_per_chunk);
+    const size_t nChunks     = std::clamp<size_t>(
+            opts.parallel_chunks, 1, std::max<size_t>(1, n / minPerChunk));
+
+    std::vector<internal::PreintegrationDelta> chunks(nChunks);
+
+    if (nChunks == 1)
+    {
+        internal::preintegrate_batch(chunks[0], m, b, 0, n, withCov);
+    }
+    else
+    {
+        // Integrate each chunk independently from the identity, in parallel,
+        // then compose them in order:
+        mrpt::WorkerThreadsPool pool(
+            nChunks, mrpt::WorkerThreadsPool::POLICY_FIFO,
+            "ImuPreintegrator"  // threads name
+        );
+        std::vector<std::future<void>> futs;
+
+        for (size_t c = 0; c < nChunks; c++)
+        {
+            const size_t first = (n * c) / nChunks;
+            const size_t last  = (n * (c + 1)) / nChunks;
+
+            futs.emplace_back(pool.enqueue(
+                [&chunks, &m, &b, c, first, last, withCov]()
+                {
+                    internal::preintegrate_batch(
+                        chunks[c], m, b, first, last, withCov);
+                }));
+        }
+        for (auto& f : futs) f.get();
+    }
+
+    internal::PreintegrationDelta d = toDelta(state_);
+    for (const auto& chunk : chunks) d = internal::compose(d, chunk, withCov);
+
+    fromDelta(d, state_);
+}
+
+ImuPreintegrator::Delta ImuPreintegrator::bias_corrected_delta(
+    const mrpt::math::TVector3D& newBiasGyro,
+    const mrpt::math::TVector3D& newBiasAcc) const
+{
+    const Eigen::Vector3d dbg = toEigen(newBiasGyro - state_.biasGyro_);
+    const Eigen::Vector3d dba = toEigen(newBiasAcc - state_.biasAcc_);
+
+    Delta d;
+
+    const Eigen::Vector3d dPhi = state_.delRdelBiasOmega_.asEigen() * dbg;
+
+    d.deltaRij = mrpt::math::CMatrixDouble33(
+        state_.deltaRij_.asEigen() *
+        mrpt::poses::Lie::SO<3>::exp(mrpt::math::CVectorFixedDouble<3>(dPhi))
+            .asEigen());
+
+    d.deltaVij = fromEigen(
+        toEigen(state_.deltaVij_) + state_.delVdelBiasOmega_.asEigen() * dbg +
+        state_.delVdelBiasAcc_.asEigen() * dba);
+
+    d.deltaPij = fromEigen(
+        toEigen(state_.deltaPij_) + state_.delPdelBiasOmega_.asEigen() * dbg +
+        state_.delPdelBiasAcc_.asEigen() * dba);
+
+    return d;
+}
+
+ImuPreintegrator::KinematicState ImuPreintegrator::predict(
+    const KinematicState& stateI) const
+{
+    Delta d;
+    d.deltaRij = state_.deltaRij_;
+    d.deltaVij = state_.deltaVij_;
+    d.deltaPij = state_.deltaPij_;
+
+    return predict(stateI, d);
+}
+
+ImuPreintegrator::KinematicState ImuPreintegrator::predict(
+    const KinematicState& stateI, const Delta& delta) const
+{
+    const double          dt = state_.deltaTij_;
+    const Eigen::Vector3d g  = toEigen(params_.gravityVector);
+
+    const Eigen::Matrix3d Ri = stateI.pose.getRotationMatrix().asEigen();
+    const Eigen::Vector3d vi = toEigen(stateI.velocity);
+    const Eigen::Vector3d pi = toEigen(stateI.pose.translation());
+
+    const Eigen::Matrix3d Rj = Ri * delta.deltaRij.asEigen();
+    const Eigen::Vector3d vj = vi + g * dt + Ri * toEigen(delta.deltaVij);
+    const Eigen::Vector3d pj =
+        pi + vi * dt + 0.5 * g * dt * dt + Ri * toEigen(delta.deltaPij);
+
+    KinematicState ret;
+    ret.pose = mrpt::poses::CPose3D::FromRotationAndTranslation(
+        mrpt::math::CMatrixDouble33(Rj), fromEigen(pj));
+    ret.velocity = fromEigen(vj);
+
+    return ret;
+}
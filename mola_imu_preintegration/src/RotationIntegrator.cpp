@@ -27,6 +27,9 @@
 #include <mola_imu_preintegration/RotationIntegrator.h>
 #include <mrpt/poses/Lie/SO.h>
 
+#include <Eigen/Dense>
+#include <cmath>
+
 using namespace mola;
 
 void RotationIntegrator::initialize(const mrpt::containers::yaml& cfg)
@@ -46,13 +49,26 @@ void RotationIntegrator::reset_integration()
 void RotationIntegrator::integrate_measurement(
     const mrpt::math::TVector3D& w, double dt)
 {
-    const auto incrR = mola::incremental_rotation(w, params_, dt);
+    mrpt::math::CMatrixDouble33 D_incrR_integratedOmega;
+
+    const auto incrR =
+        mola::incremental_rotation(w, params_, dt, D_incrR_integratedOmega);
+
+    // Jacobian of the corrected angular velocity wrt the gyro bias is -R_s,
+    // with R_s the sensor-to-vehicle rotation:
+    Eigen::Matrix3d D_incrR_bias = -D_incrR_integratedOmega.asEigen() * dt;
+    if (params_.sensorPose.has_value())
+        D_incrR_bias =
+            D_incrR_bias * params_.sensorPose->getRotationMatrix().asEigen();
+
+    // Update Jacobian (must use the former value of deltaRij_):
+    state_.delRdelBiasOmega_ = mrpt::math::CMatrixDouble33(
+        incrR.asEigen().transpose() * state_.delRdelBiasOmega_.asEigen() +
+        D_incrR_bias);
 
     // Update integration state:
     state_.deltaTij_ += dt;
     state_.deltaRij_ = state_.deltaRij_ * incrR;
-
-    // TODO: Update Jacobian
 }
 
 mrpt::math::CMatrixDouble33 mola::incremental_rotation(
@@ -74,11 +90,29 @@ mrpt::math::CMatrixDouble33 mola::incremental_rotation(
     const TVector3D w_dt = correctedW * dt;
 
     if (D_incrR_integratedOmega.has_value())
-    {
-        // TODO: Jacobian: mrpt::poses::Lie::SO<3>::jacob_dexpe_de()
-        THROW_EXCEPTION("Jacobian not implemented yet");
-    }
+        D_incrR_integratedOmega.value().get() = so3_right_jacobian(w_dt);
 
     return mrpt::poses::Lie::SO<3>::exp(
         mrpt::math::CVectorFixedDouble<3>(w_dt));
 }
+
+mrpt::math::CMatrixDouble33 mola::so3_right_jacobian(
+    const mrpt::math::TVector3D& theta)
+{
+    const double th2 = theta.sqrNorm();
+    const double th  = std::sqrt(th2);
+
+    Eigen::Matrix3d W;
+    W << 0, -theta.z, theta.y,  //
+        theta.z, 0, -theta.x,  //
+        -theta.y, theta.x, 0;
+
+    // Small angle: use Taylor expansion to avoid numerical issues
+    if (th < 1e-5)
+        return mrpt::math::CMatrixDouble33(
+            Eigen::Matrix3d::Identity() - 0.5 * W + (1.0 / 6.0) * W * W);
+
+    return mrpt::math::CMatrixDouble33(
+        Eigen::Matrix3d::Identity() - ((1.0 - std::cos(th)) / th2) * W +
+        ((th - std::sin(th)) / (th2 * th)) * W * W);
+}
@@ -0,0 +1,305 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   imu_preintegration_kernels.cpp
+ * @brief  Internal (Eigen-only) numerical kernels for IMU preintegration.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include "imu_preintegration_kernels.h"
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace mola::internal;
+
+namespace
+{
+Eigen::Matrix3d skew(const Eigen::Vector3d& v)
+{
+    Eigen::Matrix3d S;
+    S << 0, -v.z(), v.y(),  //
+        v.z(), 0, -v.x(),  //
+        -v.y(), v.x(), 0;
+    return S;
+}
+
+// Above this angle, the Taylor expansions below are replaced by the exact
+// expressions. Truncation error of the expansions is O(θ⁸/9!) < 1e-13.
+constexpr double SMALL_ANGLE_THRESHOLD = 0.1;  // [rad]
+
+// Per-thread scratch buffers, reused across calls to avoid reallocations:
+struct BatchScratch
+{
+    std::vector<double> dt, ax, ay, az;
+    std::vector<double> tx, ty, tz;  // θ = ω·dt
+    // Row-major 3x3 rotation increments and right Jacobians, one array per
+    // matrix entry:
+    std::array<std::vector<double>, 9> R, J;
+
+    void resize(std::size_t n)
+    {
+        for (auto* v : {&dt, &ax, &ay, &az, &tx, &ty, &tz}) v->resize(n);
+        for (auto& v : R) v.resize(n);
+        for (auto& v : J) v.resize(n);
+    }
+};
+}  // namespace
+
+void mola::internal::preintegration_step(
+    PreintegrationDelta& s, const PreintegrationModel& m,
+    const Eigen::Vector3d& a, const Eigen::Matrix3d& incrR,
+    const Eigen::Matrix3d& Jr, double dt, bool withCovariance)
+{
+    // Shortcuts to the state *before* this update:
+    const Eigen::Matrix3d dR  = s.dR;
+    const Eigen::Matrix3d dRa = dR * skew(a);
+    const double          dt2 = dt * dt;
+
+    // 1) Covariance propagation: Σ = A·Σ·Aᵀ + B·Σ_a·Bᵀ + C·Σ_g·Cᵀ
+    if (withCovariance)
+    {
+        Eigen::Matrix<double, 9, 9> A = Eigen::Matrix<double, 9, 9>::Identity();
+        A.block<3, 3>(0, 0) = incrR.transpose();
+        A.block<3, 3>(3, 0) = -dRa * dt;
+        A.block<3, 3>(6, 0) = -0.5 * dRa * dt2;
+        A.block<3, 3>(6, 3) = Eigen::Matrix3d::Identity() * dt;
+
+        // B·Σ_a·Bᵀ and C·Σ_g·Cᵀ only have non-zero 3x3 blocks, so build
+        // them directly instead of multiplying 9x3 matrices:
+        const Eigen::Matrix3d dRRs  = dR * m.Rs;
+        const Eigen::Matrix3d accQ  = dRRs * m.accCov * dRRs.transpose() / dt;
+        const Eigen::Matrix3d JrRs  = Jr * m.Rs;
+        const Eigen::Matrix3d gyroQ = JrRs * m.gyroCov * JrRs.transpose() * dt;
+
+        Eigen::Matrix<double, 9, 9> P = A * s.cov * A.transpose();
+        P.block<3, 3>(0, 0) += gyroQ;
+        P.block<3, 3>(3, 3) += accQ * dt2;
+        P.block<3, 3>(3, 6) += accQ * (0.5 * dt2 * dt);
+        P.block<3, 3>(6, 3) += accQ * (0.5 * dt2 * dt);
+        P.block<3, 3>(6, 6) += accQ * (0.25 * dt2 * dt2);
+        P.block<3, 3>(6, 6) += m.integrationCov * dt;
+        s.cov = P;
+    }
+
+    // 2) Bias Jacobians (they also depend on the former deltas):
+    s.dPdba += s.dVdba * dt - 0.5 * dR * m.Rs * dt2;
+    s.dPdbg += s.dVdbg * dt - 0.5 * dRa * s.dRdbg * dt2;
+    s.dVdba -= dR * m.Rs * dt;
+    s.dVdbg -= dRa * s.dRdbg * dt;
+    s.dRdbg = incrR.transpose() * s.dRdbg - Jr * m.Rs * dt;
+
+    // 3) Preintegrated deltas:
+    s.dP += s.dV * dt + 0.5 * dR * a * dt2;
+    s.dV += dR * a * dt;
+    s.dR = dR * incrR;
+    s.deltaT += dt;
+}
+
+PreintegrationDelta mola::internal::compose(
+    const PreintegrationDelta& ij, const PreintegrationDelta& jk,
+    bool withCovariance)
+{
+    PreintegrationDelta ik;
+
+    const Eigen::Matrix3d& Rij = ij.dR;
+    const Eigen::Matrix3d  Sv  = skew(jk.dV);
+    const Eigen::Matrix3d  Sp  = skew(jk.dP);
+    const double           Tjk = jk.deltaT;
+
+    ik.deltaT = ij.deltaT + jk.deltaT;
+    ik.dR     = Rij * jk.dR;
+    ik.dV     = ij.dV + Rij * jk.dV;
+    ik.dP     = ij.dP + ij.dV * Tjk + Rij * jk.dP;
+
+    ik.dRdbg = jk.dR.transpose() * ij.dRdbg + jk.dRdbg;
+    ik.dVdbg = ij.dVdbg + Rij * jk.dVdbg - Rij * Sv * ij.dRdbg;
+    ik.dVdba = ij.dVdba + Rij * jk.dVdba;
+    ik.dPdbg = ij.dPdbg + ij.dVdbg * Tjk - Rij * Sp * ij.dRdbg +
+               Rij * jk.dPdbg;
+    ik.dPdba = ij.dPdba + ij.dVdba * Tjk + Rij * jk.dPdba;
+
+    if (withCovariance)
+    {
+        Eigen::Matrix<double, 9, 9> A = Eigen::Matrix<double, 9, 9>::Identity();
+        A.block<3, 3>(0, 0) = jk.dR.transpose();
+        A.block<3, 3>(3, 0) = -Rij * Sv;
+        A.block<3, 3>(6, 0) = -Rij * Sp;
+        A.block<3, 3>(6, 3) = Eigen::Matrix3d::Identity() * Tjk;
+
+        Eigen::Matrix<double, 9, 9> B = Eigen::Matrix<double, 9, 9>::Identity();
+        B.block<3, 3>(3, 3)           = Rij;
+        B.block<3, 3>(6, 6)           = Rij;
+
+        ik.cov = A * ij.cov * A.transpose() + B * jk.cov * B.transpose();
+    }
+    else
+    {
+        // Covariance not updated:
+        ik.cov = ij.cov;
+    }
+
+    return ik;
+}
+
+void mola::internal::preintegrate_batch(
+    PreintegrationDelta& s, const PreintegrationModel& m, const ImuBatchView& b,
+    std::size_t first, std::size_t last, bool withCovariance)
+{
+    if (last <= first) return;
+
+    const std::size_t n = last - first;
+
+    thread_local BatchScratch scratch;
+    scratch.resize(n);
+
+    double* dt = scratch.dt.data();
+    double* ax = scratch.ax.data();
+    double* ay = scratch.ay.data();
+    double* az = scratch.az.data();
+    double* tx = scratch.tx.data();
+    double* ty = scratch.ty.data();
+    double* tz = scratch.tz.data();
+
+    const double* t   = b.t + first;
+    const double* iwx = b.wx + first;
+    const double* iwy = b.wy + first;
+    const double* iwz = b.wz + first;
+    const double* iax = b.ax + first;
+    const double* iay = b.ay + first;
+    const double* iaz = b.az + first;
+
+    // Local copies, so the compiler knows they do not alias the outputs:
+    const double r00 = m.Rs(0, 0), r01 = m.Rs(0, 1), r02 = m.Rs(0, 2);
+    const double r10 = m.Rs(1, 0), r11 = m.Rs(1, 1), r12 = m.Rs(1, 2);
+    const double r20 = m.Rs(2, 0), r21 = m.Rs(2, 1), r22 = m.Rs(2, 2);
+    const double bgx = m.biasGyro.x(), bgy = m.biasGyro.y(),
+                 bgz = m.biasGyro.z();
+    const double bax = m.biasAcc.x(), bay = m.biasAcc.y(), baz = m.biasAcc.z();
+
+    // Stage 1a: time steps, bias removal and rotation into the vehicle frame.
+    // Plain loops over contiguous arrays, so the compiler can vectorize them.
+    for (std::size_t i = 0; i + 1 < n; i++) dt[i] = t[i + 1] - t[i];
+    dt[n - 1] = b.dt(last - 1);
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double wx = iwx[i] - bgx, wy = iwy[i] - bgy, wz = iwz[i] - bgz;
+        const double fx = iax[i] - bax, fy = iay[i] - bay, fz = iaz[i] - baz;
+
+        tx[i] = (r00 * wx + r01 * wy + r02 * wz) * dt[i];
+        ty[i] = (r10 * wx + r11 * wy + r12 * wz) * dt[i];
+        tz[i] = (r20 * wx + r21 * wy + r22 * wz) * dt[i];
+
+        ax[i] = r00 * fx + r01 * fy + r02 * fz;
+        ay[i] = r10 * fx + r11 * fy + r12 * fz;
+        az[i] = r20 * fx + r21 * fy + r22 * fz;
+    }
+
+    // Stage 1b: SO(3) exponential and right Jacobian, with polynomial
+    // (branch-free) coefficients valid for small angles:
+    //  Exp(θ) = I + A·[θ]ₓ + B·[θ]ₓ²
+    //  Jr(θ)  = I - B·[θ]ₓ + C·[θ]ₓ²
+    //  and [θ]ₓ² = θθᵀ - |θ|²·I
+    auto& R = scratch.R;
+    auto& J = scratch.J;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const double x = tx[i], y = ty[i], z = tz[i];
+        const double th2 = x * x + y * y + z * z;
+
+        const double A =
+            1.0 - th2 * (1.0 / 6 - th2 * (1.0 / 120 - th2 * (1.0 / 5040)));
+        const double B =
+            0.5 - th2 * (1.0 / 24 - th2 * (1.0 / 720 - th2 * (1.0 / 40320)));
+        const double C =
+            1.0 / 6 -
+            th2 * (1.0 / 120 - th2 * (1.0 / 5040 - th2 * (1.0 / 362880)));
+
+        const double dR = 1.0 - B * th2, dJ = 1.0 - C * th2;
+
+        R[0][i] = dR + B * x * x;
+        R[1][i] = B * x * y - A * z;
+        R[2][i] = B * x * z + A * y;
+        R[3][i] = B * x * y + A * z;
+        R[4][i] = dR + B * y * y;
+        R[5][i] = B * y * z - A * x;
+        R[6][i] = B * x * z - A * y;
+        R[7][i] = B * y * z + A * x;
+        R[8][i] = dR + B * z * z;
+
+        J[0][i] = dJ + C * x * x;
+        J[1][i] = C * x * y + B * z;
+        J[2][i] = C * x * z - B * y;
+        J[3][i] = C * x * y - B * z;
+        J[4][i] = dJ + C * y * y;
+        J[5][i] = C * y * z + B * x;
+        J[6][i] = C * x * z + B * y;
+        J[7][i] = C * y * z - B * x;
+        J[8][i] = dJ + C * z * z;
+    }
+
+    // Stage 1c: exact expressions for the (rare) large-angle samples:
+    for (std::size_t i = 0; i < n; i++)
+    {
+        const Eigen::Vector3d th(tx[i], ty[i], tz[i]);
+        const double          th2 = th.squaredNorm();
+        if (th2 < SMALL_ANGLE_THRESHOLD * SMALL_ANGLE_THRESHOLD) continue;
+
+        const double    theta = std::sqrt(th2);
+        const double    A     = std::sin(theta) / theta;
+        const double    B     = (1.0 - std::cos(theta)) / th2;
+        const double    C     = (theta - std::sin(theta)) / (th2 * theta);
+        const Eigen::Matrix3d W  = skew(th);
+        const Eigen::Matrix3d W2 = W * W;
+
+        const Eigen::Matrix3d Ri =
+            Eigen::Matrix3d::Identity() + A * W + B * W2;
+        const Eigen::Matrix3d Ji =
+            Eigen::Matrix3d::Identity() - B * W + C * W2;
+
+        for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 3; c++)
+            {
+                R[r * 3 + c][i] = Ri(r, c);
+                J[r * 3 + c][i] = Ji(r, c);
+            }
+    }
+
+    // Stage 2: sequential recurrence over the precomputed values:
+    Eigen::Matrix3d incrR, Jr;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        // Repeated timestamps, or the last sample with t_end == t.back():
+        // nothing to integrate, and the covariance terms would divide by 0.
+        if (dt[i] <= 0) continue;
+
+        incrR << R[0][i], R[1][i], R[2][i], R[3][i], R[4][i], R[5][i],
+            R[6][i], R[7][i], R[8][i];
+        Jr << J[0][i], J[1][i], J[2][i], J[3][i], J[4][i], J[5][i], J[6][i],
+            J[7][i], J[8][i];
+
+        preintegration_step(
+            s, m, Eigen::Vector3d(ax[i], ay[i], az[i]), incrR, Jr, dt[i],
+            withCovariance);
+    }
+}
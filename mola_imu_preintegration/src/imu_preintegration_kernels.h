@@ -0,0 +1,114 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   imu_preintegration_kernels.h
+ * @brief  Internal (Eigen-only) numerical kernels for IMU preintegration.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <Eigen/Dense>
+
+#include <cstddef>
+
+namespace mola::internal
+{
+/** Working copy of ImuPreintegrator::IntegrationState using Eigen types.
+ *  Covariance ordering is [δφ, δv, δp].
+ */
+struct PreintegrationDelta
+{
+    double          deltaT = 0;
+    Eigen::Matrix3d dR     = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d dV     = Eigen::Vector3d::Zero();
+    Eigen::Vector3d dP     = Eigen::Vector3d::Zero();
+
+    Eigen::Matrix<double, 9, 9> cov = Eigen::Matrix<double, 9, 9>::Zero();
+
+    Eigen::Matrix3d dRdbg = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dVdbg = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dVdba = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dPdbg = Eigen::Matrix3d::Zero();
+    Eigen::Matrix3d dPdba = Eigen::Matrix3d::Zero();
+};
+
+/** Sensor rotation and noise densities, as needed by the kernels */
+struct PreintegrationModel
+{
+    Eigen::Matrix3d Rs             = Eigen::Matrix3d::Identity();
+    Eigen::Matrix3d accCov         = Eigen::Matrix3d::Identity();
+    Eigen::Matrix3d gyroCov        = Eigen::Matrix3d::Identity();
+    Eigen::Matrix3d integrationCov = Eigen::Matrix3d::Identity();
+    Eigen::Vector3d biasGyro       = Eigen::Vector3d::Zero();
+    Eigen::Vector3d biasAcc        = Eigen::Vector3d::Zero();
+};
+
+/** One preintegration step, given the corrected acceleration `a` (vehicle
+ * frame), the rotation increment and its right Jacobian.
+ */
+void preintegration_step(
+    PreintegrationDelta& s, const PreintegrationModel& m,
+    const Eigen::Vector3d& a, const Eigen::Matrix3d& incrR,
+    const Eigen::Matrix3d& Jr, double dt, bool withCovariance);
+
+/** Composes two consecutive preintegrated intervals [i,j] and [j,k] into
+ * [i,k]. Both must share the same linearization biases.
+ */
+PreintegrationDelta compose(
+    const PreintegrationDelta& ij, const PreintegrationDelta& jk,
+    bool withCovariance);
+
+/** Read-only view of a structure-of-arrays buffer of IMU readings */
+struct ImuBatchView
+{
+    const double* t  = nullptr;
+    const double* wx = nullptr;
+    const double* wy = nullptr;
+    const double* wz = nullptr;
+    const double* ax = nullptr;
+    const double* ay = nullptr;
+    const double* az = nullptr;
+    std::size_t   n  = 0;
+
+    /// Time at which the last sample stops being integrated
+    double t_end = 0;
+
+    /// Interval during which sample `i` is held constant:
+    double dt(std::size_t i) const
+    {
+        return (i + 1 < n ? t[i + 1] : t_end) - t[i];
+    }
+};
+
+/** Integrates samples [first, last) of a batch into `s`, which is normally
+ *  passed as a fresh (identity) delta.
+ *
+ * Rotation increments and right Jacobians are first computed for all samples
+ * in a branch-free, auto-vectorizable loop over contiguous arrays, using
+ * Taylor expansions for small angles. Then, the (inherently sequential)
+ * recurrence of deltas, bias Jacobians and covariance is run over the
+ * precomputed values.
+ */
+void preintegrate_batch(
+    PreintegrationDelta& s, const PreintegrationModel& m, const ImuBatchView& b,
+    std::size_t first, std::size_t last, bool withCovariance);
+
+}  // namespace mola::internal
@@ -0,0 +1,512 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-imu-preintegrator.cpp
+ * @brief  Unit tests for the full IMU preintegrator
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_imu_preintegration/ImuPreintegrator.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/poses/Lie/SO.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+static const char* yamlImuParams1 =
+    R"###(# Config for mola::IMUIntegrationParams
+gyroBias: [1.0e-3, -2.0e-3, 0.5e-3]
+accBias: [0.05, -0.02, 0.03]
+gravityVector: [0.0, 0.0, -9.81]
+gyroNoiseDensity: 1.0e-3
+accNoiseDensity: 1.0e-2
+integrationSigma: 1.0e-4
+sensorLocationInVehicle:
+  quaternion: [0.0, 0.0, 0.0, 1.0]
+  translation: [0.0, 0.0, 0.0]
+)###";
+
+using mrpt::math::CMatrixDouble33;
+using mrpt::math::TVector3D;
+
+namespace
+{
+// A synthetic, smooth motion: angular velocity and specific force, both in
+// the body frame, as a function of time:
+TVector3D gt_omega(double t)
+{
+    return {0.3 * std::sin(t), -0.2 + 0.1 * t, 0.5 * std::cos(2 * t)};
+}
+TVector3D gt_specific_force(double t)
+{
+    return {1.0 + std::sin(t), 0.5 * std::cos(2 * t), 9.81 + 0.1 * t};
+}
+
+CMatrixDouble33 so3_exp(const TVector3D& w)
+{
+    return mrpt::poses::Lie::SO<3>::exp(
+        mrpt::math::CVectorFixedDouble<3>(w.x, w.y, w.z));
+}
+
+double so3_dist(const CMatrixDouble33& A, const CMatrixDouble33& B)
+{
+    return mrpt::poses::Lie::SO<3>::log(
+               CMatrixDouble33(A.asEigen().transpose() * B.asEigen()))
+        .norm();
+}
+
+TVector3D mat_times_vec(const CMatrixDouble33& M, const TVector3D& v)
+{
+    return {
+        M(0, 0) * v.x + M(0, 1) * v.y + M(0, 2) * v.z,
+        M(1, 0) * v.x + M(1, 1) * v.y + M(1, 2) * v.z,
+        M(2, 0) * v.x + M(2, 1) * v.y + M(2, 2) * v.z};
+}
+
+struct ImuSample
+{
+    TVector3D acc, w;
+};
+
+// Generates biased IMU samples at a fixed rate:
+std::vector<ImuSample> generate_samples(
+    const mola::IMUIntegrationParams& p, double dt, size_t N)
+{
+    std::vector<ImuSample> samples;
+    for (size_t i = 0; i < N; i++)
+    {
+        const double t = i * dt;
+        samples.push_back(
+            {gt_specific_force(t) + p.accBias,
+             gt_omega(t) + p.rotationParams.gyroBias});
+    }
+    return samples;
+}
+}  // namespace
+
+static void test_stationary()
+{
+    mola::ImuPreintegrator ip;
+    ip.initialize(mrpt::containers::yaml::FromText(yamlImuParams1));
+
+    // A vehicle at rest only measures the reaction to gravity:
+    const TVector3D accRest =
+        TVector3D(0, 0, 9.81) + ip.params_.accBias;  // biased reading
+    const TVector3D wRest = ip.params_.rotationParams.gyroBias;
+
+    for (int i = 0; i < 1000; i++)
+        ip.integrate_measurement(accRest, wRest, 1e-3);
+
+    mola::ImuPreintegrator::KinematicState s0;
+    s0.pose =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(1.0, 2.0, 3.0, 0, 0, 0);
+
+    const auto s1 = ip.predict(s0);
+
+    ASSERT_LT_((s1.pose.translation() - s0.pose.translation()).norm(), 1e-6);
+    ASSERT_LT_(s1.velocity.norm(), 1e-6);
+    ASSERT_NEAR_(ip.current_integration_state().deltaTij_, 1.0, 1e-9);
+}
+
+static void test_vs_numerical_integration()
+{
+    mola::ImuPreintegrator ip;
+    ip.initialize(mrpt::containers::yaml::FromText(yamlImuParams1));
+
+    const double dt      = 1.0 / 200;
+    const size_t N       = 400;
+    const auto   samples = generate_samples(ip.params_, dt, N);
+
+    for (const auto& s : samples) ip.integrate_measurement(s.acc, s.w, dt);
+
+    // Ground truth: fine numerical integration of the same (piecewise
+    // constant) inputs, directly in the global frame:
+    const TVector3D g = ip.params_.gravityVector;
+
+    CMatrixDouble33 R = CMatrixDouble33::Identity();
+    TVector3D       v = {.0, .0, .0}, p = {.0, .0, .0};
+
+    const size_t SUBSTEPS = 100;
+    const double h        = dt / SUBSTEPS;
+    for (size_t i = 0; i < N; i++)
+    {
+        const TVector3D f = gt_specific_force(i * dt);
+        const TVector3D w = gt_omega(i * dt);
+        for (size_t k = 0; k < SUBSTEPS; k++)
+        {
+            const TVector3D a = mat_times_vec(R, f) + g;
+            p                 = p + v * h + a * (0.5 * h * h);
+            v                 = v + a * h;
+            R                 = R * so3_exp(w * h);
+        }
+    }
+
+    const auto predicted = ip.predict({});
+
+    const double errR = so3_dist(predicted.pose.getRotationMatrix(), R);
+    const double errV = (predicted.velocity - v).norm();
+    const double errP = (predicted.pose.translation() - p).norm();
+
+    std::cout << "[vs_numerical] errR=" << errR << " errV=" << errV
+              << " errP=" << errP << "\n";
+
+    ASSERT_LT_(errR, 1e-6);
+    ASSERT_LT_(errV, 5e-2);
+    ASSERT_LT_(errP, 5e-2);
+
+    // Sanity of covariance: symmetric, positive diagonal
+    const auto& cov = ip.current_integration_state().preintMeasCov_;
+    for (int i = 0; i < 9; i++)
+    {
+        ASSERT_GT_(cov(i, i), .0);
+        for (int j = 0; j < 9; j++) ASSERT_NEAR_(cov(i, j), cov(j, i), 1e-12);
+    }
+}
+
+static void test_bias_jacobians()
+{
+    mola::ImuPreintegrator ip;
+    ip.initialize(mrpt::containers::yaml::FromText(yamlImuParams1));
+
+    const double dt      = 1.0 / 200;
+    const size_t N       = 400;
+    const auto   samples = generate_samples(ip.params_, dt, N);
+
+    const TVector3D bg0 = ip.params_.rotationParams.gyroBias;
+    const TVector3D ba0 = ip.params_.accBias;
+
+    const auto lambdaIntegrate = [&](const TVector3D& bg, const TVector3D& ba)
+    {
+        mola::ImuPreintegrator p2;
+        p2.params_                         = ip.params_;
+        p2.params_.rotationParams.gyroBias = bg;
+        p2.params_.accBias                 = ba;
+        p2.reset_integration();
+        for (const auto& s : samples) p2.integrate_measurement(s.acc, s.w, dt);
+        return p2.current_integration_state();
+    };
+
+    const auto s0 = lambdaIntegrate(bg0, ba0);
+
+    // Finite differences:
+    const double eps    = 1e-6;
+    double       maxErr = 0;
+    for (int k = 0; k < 3; k++)
+    {
+        TVector3D d = {.0, .0, .0};
+        d[k]        = eps;
+
+        const auto sg = lambdaIntegrate(bg0 + d, ba0);
+        const auto sa = lambdaIntegrate(bg0, ba0 + d);
+
+        const auto numR =
+            mrpt::poses::Lie::SO<3>::log(CMatrixDouble33(
+                s0.deltaRij_.asEigen().transpose() * sg.deltaRij_.asEigen())) *
+            (1.0 / eps);
+
+        for (int r = 0; r < 3; r++)
+        {
+            mrpt::keep_max(
+                maxErr, std::abs(numR[r] - s0.delRdelBiasOmega_(r, k)));
+            mrpt::keep_max(
+                maxErr,
+                std::abs(
+                    (sg.deltaVij_[r] - s0.deltaVij_[r]) / eps -
+                    s0.delVdelBiasOmega_(r, k)));
+            mrpt::keep_max(
+                maxErr,
+                std::abs(
+                    (sg.deltaPij_[r] - s0.deltaPij_[r]) / eps -
+                    s0.delPdelBiasOmega_(r, k)));
+            mrpt::keep_max(
+                maxErr, std::abs(
+                            (sa.deltaVij_[r] - s0.deltaVij_[r]) / eps -
+                            s0.delVdelBiasAcc_(r, k)));
+            mrpt::keep_max(
+                maxErr, std::abs(
+                            (sa.deltaPij_[r] - s0.deltaPij_[r]) / eps -
+                            s0.delPdelBiasAcc_(r, k)));
+        }
+    }
+    std::cout << "[bias_jacobians] max error vs finite differences: " << maxErr
+              << "\n";
+    ASSERT_LT_(maxErr, 1e-3);
+
+    // O(1) bias update vs. full reintegration:
+    for (const auto& s : samples) ip.integrate_measurement(s.acc, s.w, dt);
+
+    const TVector3D newBg = bg0 + TVector3D(2e-4, -1e-4, 3e-4);
+    const TVector3D newBa = ba0 + TVector3D(-1e-2, 2e-2, 1e-2);
+
+    const auto corrected = ip.bias_corrected_delta(newBg, newBa);
+    const auto reint     = lambdaIntegrate(newBg, newBa);
+
+    ASSERT_LT_(so3_dist(corrected.deltaRij, reint.deltaRij_), 1e-6);
+    ASSERT_LT_((corrected.deltaVij - reint.deltaVij_).norm(), 1e-4);
+    ASSERT_LT_((corrected.deltaPij - reint.deltaPij_).norm(), 1e-4);
+
+    // And reset:
+    ip.reset_integration();
+    ASSERT_EQUAL_(ip.current_integration_state().deltaTij_, .0);
+    ASSERT_LT_(ip.current_integration_state().deltaVij_.norm(), 1e-12);
+}
+
+static double max_state_diff(
+    const mola::ImuPreintegrator::IntegrationState& a,
+    const mola::ImuPreintegrator::IntegrationState& b)
+{
+    double e = 0;
+    mrpt::keep_max(e, so3_dist(a.deltaRij_, b.deltaRij_));
+    mrpt::keep_max(e, (a.deltaVij_ - b.deltaVij_).norm());
+    mrpt::keep_max(e, (a.deltaPij_ - b.deltaPij_).norm());
+    mrpt::keep_max(e, std::abs(a.deltaTij_ - b.deltaTij_));
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            mrpt::keep_max(
+                e,
+                std::abs(a.delRdelBiasOmega_(r, c) - b.delRdelBiasOmega_(r, c)));
+            mrpt::keep_max(
+                e,
+                std::abs(a.delVdelBiasOmega_(r, c) - b.delVdelBiasOmega_(r, c)));
+            mrpt::keep_max(
+                e, std::abs(a.delVdelBiasAcc_(r, c) - b.delVdelBiasAcc_(r, c)));
+            mrpt::keep_max(
+                e,
+                std::abs(a.delPdelBiasOmega_(r, c) - b.delPdelBiasOmega_(r, c)));
+            mrpt::keep_max(
+                e, std::abs(a.delPdelBiasAcc_(r, c) - b.delPdelBiasAcc_(r, c)));
+        }
+    }
+    return e;
+}
+
+static double max_cov_rel_diff(
+    const mola::ImuPreintegrator::IntegrationState& a,
+    const mola::ImuPreintegrator::IntegrationState& b)
+{
+    double e = 0, maxVal = 0;
+    for (int r = 0; r < 9; r++)
+    {
+        for (int c = 0; c < 9; c++)
+        {
+            mrpt::keep_max(
+                e, std::abs(a.preintMeasCov_(r, c) - b.preintMeasCov_(r, c)));
+            mrpt::keep_max(maxVal, std::abs(b.preintMeasCov_(r, c)));
+        }
+    }
+    return e / maxVal;
+}
+
+static void test_batch_integration()
+{
+    mola::ImuPreintegrator ip;
+    ip.initialize(mrpt::containers::yaml::FromText(yamlImuParams1));
+
+    const double dt      = 1.0 / 400;
+    const size_t N       = 20000;
+    const auto   samples = generate_samples(ip.params_, dt, N);
+
+    mola::ImuMeasurementBatch batch;
+    batch.reserve(N);
+    for (size_t i = 0; i < N; i++)
+        batch.push_back(i * dt, samples[i].acc, samples[i].w);
+    // Include a few large rotation increments, beyond the range of the
+    // small-angle expansions:
+    batch.wy[100] = 50.0;
+    batch.wx[101] = -80.0;
+
+    const double t_end = N * dt;
+
+    using clock = std::chrono::steady_clock;
+    const auto lambdaElapsed = [](clock::time_point t0)
+    { return std::chrono::duration<double>(clock::now() - t0).count(); };
+
+    // Reference: one sample at a time:
+    auto t0 = clock::now();
+    for (size_t i = 0; i < N; i++)
+    {
+        ip.integrate_measurement(
+            {batch.ax[i], batch.ay[i], batch.az[i]},
+            {batch.wx[i], batch.wy[i], batch.wz[i]},
+            (i + 1 < N ? batch.t[i + 1] : t_end) - batch.t[i]);
+    }
+    const double tScalar = lambdaElapsed(t0);
+    const auto   sRef    = ip.current_integration_state();
+
+    // Batch, single thread:
+    ip.reset_integration();
+    t0 = clock::now();
+    ip.integrate_measurements(batch, t_end);
+    const double tBatch = lambdaElapsed(t0);
+    const auto   sBatch = ip.current_integration_state();
+
+    const double errBatch    = max_state_diff(sBatch, sRef);
+    const double errBatchCov = max_cov_rel_diff(sBatch, sRef);
+
+    // Batch, appended after some previously integrated samples:
+    ip.reset_integration();
+    for (size_t i = 0; i < 10; i++)
+    {
+        ip.integrate_measurement(
+            {batch.ax[i], batch.ay[i], batch.az[i]},
+            {batch.wx[i], batch.wy[i], batch.wz[i]}, dt);
+    }
+    {
+        mola::ImuMeasurementBatch rest;
+        for (size_t i = 10; i < N; i++)
+        {
+            rest.push_back(
+                batch.t[i], {batch.ax[i], batch.ay[i], batch.az[i]},
+                {batch.wx[i], batch.wy[i], batch.wz[i]});
+        }
+        ip.integrate_measurements(rest, t_end);
+    }
+    const double errAppend = max_state_diff(ip.current_integration_state(), sRef);
+
+    // Parallel prefix-composition:
+    mola::ImuPreintegrator::BatchOptions opts;
+    opts.parallel_chunks       = 4;
+    opts.min_samples_per_chunk = 1000;
+
+    ip.reset_integration();
+    t0 = clock::now();
+    ip.integrate_measurements(batch, t_end, opts);
+    const double tParallel = lambdaElapsed(t0);
+    const auto   sParallel = ip.current_integration_state();
+
+    const double errParallel    = max_state_diff(sParallel, sRef);
+    const double errParallelCov = max_cov_rel_diff(sParallel, sRef);
+
+    // Without covariance:
+    opts                    = {};
+    opts.compute_covariance = false;
+    ip.reset_integration();
+    t0 = clock::now();
+    ip.integrate_measurements(batch, t_end, opts);
+    const double tNoCov = lambdaElapsed(t0);
+    const auto   sNoCov = ip.current_integration_state();
+
+    const double errNoCov = max_state_diff(sNoCov, sRef);
+
+    std::cout << "[batch] err batch=" << errBatch << " (cov: " << errBatchCov
+              << ") append=" << errAppend << " parallel=" << errParallel
+              << " (cov: " << errParallelCov << ") no_cov=" << errNoCov
+              << "\n";
+    std::cout << "[batch] samples/s: scalar=" << N / tScalar
+              << " batch=" << N / tBatch << " parallel(4)=" << N / tParallel
+              << " batch_no_cov=" << N / tNoCov << "\n";
+
+    ASSERT_LT_(errBatch, 1e-6);
+    ASSERT_LT_(errBatchCov, 1e-6);
+    ASSERT_LT_(errAppend, 1e-6);
+    ASSERT_LT_(errParallel, 1e-6);
+    ASSERT_LT_(errParallelCov, 1e-6);
+    ASSERT_LT_(errNoCov, 1e-6);
+    for (int i = 0; i < 9; i++)
+        ASSERT_EQUAL_(sNoCov.preintMeasCov_(i, i), .0);
+}
+
+static void test_batch_zero_length_steps()
+{
+    mola::ImuPreintegrator ip;
+    ip.initialize(mrpt::containers::yaml::FromText(yamlImuParams1));
+
+    const double dt      = 1.0 / 400;
+    const size_t N       = 4000;
+    const auto   samples = generate_samples(ip.params_, dt, N);
+
+    // A repeated timestamp, and the last sample ending at t_end:
+    mola::ImuMeasurementBatch batch;
+    for (size_t i = 0; i < N; i++)
+    {
+        batch.push_back(i * dt, samples[i].acc, samples[i].w);
+        if (i == N / 2) batch.push_back(i * dt, samples[i].acc, samples[i].w);
+    }
+    const double t_end = batch.t.back();
+
+    // Reference: only the steps with a non-zero length:
+    for (size_t i = 0; i + 1 < batch.size(); i++)
+    {
+        const double dti = batch.t[i + 1] - batch.t[i];
+        if (dti <= 0) continue;
+        ip.integrate_measurement(
+            {batch.ax[i], batch.ay[i], batch.az[i]},
+            {batch.wx[i], batch.wy[i], batch.wz[i]}, dti);
+    }
+    const auto sRef = ip.current_integration_state();
+
+    mola::ImuPreintegrator::BatchOptions opts;
+    for (size_t chunks : {1, 4})
+    {
+        opts.parallel_chunks       = chunks;
+        opts.min_samples_per_chunk = 500;
+
+        ip.reset_integration();
+        ip.integrate_measurements(batch, t_end, opts);
+        const auto s = ip.current_integration_state();
+
+        for (int r = 0; r < 9; r++)
+            for (int c = 0; c < 9; c++)
+                ASSERT_(std::isfinite(s.preintMeasCov_(r, c)));
+
+        ASSERT_LT_(max_state_diff(s, sRef), 1e-6);
+        ASSERT_LT_(max_cov_rel_diff(s, sRef), 1e-6);
+        ASSERT_NEAR_(s.deltaTij_, (N - 1) * dt, 1e-9);
+    }
+
+    // Time going backwards is an error:
+    std::swap(batch.t[10], batch.t[11]);
+    bool thrown = false;
+    try
+    {
+        ip.integrate_measurements(batch, t_end);
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_stationary();
+        test_vs_numerical_integration();
+        test_bias_jacobians();
+        test_batch_integration();
+        test_batch_zero_length_steps();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -17,6 +17,8 @@
  */
 
 #include <mola_input_kitti_dataset/KittiOdometryDataset.h>
+#include <mola_kernel/ObservationPools.h>
+#include <mola_kernel/load_kitti_bin_file.h>
 #include <mola_yaml/yaml_helpers.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/initializer.h>
@@ -489,15 +491,23 @@ void KittiOdometryDataset::load_lidar(timestep_t step) const
     // Load velodyne pointcloud:
     const auto f = seq_dir_ + std::string("/velodyne/") + lst_velodyne_[step];
 
-    auto obs         = mrpt::obs::CObservationPointCloud::Create();
+    // Pooled objects: they return to the pool as soon as they are unloaded
+    // (or dropped by all consumers), and keep their memory buffers:
+    auto& pools = mola::ObservationPools::Instance();
+
+    auto obs         = pools.acquire<mrpt::obs::CObservationPointCloud>();
     obs->sensorLabel = "lidar";
     obs->setAsExternalStorage(
         f,
         mrpt::obs::CObservationPointCloud::ExternalStorageFormat::KittiBinFile);
-    obs->load();  // force loading now from disk
+
+    // Load now from disk (this is what obs->load() does, but into a pooled
+    // map):
+    auto       pts    = pools.acquire<mrpt::maps::CPointsMapXYZI>();
+    const bool loadOk = mola::load_kitti_bin_file(f, *pts);
     ASSERTMSG_(
-        obs->pointcloud,
-        mrpt::format("Error loading kitti scan file: '%s'", f.c_str()));
+        loadOk, mrpt::format("Error loading kitti scan file: '%s'", f.c_str()));
+    obs->pointcloud = std::move(pts);
 
     // Correct wrong intrinsic calibration in the original kitti datasets:
     // Refer to these works & implementations (on which this solution is based
@@ -17,6 +17,8 @@
  */
 
 #include <mola_input_mulran_dataset/MulranDataset.h>
+#include <mola_kernel/ObservationPools.h>
+#include <mola_kernel/load_kitti_bin_file.h>
 #include <mola_yaml/yaml_helpers.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/initializer.h>
@@ -433,25 +435,23 @@ void MulranDataset::load_lidar(timestep_t step) const
     const auto f =
         mrpt::system::pathJoin({seq_dir_, "Ouster", lstPointCloudFiles_[step]});
 
-    auto obs         = mrpt::obs::CObservationPointCloud::Create();
+    // Pooled objects: they return to the pool as soon as they are unloaded
+    // (or dropped by all consumers), and keep their memory buffers:
+    auto& pools = mola::ObservationPools::Instance();
+
+    auto obs         = pools.acquire<mrpt::obs::CObservationPointCloud>();
     obs->sensorLabel = "lidar";
 
-    auto pts        = mrpt::maps::CPointsMapXYZIRT::Create();
+    auto pts        = pools.acquire<mrpt::maps::CPointsMapXYZIRT>();
     obs->pointcloud = pts;
 
-    // Load XYZI from kitti-like file:
-    mrpt::maps::CPointsMapXYZI kittiData;
-
-    bool loadOk = kittiData.loadFromKittiVelodyneFile(f);
+    // Load XYZI from kitti-like file, directly into the XYZIRT map:
+    const bool loadOk = mola::load_kitti_bin_file(f, *pts);
     ASSERTMSG_(
         loadOk, mrpt::format("Error loading kitti scan file: '%s'", f.c_str()));
 
-    // Copy XYZI:
-    *pts = kittiData;
-
     const size_t nPts = pts->size();
     ASSERT_EQUAL_(nPts, 1024 * 64);
-    pts->resize_XYZIRT(nPts, true /*i*/, true /*R*/, true /*t*/);
 
     // Fixed to 10 Hz rotation in this dataset:
     const double sweepDuration = 0.1;  //  [s]
@@ -16,6 +16,7 @@
  */
 
 #include <mola_input_paris_luco_dataset/ParisLucoDataset.h>
+#include <mola_kernel/FrameArena.h>
 #include <mola_yaml/yaml_helpers.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/initializer.h>
@@ -284,8 +285,11 @@ void ParisLucoDataset::load_lidar(timestep_t step) const
     ASSERT_EQUAL_(
         pts->getPointsBufferRef_ring()->size(),
         pts->getPointsBufferRef_timestamp()->size());
-    std::map<int /*ring*/, std::map<float /*time*/, size_t /*index*/>>
-        histogram;
+
+    // One tree node per point: use the frame arena (if within a cycle)
+    // instead of the heap:
+    mola::frame_map<int /*ring*/, mola::frame_map<float /*time*/, size_t>>
+        histogram(mola::frame_memory_resource());
 
     // Equivalent matlab code:
     // depth = sqrt(D(:,1).^2 + D(:,2).^2);  % (x,y) only
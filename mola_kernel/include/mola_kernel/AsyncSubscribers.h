@@ -0,0 +1,318 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   AsyncSubscribers.h
+ * @brief  Registry of subscribers with asynchronous, per-subscriber delivery
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/lock_helper.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace mola
+{
+/** How pending updates are queued for one subscriber */
+enum class SubscriberQueuePolicy : uint8_t
+{
+    /** Only the most recent update is kept: older, undelivered ones are
+     *  dropped. Suited for large, self-contained updates (e.g. maps). */
+    LatestOnly = 0,
+
+    /** Updates are delivered in order, dropping the oldest one if the queue
+     *  is full. Suited for streams (e.g. poses). */
+    BoundedFIFO
+};
+
+/** Options for one subscriber of an AsyncSubscribers registry */
+struct SubscriberOptions
+{
+    SubscriberQueuePolicy policy = SubscriberQueuePolicy::BoundedFIFO;
+
+    /// Maximum queued updates for BoundedFIFO
+    size_t max_queue_length = 100;
+
+    /** If true, the subscriber gets its own delivery thread. Otherwise,
+     *  deliveries run in a small thread pool shared by all pooled
+     *  subscribers (still in order for each one). */
+    bool dedicated_thread = true;
+
+    static SubscriberOptions LatestOnly(bool dedicatedThread = true)
+    {
+        SubscriberOptions o;
+        o.policy           = SubscriberQueuePolicy::LatestOnly;
+        o.dedicated_thread = dedicatedThread;
+        return o;
+    }
+    static SubscriberOptions BoundedFIFO(
+        size_t maxQueueLength = 100, bool dedicatedThread = true)
+    {
+        SubscriberOptions o;
+        o.policy           = SubscriberQueuePolicy::BoundedFIFO;
+        o.max_queue_length = maxQueueLength;
+        o.dedicated_thread = dedicatedThread;
+        return o;
+    }
+};
+
+/** Delivery counters of one subscriber */
+struct SubscriberStats
+{
+    uint64_t delivered = 0;  //!< Callbacks invoked
+    uint64_t dropped   = 0;  //!< Updates discarded by the queue policy
+    size_t   queued    = 0;  //!< Updates waiting for delivery right now
+};
+
+using subscription_id_t = uint64_t;
+
+/** A set of callbacks subscribed to updates of type `T`.
+ *
+ * publish() only copies the update into the queue of each subscriber, so
+ * slow consumers never stall the producer thread. Callbacks are invoked from
+ * a dedicated thread per subscriber (or a shared pool), never while holding
+ * the registry lock, so they can safely subscribe or unsubscribe (even
+ * themselves).
+ *
+ * \ingroup mola_kernel_grp
+ */
+template <typename T>
+class AsyncSubscribers
+{
+   public:
+    using callback_t = std::function<void(const T&)>;
+
+    /// \param name Used in error messages only.
+    explicit AsyncSubscribers(const char* name) : name_(name) {}
+    ~AsyncSubscribers() { clear(); }
+
+    AsyncSubscribers(const AsyncSubscribers&)            = delete;
+    AsyncSubscribers& operator=(const AsyncSubscribers&) = delete;
+
+    subscription_id_t subscribe(
+        const callback_t& callback, const SubscriberOptions& options)
+    {
+        auto s      = std::make_shared<Subscriber>();
+        s->callback = callback;
+        s->options  = options;
+        s->owner    = name_;
+        if (options.dedicated_thread)
+            s->thread = std::thread([s]() { s->runDedicated(); });
+
+        auto lck = mrpt::lockHelper(mtx_);
+        s->id    = nextId_++;
+        subs_.push_back(s);
+        return s->id;
+    }
+
+    /** Removes a subscriber, discarding its pending updates. Once this
+     *  returns, its callback will not be invoked again, unless this is
+     *  called from within that very callback, which is allowed.
+     *  \return false if the ID was not found.
+     */
+    bool unsubscribe(subscription_id_t id)
+    {
+        std::shared_ptr<Subscriber> s;
+        {
+            auto lck = mrpt::lockHelper(mtx_);
+            for (auto it = subs_.begin(); it != subs_.end(); ++it)
+            {
+                if ((*it)->id != id) continue;
+                s = *it;
+                subs_.erase(it);
+                break;
+            }
+        }
+        if (!s) return false;
+        s->stop();
+        return true;
+    }
+
+    /// Removes all subscribers. See unsubscribe().
+    void clear()
+    {
+        std::vector<std::shared_ptr<Subscriber>> subs;
+        {
+            auto lck = mrpt::lockHelper(mtx_);
+            subs.swap(subs_);
+        }
+        for (auto& s : subs) s->stop();
+    }
+
+    bool empty() const
+    {
+        auto lck = mrpt::lockHelper(mtx_);
+        return subs_.empty();
+    }
+
+    /// Enqueues a copy of the update for each subscriber, and returns.
+    void publish(const T& value)
+    {
+        std::vector<std::shared_ptr<Subscriber>> subs;
+        {
+            auto lck = mrpt::lockHelper(mtx_);
+            subs     = subs_;
+        }
+        for (auto& s : subs) s->push(value);
+    }
+
+    std::optional<SubscriberStats> stats(subscription_id_t id) const
+    {
+        auto lck = mrpt::lockHelper(mtx_);
+        for (const auto& s : subs_)
+        {
+            if (s->id != id) continue;
+            auto            lck2 = mrpt::lockHelper(s->mtx);
+            SubscriberStats st;
+            st.delivered = s->delivered;
+            st.dropped   = s->dropped;
+            st.queued    = s->queue.size();
+            return st;
+        }
+        return {};
+    }
+
+   private:
+    struct Subscriber : public std::enable_shared_from_this<Subscriber>
+    {
+        subscription_id_t id = 0;
+        callback_t        callback;
+        SubscriberOptions options;
+        const char*       owner = "";
+
+        std::mutex              mtx;  //!< Protects all fields below
+        std::condition_variable cv;
+        std::deque<T>           queue;
+        bool                    stopping = false;
+        bool                    busy = false;  //!< A callback is running
+        bool                    drainScheduled = false;  //!< Pooled only
+        std::thread::id         deliveryThread;
+        uint64_t                delivered = 0, dropped = 0;
+
+        std::thread thread;  //!< Dedicated only
+
+        void push(const T& value)
+        {
+            {
+                auto lck = mrpt::lockHelper(mtx);
+                if (stopping) return;
+
+                if (options.policy == SubscriberQueuePolicy::LatestOnly)
+                {
+                    dropped += queue.size();
+                    queue.clear();
+                }
+                else if (
+                    queue.size() >=
+                    std::max<size_t>(1, options.max_queue_length))
+                {
+                    queue.pop_front();
+                    dropped++;
+                }
+                queue.push_back(value);
+
+                if (!options.dedicated_thread && !drainScheduled)
+                {
+                    drainScheduled = true;
+                    shared_pool().enqueue(
+                        [s = this->shared_from_this()]() { s->drain(); });
+                }
+            }
+            cv.notify_all();
+        }
+
+        // Pops and delivers one update. Called with `lck` owning `mtx`.
+        void deliverOne(std::unique_lock<std::mutex>& lck)
+        {
+            T value = std::move(queue.front());
+            queue.pop_front();
+            busy           = true;
+            deliveryThread = std::this_thread::get_id();
+            lck.unlock();
+
+            try
+            {
+                callback(value);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "[" << owner
+                          << "] Exception in callback: " << e.what() << "\n";
+            }
+
+            lck.lock();
+            busy = false;
+            delivered++;
+            cv.notify_all();
+        }
+
+        void runDedicated()
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            for (;;)
+            {
+                cv.wait(lck, [this]() { return stopping || !queue.empty(); });
+                if (stopping) return;
+                deliverOne(lck);
+            }
+        }
+
+        void drain()
+        {
+            std::unique_lock<std::mutex> lck(mtx);
+            while (!stopping && !queue.empty()) deliverOne(lck);
+            drainScheduled = false;
+        }
+
+        void stop()
+        {
+            {
+                std::unique_lock<std::mutex> lck(mtx);
+                const bool fromCallback =
+                    busy && std::this_thread::get_id() == deliveryThread;
+
+                stopping = true;
+                queue.clear();
+                cv.notify_all();
+                // Wait for an in-flight callback, unless it's ourselves:
+                if (!fromCallback) cv.wait(lck, [this]() { return !busy; });
+            }
+            if (thread.joinable())
+            {
+                if (thread.get_id() == std::this_thread::get_id())
+                    thread.detach();
+                else
+                    thread.join();
+            }
+        }
+    };
+
+    static mrpt::WorkerThreadsPool& shared_pool()
+    {
+        static mrpt::WorkerThreadsPool pool(
+            2, mrpt::WorkerThreadsPool::POLICY_FIFO, "mola_subscribers");
+        return pool;
+    }
+
+    const char*                              name_;
+    mutable std::mutex                       mtx_;
+    std::vector<std::shared_ptr<Subscriber>> subs_;
+    subscription_id_t                        nextId_ = 1;
+};
+
+}  // namespace mola
@@ -0,0 +1,100 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ChunkedFileStream.h
+ * @brief  Binary file streams which report progress after each chunk
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/io/CStream.h>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mola
+{
+/** Invoked after each chunk with the number of bytes transferred so far.
+ * It may throw to abort the transfer (e.g. to cancel it). */
+using chunk_callback_t = std::function<void(uint64_t bytes)>;
+
+/** A write-only binary file stream which buffers data into chunks of a fixed
+ * size, and invokes a callback after writing each one to disk. Use it with
+ * mrpt::serialization::archiveFrom() to serialize large objects with progress
+ * and cancellation, without keeping a copy of the whole serialized data.
+ *
+ * \ingroup mola_kernel_grp
+ */
+class ChunkedFileOutputStream : public mrpt::io::CStream
+{
+   public:
+    /** Opens (truncating) the file.
+     * \exception std::exception On errors opening the file. */
+    ChunkedFileOutputStream(
+        const std::string& fileName, chunk_callback_t onChunk = {},
+        size_t chunkSize = 4 * 1024 * 1024);
+
+    /** Writes any pending data, ignoring errors. Call close() to check for
+     * them. */
+    ~ChunkedFileOutputStream() override;
+
+    /** Writes pending data and closes the file.
+     * \exception std::exception On I/O errors. */
+    void close();
+
+    size_t   Write(const void* Buffer, size_t Count) override;
+    size_t   Read(void* Buffer, size_t Count) override;
+    uint64_t Seek(int64_t Offset, CStream::TSeekOrigin Origin) override;
+    uint64_t getTotalBytesCount() const override { return position_; }
+    uint64_t getPosition() const override { return position_; }
+    std::string getStreamDescription() const override { return fileName_; }
+
+   private:
+    std::string          fileName_;
+    std::ofstream        f_;
+    chunk_callback_t     onChunk_;
+    std::vector<uint8_t> buf_;
+    uint64_t             position_ = 0;
+
+    void flushChunk();
+};
+
+/** The reading counterpart of ChunkedFileOutputStream: reads a binary file in
+ * chunks of a fixed size, invoking a callback after reading each one.
+ *
+ * \ingroup mola_kernel_grp
+ */
+class ChunkedFileInputStream : public mrpt::io::CStream
+{
+   public:
+    /** \exception std::exception On errors opening the file. */
+    ChunkedFileInputStream(
+        const std::string& fileName, chunk_callback_t onChunk = {},
+        size_t chunkSize = 4 * 1024 * 1024);
+
+    size_t   Read(void* Buffer, size_t Count) override;
+    size_t   Write(const void* Buffer, size_t Count) override;
+    uint64_t Seek(int64_t Offset, CStream::TSeekOrigin Origin) override;
+    uint64_t getTotalBytesCount() const override { return fileSize_; }
+    uint64_t getPosition() const override { return position_; }
+    std::string getStreamDescription() const override { return fileName_; }
+
+   private:
+    std::string          fileName_;
+    std::ifstream        f_;
+    chunk_callback_t     onChunk_;
+    std::vector<uint8_t> buf_;
+    size_t               bufPos_   = 0;
+    uint64_t             fileSize_ = 0, position_ = 0, bytesRead_ = 0;
+
+    bool readChunk();
+};
+
+}  // namespace mola
@@ -0,0 +1,261 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FactorGraphBuilder.h
+ * @brief  Parallel conversion of WorldModel factors into optimizer factors
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_kernel/FastAllocator.h>
+#include <mola_kernel/PriorityTaskExecutor.h>
+#include <mola_kernel/WorldModel.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <utility>
+#include <vector>
+
+namespace mola
+{
+/** Counters and timings of the last FactorGraphBuilder::build().
+ * Times are in seconds. */
+struct FactorGraphBuilderStats
+{
+    size_t factors   = 0;  //!< Factors in the graph
+    size_t converted = 0;  //!< Converted now (new or modified factors)
+    size_t cached    = 0;  //!< Reused from the cache
+    size_t fragments = 0;  //!< Parallel conversion tasks
+
+    double lock_time  = 0;  //!< WorldModel factors locked for read
+    double merge_time = 0;  //!< Passing converted factors to merge()
+};
+
+/** Parameters of a FactorGraphBuilder */
+struct FactorGraphBuilderParameters
+{
+    /// Conversion threads, including the one calling build()
+    size_t num_threads = 4;
+
+    /// Smaller batches are not split across threads
+    size_t min_factors_per_thread = 256;
+};
+
+/** Builds an optimizer-specific graph (e.g. a `gtsam::NonlinearFactorGraph`)
+ * from WorldModel factors.
+ *
+ * The user-provided converter turns one mola::Factor into a `CONVERTED`
+ * object (e.g. a `gtsam::NonlinearFactor::shared_ptr`), usually with
+ * `std::visit()` and mola::overloaded{} over the Factor variant alternatives.
+ * It must be thread-safe, since factors are converted in parallel: build()
+ * splits the factors to convert into contiguous ranges, one per thread, each
+ * one filling its own graph fragment, with the WorldModel factors locked for
+ * read only. Fragments are then merged, out of the lock, by calling `merge()`
+ * for each factor in the order of the given IDs, so the resulting graph does
+ * not depend on the number of threads.
+ *
+ * Converted factors are cached by factor ID and WorldModel::factor_version(),
+ * so incremental or repeated re-optimizations only convert new or modified
+ * factors.
+ *
+ * Example:
+ * \code
+ * using FactorPtr = gtsam::NonlinearFactor::shared_ptr;
+ * mola::FactorGraphBuilder<FactorPtr> builder([](const mola::Factor& f) {
+ *     return std::visit(
+ *         mola::overloaded{
+ *             [](const mola::FactorRelativePose3& r) -> FactorPtr { ... },
+ *             [](const auto&) -> FactorPtr { return {}; }},
+ *         f);
+ * });
+ * gtsam::NonlinearFactorGraph graph;
+ * builder.build(worldModel, [&](const auto& f) { if (f) graph.add(f); });
+ * \endcode
+ *
+ * Instances are not thread-safe: build() must not be called concurrently.
+ *
+ * \ingroup mola_kernel_grp
+ */
+template <class CONVERTED>
+class FactorGraphBuilder
+{
+   public:
+    using converter_t = std::function<CONVERTED(const Factor&)>;
+    using Parameters  = FactorGraphBuilderParameters;
+    using Stats       = FactorGraphBuilderStats;
+
+    explicit FactorGraphBuilder(
+        converter_t converter, const Parameters& p = Parameters())
+        : converter_(std::move(converter)), params_(p)
+    {
+        ASSERT_(converter_);
+        ASSERT_(params_.num_threads > 0);
+        if (params_.num_threads > 1)
+        {
+            PriorityTaskExecutor::Parameters ep;
+            ep.num_threads = params_.num_threads - 1;
+            ep.name        = "factor_graph";
+            workers_.setParameters(ep);
+        }
+    }
+
+    /** Converts the given factors (missing in the cache or modified since
+     * cached) and calls `merge(const CONVERTED&)` for each one, in order.
+     * \exception std::exception If the converter throws for any factor.
+     */
+    template <class MERGE>
+    void build(WorldModel& wm, const std::vector<fid_t>& ids, MERGE&& merge)
+    {
+        internal_build(wm, &ids, std::forward<MERGE>(merge));
+    }
+
+    /// \overload For all the factors in the WorldModel.
+    template <class MERGE>
+    void build(WorldModel& wm, MERGE&& merge)
+    {
+        internal_build(wm, nullptr, std::forward<MERGE>(merge));
+    }
+
+    const Stats& lastStats() const { return stats_; }
+
+    size_t cacheSize() const { return cache_.size(); }
+
+    /// Removes cached conversions, e.g. of factors out of a sliding window.
+    void eraseFromCache(const fid_t id) { cache_.erase(id); }
+
+    void clearCache() { cache_.clear(); }
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    struct CacheEntry
+    {
+        uint64_t  version = 0;
+        CONVERTED value;
+    };
+
+    converter_t                       converter_;
+    Parameters                        params_;
+    PriorityTaskExecutor              workers_;  //!< Started on first use
+    mola::fast_map<fid_t, CacheEntry> cache_;
+    Stats                             stats_;
+
+    template <class MERGE>
+    void internal_build(
+        WorldModel& wm, const std::vector<fid_t>* givenIds, MERGE&& merge)
+    {
+        Stats st;
+
+        std::vector<fid_t>                  allIds;
+        std::vector<size_t>                 misses;  // Indices in ids
+        std::vector<uint64_t>               versions;
+        std::vector<std::vector<CONVERTED>> fragments;
+
+        const auto t0 = clock::now();
+        wm.factors_lock_for_read();
+        try
+        {
+            if (!givenIds) allIds = wm.factor_all_ids();
+            const auto& ids = givenIds ? *givenIds : allIds;
+
+            // Snapshot of versions, and factors to convert:
+            versions.resize(ids.size());
+            for (size_t i = 0; i < ids.size(); i++)
+            {
+                versions[i]   = wm.factor_version(ids[i]);
+                const auto it = cache_.find(ids[i]);
+                if (it == cache_.end() || it->second.version != versions[i])
+                    misses.push_back(i);
+            }
+
+            const size_t nTasks = std::max<size_t>(
+                1, std::min(
+                       params_.num_threads,
+                       misses.size() / params_.min_factors_per_thread));
+            fragments.resize(misses.empty() ? 0 : nTasks);
+
+            auto convertRange = [&](size_t task) {
+                const size_t i0   = misses.size() * task / nTasks;
+                const size_t i1   = misses.size() * (task + 1) / nTasks;
+                auto&        frag = fragments[task];
+                frag.reserve(i1 - i0);
+                for (size_t k = i0; k < i1; k++)
+                {
+                    const Factor& f = wm.factor_by_id(ids[misses[k]]);
+                    frag.push_back(converter_(f));
+                }
+            };
+
+            // Other threads, plus this one. Wait for all of them, even on
+            // errors, since they use the locked WorldModel:
+            std::vector<std::future<void>> futs;
+            for (size_t t = 1; t < fragments.size(); t++)
+                futs.push_back(
+                    workers_.enqueue(0, [&, t]() { convertRange(t); }));
+
+            std::exception_ptr err;
+            try
+            {
+                if (!fragments.empty()) convertRange(0);
+            }
+            catch (...)
+            {
+                err = std::current_exception();
+            }
+            for (auto& f : futs)
+            {
+                try
+                {
+                    f.get();
+                }
+                catch (...)
+                {
+                    if (!err) err = std::current_exception();
+                }
+            }
+            if (err) std::rethrow_exception(err);
+        }
+        catch (...)
+        {
+            wm.factors_unlock_for_read();
+            throw;
+        }
+        wm.factors_unlock_for_read();
+
+        const auto t1 = clock::now();
+
+        const auto& ids = givenIds ? *givenIds : allIds;
+
+        // Store new conversions:
+        for (size_t task = 0, k = 0; task < fragments.size(); task++)
+        {
+            for (auto& c : fragments[task])
+            {
+                const size_t i = misses[k++];
+                cache_.insert_or_assign(
+                    ids[i], CacheEntry{versions[i], std::move(c)});
+            }
+        }
+
+        for (const auto id : ids) merge(std::as_const(cache_.at(id).value));
+
+        st.factors    = ids.size();
+        st.converted  = misses.size();
+        st.cached     = ids.size() - misses.size();
+        st.fragments  = fragments.size();
+        st.lock_time  = std::chrono::duration<double>(t1 - t0).count();
+        st.merge_time =
+            std::chrono::duration<double>(clock::now() - t1).count();
+        stats_ = st;
+    }
+};
+
+}  // namespace mola
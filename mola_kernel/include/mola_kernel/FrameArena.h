@@ -0,0 +1,151 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FrameArena.h
+ * @brief  Resettable monotonic arena for per-cycle transient data (std::pmr)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace mola
+{
+/** Counters of one FrameArena */
+struct FrameArenaStats
+{
+    uint64_t frames               = 0;  //!< Number of reset() calls
+    uint64_t allocations          = 0;  //!< Allocations served, in total
+    uint64_t upstream_allocations = 0;  //!< Blocks requested from the heap
+    size_t   bytes_in_use         = 0;  //!< Allocated since the last reset()
+    size_t   peak_bytes           = 0;  //!< Max. bytes_in_use of any frame
+    size_t   buffer_size          = 0;  //!< Reused buffer, in bytes
+};
+
+/** A monotonic memory resource for short-lived data of one processing cycle
+ * (a "frame"): per-scan temporaries in filters, data readers, etc.
+ *
+ * Allocations just bump a pointer and deallocations are no-ops. All memory
+ * is released at once by reset(), at the end of the cycle. Its buffer is
+ * kept, and grown to fit the peak usage of past cycles (up to
+ * `maxRetainedBytes`), so in steady state the heap is not touched at all.
+ *
+ * Each thread has its own arena (ThisThread()), and cycles are delimited
+ * with FrameArena::Scope. MolaLauncherApp runs each ExecutableBase::spinOnce()
+ * within a scope, and so does RawDataSourceBase::sendObservationsToFrontEnds()
+ * for the `onNewObservation()` calls. Code that needs transient containers
+ * should use frame_memory_resource(), e.g. with the `mola::frame_vector<>`
+ * aliases below, and never keep them beyond the current cycle.
+ *
+ * This class is not thread-safe: use it from the thread owning it only.
+ *
+ * \ingroup mola_kernel_grp
+ */
+class FrameArena : public std::pmr::memory_resource
+{
+   public:
+    explicit FrameArena(
+        size_t initialBufferSize = 256 * 1024,
+        size_t maxRetainedBytes  = 64 * 1024 * 1024);
+    ~FrameArena() override;
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /// The arena of the calling thread
+    static FrameArena& ThisThread();
+
+    /** Frees everything allocated from the arena. If the last cycle did not
+     * fit into the buffer, the buffer grows for the next ones. */
+    void reset();
+
+    const FrameArenaStats& stats() const { return stats_; }
+
+    /// Whether we are within a Scope (of this arena)
+    bool inCycle() const { return cycleDepth_ > 0; }
+
+    /** RAII marker of a processing cycle: while alive, frame_memory_resource()
+     * returns the arena, which is reset() at the end of the outermost scope.
+     * Scopes may be nested, e.g. a data source spinOnce() that synchronously
+     * calls a consumer `onNewObservation()`.
+     */
+    class Scope
+    {
+       public:
+        explicit Scope(FrameArena& arena = FrameArena::ThisThread());
+        ~Scope();
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        FrameArena&                arena_;
+        std::pmr::memory_resource* previous_;
+    };
+
+   private:
+    // Upstream of the monotonic resource: the heap, with counters.
+    class Upstream : public std::pmr::memory_resource
+    {
+       public:
+        explicit Upstream(FrameArenaStats& stats) : stats_(stats) {}
+        size_t cycleBytes = 0;
+
+       private:
+        FrameArenaStats& stats_;
+
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void  do_deallocate(void* p, size_t bytes, size_t alignment) override;
+        bool  do_is_equal(
+             const std::pmr::memory_resource& o) const noexcept override
+        {
+            return this == &o;
+        }
+    };
+
+    FrameArenaStats                                    stats_;
+    Upstream                                           upstream_{stats_};
+    std::unique_ptr<std::byte[]>                       buffer_;
+    size_t                                             maxRetainedBytes_;
+    std::optional<std::pmr::monotonic_buffer_resource> mono_;
+    int                                                cycleDepth_ = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(
+         const std::pmr::memory_resource& o) const noexcept override
+    {
+        return this == &o;
+    }
+};
+
+/** Memory resource for transient data of the current processing cycle: the
+ * FrameArena of the calling thread while within a FrameArena::Scope, or the
+ * default (heap) resource otherwise.
+ */
+std::pmr::memory_resource* frame_memory_resource();
+
+/// A std::vector to be created with frame_memory_resource()
+template <class T>
+using frame_vector = std::pmr::vector<T>;
+
+/// A std::map to be created with frame_memory_resource()
+template <class Key, class T, class Compare = std::less<Key>>
+using frame_map = std::pmr::map<Key, T, Compare>;
+
+/// A std::set to be created with frame_memory_resource()
+template <class T, class Compare = std::less<T>>
+using frame_set = std::pmr::set<T, Compare>;
+
+}  // namespace mola
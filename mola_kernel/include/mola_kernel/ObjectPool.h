@@ -0,0 +1,180 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ObjectPool.h
+ * @brief  Thread-safe pool of reusable objects, handed out as shared_ptr's
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/core/lock_helper.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mola
+{
+/** Counters of one ObjectPool */
+struct ObjectPoolStats
+{
+    uint64_t created     = 0;  //!< Objects allocated with `new`
+    uint64_t reused      = 0;  //!< acquire() calls served from idle objects
+    uint64_t recycled    = 0;  //!< Released objects kept for reuse
+    uint64_t discarded   = 0;  //!< Released objects freed (pool full)
+    size_t   in_use      = 0;  //!< Acquired and not released yet
+    size_t   peak_in_use = 0;
+    size_t   idle        = 0;  //!< Ready for reuse
+};
+
+/** A thread-safe pool of default-constructible objects of type `T`.
+ *
+ * acquire() returns a regular `std::shared_ptr<T>` (e.g. a `T::Ptr` for MRPT
+ * classes) whose deleter, instead of freeing the object, resets it and
+ * returns it to the pool, up to `maxIdle` idle objects. Hence, consumers need
+ * no change at all: the object is recycled when its last user drops it, from
+ * whatever thread that happens.
+ *
+ * The reset function is called on release. It must leave the object as a
+ * new one, as far as the users of the pool are concerned, while keeping any
+ * expensive memory buffers (e.g. resizing vectors to zero). By default,
+ * objects are not reset.
+ *
+ * Objects may safely outlive their pool: they are then just deleted.
+ *
+ * \ingroup mola_kernel_grp
+ */
+template <class T>
+class ObjectPool
+{
+   public:
+    using reset_t = std::function<void(T&)>;
+
+    explicit ObjectPool(size_t maxIdle = 16, reset_t reset = {})
+        : state_(std::make_shared<State>())
+    {
+        state_->maxIdle = maxIdle;
+        state_->reset   = std::move(reset);
+    }
+
+    ObjectPool(const ObjectPool&)            = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    /// Returns an idle object, or a new one if there is none.
+    std::shared_ptr<T> acquire()
+    {
+        std::unique_ptr<T> obj;
+        {
+            auto  lck = mrpt::lockHelper(state_->mtx);
+            auto& st  = state_->stats;
+            if (!state_->idle.empty())
+            {
+                obj = std::move(state_->idle.back());
+                state_->idle.pop_back();
+                st.reused++;
+            }
+            else
+                st.created++;
+
+            st.in_use++;
+            st.peak_in_use = std::max(st.peak_in_use, st.in_use);
+        }
+        if (!obj) obj = std::make_unique<T>();
+
+        return std::shared_ptr<T>(
+            obj.release(),
+            [ws = std::weak_ptr<State>(state_)](T* p) { release(ws, p); });
+    }
+
+    /// Maximum number of idle objects kept for reuse
+    void setMaxIdle(size_t maxIdle)
+    {
+        std::vector<std::unique_ptr<T>> toFree;
+
+        auto lck        = mrpt::lockHelper(state_->mtx);
+        state_->maxIdle = maxIdle;
+        while (state_->idle.size() > maxIdle)
+        {
+            toFree.push_back(std::move(state_->idle.back()));
+            state_->idle.pop_back();
+        }
+        lck.unlock();
+    }
+
+    /// Frees all idle objects
+    void clear()
+    {
+        std::vector<std::unique_ptr<T>> toFree;
+
+        auto lck = mrpt::lockHelper(state_->mtx);
+        toFree.swap(state_->idle);
+        lck.unlock();
+    }
+
+    size_t maxIdle() const
+    {
+        auto lck = mrpt::lockHelper(state_->mtx);
+        return state_->maxIdle;
+    }
+
+    ObjectPoolStats stats() const
+    {
+        auto lck = mrpt::lockHelper(state_->mtx);
+        auto st  = state_->stats;
+        st.idle  = state_->idle.size();
+        return st;
+    }
+
+   private:
+    // Shared with the deleters of acquired objects, so they can tell whether
+    // the pool still exists:
+    struct State
+    {
+        std::mutex                      mtx;
+        std::vector<std::unique_ptr<T>> idle;
+        size_t                          maxIdle = 16;
+        reset_t                         reset;
+        ObjectPoolStats                 stats;
+    };
+    std::shared_ptr<State> state_;
+
+    // Called from the shared_ptr deleter: must not throw.
+    static void release(const std::weak_ptr<State>& ws, T* p)
+    {
+        std::unique_ptr<T> obj(p);  // freed at exit unless recycled
+
+        auto s = ws.lock();
+        if (!s) return;  // The pool is gone
+
+        // Reset out of the lock: this may release other pooled objects
+        // (e.g. the point cloud of an observation).
+        bool resetOk = true;
+        try
+        {
+            if (s->reset) s->reset(*obj);
+        }
+        catch (...)
+        {
+            resetOk = false;
+        }
+
+        auto lck = mrpt::lockHelper(s->mtx);
+        s->stats.in_use--;
+        if (resetOk && s->idle.size() < s->maxIdle)
+        {
+            s->idle.push_back(std::move(obj));
+            s->stats.recycled++;
+        }
+        else
+            s->stats.discarded++;
+    }
+};
+
+}  // namespace mola
@@ -0,0 +1,86 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ObservationPools.h
+ * @brief  Process-wide pools of point cloud observations and point maps
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_kernel/ObjectPool.h>
+#include <mrpt/maps/CPointsMapXYZI.h>
+#include <mrpt/maps/CPointsMapXYZIRT.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservationPointCloud.h>
+
+#include <map>
+#include <string>
+
+namespace mola
+{
+/** Process-wide ObjectPool's for the objects that high-rate point cloud
+ * sources (dataset readers, ROS bridge...) create for each scan.
+ *
+ * Use acquire<T>() instead of `T::Create()`. Observations are reset to a
+ * default-constructed state on release. Point maps only have their points
+ * removed, keeping the capacity of their buffers, so, after a few scans,
+ * refilling them needs no heap allocation. Map options (e.g.
+ * `insertionOptions`) are kept, so users of pooled maps should not modify
+ * them.
+ *
+ * Supported types: mrpt::obs::CObservationPointCloud,
+ * mrpt::maps::CSimplePointsMap, mrpt::maps::CPointsMapXYZI, and
+ * mrpt::maps::CPointsMapXYZIRT.
+ *
+ * \ingroup mola_kernel_grp
+ */
+class ObservationPools
+{
+   public:
+    static ObservationPools& Instance();
+
+    template <class T>
+    ObjectPool<T>& pool();
+
+    template <class T>
+    std::shared_ptr<T> acquire()
+    {
+        return pool<T>().acquire();
+    }
+
+    /// Statistics of all pools, by class name
+    std::map<std::string, ObjectPoolStats> stats() const;
+
+    /// Changes the maximum number of idle objects of all pools
+    void setMaxIdle(size_t maxIdle);
+
+    /// Frees all idle objects
+    void clear();
+
+   private:
+    ObservationPools();
+
+    ObjectPool<mrpt::obs::CObservationPointCloud> obsPointCloud_;
+    ObjectPool<mrpt::maps::CSimplePointsMap>      simplePointsMaps_;
+    ObjectPool<mrpt::maps::CPointsMapXYZI>        pointsMapsXYZI_;
+    ObjectPool<mrpt::maps::CPointsMapXYZIRT>      pointsMapsXYZIRT_;
+};
+
+template <>
+ObjectPool<mrpt::obs::CObservationPointCloud>&
+    ObservationPools::pool<mrpt::obs::CObservationPointCloud>();
+template <>
+ObjectPool<mrpt::maps::CSimplePointsMap>&
+    ObservationPools::pool<mrpt::maps::CSimplePointsMap>();
+template <>
+ObjectPool<mrpt::maps::CPointsMapXYZI>&
+    ObservationPools::pool<mrpt::maps::CPointsMapXYZI>();
+template <>
+ObjectPool<mrpt::maps::CPointsMapXYZIRT>&
+    ObservationPools::pool<mrpt::maps::CPointsMapXYZIRT>();
+
+}  // namespace mola
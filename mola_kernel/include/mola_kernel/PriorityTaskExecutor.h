@@ -0,0 +1,163 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   PriorityTaskExecutor.h
+ * @brief  Thread pool with priority lanes, bounded queues and statistics
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mola
+{
+/** Counters and latencies of one lane of a PriorityTaskExecutor.
+ * Times are in seconds. */
+struct PriorityTaskExecutorLaneStats
+{
+    uint64_t submitted   = 0;
+    uint64_t executed    = 0;
+    size_t   queued      = 0;  //!< Waiting right now
+    size_t   peak_queued = 0;
+
+    /** Submissions which had to wait for room in the (full) queue, and the
+     *  total time they waited. */
+    uint64_t blocked_submissions = 0;
+    double   blocked_time        = 0;
+
+    /// From submission to the start of the execution
+    double queue_latency_mean = 0, queue_latency_max = 0;
+
+    /// Execution time of the tasks
+    double run_time_mean = 0, run_time_max = 0;
+};
+
+/** Parameters of a PriorityTaskExecutor */
+struct PriorityTaskExecutorParameters
+{
+    size_t num_threads = 2;
+
+    /// Maximum queued tasks per lane (0=unbounded). Its size sets the
+    /// number of lanes.
+    std::vector<size_t> max_queue_lengths = {0};
+
+    /// Name of the threads, for debuggers and profilers
+    std::string name = "priority_executor";
+};
+
+/** A pool of worker threads running tasks from several *lanes*, with
+ * strict priority: a task is only taken from a lane if all lanes with a
+ * lower index are empty. Within a lane, tasks start in FIFO order.
+ *
+ * Each lane may have a maximum queue length. enqueue() then blocks the
+ * caller while the lane is full, so producers are slowed down to the pace
+ * of the consumers (backpressure). Tasks submitted from the executor worker
+ * threads never block, to avoid deadlocks.
+ *
+ * Threads are launched on the first enqueue(), or with start(), so the
+ * parameters can be changed after construction with setParameters().
+ *
+ * \ingroup mola_kernel_grp
+ */
+class PriorityTaskExecutor
+{
+   public:
+    using Parameters = PriorityTaskExecutorParameters;
+
+    explicit PriorityTaskExecutor(const Parameters& p = Parameters());
+
+    /// Calls stop()
+    ~PriorityTaskExecutor();
+
+    PriorityTaskExecutor(const PriorityTaskExecutor&)            = delete;
+    PriorityTaskExecutor& operator=(const PriorityTaskExecutor&) = delete;
+
+    /** Changes the parameters. Only allowed before the threads are started
+     *  \exception std::exception If already started. */
+    void setParameters(const Parameters& p);
+
+    const Parameters& parameters() const { return params_; }
+
+    size_t numLanes() const { return params_.max_queue_lengths.size(); }
+
+    /// Launches the worker threads, if not done yet.
+    void start();
+
+    /** Discards pending tasks (their futures get a std::future_error) and
+     *  waits for the running ones to finish. Afterwards, enqueue() throws.
+     *  Must not be called from a task of this executor. */
+    void stop();
+
+    /** Enqueues a task into a lane (0: highest priority), blocking while the
+     *  lane is full.
+     *  \return A future for the result of `f`, or for its exception.
+     */
+    template <class F>
+    auto enqueue(size_t lane, F&& f)
+        -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using R   = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<R()>>(
+            std::forward<F>(f));
+        auto fut = task->get_future();
+        push(lane, [task]() { (*task)(); });
+        return fut;
+    }
+
+    /// Tasks waiting to start in one lane
+    size_t pendingTasks(size_t lane) const;
+
+    /// Tasks waiting to start or running, in all lanes
+    size_t busyTasks() const;
+
+    PriorityTaskExecutorLaneStats laneStats(size_t lane) const;
+
+    /// Whether the caller runs in one of the worker threads of this executor
+    bool inWorkerThread() const;
+
+    void resetStats();
+
+   private:
+    using clock = std::chrono::steady_clock;
+
+    struct Task
+    {
+        std::function<void()> f;
+        clock::time_point     submitted;
+    };
+    struct Lane
+    {
+        std::deque<Task>              queue;
+        PriorityTaskExecutorLaneStats stats;
+    };
+
+    Parameters               params_;
+    std::vector<Lane>        lanes_;
+    std::vector<std::thread> threads_;
+    size_t                   running_ = 0;
+    bool                     stop_    = false;
+
+    mutable std::mutex      mtx_;
+    std::condition_variable cvTasks_;  //!< New task, or stop
+    std::condition_variable cvRoom_;  //!< A task left a queue, or stop
+
+    void push(size_t lane, std::function<void()>&& f);
+    void worker();
+};
+
+}  // namespace mola
@@ -136,6 +136,15 @@ class WorldModel : public ExecutableBase
     std::vector<id_t>  entity_all_ids() const;
     std::vector<fid_t> factor_all_ids() const;
 
+    /** Modification counter of a factor, 0 for never-modified factors.
+     * Requires factors_lock_for_read(). \sa factor_mark_modified() */
+    uint64_t factor_version(const fid_t id) const;
+
+    /** Must be called after modifying an existing factor via factor_by_id(),
+     * so caches of converted factors (e.g. FactorGraphBuilder) are
+     * invalidated. Requires factors_lock_for_write(). */
+    void factor_mark_modified(const fid_t id);
+
     annotations_data_t&       entity_annotations_by_id(const id_t id);
     const annotations_data_t& entity_annotations_by_id(const id_t id) const;
 
@@ -152,6 +161,10 @@ class WorldModel : public ExecutableBase
 
     std::string map_base_dir_;
 
+    /** Versions of modified factors. Not stored in WorldModelData since they
+     * are only meaningful within one session. */
+    mola::fast_map<fid_t, uint64_t> factor_versions_;
+
     /** Returns a list with all those entities that have not been accessed in
      * `age_to_unload_keyframes`. Once an entity is reported as "aged", it's
      * removed from the list of entities to watch, so it will be not reported
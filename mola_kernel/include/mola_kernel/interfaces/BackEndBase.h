@@ -11,23 +11,40 @@
  */
 #pragma once
 
+#include <mola_kernel/PriorityTaskExecutor.h>
 #include <mola_kernel/WorldModel.h>
 #include <mola_kernel/Yaml.h>
 #include <mola_kernel/interfaces/ExecutableBase.h>
 #include <mrpt/core/Clock.h>
-#include <mrpt/core/WorkerThreadsPool.h>
 #include <mrpt/img/TCamera.h>  // TODO: Remove after unused below
 #include <mrpt/math/CMatrixFixed.h>
 #include <mrpt/obs/CSensoryFrame.h>
 
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <optional>
+#include <vector>
 
 namespace mola
 {
 /** Virtual interface for SLAM back-ends.
- * All calls to `onXXX()` methods are enqueued and executed in a separate
- * thread.
+ * All calls to the user interface methods (addKeyFrame(), addFactor(),...)
+ * are enqueued and executed in separate threads, by a PriorityTaskExecutor
+ * with one lane per kind of task (see TaskLane). Its parameters can be set
+ * in the optional `executor` entry of the back-end YAML configuration:
+ *
+ * \code
+ * executor:
+ *   num_threads: 2
+ *   # Maximum queued tasks per lane (0=unbounded). If full, callers
+ *   # (e.g. front-ends) are blocked until there is room again.
+ *   max_queue_length:
+ *     localization: 0
+ *     keyframes: 100
+ *     factors: 1000
+ *     maintenance: 0
+ * \endcode
  *
  * \ingroup mola_kernel_grp */
 class BackEndBase : public ExecutableBase
@@ -41,10 +58,47 @@ class BackEndBase : public ExecutableBase
     /** Loads common parameters for all back-ends. */
     void initialize(const Yaml& cfg) override final;
 
+    /** Lanes of the back-end task executor, from highest to lowest
+     * priority. */
+    enum class TaskLane : uint8_t
+    {
+        Localization = 0,
+        KeyFrames,
+        Factors,
+        Maintenance
+    };
+    static constexpr size_t NUM_TASK_LANES = 4;
+
+    /** Returns "localization", "keyframes", etc. */
+    static const char* taskLaneName(TaskLane lane);
+
+    /** Queue and latency statistics of one lane of the task executor */
+    PriorityTaskExecutorLaneStats taskLaneStats(TaskLane lane) const
+    {
+        return slam_be_executor_.laneStats(static_cast<size_t>(lane));
+    }
+
+    /** Number of tasks waiting in one lane. Front-ends may use it to skip
+     * optional work (e.g. new keyframes) while the back-end is busy. */
+    size_t pendingTasks(TaskLane lane) const
+    {
+        return slam_be_executor_.pendingTasks(static_cast<size_t>(lane));
+    }
+
    protected:
     /** Loads children specific parameters */
     virtual void initialize_backend(const Yaml& cfg) = 0;
 
+    /** Sets the task executor parameters from the `executor` YAML entry, if
+     *  present. Called from initialize(). */
+    void initialize_executor(const Yaml& cfg);
+
+    /** Discards pending tasks and waits for the running ones to finish.
+     * Derived classes must call it in their destructor, since tasks call
+     * their methods and ~BackEndBase() runs once they are already
+     * destroyed. Afterwards, no new task can be enqueued. */
+    void stopTasks() { slam_be_executor_.stop(); }
+
    public:
     /** @name User interface for a SLAM back-end
      *{ */
@@ -68,8 +122,8 @@ class BackEndBase : public ExecutableBase
     /** Creates a new KeyFrame in the world model. */
     std::future<ProposeKF_Output> addKeyFrame(const ProposeKF_Input& i)
     {
-        return slam_be_threadpool_.enqueue(
-            &BackEndBase::doAddKeyFrame, this, i);
+        return enqueueTask(
+            TaskLane::KeyFrames, [this, i]() { return doAddKeyFrame(i); });
     }
 
     struct AddFactor_Output
@@ -85,7 +139,21 @@ class BackEndBase : public ExecutableBase
      */
     std::future<AddFactor_Output> addFactor(Factor& f)
     {
-        return slam_be_threadpool_.enqueue(&BackEndBase::doAddFactor, this, f);
+        return enqueueTask(
+            TaskLane::Factors,
+            [this, f = std::move(f)]() mutable { return doAddFactor(f); });
+    }
+
+    /** Adds many factors in one single task, which is much cheaper than
+     * calling addFactor() for each one. Factors are **moved** as in
+     * addFactor(), and the outputs are in the same order.
+     */
+    std::future<std::vector<AddFactor_Output>> addFactors(
+        std::vector<Factor>& fs)
+    {
+        return enqueueTask(
+            TaskLane::Factors,
+            [this, fs = std::move(fs)]() mutable { return doAddFactors(fs); });
     }
 
     struct AdvertiseUpdatedLocalization_Input
@@ -102,9 +170,16 @@ class BackEndBase : public ExecutableBase
     std::future<void> advertiseUpdatedLocalization(
         const AdvertiseUpdatedLocalization_Input& l)
     {
-        const auto copyOfL = l;
-        return slam_be_threadpool_.enqueue(
-            [this, copyOfL]() { doAdvertiseUpdatedLocalization(copyOfL); });
+        return enqueueTask(TaskLane::Localization, [this, l]() {
+            doAdvertiseUpdatedLocalization(l);
+        });
+    }
+
+    /** Runs a back-end specific task (e.g. re-linearization, map
+     * housekeeping) with the lowest priority. */
+    std::future<void> enqueueMaintenanceTask(std::function<void()> f)
+    {
+        return enqueueTask(TaskLane::Maintenance, std::move(f));
     }
 
     /** @} */
@@ -143,13 +218,27 @@ class BackEndBase : public ExecutableBase
     virtual AddFactor_Output doAddFactor(Factor& f)                  = 0;
     virtual void             doAdvertiseUpdatedLocalization(
                     const AdvertiseUpdatedLocalization_Input& l) = 0;
+
+    /** Adds a batch of factors. By default, it calls doAddFactor() for each
+     *  one. Back-ends may override it to update their internal structures
+     *  only once per batch. */
+    virtual std::vector<AddFactor_Output> doAddFactors(
+        std::vector<Factor>& fs);
     /** @} */
 
    protected:
     WorldModel::Ptr worldmodel_;
 
-    mrpt::WorkerThreadsPool slam_be_threadpool_{
-        2, mrpt::WorkerThreadsPool::POLICY_FIFO, "slam_backend"};
+    /** Runs all back-end tasks. \sa initialize_executor() */
+    PriorityTaskExecutor slam_be_executor_;
+
+    template <class F>
+    auto enqueueTask(TaskLane lane, F&& f)
+        -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        return slam_be_executor_.enqueue(
+            static_cast<size_t>(lane), std::forward<F>(f));
+    }
 };
 
 }  // namespace mola
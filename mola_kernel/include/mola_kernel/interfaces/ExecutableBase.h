@@ -33,7 +33,7 @@ using ProfilerSaverAtDtor = mrpt::system::CTimeLoggerSaveAtDtor;
  * SLAM system. \ingroup mola_kernel_grp */
 class ExecutableBase : public mrpt::system::COutputLogger,  // for logging
                        public mrpt::rtti::CObject,  // RTTI helpers
-                       std::enable_shared_from_this<ExecutableBase>
+                       public std::enable_shared_from_this<ExecutableBase>
 {
     // This macro defines `Ptr=shared_ptr<T>`, among other types and methods.
     DEFINE_VIRTUAL_MRPT_OBJECT(ExecutableBase)
@@ -54,7 +54,10 @@ class ExecutableBase : public mrpt::system::COutputLogger,  // for logging
     /** This must be implemented to read all the required parameters */
     virtual void initialize(const Yaml& cfg) = 0;
 
-    /** Runs any required action on a timely manner */
+    /** Runs any required action on a timely manner.
+     * Each call is one processing cycle of the thread FrameArena, hence
+     * frame_memory_resource() can be used for transient data.
+     */
     virtual void spinOnce() = 0;
 
     /** Modules will be initialized in the order determined by:
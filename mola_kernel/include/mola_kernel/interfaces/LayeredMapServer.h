@@ -0,0 +1,85 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LayeredMapServer.h
+ * @brief  MapServer saving/loading named map layers in the background
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_kernel/interfaces/MapServer.h>
+#include <mrpt/serialization/CSerializable.h>
+
+#include <map>
+#include <string>
+
+namespace mola
+{
+/** A MapServer for maps made of named, serializable layers, e.g. the layers
+ * of a metric map.
+ *
+ * map_save_async() takes a snapshot of the layers in the calling thread, via
+ * map_snapshot_layers(), and serializes them in the background into a single
+ * file, written in chunks by a ChunkedFileOutputStream. Between chunks, the
+ * progress is reported and the operation may be cancelled. Files are written
+ * into a temporary file first, so an existing map is never left half-written.
+ *
+ * map_load_async() reads all layers in the background and, only if all of
+ * them could be read, passes them to map_set_layers().
+ *
+ * The synchronous map_load() and map_save() just wait for the asynchronous
+ * versions.
+ *
+ * A running load ends calling map_set_layers(), so it keeps the module alive
+ * (see MapServer::operationKeepAlive()). Derived classes not owned by a
+ * std::shared_ptr must call cancelMapOperations() in their destructor
+ * instead: it cannot be done in ~LayeredMapServer(), since derived classes
+ * are already destroyed by then.
+ *
+ * \ingroup mola_kernel_grp */
+class LayeredMapServer : public MapServer
+{
+   public:
+    LayeredMapServer();
+    ~LayeredMapServer() override;
+
+    using layers_t =
+        std::map<std::string, mrpt::serialization::CSerializable::Ptr>;
+
+    ReturnStatus map_load(const std::string& path) override;
+    ReturnStatus map_save(const std::string& path) override;
+
+    Operation::Ptr map_load_async(
+        const std::string& path, const AsyncCallbacks& callbacks = {}) override;
+    Operation::Ptr map_save_async(
+        const std::string& path, const AsyncCallbacks& callbacks = {}) override;
+
+    /// Size of the chunks of data written or read between progress updates.
+    size_t map_chunk_size = 4 * 1024 * 1024;
+
+   protected:
+    /** Returns the layers to be saved. This is called from map_save_async(),
+     * in the caller thread, while serialization happens later in another
+     * thread: implementations should only hold their map lock to copy the
+     * layer smart pointers, cloning those which might be modified while being
+     * saved, so the map is locked for a short time only.
+     */
+    virtual layers_t map_snapshot_layers() = 0;
+
+    /** Replaces the current map with the loaded layers. Called from the map
+     * server worker thread. */
+    virtual void map_set_layers(layers_t&& layers) = 0;
+
+    /** The file for a given map_load() / map_save() path. By default, the
+     * path plus the ".molamap" extension. */
+    virtual std::string map_file_name(const std::string& path) const
+    {
+        return path + ".molamap";
+    }
+};
+
+}  // namespace mola
@@ -11,25 +11,24 @@
  */
 #pragma once
 
+#include <mola_kernel/AsyncSubscribers.h>
 #include <mrpt/core/Clock.h>
-#include <mrpt/core/lock_helper.h>
 #include <mrpt/math/CMatrixFixed.h>
 #include <mrpt/math/TPose3D.h>
 
 #include <functional>
-#include <iostream>
-#include <mutex>
 #include <optional>
 #include <string>
-#include <vector>
 
 namespace mola
 {
 /** Virtual interface for SLAM/odometry methods publishing poses.
  *
  * Publishers must call advertiseUpdatedLocalization(), subscribers
- * must call subscribeToLocalizationUpdates() providing a callback that returns
- * as fast as possible.
+ * must call subscribeToLocalizationUpdates() providing a callback. Callbacks
+ * run in a delivery thread per subscriber (see AsyncSubscribers), so slow
+ * subscribers do not stall the publisher, although they may drop updates
+ * if their queue overflows.
  *
  * \ingroup mola_kernel_grp */
 class LocalizationSourceBase
@@ -59,40 +58,46 @@ class LocalizationSourceBase
     using localization_updates_callback_t =
         std::function<void(const LocalizationUpdate&)>;
 
-    void subscribeToLocalizationUpdates(
-        const localization_updates_callback_t& callback)
+    /** Registers a callback for new poses. By default, updates are
+     * delivered in order through a bounded FIFO queue.
+     * \return A handle for unsubscribeFromLocalizationUpdates()
+     */
+    subscription_id_t subscribeToLocalizationUpdates(
+        const localization_updates_callback_t& callback,
+        const SubscriberOptions& options = SubscriberOptions::BoundedFIFO())
     {
-        auto lck = mrpt::lockHelper(locUpdSubsMtx_);
-        locUpdSubs_.push_back(callback);
+        return locUpdSubs_.subscribe(callback, options);
+    }
+
+    /** Once this returns, the callback will not be invoked again.
+     *  \return false if the handle was not found. */
+    bool unsubscribeFromLocalizationUpdates(subscription_id_t id)
+    {
+        return locUpdSubs_.unsubscribe(id);
+    }
+
+    /// Delivery and drop counters of one subscriber
+    std::optional<SubscriberStats> localizationUpdatesSubscriberStats(
+        subscription_id_t id) const
+    {
+        return locUpdSubs_.stats(id);
     }
 
    protected:
-    bool anyUpdateLocalizationSubscriber()
+    bool anyUpdateLocalizationSubscriber() const
     {
-        auto lck = mrpt::lockHelper(locUpdSubsMtx_);
         return !locUpdSubs_.empty();
     }
 
+    /// Enqueues the update for all subscribers, without waiting for them.
     void advertiseUpdatedLocalization(const LocalizationUpdate& l)
     {
-        auto lck = mrpt::lockHelper(locUpdSubsMtx_);
-        for (const auto& callback : locUpdSubs_)
-        {
-            try
-            {
-                callback(l);
-            }
-            catch (const std::exception& e)
-            {
-                std::cerr << "[LocalizationSourceBase] Exception in callback: "
-                          << e.what();
-            }
-        }
+        locUpdSubs_.publish(l);
     }
 
    private:
-    std::vector<localization_updates_callback_t> locUpdSubs_;
-    std::mutex                                   locUpdSubsMtx_;
+    AsyncSubscribers<LocalizationUpdate> locUpdSubs_{
+        "LocalizationSourceBase"};
 };
 
 }  // namespace mola
@@ -11,12 +11,34 @@
  */
 #pragma once
 
-#include <cstdlib>
+#include <mola_kernel/PriorityTaskExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace mola
 {
 /** Virtual interface for map server services offered by MOLA modules
+ *
+ * Maps can be loaded and saved either synchronously (map_load(), map_save())
+ * or in the background (map_load_async(), map_save_async()). By default, the
+ * asynchronous versions just run the synchronous ones in a worker thread,
+ * without progress information nor cancellation. See LayeredMapServer for a
+ * base class providing both.
+ *
+ * Asynchronous operations keep the MOLA module implementing this interface
+ * alive until they finish, if it is owned by a std::shared_ptr, as modules
+ * created by the launcher are (see operationKeepAlive()). Otherwise, see
+ * cancelMapOperations().
+ *
  * \ingroup mola_kernel_grp */
 class MapServer
 {
@@ -59,7 +81,125 @@ class MapServer
         return {};
     }
 
+    /** Progress of an asynchronous load or save operation */
+    struct Progress
+    {
+        double   fraction = 0;  //!< [0,1]. Roughly, for some operations.
+        uint64_t bytes    = 0;  //!< Bytes written or read so far
+        std::string stage;  //!< Human-readable, e.g. the current map layer
+    };
+
+    struct AsyncCallbacks
+    {
+        /** Invoked from the worker thread on progress. It should return
+         *  quickly. */
+        std::function<void(const Progress&)> on_progress;
+
+        /** Invoked once, from the worker thread, on completion, error or
+         *  cancellation. */
+        std::function<void(const ReturnStatus&)> on_done;
+    };
+
+    /** Handle to an asynchronous map_load_async() / map_save_async(). */
+    class Operation
+    {
+       public:
+        using Ptr = std::shared_ptr<Operation>;
+
+        explicit Operation(AsyncCallbacks callbacks = {});
+
+        /// Requests the operation to stop as soon as possible.
+        void cancel() { cancelRequested_ = true; }
+
+        bool cancelRequested() const { return cancelRequested_; }
+
+        Progress progress() const;
+
+        /// Ready once the operation finishes, successfully or not
+        std::shared_future<ReturnStatus> future() const { return future_; }
+
+        bool done() const
+        {
+            return future_.wait_for(std::chrono::seconds(0)) ==
+                   std::future_status::ready;
+        }
+
+        /// Waits for the operation to finish and returns its result
+        ReturnStatus wait() const { return future_.get(); }
+
+        /** @name For implementations of asynchronous operations
+         * @{ */
+
+        /** Updates the progress and invokes the on_progress callback.
+         *  \exception OperationCancelled If cancel() was called. */
+        void reportProgress(const Progress& p);
+
+        /// \exception OperationCancelled If cancel() was called.
+        void throwIfCancelled() const;
+
+        /// Sets the result. Only the first call has any effect.
+        void finish(const ReturnStatus& r);
+
+        /** @} */
+
+       private:
+        AsyncCallbacks                   callbacks_;
+        std::atomic_bool                 cancelRequested_{false};
+        mutable std::mutex               mtx_;
+        Progress                         progress_;
+        bool                             finished_ = false;
+        std::promise<ReturnStatus>       promise_;
+        std::shared_future<ReturnStatus> future_;
+    };
+
+    /** Thrown by Operation methods to abort a cancelled operation. */
+    class OperationCancelled : public std::runtime_error
+    {
+       public:
+        OperationCancelled() : std::runtime_error("Operation cancelled") {}
+    };
+
+    /** Loads a map in the background, like map_load(). The map is set as the
+     * active one upon success only. */
+    virtual Operation::Ptr map_load_async(
+        const std::string& path, const AsyncCallbacks& callbacks = {});
+
+    /** Saves a map in the background, like map_save(). Implementations take
+     * a snapshot of the map first, so later changes are not saved. */
+    virtual Operation::Ptr map_save_async(
+        const std::string& path, const AsyncCallbacks& callbacks = {});
+
     /** @} */
+
+    /** Cancels all running or pending asynchronous operations, and waits
+     * for them to finish. Derived classes not owned by a std::shared_ptr
+     * (hence, whose operations cannot keep them alive) should call it in
+     * their destructor if they ever run asynchronous operations. As a last
+     * resort, MapServer's destructor calls it too, but derived classes are
+     * already destroyed by then.
+     */
+    void cancelMapOperations();
+
+   protected:
+    /** Runs `f` in the map server worker thread, and finishes `op` with its
+     * result, or with an error if it throws. Pending operations run one
+     * after the other, in FIFO order. */
+    void runMapOperation(
+        const Operation::Ptr& op, std::function<ReturnStatus()> f);
+
+    /** A reference to the ExecutableBase (module) this object is part of, if
+     * it is owned by a std::shared_ptr, or an empty pointer otherwise.
+     * Operations calling methods of this object hold it until they finish, so
+     * the module is not destroyed under them. */
+    std::shared_ptr<void> operationKeepAlive();
+
+   private:
+    /** Started on first use. Shared, since the module may be released by
+     * its last operation, in the worker thread itself. */
+    std::shared_ptr<PriorityTaskExecutor> mapServerWorker_;
+
+    std::mutex                            opsMtx_;
+    std::vector<std::weak_ptr<Operation>> ops_;
 };
 
 }  // namespace mola
@@ -11,17 +11,19 @@
  */
 #pragma once
 
+#include <mola_kernel/AsyncSubscribers.h>
 #include <mrpt/maps/CMetricMap.h>
 
 #include <functional>
-#include <iostream>
-#include <mutex>
+#include <optional>
 #include <string>
-#include <vector>
 
 namespace mola
 {
 /** Virtual interface for SLAM/odometry methods publishing a map
+ *
+ * Updates are delivered asynchronously (see AsyncSubscribers), so
+ * advertiseUpdatedMap() never blocks on slow subscribers.
  *
  * \ingroup mola_kernel_grp */
 class MapSourceBase
@@ -47,44 +49,51 @@ class MapSourceBase
         /** Map layer/submap name */
         std::string map_name = "local_map";
 
+        /** The map is shared with all subscribers, not copied, and they
+         * read it from other threads after advertiseUpdatedMap() returns.
+         * Hence, it must be treated as immutable once published: publishers
+         * must not modify this object afterwards (publish a copy, or a new
+         * map each time; check anyUpdateMapSubscriber() to skip copying
+         * when nobody listens), and subscribers must not modify it. */
         mrpt::maps::CMetricMap::Ptr map;
     };
 
     using map_updates_callback_t = std::function<void(const MapUpdate&)>;
 
-    void subscribeToMapUpdates(const map_updates_callback_t& callback)
+    /** Registers a callback for new maps, invoked from a delivery thread
+     * (not the publisher's). By default, only the latest pending update is
+     * kept if the subscriber is slower than the publisher.
+     * \return A handle for unsubscribeFromMapUpdates()
+     */
+    subscription_id_t subscribeToMapUpdates(
+        const map_updates_callback_t& callback,
+        const SubscriberOptions&      options = SubscriberOptions::LatestOnly())
     {
-        auto lck = mrpt::lockHelper(mapUpdSubsMtx_);
-        mapUpdSubs_.push_back(callback);
+        return mapUpdSubs_.subscribe(callback, options);
     }
 
-   protected:
-    bool anyUpdateMapSubscriber()
+    /** Once this returns, the callback will not be invoked again.
+     *  \return false if the handle was not found. */
+    bool unsubscribeFromMapUpdates(subscription_id_t id)
     {
-        auto lck = mrpt::lockHelper(mapUpdSubsMtx_);
-        return !mapUpdSubs_.empty();
+        return mapUpdSubs_.unsubscribe(id);
     }
 
-    void advertiseUpdatedMap(const MapUpdate& l)
+    /// Delivery and drop counters of one subscriber
+    std::optional<SubscriberStats> mapUpdatesSubscriberStats(
+        subscription_id_t id) const
     {
-        auto lck = mrpt::lockHelper(mapUpdSubsMtx_);
-        for (const auto& callback : mapUpdSubs_)
-        {
-            try
-            {
-                callback(l);
-            }
-            catch (const std::exception& e)
-            {
-                std::cerr << "[MapSourceBase] Exception in callback: "
-                          << e.what();
-            }
-        }
+        return mapUpdSubs_.stats(id);
     }
 
+   protected:
+    bool anyUpdateMapSubscriber() const { return !mapUpdSubs_.empty(); }
+
+    /// Enqueues the update for all subscribers, without waiting for them.
+    void advertiseUpdatedMap(const MapUpdate& l) { mapUpdSubs_.publish(l); }
+
    private:
-    std::vector<map_updates_callback_t> mapUpdSubs_;
-    std::mutex                          mapUpdSubsMtx_;
+    AsyncSubscribers<MapUpdate> mapUpdSubs_{"MapSourceBase"};
 };
 
 }  // namespace mola
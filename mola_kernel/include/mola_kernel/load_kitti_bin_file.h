@@ -0,0 +1,75 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   load_kitti_bin_file.h
+ * @brief  Reader of KITTI-like binary point cloud files into point maps
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/maps/CPointsMapXYZI.h>
+#include <mrpt/maps/CPointsMapXYZIRT.h>
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+namespace mola
+{
+/** Reads a KITTI-like scan (float32 x,y,z,intensity records) by resizing
+ * `pts`, so the memory of recycled (pooled, see ObservationPools) maps is
+ * reused.
+ *
+ * `POINTS_MAP` can be mrpt::maps::CPointsMapXYZI or
+ * mrpt::maps::CPointsMapXYZIRT. For the latter, ring and time fields are
+ * allocated, but left for the caller to fill in.
+ *
+ * \return false if the file cannot be opened, or its size or contents are
+ *         not a whole number of records.
+ * \ingroup mola_kernel_grp
+ */
+template <class POINTS_MAP>
+bool load_kitti_bin_file(const std::string& f, POINTS_MAP& pts)
+{
+    static_assert(
+        std::is_same_v<POINTS_MAP, mrpt::maps::CPointsMapXYZI> ||
+            std::is_same_v<POINTS_MAP, mrpt::maps::CPointsMapXYZIRT>,
+        "Unsupported point map type");
+
+    std::ifstream is(f, std::ios::binary | std::ios::ate);
+    if (!is.is_open()) return false;
+
+    constexpr size_t RECORD = 4 * sizeof(float);
+    const auto       nBytes = static_cast<size_t>(is.tellg());
+    if (nBytes % RECORD != 0) return false;
+    const size_t nPts = nBytes / RECORD;
+    is.seekg(0);
+
+    if constexpr (std::is_same_v<POINTS_MAP, mrpt::maps::CPointsMapXYZIRT>)
+        pts.resize_XYZIRT(nPts, true /*i*/, true /*R*/, true /*t*/);
+    else
+        pts.resize(nPts);
+
+    std::array<float, 4 * 1024> buf;
+    for (size_t i = 0; i < nPts;)
+    {
+        const size_t n = std::min(nPts - i, buf.size() / 4);
+        if (!is.read(reinterpret_cast<char*>(buf.data()), n * RECORD))
+            return false;
+        for (size_t k = 0; k < n; k++, i++)
+        {
+            pts.setPointFast(i, buf[4 * k], buf[4 * k + 1], buf[4 * k + 2]);
+            pts.setPointIntensity(i, buf[4 * k + 3]);
+        }
+    }
+    pts.mark_as_modified();
+    return true;
+}
+
+}  // namespace mola
@@ -0,0 +1,153 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ChunkedFileStream.cpp
+ * @brief  Binary file streams which report progress after each chunk
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/ChunkedFileStream.h>
+#include <mrpt/core/exceptions.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace mola;
+
+ChunkedFileOutputStream::ChunkedFileOutputStream(
+    const std::string& fileName, chunk_callback_t onChunk, size_t chunkSize)
+    : fileName_(fileName), onChunk_(std::move(onChunk))
+{
+    ASSERT_GT_(chunkSize, 0U);
+    buf_.reserve(chunkSize);
+
+    f_.open(fileName, std::ios::binary | std::ios::trunc);
+    ASSERTMSG_(f_.is_open(), "Cannot open for writing: '" + fileName + "'");
+}
+
+ChunkedFileOutputStream::~ChunkedFileOutputStream()
+{
+    if (!f_.is_open()) return;
+    try
+    {
+        // No callback here: it might throw, or refer to destroyed objects.
+        onChunk_ = nullptr;
+        close();
+    }
+    catch (const std::exception&)
+    {
+    }
+}
+
+void ChunkedFileOutputStream::flushChunk()
+{
+    if (buf_.empty()) return;
+
+    f_.write(
+        reinterpret_cast<const char*>(buf_.data()),
+        static_cast<std::streamsize>(buf_.size()));
+    ASSERTMSG_(f_.good(), "Error writing to: '" + fileName_ + "'");
+    buf_.clear();
+
+    if (onChunk_) onChunk_(position_);
+}
+
+void ChunkedFileOutputStream::close()
+{
+    if (!f_.is_open()) return;
+    flushChunk();
+    f_.close();
+    ASSERTMSG_(!f_.fail(), "Error closing: '" + fileName_ + "'");
+}
+
+size_t ChunkedFileOutputStream::Write(const void* Buffer, size_t Count)
+{
+    ASSERTMSG_(f_.is_open(), "Write() after close()");
+
+    const auto*  in        = static_cast<const uint8_t*>(Buffer);
+    const size_t chunkSize = buf_.capacity();
+    size_t       left      = Count;
+    while (left > 0)
+    {
+        const size_t n = std::min(left, chunkSize - buf_.size());
+        buf_.insert(buf_.end(), in, in + n);
+        in += n;
+        left -= n;
+        position_ += n;
+        if (buf_.size() == chunkSize) flushChunk();
+    }
+    return Count;
+}
+
+size_t ChunkedFileOutputStream::Read(void*, size_t)
+{
+    THROW_EXCEPTION("ChunkedFileOutputStream is write-only");
+}
+
+uint64_t ChunkedFileOutputStream::Seek(int64_t Offset, CStream::TSeekOrigin)
+{
+    THROW_EXCEPTION_FMT(
+        "ChunkedFileOutputStream does not support Seek(%li)",
+        static_cast<long>(Offset));
+}
+
+ChunkedFileInputStream::ChunkedFileInputStream(
+    const std::string& fileName, chunk_callback_t onChunk, size_t chunkSize)
+    : fileName_(fileName), onChunk_(std::move(onChunk))
+{
+    ASSERT_GT_(chunkSize, 0U);
+    buf_.reserve(chunkSize);
+
+    f_.open(fileName, std::ios::binary | std::ios::ate);
+    ASSERTMSG_(f_.is_open(), "Cannot open for reading: '" + fileName + "'");
+    fileSize_ = static_cast<uint64_t>(f_.tellg());
+    f_.seekg(0);
+}
+
+bool ChunkedFileInputStream::readChunk()
+{
+    buf_.resize(buf_.capacity());
+    f_.read(
+        reinterpret_cast<char*>(buf_.data()),
+        static_cast<std::streamsize>(buf_.size()));
+    buf_.resize(static_cast<size_t>(f_.gcount()));
+    bufPos_ = 0;
+    if (buf_.empty()) return false;
+
+    bytesRead_ += buf_.size();
+    if (onChunk_) onChunk_(bytesRead_);
+    return true;
+}
+
+size_t ChunkedFileInputStream::Read(void* Buffer, size_t Count)
+{
+    auto*  out  = static_cast<uint8_t*>(Buffer);
+    size_t done = 0;
+    while (done < Count)
+    {
+        if (bufPos_ == buf_.size() && !readChunk()) break;
+
+        const size_t n = std::min(Count - done, buf_.size() - bufPos_);
+        std::memcpy(out + done, buf_.data() + bufPos_, n);
+        bufPos_ += n;
+        done += n;
+    }
+    position_ += done;
+    return done;
+}
+
+size_t ChunkedFileInputStream::Write(const void*, size_t)
+{
+    THROW_EXCEPTION("ChunkedFileInputStream is read-only");
+}
+
+uint64_t ChunkedFileInputStream::Seek(int64_t Offset, CStream::TSeekOrigin)
+{
+    THROW_EXCEPTION_FMT(
+        "ChunkedFileInputStream does not support Seek(%li)",
+        static_cast<long>(Offset));
+}
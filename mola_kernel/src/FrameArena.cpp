@@ -0,0 +1,110 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   FrameArena.cpp
+ * @brief  Resettable monotonic arena for per-cycle transient data (std::pmr)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/FrameArena.h>
+
+#include <algorithm>
+
+using namespace mola;
+
+namespace
+{
+thread_local std::pmr::memory_resource* currentFrameResource = nullptr;
+}
+
+FrameArena::FrameArena(size_t initialBufferSize, size_t maxRetainedBytes)
+    : buffer_(new std::byte[initialBufferSize]),
+      maxRetainedBytes_(maxRetainedBytes)
+{
+    stats_.buffer_size = initialBufferSize;
+    mono_.emplace(buffer_.get(), stats_.buffer_size, &upstream_);
+}
+
+FrameArena::~FrameArena()
+{
+    // Release the heap blocks (if any) before the buffer:
+    mono_.reset();
+}
+
+FrameArena& FrameArena::ThisThread()
+{
+    thread_local FrameArena arena;
+    return arena;
+}
+
+void FrameArena::reset()
+{
+    // Destroying the monotonic resource returns its heap blocks:
+    mono_.reset();
+
+    if (upstream_.cycleBytes > 0 && stats_.buffer_size < maxRetainedBytes_)
+    {
+        // Grow, so the next cycles like this one fit into the buffer:
+        size_t newSize = std::max<size_t>(stats_.buffer_size, 4096);
+        while (newSize < stats_.buffer_size + upstream_.cycleBytes)
+            newSize *= 2;
+        newSize = std::min(newSize, maxRetainedBytes_);
+
+        buffer_.reset();  // do not hold both at once
+        buffer_.reset(new std::byte[newSize]);
+        stats_.buffer_size = newSize;
+    }
+    upstream_.cycleBytes = 0;
+
+    mono_.emplace(buffer_.get(), stats_.buffer_size, &upstream_);
+
+    stats_.frames++;
+    stats_.bytes_in_use = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = mono_->allocate(bytes, alignment);
+
+    stats_.allocations++;
+    stats_.bytes_in_use += bytes;
+    stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.bytes_in_use);
+    return p;
+}
+
+void* FrameArena::Upstream::do_allocate(size_t bytes, size_t alignment)
+{
+    void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    stats_.upstream_allocations++;
+    cycleBytes += bytes;
+    return p;
+}
+
+void FrameArena::Upstream::do_deallocate(
+    void* p, size_t bytes, size_t alignment)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+FrameArena::Scope::Scope(FrameArena& arena)
+    : arena_(arena), previous_(currentFrameResource)
+{
+    currentFrameResource = &arena_;
+    arena_.cycleDepth_++;
+}
+
+FrameArena::Scope::~Scope()
+{
+    currentFrameResource = previous_;
+    if (--arena_.cycleDepth_ == 0) arena_.reset();
+}
+
+std::pmr::memory_resource* mola::frame_memory_resource()
+{
+    return currentFrameResource ? currentFrameResource
+                                : std::pmr::get_default_resource();
+}
@@ -0,0 +1,97 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ObservationPools.cpp
+ * @brief  Process-wide pools of point cloud observations and point maps
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/ObservationPools.h>
+
+using namespace mola;
+
+namespace
+{
+// Enough for a few sensors, plus read-ahead buffers and queued scans:
+constexpr size_t DEFAULT_MAX_IDLE = 32;
+
+// Removes all points, but keeps the allocated memory (resize() does not
+// shrink the underlying std::vector's, unlike clear()).
+void reset_points_map(mrpt::maps::CPointsMap& m) { m.resize(0); }
+
+}  // namespace
+
+ObservationPools& ObservationPools::Instance()
+{
+    static ObservationPools o;
+    return o;
+}
+
+ObservationPools::ObservationPools()
+    : obsPointCloud_(
+          DEFAULT_MAX_IDLE,
+          [](mrpt::obs::CObservationPointCloud& o)
+          {
+              // This releases the point cloud (e.g. to its own pool) too:
+              o = mrpt::obs::CObservationPointCloud();
+          }),
+      simplePointsMaps_(DEFAULT_MAX_IDLE, &reset_points_map),
+      pointsMapsXYZI_(DEFAULT_MAX_IDLE, &reset_points_map),
+      pointsMapsXYZIRT_(DEFAULT_MAX_IDLE, &reset_points_map)
+{
+}
+
+template <>
+ObjectPool<mrpt::obs::CObservationPointCloud>&
+    ObservationPools::pool<mrpt::obs::CObservationPointCloud>()
+{
+    return obsPointCloud_;
+}
+template <>
+ObjectPool<mrpt::maps::CSimplePointsMap>&
+    ObservationPools::pool<mrpt::maps::CSimplePointsMap>()
+{
+    return simplePointsMaps_;
+}
+template <>
+ObjectPool<mrpt::maps::CPointsMapXYZI>&
+    ObservationPools::pool<mrpt::maps::CPointsMapXYZI>()
+{
+    return pointsMapsXYZI_;
+}
+template <>
+ObjectPool<mrpt::maps::CPointsMapXYZIRT>&
+    ObservationPools::pool<mrpt::maps::CPointsMapXYZIRT>()
+{
+    return pointsMapsXYZIRT_;
+}
+
+std::map<std::string, ObjectPoolStats> ObservationPools::stats() const
+{
+    return {
+        {"mrpt::obs::CObservationPointCloud", obsPointCloud_.stats()},
+        {"mrpt::maps::CSimplePointsMap", simplePointsMaps_.stats()},
+        {"mrpt::maps::CPointsMapXYZI", pointsMapsXYZI_.stats()},
+        {"mrpt::maps::CPointsMapXYZIRT", pointsMapsXYZIRT_.stats()},
+    };
+}
+
+void ObservationPools::setMaxIdle(size_t maxIdle)
+{
+    obsPointCloud_.setMaxIdle(maxIdle);
+    simplePointsMaps_.setMaxIdle(maxIdle);
+    pointsMapsXYZI_.setMaxIdle(maxIdle);
+    pointsMapsXYZIRT_.setMaxIdle(maxIdle);
+}
+
+void ObservationPools::clear()
+{
+    obsPointCloud_.clear();
+    simplePointsMaps_.clear();
+    pointsMapsXYZI_.clear();
+    pointsMapsXYZIRT_.clear();
+}
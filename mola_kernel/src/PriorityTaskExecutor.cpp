@@ -0,0 +1,201 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   PriorityTaskExecutor.cpp
+ * @brief  Thread pool with priority lanes, bounded queues and statistics
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/PriorityTaskExecutor.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/system/thread_name.h>
+
+#include <algorithm>
+
+using namespace mola;
+
+namespace
+{
+// The executor whose worker is running in this thread, if any:
+thread_local const PriorityTaskExecutor* current_executor = nullptr;
+
+double to_seconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+}  // namespace
+
+PriorityTaskExecutor::PriorityTaskExecutor(const Parameters& p)
+{
+    setParameters(p);
+}
+
+PriorityTaskExecutor::~PriorityTaskExecutor() { stop(); }
+
+void PriorityTaskExecutor::stop()
+{
+    std::vector<std::deque<Task>> discarded;
+    {
+        auto lck = mrpt::lockHelper(mtx_);
+        stop_    = true;
+        for (auto& l : lanes_)
+        {
+            discarded.emplace_back(std::move(l.queue));
+            l.queue.clear();
+        }
+    }
+    cvTasks_.notify_all();
+    cvRoom_.notify_all();
+
+    for (auto& t : threads_)
+        if (t.joinable()) t.join();
+
+    // "discarded" tasks are destroyed here, out of the lock, breaking the
+    // promises of their futures.
+}
+
+void PriorityTaskExecutor::setParameters(const Parameters& p)
+{
+    ASSERT_(p.num_threads > 0);
+    ASSERT_(!p.max_queue_lengths.empty());
+
+    auto lck = mrpt::lockHelper(mtx_);
+    ASSERTMSG_(
+        threads_.empty(),
+        "setParameters() cannot be called after the threads are started");
+
+    params_ = p;
+    lanes_.clear();
+    lanes_.resize(p.max_queue_lengths.size());
+}
+
+void PriorityTaskExecutor::start()
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    if (!threads_.empty() || stop_) return;
+
+    for (size_t i = 0; i < params_.num_threads; i++)
+    {
+        auto& t = threads_.emplace_back([this]() { worker(); });
+        mrpt::system::thread_name(
+            params_.name + std::to_string(i), t);  // for debuggers
+    }
+}
+
+void PriorityTaskExecutor::push(size_t lane, std::function<void()>&& f)
+{
+    start();
+
+    auto lck = std::unique_lock<std::mutex>(mtx_);
+    ASSERT_LT_(lane, lanes_.size());
+
+    auto&        l      = lanes_[lane];
+    const size_t maxLen = params_.max_queue_lengths[lane];
+
+    // Backpressure:
+    if (maxLen != 0 && l.queue.size() >= maxLen && current_executor != this)
+    {
+        const auto t0 = clock::now();
+        cvRoom_.wait(lck, [&]() { return stop_ || l.queue.size() < maxLen; });
+        l.stats.blocked_submissions++;
+        l.stats.blocked_time += to_seconds(clock::now() - t0);
+    }
+    ASSERTMSG_(!stop_, "Executor is stopped");
+
+    l.queue.push_back({std::move(f), clock::now()});
+    l.stats.submitted++;
+    l.stats.peak_queued = std::max(l.stats.peak_queued, l.queue.size());
+
+    lck.unlock();
+    cvTasks_.notify_one();
+}
+
+void PriorityTaskExecutor::worker()
+{
+    current_executor = this;
+
+    auto lck = std::unique_lock<std::mutex>(mtx_);
+    for (;;)
+    {
+        // Highest priority non-empty lane:
+        auto it = lanes_.end();
+        cvTasks_.wait(lck, [&]() {
+            it = std::find_if(lanes_.begin(), lanes_.end(), [](const Lane& l) {
+                return !l.queue.empty();
+            });
+            return stop_ || it != lanes_.end();
+        });
+        if (stop_) break;
+
+        const size_t laneIdx = static_cast<size_t>(it - lanes_.begin());
+        Task         task    = std::move(it->queue.front());
+        it->queue.pop_front();
+        running_++;
+        cvRoom_.notify_all();
+
+        const auto tStart = clock::now();
+        lck.unlock();
+
+        // packaged_task stores exceptions into the future: this won't throw.
+        task.f();
+        task.f = nullptr;  // Release captured data out of the lock
+
+        const auto tEnd = clock::now();
+        lck.lock();
+        running_--;
+
+        if (stop_) break;
+
+        // Stats:
+        auto&        st = lanes_[laneIdx].stats;
+        const double tQ = to_seconds(tStart - task.submitted);
+        const double tR = to_seconds(tEnd - tStart);
+        st.executed++;
+        const auto n = static_cast<double>(st.executed);
+        st.queue_latency_mean += (tQ - st.queue_latency_mean) / n;
+        st.run_time_mean += (tR - st.run_time_mean) / n;
+        st.queue_latency_max = std::max(st.queue_latency_max, tQ);
+        st.run_time_max      = std::max(st.run_time_max, tR);
+    }
+}
+
+bool PriorityTaskExecutor::inWorkerThread() const
+{
+    return current_executor == this;
+}
+
+size_t PriorityTaskExecutor::pendingTasks(size_t lane) const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    ASSERT_LT_(lane, lanes_.size());
+    return lanes_[lane].queue.size();
+}
+
+size_t PriorityTaskExecutor::busyTasks() const
+{
+    auto   lck = mrpt::lockHelper(mtx_);
+    size_t n   = running_;
+    for (const auto& l : lanes_) n += l.queue.size();
+    return n;
+}
+
+PriorityTaskExecutorLaneStats PriorityTaskExecutor::laneStats(
+    size_t lane) const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    ASSERT_LT_(lane, lanes_.size());
+    auto st   = lanes_[lane].stats;
+    st.queued = lanes_[lane].queue.size();
+    return st;
+}
+
+void PriorityTaskExecutor::resetStats()
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    for (auto& l : lanes_) l.stats = PriorityTaskExecutorLaneStats();
+}
@@ -242,7 +242,7 @@ void WorldModel::initialize(const Yaml& c)
     // Create map container:
     // TODO(jlbc): Switch between container type per cfg
     data_.entities_ = std::make_unique<EntitiesContainerFastMap>();
-    data_.factors_  = std::unique_ptr<FactorsContainerFastMap>();
+    data_.factors_  = std::make_unique<FactorsContainerFastMap>();
 
     ASSERT_(data_.entities_);
     ASSERT_(data_.factors_);
@@ -280,6 +280,17 @@ std::vector<mola::fid_t> WorldModel::factor_all_ids() const
     return data_.factors_->all_ids();
 }
 
+uint64_t WorldModel::factor_version(const fid_t id) const
+{
+    const auto it = factor_versions_.find(id);
+    return it == factor_versions_.end() ? 0 : it->second;
+}
+
+void WorldModel::factor_mark_modified(const fid_t id)
+{
+    factor_versions_[id]++;
+}
+
 mola::id_t WorldModel::entity_emplace_back(Entity&& e)
 {
     const auto [id, eptr] = data_.entities_->emplace_back(std::move(e));
@@ -20,7 +20,73 @@ using namespace mola;
 // arguments: class_name, parent_class, class namespace
 IMPLEMENTS_VIRTUAL_MRPT_OBJECT(BackEndBase, ExecutableBase, mola)
 
-BackEndBase::BackEndBase() = default;
+namespace
+{
+PriorityTaskExecutor::Parameters default_executor_parameters()
+{
+    PriorityTaskExecutor::Parameters p;
+    p.num_threads = 2;
+    // Indexed by BackEndBase::TaskLane:
+    p.max_queue_lengths = {0, 100, 1000, 0};
+    p.name              = "slam_backend";
+    return p;
+}
+}  // namespace
+
+BackEndBase::BackEndBase() : slam_be_executor_(default_executor_parameters())
+{
+}
+
+const char* BackEndBase::taskLaneName(TaskLane lane)
+{
+    switch (lane)
+    {
+        case TaskLane::Localization:
+            return "localization";
+        case TaskLane::KeyFrames:
+            return "keyframes";
+        case TaskLane::Factors:
+            return "factors";
+        case TaskLane::Maintenance:
+            return "maintenance";
+    }
+    return "";
+}
+
+void BackEndBase::initialize_executor(const Yaml& cfg)
+{
+    MRPT_TRY_START
+
+    if (!cfg.has("executor")) return;
+    const auto c = cfg["executor"];
+
+    auto p        = slam_be_executor_.parameters();
+    p.num_threads = c.getOrDefault<size_t>("num_threads", p.num_threads);
+
+    if (c.has("max_queue_length"))
+    {
+        const auto ql = c["max_queue_length"];
+        for (size_t i = 0; i < NUM_TASK_LANES; i++)
+        {
+            const char* name = taskLaneName(static_cast<TaskLane>(i));
+            p.max_queue_lengths[i] =
+                ql.getOrDefault<size_t>(name, p.max_queue_lengths[i]);
+        }
+    }
+
+    slam_be_executor_.setParameters(p);
+
+    MRPT_TRY_END
+}
+
+std::vector<BackEndBase::AddFactor_Output> BackEndBase::doAddFactors(
+    std::vector<Factor>& fs)
+{
+    std::vector<AddFactor_Output> outs;
+    outs.reserve(fs.size());
+    for (auto& f : fs) outs.push_back(doAddFactor(f));
+    return outs;
+}
 
 void BackEndBase::initialize(const Yaml& cfg)
 {
@@ -38,6 +104,8 @@ void BackEndBase::initialize(const Yaml& cfg)
         "Attached to WorldModel module `%s`",
         worldmodel_->getModuleInstanceName().c_str());
 
+    initialize_executor(cfg);
+
     // children config:
     this->initialize_backend(cfg);
 
@@ -10,6 +10,7 @@
  * @date   Dec 11, 2018
  */
 
+#include <mola_kernel/FrameArena.h>
 #include <mola_kernel/interfaces/FilterBase.h>
 
 #include <iostream>
@@ -47,6 +48,9 @@ void FilterBase::onNewObservation(const CObservation::Ptr& o)
         {
             try
             {
+                // One FrameArena cycle per observation:
+                FrameArena::Scope frameScope;
+
                 // Process the observation:
                 CObservation::Ptr out = this->doFilter(in);
                 // Forward it:
@@ -0,0 +1,161 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LayeredMapServer.cpp
+ * @brief  MapServer saving/loading named map layers in the background
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/ChunkedFileStream.h>
+#include <mola_kernel/interfaces/LayeredMapServer.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/serialization/CArchive.h>
+
+#include <cstdio>
+
+using namespace mola;
+
+namespace
+{
+const char*    MAP_FILE_MAGIC   = "MOLA_LAYERED_MAP";
+const uint32_t MAP_FILE_VERSION = 1;
+}  // namespace
+
+LayeredMapServer::LayeredMapServer() = default;
+
+LayeredMapServer::~LayeredMapServer() = default;
+
+MapServer::ReturnStatus LayeredMapServer::map_load(const std::string& path)
+{
+    return map_load_async(path)->wait();
+}
+
+MapServer::ReturnStatus LayeredMapServer::map_save(const std::string& path)
+{
+    return map_save_async(path)->wait();
+}
+
+MapServer::Operation::Ptr LayeredMapServer::map_save_async(
+    const std::string& path, const AsyncCallbacks& callbacks)
+{
+    auto op = std::make_shared<Operation>(callbacks);
+
+    // The only step with the map locked, in the caller thread:
+    auto layers = std::make_shared<layers_t>(map_snapshot_layers());
+
+    const std::string file = map_file_name(path), tmpFile = file + ".tmp";
+    const size_t      chunkSize = map_chunk_size;
+
+    runMapOperation(op, [op, layers, file, tmpFile, chunkSize]() {
+        Progress     p;
+        size_t       layersDone = 0;
+        const size_t n          = layers->size();
+
+        try
+        {
+            ChunkedFileOutputStream f(
+                tmpFile,
+                [&](uint64_t bytes) {
+                    p.bytes = bytes;
+                    op->reportProgress(p);
+                },
+                chunkSize);
+
+            auto arch = mrpt::serialization::archiveFrom(f);
+            arch << std::string(MAP_FILE_MAGIC) << MAP_FILE_VERSION
+                 << static_cast<uint32_t>(n);
+
+            for (const auto& [name, layer] : *layers)
+            {
+                ASSERTMSG_(layer, "Empty map layer: '" + name + "'");
+                p.stage    = name;
+                p.fraction = static_cast<double>(layersDone) /
+                             static_cast<double>(n);
+                op->reportProgress(p);
+
+                arch << name;
+                arch.WriteObject(layer.get());
+                layersDone++;
+            }
+            f.close();
+        }
+        catch (...)
+        {
+            std::remove(tmpFile.c_str());
+            throw;
+        }
+
+        if (0 != std::rename(tmpFile.c_str(), file.c_str()))
+        {
+            std::remove(tmpFile.c_str());
+            THROW_EXCEPTION_FMT(
+                "Cannot rename '%s' to '%s'", tmpFile.c_str(), file.c_str());
+        }
+
+        ReturnStatus r;
+        r.success = true;
+        return r;
+    });
+    return op;
+}
+
+MapServer::Operation::Ptr LayeredMapServer::map_load_async(
+    const std::string& path, const AsyncCallbacks& callbacks)
+{
+    auto op = std::make_shared<Operation>(callbacks);
+
+    const std::string file      = map_file_name(path);
+    const size_t      chunkSize = map_chunk_size;
+
+    runMapOperation(op, [this, self = operationKeepAlive(), op, file,
+                         chunkSize]() {
+        Progress p;
+        layers_t layers;
+        {
+            uint64_t               fileSize = 0;
+            ChunkedFileInputStream f(
+                file,
+                [&](uint64_t bytes) {
+                    p.bytes    = bytes;
+                    p.fraction = fileSize ? static_cast<double>(bytes) /
+                                                static_cast<double>(fileSize)
+                                          : 1.0;
+                    op->reportProgress(p);
+                },
+                chunkSize);
+            fileSize = f.getTotalBytesCount();
+
+            auto        arch = mrpt::serialization::archiveFrom(f);
+            std::string magic;
+            uint32_t    version = 0, n = 0;
+            arch >> magic;
+            ASSERTMSG_(
+                magic == MAP_FILE_MAGIC,
+                "Not a MOLA layered map file: '" + file + "'");
+            arch >> version;
+            ASSERT_EQUAL_(version, MAP_FILE_VERSION);
+            arch >> n;
+
+            for (uint32_t i = 0; i < n; i++)
+            {
+                std::string name;
+                arch >> name;
+                p.stage      = name;
+                layers[name] = arch.ReadObject();
+            }
+        }
+
+        // All layers were read: replace the map now.
+        op->throwIfCancelled();
+        map_set_layers(std::move(layers));
+
+        ReturnStatus r;
+        r.success = true;
+        return r;
+    });
+    return op;
+}
@@ -10,10 +10,165 @@
  * @date   Aug 18, 2024
  */
 
+#include <mola_kernel/interfaces/ExecutableBase.h>
 #include <mola_kernel/interfaces/MapServer.h>
+#include <mrpt/core/lock_helper.h>
+
+#include <algorithm>
+#include <thread>
 
 namespace mola
 {
-MapServer::MapServer()  = default;
-MapServer::~MapServer() = default;
+namespace
+{
+PriorityTaskExecutor::Parameters map_server_worker_params()
+{
+    PriorityTaskExecutor::Parameters p;
+    p.num_threads = 1;
+    p.name        = "map_server";
+    return p;
+}
+}  // namespace
+
+MapServer::MapServer()
+    : mapServerWorker_(
+          std::make_shared<PriorityTaskExecutor>(map_server_worker_params()))
+{
+}
+
+MapServer::~MapServer()
+{
+    if (mapServerWorker_->inWorkerThread())
+    {
+        // The last reference to the module was held by an operation, which
+        // just finished in the worker thread. A thread cannot join itself, so
+        // another one destroys the worker once it returns from that task:
+        std::thread([w = std::move(mapServerWorker_)]() mutable { w.reset(); })
+            .detach();
+        return;
+    }
+
+    // Last resort, for operations which did not keep the object alive:
+    // derived classes are already destroyed here, but this at least finishes
+    // pending operations as cancelled, instead of leaving their futures
+    // broken.
+    cancelMapOperations();
+}
+
+MapServer::Operation::Operation(AsyncCallbacks callbacks)
+    : callbacks_(std::move(callbacks)), future_(promise_.get_future().share())
+{
+}
+
+MapServer::Progress MapServer::Operation::progress() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return progress_;
+}
+
+void MapServer::Operation::reportProgress(const Progress& p)
+{
+    {
+        auto lck  = mrpt::lockHelper(mtx_);
+        progress_ = p;
+    }
+    if (callbacks_.on_progress) callbacks_.on_progress(p);
+
+    throwIfCancelled();
+}
+
+void MapServer::Operation::throwIfCancelled() const
+{
+    if (cancelRequested_) throw OperationCancelled();
+}
+
+void MapServer::Operation::finish(const ReturnStatus& r)
+{
+    {
+        auto lck = mrpt::lockHelper(mtx_);
+        if (finished_) return;
+        finished_ = true;
+        if (r.success) progress_.fraction = 1.0;
+    }
+    // Callback first, so it has run once wait() returns:
+    if (callbacks_.on_done) callbacks_.on_done(r);
+    promise_.set_value(r);
+}
+
+void MapServer::runMapOperation(
+    const Operation::Ptr& op, std::function<ReturnStatus()> f)
+{
+    {
+        auto lck = mrpt::lockHelper(opsMtx_);
+        ops_.erase(
+            std::remove_if(
+                ops_.begin(), ops_.end(),
+                [](const auto& o) { return o.expired(); }),
+            ops_.end());
+        ops_.push_back(op);
+    }
+
+    mapServerWorker_->enqueue(0, [op, f = std::move(f)]() {
+        ReturnStatus r;
+        try
+        {
+            op->throwIfCancelled();
+            r = f();
+        }
+        catch (const OperationCancelled& e)
+        {
+            r.error_message = e.what();
+        }
+        catch (const std::exception& e)
+        {
+            r.error_message = e.what();
+        }
+        op->finish(r);
+    });
+}
+
+MapServer::Operation::Ptr MapServer::map_load_async(
+    const std::string& path, const AsyncCallbacks& callbacks)
+{
+    auto op = std::make_shared<Operation>(callbacks);
+    runMapOperation(op, [this, self = operationKeepAlive(), path]() {
+        return map_load(path);
+    });
+    return op;
+}
+
+MapServer::Operation::Ptr MapServer::map_save_async(
+    const std::string& path, const AsyncCallbacks& callbacks)
+{
+    auto op = std::make_shared<Operation>(callbacks);
+    runMapOperation(op, [this, self = operationKeepAlive(), path]() {
+        return map_save(path);
+    });
+    return op;
+}
+
+void MapServer::cancelMapOperations()
+{
+    std::vector<Operation::Ptr> ops;
+    {
+        auto lck = mrpt::lockHelper(opsMtx_);
+        for (const auto& o : ops_)
+            if (auto op = o.lock(); op) ops.push_back(op);
+        ops_.clear();
+    }
+    for (const auto& op : ops) op->cancel();
+
+    // From the worker thread, pending operations could never finish:
+    if (mapServerWorker_->inWorkerThread()) return;
+
+    for (const auto& op : ops) op->future().wait();
+}
+
+std::shared_ptr<void> MapServer::operationKeepAlive()
+{
+    auto* module = dynamic_cast<ExecutableBase*>(this);
+    if (!module) return {};
+    return module->weak_from_this().lock();
+}
+
 }  // namespace mola
@@ -10,6 +10,7 @@
  * @date   Nov 21, 2018
  */
 
+#include <mola_kernel/FrameArena.h>
 #include <mola_kernel/interfaces/RawDataSourceBase.h>
 #include <mola_kernel/interfaces/VizInterface.h>
 #include <mola_yaml/yaml_helpers.h>
@@ -118,7 +119,9 @@ void RawDataSourceBase::sendObservationsToFrontEnds(
         // prepare observation before processing it:
         prepareObservationBeforeFrontEnds(obs);
 
-        // Forward data:
+        // Forward data. Consumers may use frame_memory_resource() for
+        // transient data:
+        FrameArena::Scope frameScope;
         for (auto& subscriber : rdc_) subscriber->onNewObservation(obs);
     }
     else
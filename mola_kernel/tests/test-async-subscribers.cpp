@@ -0,0 +1,205 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-async-subscribers.cpp
+ * @brief  Unit tests for AsyncSubscribers
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/AsyncSubscribers.h>
+#include <mrpt/core/exceptions.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using namespace std::chrono_literals;
+
+template <typename PRED>
+void wait_until(PRED pred, const char* what)
+{
+    const auto tEnd = std::chrono::steady_clock::now() + 5s;
+    while (!pred())
+    {
+        ASSERTMSG_(std::chrono::steady_clock::now() < tEnd, what);
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+// A subscriber whose first callback blocks until release() is called, so
+// the following updates pile up in its queue.
+struct BlockedReceiver
+{
+    std::promise<void>       started, gate;
+    std::shared_future<void> gateFuture = gate.get_future().share();
+    std::atomic_bool         first{true};
+    std::mutex               mtx;
+    std::vector<int>         received;
+
+    void operator()(int v)
+    {
+        if (first.exchange(false))
+        {
+            started.set_value();
+            gateFuture.wait();
+        }
+        std::lock_guard<std::mutex> lck(mtx);
+        received.push_back(v);
+    }
+    void release() { gate.set_value(); }
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return received.size();
+    }
+};
+
+void test_latest_only()
+{
+    for (bool dedicated : {true, false})
+    {
+        mola::AsyncSubscribers<int> subs("test");
+        BlockedReceiver             r;
+
+        const auto id = subs.subscribe(
+            [&](const int& v) { r(v); },
+            mola::SubscriberOptions::LatestOnly(dedicated));
+
+        subs.publish(0);
+        r.started.get_future().wait();
+        for (int i = 1; i < 10; i++) subs.publish(i);
+
+        // Each new update replaced the previous, undelivered one:
+        auto st = subs.stats(id);
+        ASSERT_(st.has_value());
+        ASSERT_EQUAL_(st->queued, 1U);
+        ASSERT_EQUAL_(st->dropped, 8U);
+
+        r.release();
+        wait_until([&]() { return r.count() == 2; }, "LatestOnly delivery");
+        ASSERT_(r.received == std::vector<int>({0, 9}));
+        wait_until(
+            [&]() { return subs.stats(id)->delivered == 2; },
+            "LatestOnly stats");
+    }
+}
+
+void test_bounded_fifo_overflow()
+{
+    for (bool dedicated : {true, false})
+    {
+        mola::AsyncSubscribers<int> subs("test");
+        BlockedReceiver             r;
+
+        const auto id = subs.subscribe(
+            [&](const int& v) { r(v); },
+            mola::SubscriberOptions::BoundedFIFO(3, dedicated));
+
+        subs.publish(0);
+        r.started.get_future().wait();
+        for (int i = 1; i < 10; i++) subs.publish(i);
+
+        // The oldest queued updates were dropped to make room:
+        auto st = subs.stats(id);
+        ASSERT_(st.has_value());
+        ASSERT_EQUAL_(st->queued, 3U);
+        ASSERT_EQUAL_(st->dropped, 6U);
+
+        r.release();
+        wait_until([&]() { return r.count() == 4; }, "BoundedFIFO delivery");
+        ASSERT_(r.received == std::vector<int>({0, 7, 8, 9}));
+        st = subs.stats(id);
+        ASSERT_EQUAL_(st->dropped, 6U);
+    }
+}
+
+void test_unsubscribe_from_callback()
+{
+    for (bool dedicated : {true, false})
+    {
+        mola::AsyncSubscribers<int> subs("test");
+        std::atomic_int             calls{0};
+        std::atomic_bool            unsubscribed{false};
+        mola::subscription_id_t     id = 0;
+
+        id = subs.subscribe(
+            [&](const int&) {
+                calls++;
+                unsubscribed = subs.unsubscribe(id);
+            },
+            mola::SubscriberOptions::BoundedFIFO(100, dedicated));
+
+        for (int i = 0; i < 10; i++) subs.publish(i);
+
+        wait_until([&]() { return unsubscribed.load(); }, "self-unsubscribe");
+        for (int i = 0; i < 10; i++) subs.publish(i);
+        std::this_thread::sleep_for(20ms);
+
+        ASSERT_EQUAL_(calls.load(), 1);
+        ASSERT_(subs.empty());
+        ASSERT_(!subs.unsubscribe(id));
+    }
+}
+
+void test_no_callback_after_unsubscribe()
+{
+    for (bool dedicated : {true, false})
+    {
+        mola::AsyncSubscribers<int> subs("test");
+        std::atomic_bool            unsubscribed{false}, stopPublisher{false};
+        std::atomic_int             calls{0}, lateCalls{0};
+
+        const auto id = subs.subscribe(
+            [&](const int&) {
+                if (unsubscribed) lateCalls++;
+                calls++;
+                std::this_thread::sleep_for(100us);
+                if (unsubscribed) lateCalls++;
+            },
+            mola::SubscriberOptions::BoundedFIFO(100, dedicated));
+
+        std::thread publisher([&]() {
+            for (int i = 0; !stopPublisher; i++) subs.publish(i);
+        });
+
+        wait_until([&]() { return calls > 10; }, "deliveries");
+        ASSERT_(subs.unsubscribe(id));
+        unsubscribed = true;
+
+        std::this_thread::sleep_for(20ms);
+        stopPublisher = true;
+        publisher.join();
+
+        ASSERT_EQUAL_(lateCalls.load(), 0);
+    }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_latest_only();
+        test_bounded_fifo_overflow();
+        test_unsubscribe_from_callback();
+        test_no_callback_after_unsubscribe();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
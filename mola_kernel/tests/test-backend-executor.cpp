@@ -0,0 +1,331 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-backend-executor.cpp
+ * @brief  Unit tests of the BackEndBase priority task executor
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/interfaces/BackEndBase.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/lock_helper.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace mola
+{
+// A back-end which just logs the order of its calls. Keyframes wait for
+// "gate", so tests can keep the executor busy.
+class MockBackEnd : public BackEndBase
+{
+    DEFINE_MRPT_OBJECT(MockBackEnd, mola)
+
+   public:
+    MockBackEnd() = default;
+    ~MockBackEnd() override { stopTasks(); }
+
+    std::shared_future<void> gate;
+    std::atomic<size_t>      factorsAdded{0};
+
+    void configure(const std::string& yamlText)
+    {
+        initialize_executor(Yaml::FromText(yamlText));
+    }
+
+    std::string log()
+    {
+        auto lck = mrpt::lockHelper(logMtx_);
+        return log_;
+    }
+
+    void initialize_backend(const Yaml&) override {}
+    void spinOnce() override {}
+
+    ProposeKF_Output doAddKeyFrame(const ProposeKF_Input&) override
+    {
+        if (gate.valid()) gate.wait();
+        append('K');
+        ProposeKF_Output o;
+        o.success = true;
+        return o;
+    }
+    AddFactor_Output doAddFactor(Factor&) override
+    {
+        append('F');
+        AddFactor_Output o;
+        o.success       = true;
+        o.new_factor_id = factorsAdded++;
+        return o;
+    }
+    void doAdvertiseUpdatedLocalization(
+        const AdvertiseUpdatedLocalization_Input&) override
+    {
+        append('L');
+    }
+
+   private:
+    std::mutex  logMtx_;
+    std::string log_;
+
+    void append(char c)
+    {
+        auto lck = mrpt::lockHelper(logMtx_);
+        log_.push_back(c);
+    }
+};
+
+}  // namespace mola
+
+IMPLEMENTS_MRPT_OBJECT(MockBackEnd, BackEndBase, mola)
+
+namespace
+{
+using mola::BackEndBase;
+using Lane = mola::BackEndBase::TaskLane;
+
+// Adds a keyframe which keeps the (single) worker thread busy until the
+// returned promise is set:
+std::promise<void> block_executor(mola::MockBackEnd& be)
+{
+    std::promise<void> p;
+    be.gate = p.get_future().share();
+    be.addKeyFrame({});
+    while (be.pendingTasks(Lane::KeyFrames) != 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return p;
+}
+
+void test_priorities()
+{
+    mola::MockBackEnd be;
+    be.configure("executor:\n  num_threads: 1\n");
+
+    auto gate = block_executor(be);
+
+    std::vector<std::future<BackEndBase::AddFactor_Output>> factors;
+
+    auto fm = be.enqueueMaintenanceTask([]() {});
+    for (int i = 0; i < 20; i++)
+    {
+        mola::Factor f;
+        factors.push_back(be.addFactor(f));
+    }
+    auto fk = be.addKeyFrame({});
+    auto fl = be.advertiseUpdatedLocalization({});
+
+    gate.set_value();
+
+    fm.get();
+    fk.get();
+    fl.get();
+    for (auto& f : factors) ASSERT_(f.get().success);
+
+    // Maintenance tasks don't log, and run last:
+    ASSERT_EQUAL_(be.log(), "KLK" + std::string(20, 'F'));
+    ASSERT_EQUAL_(be.taskLaneStats(Lane::Maintenance).executed, 1U);
+}
+
+void test_batch()
+{
+    mola::MockBackEnd be;
+
+    std::vector<mola::Factor> fs(500);
+    const auto                outs = be.addFactors(fs).get();
+
+    ASSERT_EQUAL_(outs.size(), 500U);
+    for (size_t i = 0; i < outs.size(); i++)
+    {
+        ASSERT_(outs[i].success);
+        ASSERT_EQUAL_(outs[i].new_factor_id.value(), i);
+    }
+
+    const auto st = be.taskLaneStats(Lane::Factors);
+    ASSERT_EQUAL_(st.submitted, 1U);
+    ASSERT_EQUAL_(st.executed, 1U);
+}
+
+void test_backpressure()
+{
+    mola::MockBackEnd be;
+    be.configure(
+        "executor:\n"
+        "  num_threads: 1\n"
+        "  max_queue_length:\n"
+        "    factors: 4\n");
+
+    auto gate = block_executor(be);
+
+    std::atomic_bool done{false};
+    std::thread      producer([&]() {
+        for (int i = 0; i < 20; i++)
+        {
+            mola::Factor f;
+            be.addFactor(f);
+        }
+        done = true;
+    });
+
+    // The producer must be blocked by the full queue:
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_(!done);
+    ASSERT_EQUAL_(be.pendingTasks(Lane::Factors), 4U);
+
+    // ...but other lanes are not:
+    auto fl = be.advertiseUpdatedLocalization({});
+
+    gate.set_value();
+    producer.join();
+    fl.get();
+
+    while (be.factorsAdded < 20)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const auto st = be.taskLaneStats(Lane::Factors);
+    ASSERT_EQUAL_(st.executed, 20U);
+    ASSERT_EQUAL_(st.peak_queued, 4U);
+    ASSERT_GT_(st.blocked_submissions, 0U);
+    ASSERT_GT_(st.blocked_time, 0.0);
+    ASSERT_EQUAL_(be.log().at(1), 'L');
+}
+
+// Tasks not started yet when the executor is destroyed are discarded:
+void test_pending_discarded()
+{
+    std::promise<void> gate;
+    std::future<void>  fBlocker, fDiscarded;
+    std::thread        releaser;
+    {
+        mola::PriorityTaskExecutor::Parameters p;
+        p.num_threads = 1;
+        mola::PriorityTaskExecutor exec(p);
+
+        std::atomic_bool started{false};
+        fBlocker = exec.enqueue(0, [&started, g = gate.get_future()]() {
+            started = true;
+            g.wait();
+        });
+        while (!started)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        fDiscarded = exec.enqueue(0, []() {});
+
+        // Release the running task once the destructor is waiting for it:
+        releaser = std::thread([&gate]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            gate.set_value();
+        });
+    }
+    releaser.join();
+
+    fBlocker.get();
+
+    bool thrown = false;
+    try
+    {
+        fDiscarded.get();
+    }
+    catch (const std::future_error&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+}
+
+// A back-end destroyed with tasks in its executor: the running one ends
+// before the derived class members it uses are destroyed, and pending ones
+// are discarded.
+void test_destroy_with_tasks()
+{
+    auto be = std::make_unique<mola::MockBackEnd>();
+    be->configure("executor:\n  num_threads: 1\n");
+
+    auto         gate = block_executor(*be);
+    mola::Factor f;
+    auto         fPending = be->addFactor(f);
+
+    // Release the running task once the destructor is waiting for it:
+    std::thread releaser([&gate]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate.set_value();
+    });
+    be.reset();
+    releaser.join();
+
+    bool thrown = false;
+    try
+    {
+        fPending.get();
+    }
+    catch (const std::future_error&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+}
+
+// Localization latency while the back-end is flooded with other tasks:
+void benchmark_latency()
+{
+    mola::MockBackEnd be;
+    be.configure("executor:\n  num_threads: 1\n");
+
+    std::vector<std::future<void>> locs;
+    for (int i = 0; i < 2000; i++)
+    {
+        be.enqueueMaintenanceTask([]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        });
+        if (i % 100 == 0) locs.push_back(be.advertiseUpdatedLocalization({}));
+    }
+    for (auto& f : locs) f.get();
+
+    for (size_t i = 0; i < BackEndBase::NUM_TASK_LANES; i++)
+    {
+        const auto lane = static_cast<Lane>(i);
+        const auto st   = be.taskLaneStats(lane);
+        if (!st.executed) continue;
+        std::cout << mrpt::format(
+            "[%-12s] executed=%5u queue latency: mean=%8.03f ms max=%8.03f "
+            "ms\n",
+            BackEndBase::taskLaneName(lane),
+            static_cast<unsigned>(st.executed), 1e3 * st.queue_latency_mean,
+            1e3 * st.queue_latency_max);
+    }
+    ASSERT_LT_(
+        be.taskLaneStats(Lane::Localization).queue_latency_mean,
+        be.taskLaneStats(Lane::Maintenance).queue_latency_mean);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_priorities();
+        test_batch();
+        test_backpressure();
+        test_pending_discarded();
+        test_destroy_with_tasks();
+        benchmark_latency();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
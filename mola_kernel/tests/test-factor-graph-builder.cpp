@@ -0,0 +1,253 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-factor-graph-builder.cpp
+ * @brief  Unit tests and benchmark of FactorGraphBuilder
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/FactorGraphBuilder.h>
+#include <mola_kernel/variant_helper.h>
+#include <mrpt/core/format.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+// A converted factor, for a hypothetical optimizer:
+struct Edge
+{
+    mola::fid_t                 fid  = mola::INVALID_FID;
+    mola::id_t                  from = mola::INVALID_ID, to = mola::INVALID_ID;
+    mrpt::poses::CPose3D        pose;
+    mrpt::math::CMatrixDouble66 information;
+
+    bool operator==(const Edge& o) const
+    {
+        return fid == o.fid && from == o.from && to == o.to &&
+               pose == o.pose && information == o.information;
+    }
+};
+
+std::atomic<size_t> numConversions{0};
+
+Edge convert(const mola::Factor& f)
+{
+    numConversions++;
+    return std::visit(
+        mola::overloaded{
+            [](const mola::FactorRelativePose3& r) {
+                Edge e;
+                e.fid  = r.my_id_;
+                e.from = r.from_kf_;
+                e.to   = r.to_kf_;
+                e.pose = mrpt::poses::CPose3D(r.rel_pose_);
+                ASSERT_(r.noise_model_.has_value());
+                e.information = r.noise_model_->inverse_LLt();
+                return e;
+            },
+            [](const auto&) -> Edge { THROW_EXCEPTION("Unexpected factor"); }},
+        f);
+}
+
+using Builder = mola::FactorGraphBuilder<Edge>;
+using Graph   = std::vector<Edge>;
+
+// A synthetic pose graph: a chain of relative poses, plus loop closures
+void add_factors(mola::WorldModel& wm, size_t numPoses, size_t firstPose = 0)
+{
+    mrpt::math::CMatrixDouble66 cov;
+    cov.setDiagonal(1e-2);
+
+    wm.factors_lock_for_write();
+    for (size_t i = firstPose; i < firstPose + numPoses; i++)
+    {
+        mola::FactorRelativePose3 f(i, i + 1, {1.0, 0, 0, 0.01 * i, 0, 0});
+        f.noise_model_ = cov;
+        wm.factor_emplace_back(std::move(f));
+
+        if (i % 10 == 0 && i >= 50)
+        {
+            mola::FactorRelativePose3 lc(i - 50, i, {0.5, 1.0, 0, 0, 0, 0});
+            lc.noise_model_ = cov;
+            wm.factor_emplace_back(std::move(lc));
+        }
+    }
+    wm.factors_unlock_for_write();
+}
+
+void init_world_model(mola::WorldModel& wm)
+{
+    wm.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+    wm.initialize(mola::Yaml::FromText("params: {}"));
+}
+
+// The reference: a single-threaded conversion, with no cache
+Graph sequential_graph(
+    mola::WorldModel& wm, const std::vector<mola::fid_t>& ids)
+{
+    Graph g;
+    for (const auto id : ids) g.push_back(convert(wm.factor_by_id(id)));
+    return g;
+}
+
+Builder::Parameters params(size_t numThreads)
+{
+    Builder::Parameters p;
+    p.num_threads            = numThreads;
+    p.min_factors_per_thread = 64;
+    return p;
+}
+
+void test_build_and_cache()
+{
+    mola::WorldModel wm;
+    init_world_model(wm);
+    add_factors(wm, 2000);
+
+    Builder b(&convert, params(4));
+    Graph   g;
+    b.build(wm, [&](const Edge& e) { g.push_back(e); });
+
+    const auto ids = wm.factor_all_ids();
+    ASSERT_(g == sequential_graph(wm, ids));
+    ASSERT_EQUAL_(b.lastStats().converted, ids.size());
+    ASSERT_EQUAL_(b.lastStats().fragments, 4U);
+    ASSERT_EQUAL_(b.cacheSize(), ids.size());
+
+    // Nothing to convert again:
+    const size_t n0 = numConversions;
+    Graph        g2;
+    b.build(wm, [&](const Edge& e) { g2.push_back(e); });
+    ASSERT_EQUAL_(numConversions, n0);
+    ASSERT_EQUAL_(b.lastStats().cached, ids.size());
+    ASSERT_(g2 == g);
+
+    // New and modified factors:
+    add_factors(wm, 100, 2000);
+    const mola::fid_t modified = ids.at(10);
+    wm.factors_lock_for_write();
+    std::get<mola::FactorRelativePose3>(wm.factor_by_id(modified))
+        .rel_pose_.x = 5.0;
+    wm.factor_mark_modified(modified);
+    wm.factors_unlock_for_write();
+
+    const auto ids2 = wm.factor_all_ids();
+    Graph      g3;
+    b.build(wm, [&](const Edge& e) { g3.push_back(e); });
+    ASSERT_EQUAL_(b.lastStats().converted, ids2.size() - ids.size() + 1);
+    ASSERT_(g3 == sequential_graph(wm, ids2));
+    ASSERT_EQUAL_(g3.at(10).pose.x(), 5.0);
+}
+
+void test_subset_and_threads()
+{
+    mola::WorldModel wm;
+    init_world_model(wm);
+    add_factors(wm, 3000);
+
+    // A window of the last factors, in a custom order:
+    auto ids = wm.factor_all_ids();
+    ids.erase(ids.begin(), ids.begin() + 1000);
+    std::reverse(ids.begin(), ids.end());
+
+    const Graph expected = sequential_graph(wm, ids);
+    for (size_t nThreads : {1, 2, 3, 8})
+    {
+        Builder b(&convert, params(nThreads));
+        Graph   g;
+        b.build(wm, ids, [&](const Edge& e) { g.push_back(e); });
+        ASSERT_(g == expected);
+        ASSERT_EQUAL_(b.cacheSize(), ids.size());
+    }
+}
+
+void test_errors()
+{
+    mola::WorldModel wm;
+    init_world_model(wm);
+    add_factors(wm, 1000);
+
+    // A factor the converter does not know about:
+    wm.factors_lock_for_write();
+    wm.factor_emplace_back(mola::FactorConstVelKinematics(1, 2, 0.1));
+    wm.factors_unlock_for_write();
+
+    Builder b(&convert, params(4));
+    bool    thrown = false;
+    try
+    {
+        b.build(wm, [](const Edge&) {});
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+
+    // The world model must be unlocked:
+    wm.factors_lock_for_write();
+    wm.factors_unlock_for_write();
+}
+
+void benchmark_pose_graph()
+{
+    mola::WorldModel wm;
+    init_world_model(wm);
+    add_factors(wm, 50000);
+
+    using clock = std::chrono::steady_clock;
+
+    for (size_t nThreads : {1, 2, 4, 8})
+    {
+        Builder b(&convert, params(nThreads));
+        Graph   g;
+
+        const auto t0 = clock::now();
+        b.build(wm, [&](const Edge& e) { g.push_back(e); });
+        const double tFull =
+            std::chrono::duration<double>(clock::now() - t0).count();
+        const double tLock = b.lastStats().lock_time;
+
+        // A re-optimization with a few new factors:
+        add_factors(wm, 100, 50000 + nThreads * 100);
+        g.clear();
+        b.build(wm, [&](const Edge& e) { g.push_back(e); });
+
+        std::cout << mrpt::format(
+            "[FactorGraphBuilder] threads=%u factors=%6u full build: "
+            "%7.02f ms (locked %7.02f ms) | incremental: converted=%u "
+            "locked %6.02f ms\n",
+            static_cast<unsigned>(nThreads), static_cast<unsigned>(g.size()),
+            1e3 * tFull, 1e3 * tLock,
+            static_cast<unsigned>(b.lastStats().converted),
+            1e3 * b.lastStats().lock_time);
+    }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_build_and_cache();
+        test_subset_and_threads();
+        test_errors();
+        benchmark_pose_graph();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
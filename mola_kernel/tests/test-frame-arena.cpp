@@ -0,0 +1,181 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-frame-arena.cpp
+ * @brief  Unit tests and allocation benchmark of FrameArena
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/FrameArena.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+namespace
+{
+// The heap, counting allocations:
+class CountingResource : public std::pmr::memory_resource
+{
+   public:
+    uint64_t allocations = 0;
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const memory_resource& o) const noexcept override
+    {
+        return this == &o;
+    }
+};
+
+void test_scopes()
+{
+    mola::FrameArena arena(4096);
+
+    ASSERT_EQUAL_(
+        mola::frame_memory_resource(), std::pmr::get_default_resource());
+    {
+        mola::FrameArena::Scope scope(arena);
+        ASSERT_EQUAL_(mola::frame_memory_resource(), &arena);
+        ASSERT_(arena.inCycle());
+
+        mola::frame_vector<int> v(mola::frame_memory_resource());
+        v.resize(100);
+        ASSERT_GE_(arena.stats().bytes_in_use, 100 * sizeof(int));
+
+        {
+            // Nested cycle: no reset at its end
+            mola::FrameArena::Scope inner(arena);
+            mola::frame_vector<int> v2(100, mola::frame_memory_resource());
+        }
+        ASSERT_EQUAL_(arena.stats().frames, 0U);
+        ASSERT_GT_(arena.stats().bytes_in_use, 0U);
+        v.clear();
+    }
+    ASSERT_(!arena.inCycle());
+    ASSERT_EQUAL_(arena.stats().frames, 1U);
+    ASSERT_EQUAL_(arena.stats().bytes_in_use, 0U);
+    ASSERT_EQUAL_(
+        mola::frame_memory_resource(), std::pmr::get_default_resource());
+}
+
+void test_growth()
+{
+    mola::FrameArena arena(4096);
+
+    const auto oneFrame = [&]()
+    {
+        mola::FrameArena::Scope   scope(arena);
+        mola::frame_vector<float> v(mola::frame_memory_resource());
+        for (int i = 0; i < 10000; i++) v.push_back(i);
+    };
+
+    // The first frame does not fit into the buffer:
+    oneFrame();
+    const auto up1 = arena.stats().upstream_allocations;
+    ASSERT_GT_(up1, 0U);
+    ASSERT_GE_(arena.stats().buffer_size, arena.stats().peak_bytes);
+
+    // ...but the next ones do:
+    for (int i = 0; i < 5; i++) oneFrame();
+    ASSERT_EQUAL_(arena.stats().upstream_allocations, up1);
+    ASSERT_EQUAL_(arena.stats().frames, 6U);
+
+    // The buffer does not grow beyond maxRetainedBytes:
+    mola::FrameArena small(1024, 8192);
+    {
+        mola::FrameArena::Scope scope(small);
+        mola::frame_vector<char> v(100000, 0, mola::frame_memory_resource());
+    }
+    ASSERT_EQUAL_(small.stats().buffer_size, 8192U);
+}
+
+// Typical per-scan workload (e.g. the ring histogram of ParisLucoDataset):
+// one map node per point.
+template <class Map>
+size_t scan_workload(Map& m, const std::vector<float>& pitch)
+{
+    for (size_t i = 0; i < pitch.size(); i++)
+        m[static_cast<int>(pitch[i] * 32)][pitch[i]] = i;
+    return m.size();
+}
+
+void benchmark()
+{
+    constexpr size_t NUM_FRAMES = 50, NUM_POINTS = 60000;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> unif(0.0f, 1.0f);
+    std::vector<float>                    pitch(NUM_POINTS);
+    for (auto& p : pitch) p = unif(rng);
+
+    using histogram_t = mola::frame_map<int, mola::frame_map<float, size_t>>;
+
+    mrpt::system::CTicTac tictac;
+    std::printf("%-18s %14s %14s\n", "[benchmark]", "allocs/frame", "frames/s");
+
+    // Heap (counted):
+    CountingResource heap;
+    tictac.Tic();
+    for (size_t f = 0; f < NUM_FRAMES; f++)
+    {
+        histogram_t h(&heap);
+        scan_workload(h, pitch);
+    }
+    double t = tictac.Tac();
+    std::printf(
+        "%-18s %14.1f %14.1f\n", "heap", double(heap.allocations) / NUM_FRAMES,
+        NUM_FRAMES / t);
+
+    // Frame arena:
+    mola::FrameArena arena;
+    tictac.Tic();
+    for (size_t f = 0; f < NUM_FRAMES; f++)
+    {
+        mola::FrameArena::Scope scope(arena);
+        histogram_t             h(mola::frame_memory_resource());
+        scan_workload(h, pitch);
+    }
+    t = tictac.Tac();
+
+    const auto& st = arena.stats();
+    std::printf(
+        "%-18s %14.1f %14.1f (buffer: %zu KiB, peak: %zu KiB)\n",
+        "frame arena", double(st.upstream_allocations) / NUM_FRAMES,
+        NUM_FRAMES / t, st.buffer_size / 1024, st.peak_bytes / 1024);
+
+    // After the first frame, no heap allocation at all:
+    ASSERT_LE_(st.upstream_allocations, 32U);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_scopes();
+        test_growth();
+        benchmark();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
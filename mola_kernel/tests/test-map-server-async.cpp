@@ -0,0 +1,365 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-map-server-async.cpp
+ * @brief  Unit tests of asynchronous map saving/loading in MapServer
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/interfaces/ExecutableBase.h>
+#include <mola_kernel/interfaces/LayeredMapServer.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/system/filesystem.h>
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mola
+{
+// A MOLA module with the default map server implementation. As modules
+// created by the launcher, it is owned by a shared_ptr, so it does not need
+// to cancel its operations on destruction.
+class MapServerModule : public ExecutableBase, public MapServer
+{
+    DEFINE_MRPT_OBJECT(MapServerModule, mola)
+
+   public:
+    MapServerModule() = default;
+
+    std::shared_future<void> gate;
+
+    void initialize(const Yaml&) override {}
+    void spinOnce() override {}
+
+    ReturnStatus map_save(const std::string&) override
+    {
+        gate.wait();
+        ReturnStatus r;
+        r.success = true;
+        return r;
+    }
+};
+
+}  // namespace mola
+
+IMPLEMENTS_MRPT_OBJECT(MapServerModule, ExecutableBase, mola)
+
+namespace
+{
+const std::string tmpDir  = mrpt::system::getTempFileName() + "-map-server";
+const std::string mapPath = tmpDir + "/map";
+
+// A map server with point cloud layers
+class DummyMapServer : public mola::LayeredMapServer
+{
+   public:
+    DummyMapServer() { map_chunk_size = 64 * 1024; }
+    ~DummyMapServer() override { cancelMapOperations(); }
+
+    void addLayer(const std::string& name, size_t nPoints)
+    {
+        auto m = mrpt::maps::CSimplePointsMap::Create();
+        for (size_t i = 0; i < nPoints; i++)
+            m->insertPoint(i * 0.1f, 1.0f, -1.0f);
+
+        auto lck      = mrpt::lockHelper(mapMtx_);
+        layers_[name] = m;
+    }
+
+    size_t layerSize(const std::string& name)
+    {
+        auto lck = mrpt::lockHelper(mapMtx_);
+        if (!layers_.count(name)) return 0;
+        return std::dynamic_pointer_cast<mrpt::maps::CSimplePointsMap>(
+                   layers_.at(name))
+            ->size();
+    }
+
+    size_t numLayers()
+    {
+        auto lck = mrpt::lockHelper(mapMtx_);
+        return layers_.size();
+    }
+
+    std::thread::id snapshotThread;
+
+   protected:
+    layers_t map_snapshot_layers() override
+    {
+        snapshotThread = std::this_thread::get_id();
+
+        auto     lck = mrpt::lockHelper(mapMtx_);
+        layers_t snapshot;
+        for (const auto& [name, layer] : layers_)
+            snapshot[name] =
+                std::dynamic_pointer_cast<mrpt::serialization::CSerializable>(
+                    layer->duplicateGetSmartPtr());
+        return snapshot;
+    }
+
+    void map_set_layers(layers_t&& layers) override
+    {
+        auto lck = mrpt::lockHelper(mapMtx_);
+        layers_  = std::move(layers);
+    }
+
+   private:
+    std::mutex mapMtx_;
+    layers_t   layers_;
+};
+
+// A map server with the default, synchronous-only, implementation
+class SyncMapServer : public mola::MapServer
+{
+   public:
+    ~SyncMapServer() override { cancelMapOperations(); }
+
+    std::string savedPath;
+
+    ReturnStatus map_save(const std::string& path) override
+    {
+        savedPath = path;
+        ReturnStatus r;
+        r.success = true;
+        return r;
+    }
+};
+
+void test_save_load()
+{
+    DummyMapServer srv;
+    srv.addLayer("lidar", 100000);
+    srv.addLayer("other", 50000);
+
+    std::vector<mola::MapServer::Progress> progress;
+    bool                                   doneCalled = false;
+
+    mola::MapServer::AsyncCallbacks cbs;
+    cbs.on_progress = [&](const auto& p) { progress.push_back(p); };
+    cbs.on_done     = [&](const auto& r) { doneCalled = r.success; };
+
+    auto op = srv.map_save_async(mapPath, cbs);
+    ASSERT_(srv.snapshotThread == std::this_thread::get_id());
+
+    // Later changes are not saved:
+    srv.addLayer("lidar", 10);
+
+    const auto r = op->wait();
+    ASSERTMSG_(r.success, r.error_message);
+    ASSERT_(doneCalled);
+    ASSERT_(mrpt::system::fileExists(mapPath + ".molamap"));
+    ASSERT_(!mrpt::system::fileExists(mapPath + ".molamap.tmp"));
+
+    // Many chunks, with increasing progress:
+    ASSERT_GT_(progress.size(), 10U);
+    for (size_t i = 1; i < progress.size(); i++)
+    {
+        ASSERT_GE_(progress[i].bytes, progress[i - 1].bytes);
+        ASSERT_GE_(progress[i].fraction, progress[i - 1].fraction);
+    }
+    ASSERT_EQUAL_(op->progress().fraction, 1.0);
+
+    DummyMapServer srv2;
+    progress.clear();
+    const auto r2 = srv2.map_load_async(mapPath, cbs)->wait();
+    ASSERTMSG_(r2.success, r2.error_message);
+    ASSERT_EQUAL_(srv2.numLayers(), 2U);
+    ASSERT_EQUAL_(srv2.layerSize("lidar"), 100000U);
+    ASSERT_EQUAL_(srv2.layerSize("other"), 50000U);
+    ASSERT_GT_(progress.size(), 10U);
+    ASSERT_EQUAL_(progress.back().fraction, 1.0);
+
+    // Synchronous API:
+    ASSERT_(srv2.map_save(mapPath + "2").success);
+    ASSERT_(srv.map_load(mapPath + "2").success);
+    ASSERT_EQUAL_(srv.layerSize("lidar"), 100000U);
+}
+
+// Starts an operation, and cancels it while its first progress report is
+// being held:
+template <class START_OP>
+mola::MapServer::Operation::Ptr cancel_at_first_progress(START_OP startOp)
+{
+    std::promise<void>              started, gate;
+    auto                            gateFut = gate.get_future().share();
+    mola::MapServer::AsyncCallbacks cbs;
+    cbs.on_progress = [&started, gateFut, first = true](const auto&) mutable {
+        if (!first) return;
+        first = false;
+        started.set_value();
+        gateFut.wait();
+    };
+
+    auto op = startOp(cbs);
+    started.get_future().wait();
+    op->cancel();
+    gate.set_value();
+    op->future().wait();
+    return op;
+}
+
+void test_cancel()
+{
+    DummyMapServer srv;
+    srv.addLayer("lidar", 100000);
+    ASSERT_(srv.map_save(mapPath).success);
+    const auto oldSize = mrpt::system::getFileSize(mapPath + ".molamap");
+
+    srv.addLayer("lidar", 200000);
+
+    auto op = cancel_at_first_progress([&](const auto& cbs) {
+        return srv.map_save_async(mapPath, cbs);
+    });
+    const auto r = op->wait();
+    ASSERT_(!r.success);
+    ASSERT_(op->cancelRequested());
+
+    // The previous file is intact:
+    ASSERT_EQUAL_(mrpt::system::getFileSize(mapPath + ".molamap"), oldSize);
+    ASSERT_(!mrpt::system::fileExists(mapPath + ".molamap.tmp"));
+
+    // Cancelled loads do not modify the map:
+    DummyMapServer srv2;
+    srv2.addLayer("mine", 10);
+    auto op2 = cancel_at_first_progress([&](const auto& cbs) {
+        return srv2.map_load_async(mapPath, cbs);
+    });
+    ASSERT_(!op2->wait().success);
+    ASSERT_EQUAL_(srv2.layerSize("mine"), 10U);
+}
+
+void test_load_errors()
+{
+    DummyMapServer srv;
+    srv.addLayer("mine", 10);
+
+    const auto r = srv.map_load(tmpDir + "/does-not-exist");
+    ASSERT_(!r.success);
+    ASSERT_(!r.error_message.empty());
+
+    // Not a map file:
+    {
+        std::ofstream f(tmpDir + "/garbage.molamap");
+        f << "this is not a map";
+    }
+    ASSERT_(!srv.map_load(tmpDir + "/garbage").success);
+
+    ASSERT_EQUAL_(srv.layerSize("mine"), 10U);
+}
+
+void test_default_async()
+{
+    SyncMapServer srv;
+    const auto    r = srv.map_save_async("foo")->wait();
+    ASSERT_(r.success);
+    ASSERT_EQUAL_(srv.savedPath, "foo");
+
+    // Pending operations are cancelled, not run:
+    std::promise<void>              gate;
+    auto                            gateFut = gate.get_future().share();
+    mola::MapServer::AsyncCallbacks cbs;
+    cbs.on_done = [&](const auto&) { gateFut.wait(); };
+
+    auto op1 = srv.map_save_async("bar", cbs);
+    auto op2 = srv.map_save_async("baz");
+    op2->cancel();
+    gate.set_value();
+    ASSERT_(op1->wait().success);
+    ASSERT_(!op2->wait().success);
+    ASSERT_EQUAL_(srv.savedPath, "bar");
+}
+
+void test_destroy_with_operations()
+{
+    auto srv = std::make_unique<SyncMapServer>();
+
+    std::promise<void>              started, gate;
+    auto                            gateFut = gate.get_future().share();
+    mola::MapServer::AsyncCallbacks cbs;
+    cbs.on_done = [&](const auto&) {
+        started.set_value();
+        gateFut.wait();
+    };
+
+    auto op1 = srv->map_save_async("running", cbs);
+    auto op2 = srv->map_save_async("pending");
+    started.get_future().wait();
+
+    // Not owned by a shared_ptr: the derived class destructor cancels the
+    // pending operation, and waits for the running one:
+    std::thread t([&]() { srv.reset(); });
+    while (!op2->cancelRequested())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    gate.set_value();
+    t.join();
+
+    ASSERT_(op1->done() && op2->done());
+    ASSERT_(op1->wait().success);
+    ASSERT_(!op2->wait().success);
+}
+
+void test_operations_keep_module_alive()
+{
+    std::promise<void> gate;
+
+    auto module  = std::make_shared<mola::MapServerModule>();
+    module->gate = gate.get_future().share();
+
+    std::weak_ptr<mola::MapServerModule> weak = module;
+
+    auto op = module->map_save_async("foo");
+
+    // Released by its owner (e.g. the launcher, at shutdown) while the
+    // operation is running:
+    module.reset();
+    ASSERT_(!weak.expired());
+
+    gate.set_value();
+    ASSERT_(op->wait().success);
+
+    // ...then destroyed when the operation releases it, in the worker thread:
+    using namespace std::chrono_literals;
+    const auto tEnd = std::chrono::steady_clock::now() + 5s;
+    while (!weak.expired())
+    {
+        ASSERTMSG_(std::chrono::steady_clock::now() < tEnd, "Not released");
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        mrpt::system::createDirectory(tmpDir);
+
+        test_save_load();
+        test_cancel();
+        test_load_errors();
+        test_default_async();
+        test_destroy_with_operations();
+        test_operations_keep_module_alive();
+
+        mrpt::system::deleteFilesInDirectory(tmpDir, true);
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,253 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-object-pool.cpp
+ * @brief  Unit tests and replay benchmark of ObjectPool / ObservationPools
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/ObservationPools.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+#include <mrpt/system/memory.h>
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+struct Dummy
+{
+    std::vector<int> data;
+};
+
+void test_reuse()
+{
+    mola::ObjectPool<Dummy> pool(2, [](Dummy& d) { d.data.clear(); });
+
+    auto        a    = pool.acquire();
+    const auto* rawA = a.get();
+    a->data.resize(1000);
+    const auto cap = a->data.capacity();
+    a.reset();
+
+    auto st = pool.stats();
+    ASSERT_EQUAL_(st.created, 1U);
+    ASSERT_EQUAL_(st.recycled, 1U);
+    ASSERT_EQUAL_(st.in_use, 0U);
+    ASSERT_EQUAL_(st.idle, 1U);
+
+    // The same object comes back, reset but with its memory:
+    auto b = pool.acquire();
+    ASSERT_EQUAL_(b.get(), rawA);
+    ASSERT_(b->data.empty());
+    ASSERT_EQUAL_(b->data.capacity(), cap);
+
+    // Beyond maxIdle, released objects are freed:
+    auto c = pool.acquire(), d = pool.acquire(), e = pool.acquire();
+    st = pool.stats();
+    ASSERT_EQUAL_(st.reused, 1U);
+    ASSERT_EQUAL_(st.created, 4U);
+    ASSERT_EQUAL_(st.in_use, 4U);
+    ASSERT_EQUAL_(st.peak_in_use, 4U);
+    b.reset(), c.reset(), d.reset(), e.reset();
+    st = pool.stats();
+    ASSERT_EQUAL_(st.idle, 2U);
+    ASSERT_EQUAL_(st.discarded, 2U);
+
+    pool.setMaxIdle(1);
+    ASSERT_EQUAL_(pool.stats().idle, 1U);
+    pool.clear();
+    ASSERT_EQUAL_(pool.stats().idle, 0U);
+    ASSERT_EQUAL_(pool.maxIdle(), 1U);
+}
+
+void test_outlive_pool()
+{
+    std::shared_ptr<Dummy> obj;
+    {
+        mola::ObjectPool<Dummy> pool;
+        obj = pool.acquire();
+    }
+    obj->data.resize(10);
+    obj.reset();  // must not crash
+}
+
+void test_threads()
+{
+    constexpr int NUM_PRODUCERS = 4, OBJS_PER_PRODUCER = 10000;
+
+    mola::ObjectPool<Dummy> pool(8);
+
+    // Producers acquire objects, a consumer thread releases them:
+    std::mutex                         queueMtx;
+    std::deque<std::shared_ptr<Dummy>> queue;
+    std::atomic_int                    producersDone{0};
+
+    std::thread consumer(
+        [&]()
+        {
+            for (;;)
+            {
+                auto lck  = mrpt::lockHelper(queueMtx);
+                bool done = producersDone == NUM_PRODUCERS;
+                if (queue.empty())
+                {
+                    lck.unlock();
+                    if (done) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                auto o = std::move(queue.front());
+                queue.pop_front();
+                lck.unlock();
+                o.reset();
+            }
+        });
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < NUM_PRODUCERS; t++)
+    {
+        producers.emplace_back(
+            [&]()
+            {
+                for (int i = 0; i < OBJS_PER_PRODUCER; i++)
+                {
+                    auto o = pool.acquire();
+                    o->data.push_back(i);
+                    auto lck = mrpt::lockHelper(queueMtx);
+                    queue.push_back(std::move(o));
+                }
+                producersDone++;
+            });
+    }
+    for (auto& t : producers) t.join();
+    consumer.join();
+
+    const auto st = pool.stats();
+    ASSERT_EQUAL_(st.in_use, 0U);
+    ASSERT_EQUAL_(
+        st.created + st.reused, size_t(NUM_PRODUCERS * OBJS_PER_PRODUCER));
+    ASSERT_EQUAL_(
+        st.recycled + st.discarded,
+        size_t(NUM_PRODUCERS * OBJS_PER_PRODUCER));
+    ASSERT_LE_(st.idle, 8U);
+}
+
+void test_observation_pools()
+{
+    auto& pools = mola::ObservationPools::Instance();
+
+    auto obs = pools.acquire<mrpt::obs::CObservationPointCloud>();
+    auto pts = pools.acquire<mrpt::maps::CPointsMapXYZI>();
+    for (int i = 0; i < 1000; i++) pts->insertPointFast(i, 0, 0);
+    pts->mark_as_modified();
+    obs->pointcloud  = pts;
+    obs->sensorLabel = "lidar";
+    pts.reset();
+
+    // The map is still referenced from the observation:
+    auto st = pools.stats().at("mrpt::maps::CPointsMapXYZI");
+    ASSERT_EQUAL_(st.in_use, 1U);
+
+    obs.reset();
+    st = pools.stats().at("mrpt::maps::CPointsMapXYZI");
+    ASSERT_EQUAL_(st.in_use, 0U);
+
+    // Both come back empty:
+    obs = pools.acquire<mrpt::obs::CObservationPointCloud>();
+    pts = pools.acquire<mrpt::maps::CPointsMapXYZI>();
+    ASSERT_(!obs->pointcloud);
+    ASSERT_(obs->sensorLabel.empty());
+    ASSERT_EQUAL_(pts->size(), 0U);
+    ASSERT_GE_(pools.stats().at("mrpt::maps::CPointsMapXYZI").reused, 1U);
+}
+
+// Simulates replaying a dataset with a read-ahead queue, comparing
+// allocation cost and memory usage (RSS) with and without pooling.
+void benchmark()
+{
+    constexpr size_t NUM_SCANS = 300, SCAN_POINTS = 120000, READ_AHEAD = 8;
+
+    std::printf(
+        "%-18s %12s %14s %14s\n", "[benchmark]", "us/scan", "RSS@50 (MB)",
+        "RSS@end (MB)");
+
+    for (const bool pooled : {false, true})
+    {
+        auto& pools = mola::ObservationPools::Instance();
+        pools.clear();
+
+        std::deque<mrpt::obs::CObservationPointCloud::Ptr> queue;
+        mrpt::system::CTicTac                              tictac;
+        double tAlloc = 0, rss50 = 0;
+
+        for (size_t i = 0; i < NUM_SCANS; i++)
+        {
+            tictac.Tic();
+            auto obs = pooled
+                           ? pools.acquire<mrpt::obs::CObservationPointCloud>()
+                           : mrpt::obs::CObservationPointCloud::Create();
+            auto pts = pooled ? pools.acquire<mrpt::maps::CPointsMapXYZI>()
+                              : mrpt::maps::CPointsMapXYZI::Create();
+            // Scans have slightly different sizes, as real ones:
+            const size_t n = SCAN_POINTS - (i % 7) * 1000;
+            pts->reserve(n);
+            for (size_t k = 0; k < n; k++)
+            {
+                pts->insertPointFast(k * 1e-3f, 0, 0);
+                pts->insertPointField_Intensity(0.5f);
+            }
+            pts->mark_as_modified();
+            obs->pointcloud = pts;
+            tAlloc += tictac.Tac();
+
+            queue.push_back(obs);
+            if (queue.size() > READ_AHEAD) queue.pop_front();
+
+            if (i == 50) rss50 = mrpt::system::getMemoryUsage() / 1e6;
+        }
+        queue.clear();
+
+        std::printf(
+            "%-18s %12.1f %14.1f %14.1f\n", pooled ? "pooled" : "Create()",
+            1e6 * tAlloc / NUM_SCANS, rss50,
+            mrpt::system::getMemoryUsage() / 1e6);
+    }
+
+    for (const auto& [name, st] : mola::ObservationPools::Instance().stats())
+    {
+        std::printf(
+            "%-34s created=%lu reused=%lu peak_in_use=%zu idle=%zu\n",
+            name.c_str(), static_cast<unsigned long>(st.created),
+            static_cast<unsigned long>(st.reused), st.peak_in_use, st.idle);
+    }
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_reuse();
+        test_outlive_pool();
+        test_threads();
+        test_observation_pools();
+        benchmark();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -93,6 +93,19 @@ struct Cli
         "can be added with the environment variable MOLA_MODULES_SHARED_PATH.",
         cmd};
 
+    TCLAP::SwitchArg arg_load_all_modules{
+        "", "load-all-modules",
+        "Loads all MOLA module libraries at start up, instead of only those "
+        "required by the YAML config file (Default: NO)",
+        cmd};
+
+    TCLAP::SwitchArg arg_update_module_manifest{
+        "", "update-module-manifest",
+        "Updates the cached list of classes provided by each MOLA module "
+        "library (e.g. after installing modules), then exits. Its path can be "
+        "set with the environment variable MOLA_MODULES_MANIFEST.",
+        cmd};
+
     TCLAP::SwitchArg arg_ros_args{
         "", "ros-args",
         "Dummy flag, defined just to allow the program invocation from ROS 2 "
@@ -153,6 +166,9 @@ int mola_cli_launch_slam(Cli& cli)
         cli.arg_enable_profiler_whole.isSet());
     app.profiler_.enableKeepWholeHistory(cli.arg_enable_profiler_whole.isSet());
 
+    app.launcher_params_.load_all_module_libraries =
+        cli.arg_load_all_modules.isSet();
+
     // Create SLAM system:
     app.setup(cfg, mrpt::system::extractFileDirectory(file_yml));
 
@@ -247,6 +263,19 @@ int mola_cli_list_module_shared_dirs()
     return 0;
 }
 
+int mola_cli_update_module_manifest()
+{
+    mola::MolaLauncherApp app;
+    theApp = &app;  // for the signal handler
+
+    // Requesting no class just brings the manifest up to date:
+    app.loadLibrariesForClasses({});
+
+    std::cout << "Module manifest: "
+              << app.launcher_params_.module_manifest_file << "\n";
+    return 0;
+}
+
 }  // namespace
 
 int main(int argc, char** argv)
@@ -273,6 +302,9 @@ int main(int argc, char** argv)
         if (cli.arg_list_module_shared_dirs.isSet())
             return mola_cli_list_module_shared_dirs();
 
+        if (cli.arg_update_module_manifest.isSet())
+            return mola_cli_update_module_manifest();
+
         // Default task:
         return mola_cli_launch_slam(cli);
 
@@ -19,6 +19,8 @@
 #include <atomic>
 #include <condition_variable>
 #include <map>
+#include <set>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -40,7 +42,14 @@ class MolaLauncherApp : public mrpt::system::COutputLogger
      * At this point, MOLA module libraries are searched in a list of paths
      * and loaded for their classes to be available in name-based class
      * factories. Modules must be named "libmola*" to be loaded.
-     * \sa addPathModuleLibs, scanAndLoadLibraries
+     *
+     * Only the libraries providing the classes named in each module config
+     * block (its `type`, plus any other string value which is a known class
+     * name) are loaded, as told by the module manifest (see
+     * Parameters::module_manifest_file), unless
+     * Parameters::load_all_module_libraries is set.
+     *
+     * \sa addPathModuleLibs, scanAndLoadLibraries, loadLibrariesForClasses
      */
     void setup(
         const mrpt::containers::yaml&     cfg,
@@ -124,6 +133,14 @@ class MolaLauncherApp : public mrpt::system::COutputLogger
      */
     void scanAndLoadLibraries();
 
+    /** Loads only the MOLA module libraries providing any of the given
+     * classes (e.g. `mola::KittiOdometryDataset`). Libraries not in the
+     * module manifest yet, or modified since, are loaded once to update it.
+     * Called from setup(). Unknown class names are silently ignored.
+     * \sa setup, Parameters::module_manifest_file
+     */
+    void loadLibrariesForClasses(const std::set<std::string>& classNames);
+
     using module_name_t        = std::string;
     using module_shared_path_t = std::string;
 
@@ -145,6 +162,18 @@ class MolaLauncherApp : public mrpt::system::COutputLogger
     struct Parameters
     {
         bool enforce_initialize_one_at_a_time{false};
+
+        /** If true, setup() loads all module libraries found in the search
+         * paths, instead of only those required by the configuration. */
+        bool load_all_module_libraries{false};
+
+        /** File with the list of classes provided by each module library,
+         * updated automatically. Set from the environment variable
+         * `MOLA_MODULES_MANIFEST` if defined, otherwise it defaults to
+         * `$XDG_CACHE_HOME/mola/modules-manifest.txt` (or `~/.cache/...`).
+         * If empty, all libraries are scanned in each setup().
+         */
+        std::string module_manifest_file;
     };
 
     Parameters launcher_params_;
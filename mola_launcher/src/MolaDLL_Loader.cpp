@@ -13,40 +13,53 @@
 #include "MolaDLL_Loader.h"
 
 #include <mrpt/core/exceptions.h>
+#include <mrpt/rtti/CObject.h>
 #include <mrpt/system/CDirectoryExplorer.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/system/string_utils.h>
 
+#include <cstdio>  // std::rename
+#include <fstream>
 #include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
 
 #if defined(__unix__)
 #include <dlfcn.h>
 #endif
 
-MRPT_TODO(
-    "Improvement: automatic scanning libraries and extract their classes");
+#if STD_FS_IS_EXPERIMENTAL
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
 
 /** From internal_load_lib_modules() */
 static std::map<std::string, LoadedModules> loaded_lib_handled;
 
-const std::map<std::string, LoadedModules>& get_loaded_modules()
-{
-    return loaded_lib_handled;
-}
-
-/** Loads all libs under lib_search_paths_. \sa setup() */
-void internal_load_lib_modules(
-    mrpt::system::COutputLogger&    app,
-    const std::vector<std::string>& lib_search_paths)
-{
-    MRPT_TRY_START
-
 #if defined(__unix__)
 #define DLL_EXT "so"
 #else
 #define DLL_EXT "dll"
 #endif
 
+namespace
+{
+using mrpt::system::LVL_DEBUG;
+
+/** Library files (name => full path) which look like MOLA modules under
+ * the given paths. For repeated names, the first path wins. */
+std::vector<std::pair<std::string, std::string>> list_module_libs(
+    mrpt::system::COutputLogger&    app,
+    const std::vector<std::string>& lib_search_paths)
+{
     using direxpl = mrpt::system::CDirectoryExplorer;
-    using mrpt::system::LVL_DEBUG;
+
+    std::vector<std::pair<std::string, std::string>> libs;
+    std::set<std::string>                            names;
 
     for (const auto& path : lib_search_paths)
     {
@@ -61,47 +74,264 @@ void internal_load_lib_modules(
         for (const auto& lib : lst)
         {
             if (lib.name.find("mola") == std::string::npos) continue;  // skip
+            if (!names.insert(lib.name).second) continue;  // repeated
+            libs.emplace_back(lib.name, lib.wholePath);
+        }
+    }
+    return libs;
+}
 
-            // Already loaded?
-            if (loaded_lib_handled.count(lib.name) != 0) continue;  // skip
+/** Loads one library, unless it was already loaded.
+ * \return true if it has been loaded now. */
+bool load_lib(
+    mrpt::system::COutputLogger& app, const std::string& name,
+    const std::string& wholePath)
+{
+    // Already loaded?
+    if (loaded_lib_handled.count(name) != 0) return false;  // skip
 
 #if defined(__unix__)
-            // Check if already loaded?
-            {
-                void* handle = dlopen(lib.wholePath.c_str(), RTLD_NOLOAD);
-                if (handle != nullptr)
-                {
-                    app.logStr(
-                        LVL_DEBUG, mrpt::format(
-                                       "Skipping already loaded lib: %s",
-                                       lib.name.c_str()));
-                    continue;  // skip
-                }
-            }
+    // Check if already loaded?
+    {
+        void* handle = dlopen(wholePath.c_str(), RTLD_NOLOAD);
+        if (handle != nullptr)
+        {
+            app.logStr(
+                LVL_DEBUG,
+                mrpt::format("Skipping already loaded lib: %s", name.c_str()));
+            return false;  // skip
+        }
+    }
 
-            void* handle = dlopen(lib.wholePath.c_str(), RTLD_LAZY);
+    void* handle = dlopen(wholePath.c_str(), RTLD_LAZY);
 #else
-            HMODULE handle = LoadLibrary(lib.wholePath.c_str());
+    HMODULE handle = LoadLibrary(wholePath.c_str());
 #endif
-            if (handle == nullptr)
+    if (handle == nullptr)
+    {
+        const char* err = dlerror();
+        if (!err) err = "(error calling dlerror())";
+        THROW_EXCEPTION(mrpt::format(
+            "Error loading module: `%s`\ndlerror(): `%s`", wholePath.c_str(),
+            err));
+    }
+
+    app.logStr(
+        LVL_DEBUG,
+        mrpt::format(
+            "[load modules]: Successfully loaded: `%s`", name.c_str()));
+
+    loaded_lib_handled[name] = LoadedModules{wholePath, handle};
+    return true;
+}
+
+// The module manifest: classes registered by each library (by full path),
+// plus the library file modification time and size, to detect changes.
+struct ManifestEntry
+{
+    int64_t                  mtime = 0;
+    uint64_t                 size  = 0;
+    std::vector<std::string> classes;
+};
+using manifest_t = std::map<std::string, ManifestEntry>;
+
+// In-memory copy of the manifest, and the libraries already checked against
+// their files, so setup() can call us once per module at little cost:
+manifest_t            manifest;
+bool                  manifest_changed = false;
+std::string           manifest_loaded_from;
+std::set<std::string> manifest_checked_libs;
+
+constexpr const char* MANIFEST_HEADER =
+    "# MOLA module manifest v1: <lib path> <mtime> <size> <class>...";
+
+// A missing, outdated or corrupted (e.g. truncated, hand-edited) manifest
+// is returned as empty, so it gets rebuilt from the libraries:
+manifest_t read_manifest(const std::string& file)
+{
+    manifest_t    m;
+    std::ifstream f(file);
+    if (!f.is_open()) return m;
+
+    std::string line;
+    if (!std::getline(f, line) || line != MANIFEST_HEADER)
+        return m;  // unknown format: start over
+
+    try
+    {
+        while (std::getline(f, line))
+        {
+            std::vector<std::string> fields;
+            mrpt::system::tokenize(line, "\t", fields);
+            if (fields.size() < 3)
+                throw std::invalid_argument("missing fields");
+
+            size_t         nMtime = 0, nSize = 0;
+            ManifestEntry& e = m[fields[0]];
+            e.mtime          = std::stoll(fields[1], &nMtime);
+            e.size           = std::stoull(fields[2], &nSize);
+            if (nMtime != fields[1].size() || nSize != fields[2].size())
+                throw std::invalid_argument("trailing characters");
+            e.classes.assign(fields.begin() + 3, fields.end());
+        }
+    }
+    catch (const std::exception&)
+    {
+        // std::invalid_argument or std::out_of_range: discard it all.
+        m.clear();
+    }
+    return m;
+}
+
+// Written into a temporary file, then renamed, since several programs may
+// be launched at once:
+void write_manifest(
+    mrpt::system::COutputLogger& app, const std::string& file,
+    const manifest_t& m)
+{
+    std::error_code ec;
+    fs::create_directories(fs::path(file).parent_path(), ec);
+
+    const auto tmpFile =
+        file + ".tmp" + std::to_string(std::random_device()() % 100000);
+    {
+        std::ofstream f(tmpFile);
+        if (!f.is_open())
+        {
+            app.logStr(
+                mrpt::system::LVL_WARN,
+                mrpt::format(
+                    "[load modules]: Cannot write module manifest: `%s`",
+                    tmpFile.c_str()));
+            return;
+        }
+        f << MANIFEST_HEADER << "\n";
+        for (const auto& [lib, e] : m)
+        {
+            f << lib << "\t" << e.mtime << "\t" << e.size;
+            for (const auto& c : e.classes) f << "\t" << c;
+            f << "\n";
+        }
+    }
+    if (0 != std::rename(tmpFile.c_str(), file.c_str()))
+        std::remove(tmpFile.c_str());
+}
+
+std::set<std::string> registered_class_names()
+{
+    std::set<std::string> names;
+    for (const auto* c : mrpt::rtti::getAllRegisteredClasses())
+        names.insert(c->className);
+    return names;
+}
+
+}  // namespace
+
+const std::map<std::string, LoadedModules>& get_loaded_modules()
+{
+    return loaded_lib_handled;
+}
+
+/** Loads all libs under lib_search_paths_. \sa setup() */
+void internal_load_lib_modules(
+    mrpt::system::COutputLogger&    app,
+    const std::vector<std::string>& lib_search_paths)
+{
+    MRPT_TRY_START
+
+    const auto libs = list_module_libs(app, lib_search_paths);
+    for (const auto& [name, wholePath] : libs) load_lib(app, name, wholePath);
+
+    MRPT_TRY_END
+}
+
+void internal_load_lib_modules_for_classes(
+    mrpt::system::COutputLogger&    app,
+    const std::vector<std::string>& lib_search_paths,
+    const std::set<std::string>&    class_names,
+    const std::string&              manifest_file)
+{
+    MRPT_TRY_START
+
+    if (manifest_loaded_from != manifest_file)
+    {
+        manifest = manifest_file.empty() ? manifest_t()
+                                         : read_manifest(manifest_file);
+        manifest_loaded_from = manifest_file;
+        manifest_checked_libs.clear();
+
+        // Forget libraries which no longer exist:
+        for (auto it = manifest.begin(); it != manifest.end();)
+        {
+            if (!mrpt::system::fileExists(it->first))
             {
-                const char* err = dlerror();
-                if (!err) err = "(error calling dlerror())";
-                THROW_EXCEPTION(mrpt::format(
-                    "Error loading module: `%s`\ndlerror(): `%s`",
-                    lib.wholePath.c_str(), err));
+                it               = manifest.erase(it);
+                manifest_changed = true;
             }
+            else
+                ++it;
+        }
+    }
 
-            app.logStr(
-                LVL_DEBUG, mrpt::format(
-                               "[load modules]: Successfully loaded: `%s`",
-                               lib.name.c_str()));
+    const auto libs = list_module_libs(app, lib_search_paths);
 
-            loaded_lib_handled[lib.name] = LoadedModules{lib.wholePath, handle};
+    // 1) Make sure all libraries are in the manifest, and up to date:
+    for (const auto& [name, wholePath] : libs)
+    {
+        if (manifest_checked_libs.count(wholePath)) continue;
+        manifest_checked_libs.insert(wholePath);
+
+        std::error_code ec;
+        const int64_t   mtime = static_cast<int64_t>(
+            fs::last_write_time(wholePath, ec).time_since_epoch().count());
+        const uint64_t size = fs::file_size(wholePath, ec);
+
+        if (auto it = manifest.find(wholePath); it != manifest.end() &&
+                                                it->second.mtime == mtime &&
+                                                it->second.size == size)
+            continue;  // up to date
+
+        // New or changed: load it and find out its classes. Classes of other
+        // libraries loaded as dependencies are attributed to this one, which
+        // is fine, since loading it also provides them.
+        app.logStr(
+            LVL_DEBUG,
+            mrpt::format(
+                "[load modules]: Scanning classes of: `%s`",
+                wholePath.c_str()));
+
+        const auto before = registered_class_names();
+        load_lib(app, name, wholePath);
+        const auto after = registered_class_names();
+
+        ManifestEntry& e = manifest[wholePath];
+        e.mtime          = mtime;
+        e.size           = size;
+        e.classes.clear();
+        for (const auto& c : after)
+            if (!before.count(c)) e.classes.push_back(c);
+
+        manifest_changed = true;
+    }
+
+    if (manifest_changed && !manifest_file.empty())
+        write_manifest(app, manifest_file, manifest);
+    manifest_changed = false;
+
+    // 2) Load the libraries providing the requested classes:
+    for (const auto& [name, wholePath] : libs)
+    {
+        const auto it = manifest.find(wholePath);
+        if (it == manifest.end()) continue;
+
+        for (const auto& c : it->second.classes)
+        {
+            if (!class_names.count(c)) continue;
+            load_lib(app, name, wholePath);
+            break;
         }
     }
 
-#undef DLL_EXT
     MRPT_TRY_END
 }
 
@@ -14,6 +14,8 @@
 
 #include <mrpt/system/COutputLogger.h>
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -29,5 +31,20 @@ void internal_load_lib_modules(
     mrpt::system::COutputLogger&    app,
     const std::vector<std::string>& lib_search_paths);
 
+/** Loads only those libs under lib_search_paths which provide (register) any
+ * of the given classes, according to the module manifest `manifest_file`:
+ * a cache of the classes registered by each library.
+ *
+ * Libraries not in the manifest yet, or modified since they were added to it
+ * (by modification time and size), are loaded once to find out their
+ * classes, then the manifest file is updated. An empty `manifest_file` means
+ * not persisting the manifest between program runs.
+ */
+void internal_load_lib_modules_for_classes(
+    mrpt::system::COutputLogger&    app,
+    const std::vector<std::string>& lib_search_paths,
+    const std::set<std::string>&    class_names,
+    const std::string&              manifest_file);
+
 /** Returns the current list of loaded module dyanmic libraries. */
 const std::map<std::string, LoadedModules>& get_loaded_modules();
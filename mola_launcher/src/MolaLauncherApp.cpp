@@ -14,6 +14,7 @@
  * systems
  */
 
+#include <mola_kernel/FrameArena.h>
 #include <mola_kernel/interfaces/FrontEndBase.h>
 #include <mola_kernel/interfaces/RawDataSourceBase.h>
 #include <mola_launcher/MolaLauncherApp.h>
@@ -89,6 +90,49 @@ std::string relative_to_abs_path(
     else
         return path;
 }
+
+std::string default_module_manifest_file()
+{
+    if (const auto f = mrpt::get_env<std::string>("MOLA_MODULES_MANIFEST");
+        !f.empty())
+        return f;
+
+    auto cacheDir = mrpt::get_env<std::string>("XDG_CACHE_HOME");
+    if (cacheDir.empty())
+    {
+        const auto home = mrpt::get_env<std::string>("HOME");
+        if (home.empty()) return {};
+        cacheDir = (fs::path(home) / ".cache").string();
+    }
+    return (fs::path(cacheDir) / "mola" / "modules-manifest.txt").string();
+}
+
+// All string scalars in a YAML tree, as candidate class names:
+void collect_yaml_strings(
+    const mrpt::containers::yaml& n, std::set<std::string>& out)
+{
+    if (n.isMap())
+    {
+        for (const auto& [k, v] : n.asMap())
+            collect_yaml_strings(mrpt::containers::yaml(v), out);
+    }
+    else if (n.isSequence())
+    {
+        for (const auto& v : n.asSequence())
+            collect_yaml_strings(mrpt::containers::yaml(v), out);
+    }
+    else if (n.isScalar() && !n.isNullNode())
+    {
+        try
+        {
+            out.insert(n.as<std::string>());
+        }
+        catch (const std::exception&)
+        {
+            // Not a string: ignore.
+        }
+    }
+}
 }  // namespace
 
 MolaLauncherApp::MolaLauncherApp()
@@ -105,6 +149,8 @@ MolaLauncherApp::MolaLauncherApp()
     // do not filter these ones by *directory* name, since *filenames* will be
     // filtered later on:
     from_env_var_to_list("LD_LIBRARY_PATH", lib_search_paths_);
+
+    launcher_params_.module_manifest_file = default_module_manifest_file();
 }
 
 MolaLauncherApp::~MolaLauncherApp()
@@ -182,13 +228,26 @@ void MolaLauncherApp::scanAndLoadLibraries()
     MRPT_TRY_END
 }
 
+void MolaLauncherApp::loadLibrariesForClasses(
+    const std::set<std::string>& classNames)
+{
+    MRPT_TRY_START
+
+    internal_load_lib_modules_for_classes(
+        *this, lib_search_paths_, classNames,
+        launcher_params_.module_manifest_file);
+
+    MRPT_TRY_END
+}
+
 void MolaLauncherApp::setup(
     const mrpt::containers::yaml&     cfg,
     const std::optional<std::string>& basePath)
 {
     MRPT_TRY_START
 
-    scanAndLoadLibraries();
+    // Otherwise, module libraries are loaded on demand, below:
+    if (launcher_params_.load_all_module_libraries) scanAndLoadLibraries();
 
     MRPT_LOG_INFO(
         "Setting up system from YAML config... (set DEBUG verbosity level to "
@@ -293,6 +352,15 @@ void MolaLauncherApp::setup(
                     info.yaml_cfg_block[k.as<std::string>()] = v;
             }
 
+            if (!launcher_params_.load_all_module_libraries)
+            {
+                // Load the library of this module, and of any other class
+                // named in its configuration (e.g. by-name class factories):
+                std::set<std::string> classNames = {ds_classname};
+                collect_yaml_strings(info.yaml_cfg_block, classNames);
+                loadLibrariesForClasses(classNames);
+            }
+
             MRPT_LOG_INFO_STREAM(
                 "Instantiating module `" << ds_label << "` of type `"
                                          << ds_classname << "`");
@@ -457,7 +525,9 @@ void MolaLauncherApp::executor_thread(InfoPerRunningThread& rds)
             // Only if all modules are correctly initialized:
             if (pending_initializations_ == 0)
             {
-                // Run the main module loop code:
+                // Run the main module loop code, as one cycle of the
+                // thread FrameArena (see frame_memory_resource()):
+                mola::FrameArena::Scope frameScope;
                 rds.impl->spinOnce();
             }
 
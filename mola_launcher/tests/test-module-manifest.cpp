@@ -0,0 +1,218 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-module-manifest.cpp
+ * @brief  Unit tests and start up benchmark of on-demand module loading
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/rtti/CObject.h>
+#include <mrpt/system/CTicTac.h>
+#include <mrpt/system/filesystem.h>
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+
+#include "MolaDLL_Loader.h"
+
+#if defined(__unix__)
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
+
+namespace
+{
+const std::vector<std::string> search_paths = {TEST_DUMMY_MODULES_DIR};
+
+const std::string manifest_file =
+    mrpt::system::getTempFileName() + "-mola-manifest.txt";
+
+mrpt::system::COutputLogger logger("test-module-manifest");
+
+std::string dummy_class(int i)
+{
+    return mrpt::format("mola::TestDummyModule%i", i);
+}
+
+std::string dummy_lib(int i)
+{
+    return mrpt::format(
+        "%s/libmola_test_dummy_module_%i.so", TEST_DUMMY_MODULES_DIR, i);
+}
+
+bool is_registered(int i)
+{
+    return mrpt::rtti::findRegisteredClass(dummy_class(i)) != nullptr;
+}
+
+// Loaded libraries and classes cannot be unloaded, so each test runs in a
+// new process:
+void run_in_child(const std::string& name, const std::function<void()>& f)
+{
+#if defined(__unix__)
+    const pid_t pid = fork();
+    ASSERT_(pid >= 0);
+    if (pid == 0)
+    {
+        int ret = 0;
+        try
+        {
+            mrpt::system::CTicTac tic;
+            f();
+            std::cout << mrpt::format(
+                             "[%-28s] %8.03f ms, %2zu libraries loaded",
+                             name.c_str(), 1e3 * tic.Tac(),
+                             get_loaded_modules().size())
+                      << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << name << ": " << e.what() << std::endl;
+            ret = 1;
+        }
+        std::fflush(stdout);
+        _exit(ret);
+    }
+    int status = 0;
+    ASSERT_(waitpid(pid, &status, 0) == pid);
+    ASSERTMSG_(
+        WIFEXITED(status) && WEXITSTATUS(status) == 0, "Failed: " + name);
+#endif
+}
+
+void test_load_all()
+{
+    run_in_child("load all (baseline)", []() {
+        internal_load_lib_modules(logger, search_paths);
+        ASSERT_EQUAL_(get_loaded_modules().size(), TEST_NUM_DUMMY_MODULES);
+        for (int i = 1; i <= TEST_NUM_DUMMY_MODULES; i++)
+            ASSERT_(is_registered(i));
+    });
+}
+
+void test_manifest()
+{
+    std::remove(manifest_file.c_str());
+
+    // No manifest yet: all libraries are loaded to build it.
+    run_in_child("cold manifest", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {dummy_class(1)}, manifest_file);
+        ASSERT_(mrpt::system::fileExists(manifest_file));
+        ASSERT_EQUAL_(get_loaded_modules().size(), TEST_NUM_DUMMY_MODULES);
+    });
+
+    // Up to date manifest: only the requested library is loaded.
+    for (int rep = 0; rep < 2; rep++)
+    {
+        run_in_child("warm manifest", []() {
+            internal_load_lib_modules_for_classes(
+                logger, search_paths, {dummy_class(3)}, manifest_file);
+            ASSERT_EQUAL_(get_loaded_modules().size(), 1U);
+            ASSERT_(is_registered(3));
+            ASSERT_(!is_registered(1));
+        });
+    }
+
+    // Several modules, and strings which are not classes:
+    run_in_child("warm manifest, 2 classes", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths,
+            {dummy_class(2), dummy_class(5), "foo", "mola::Nope", "1.0"},
+            manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), 2U);
+        ASSERT_(is_registered(2));
+        ASSERT_(is_registered(5));
+    });
+
+    run_in_child("warm manifest, no class", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {"mola::Nope"}, manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), 0U);
+    });
+
+#if defined(__unix__)
+    // A modified library must be scanned again, but only that one:
+    ASSERT_(0 == utime(dummy_lib(4).c_str(), nullptr));
+    run_in_child("stale library", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {dummy_class(6)}, manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), 2U);
+        ASSERT_(is_registered(4));
+        ASSERT_(is_registered(6));
+    });
+#endif
+
+    // A broken manifest is just rebuilt:
+    {
+        std::FILE* f = std::fopen(manifest_file.c_str(), "wt");
+        ASSERT_(f != nullptr);
+        std::fputs("garbage\n", f);
+        std::fclose(f);
+    }
+    run_in_child("broken manifest", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {dummy_class(1)}, manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), TEST_NUM_DUMMY_MODULES);
+    });
+    run_in_child("warm manifest (rebuilt)", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {dummy_class(1)}, manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), 1U);
+    });
+
+    // Same for a valid header followed by malformed entries (<mtime> and
+    // <size> fields): not a number, missing, trailing chars, out of range.
+    const char* badFields[] = {
+        "x12\t34", "12\t", "12\t34x", "99999999999999999999999\t1"};
+    for (const char* bad : badFields)
+    {
+        std::FILE* f = std::fopen(manifest_file.c_str(), "wt");
+        ASSERT_(f != nullptr);
+        std::fprintf(
+            f,
+            "# MOLA module manifest v1: <lib path> <mtime> <size> "
+            "<class>...\n%s\t%s\t%s\n",
+            dummy_lib(1).c_str(), bad, dummy_class(1).c_str());
+        std::fclose(f);
+
+        run_in_child("malformed manifest", []() {
+            internal_load_lib_modules_for_classes(
+                logger, search_paths, {dummy_class(1)}, manifest_file);
+            ASSERT_EQUAL_(
+                get_loaded_modules().size(), TEST_NUM_DUMMY_MODULES);
+        });
+    }
+    run_in_child("warm manifest (rebuilt)", []() {
+        internal_load_lib_modules_for_classes(
+            logger, search_paths, {dummy_class(1)}, manifest_file);
+        ASSERT_EQUAL_(get_loaded_modules().size(), 1U);
+    });
+
+    std::remove(manifest_file.c_str());
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_load_all();
+        test_manifest();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,328 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LoopClosureDetector.h
+ * @brief  Loop closure candidates among the keyframes of a SLAM map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_kernel/PriorityTaskExecutor.h>
+#include <mola_kernel/id.h>
+#include <mola_pose_list/HashedSetSE3.h>
+#include <mola_relocalization/ScanContext.h>
+#include <mp2p_icp/ICP.h>
+#include <mp2p_icp/Parameters.h>
+#include <mp2p_icp/metricmap.h>
+#include <mrpt/math/CMatrixFixed.h>
+#include <mrpt/math/TPose3D.h>
+
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace mola
+{
+class WorldModel;
+
+/** Parameters of LoopClosureDetector
+ *
+ * \ingroup mola_loop_closure_grp
+ */
+struct LoopClosureDetectorParameters
+{
+    /** @name Spatial search
+     *  @{ */
+
+    /** The search radius around a keyframe grows with the path length
+     * traveled since each older keyframe, to account for odometry drift:
+     *
+     *  r = min(max_search_radius,
+     *          min_search_radius + drift_per_meter * path_length)
+     */
+    double min_search_radius = 3.0;  //!< [m]
+    double drift_per_meter   = 0.02;
+    double max_search_radius = 30.0;  //!< [m]
+
+    /// Maximum rotation between both keyframes [rad]
+    double max_rotation = M_PI;
+
+    /// Keyframes closer than this along the path are not loop closures [m]
+    double min_path_length = 30.0;
+
+    /// Maximum number of candidates per query, after ranking
+    size_t max_candidates = 5;
+
+    /** The spatial index is rebuilt once any keyframe moves more than this
+     * since it was indexed [m] */
+    double reindex_threshold = 1.0;
+
+    /// Size of the spatial index cells [m]
+    double index_voxel_size = 5.0;
+
+    /** @} */
+
+    /** @name Descriptors (optional)
+     *  @{ */
+
+    /// Candidates whose descriptors are farther than this are discarded
+    double max_descriptor_distance = 0.4;
+
+    /// Weight of the descriptor distance in the candidate score
+    double descriptor_weight = 1.0;
+
+    /** Number of candidates retrieved by descriptor only, regardless of the
+     * keyframe poses (e.g. for drift beyond max_search_radius). 0=disabled.
+     */
+    size_t appearance_candidates = 0;
+
+    ScanContextIndex::Parameters descriptor_index;
+
+    /** @} */
+
+    /** @name Verification
+     *  @{ */
+
+    /// Background threads running the verifier
+    size_t verification_threads = 2;
+
+    /// Minimum ICP quality to accept a loop closure (default verifier)
+    double icp_minimum_quality = 0.50;
+
+    /** @} */
+};
+
+/** A possible loop closure between two keyframes.
+ * \ingroup mola_loop_closure_grp */
+struct LoopClosureCandidate
+{
+    id_t query_kf     = INVALID_ID;  //!< The newer keyframe
+    id_t candidate_kf = INVALID_ID;  //!< The older keyframe
+
+    /** Pose of query_kf wrt candidate_kf, from their current pose estimates.
+     * For appearance-only candidates, the relative yaw from the descriptors.
+     */
+    mrpt::math::TPose3D relative_pose;
+
+    double distance      = 0;  //!< Translation between both keyframes [m]
+    double search_radius = 0;  //!< Radius for this pair [m]
+    double path_length   = 0;  //!< Traveled from candidate to query [m]
+
+    std::optional<double> descriptor_distance;  //!< If both have one
+    bool appearance_only = false;  //!< Found by descriptor only
+
+    double score = 0;  //!< Ranking score, lower is better
+};
+
+/** Result of verifying a LoopClosureCandidate.
+ * \ingroup mola_loop_closure_grp */
+struct LoopClosureVerification
+{
+    LoopClosureCandidate candidate;
+
+    bool   accepted = false;
+    double quality  = 0;  //!< e.g. ICP quality, in [0,1]
+
+    /// Refined pose of query_kf wrt candidate_kf
+    mrpt::math::TPose3D relative_pose;
+
+    /// Covariance of relative_pose, in MRPT order (x y z yaw pitch roll)
+    std::optional<mrpt::math::CMatrixDouble66> cov;
+
+    std::optional<std::string> error_msg;
+};
+
+/** Finds loop closure candidates among SLAM keyframes, ranks them, and
+ * verifies them in background threads.
+ *
+ * Keyframe poses are indexed in a HashedSetSE3. For a query keyframe, older
+ * keyframes at least `min_path_length` meters behind it along the trajectory
+ * are candidates if they are within a search radius which grows with the
+ * path length between both, since so does the odometry drift.
+ * If both keyframes have ScanContext descriptors, candidates whose
+ * descriptors do not match are discarded, and the descriptor distance is
+ * part of the score. Optionally, descriptors also provide candidates
+ * regardless of the keyframe poses. Candidates are ranked by:
+ *
+ *  score = distance / search_radius + descriptor_weight * descriptor_distance
+ *
+ * with appearance-only candidates scored as if at the search radius.
+ *
+ * detect() emits the ranked candidates through `on_candidates`, then enqueues
+ * each one for verification, with the custom `verifier` if set, or ICP
+ * between the keyframe local maps otherwise (see setICP()). Results are
+ * emitted from the verification threads through `on_verified`. Callbacks and
+ * the verifier must be set before the first call to detect().
+ *
+ * Keyframes may be fed directly with insertKeyFrame() and
+ * updateKeyFramePose(), or from the RelPose3KF entities of a WorldModel with
+ * syncFromWorldModel(), in which case all keyframes are assumed to be
+ * relative to the same reference frame.
+ *
+ * All methods are thread-safe.
+ *
+ * \ingroup mola_loop_closure_grp
+ */
+class LoopClosureDetector
+{
+   public:
+    using Parameters   = LoopClosureDetectorParameters;
+    using Candidate    = LoopClosureCandidate;
+    using Verification = LoopClosureVerification;
+    using verifier_t   = std::function<Verification(const Candidate&)>;
+    using local_map_t  = std::shared_ptr<const mp2p_icp::metric_map_t>;
+
+    explicit LoopClosureDetector(const Parameters& p = Parameters());
+
+    /** Discards pending verifications and waits for the running ones */
+    ~LoopClosureDetector();
+
+    const Parameters& parameters() const { return params_; }
+
+    /** @name Keyframes
+     *  @{ */
+
+    /** Adds a new keyframe. Keyframes must be inserted in trajectory order,
+     * since the path length is accumulated from consecutive keyframes. */
+    void insertKeyFrame(
+        id_t id, const mrpt::math::TPose3D& pose,
+        const std::optional<ScanContext>& descriptor = std::nullopt,
+        const local_map_t&                localMap   = {});
+
+    /// Updates the pose estimate of a keyframe, e.g. after an optimization
+    void updateKeyFramePose(id_t id, const mrpt::math::TPose3D& pose);
+
+    void setKeyFrameDescriptor(id_t id, const ScanContext& descriptor);
+    void setKeyFrameLocalMap(id_t id, const local_map_t& localMap);
+
+    /** Inserts new RelPose3KF keyframes from the WorldModel, in ID order, and
+     * updates the poses of the existing ones.
+     * \return The IDs of the new keyframes.
+     */
+    std::vector<id_t> syncFromWorldModel(WorldModel& wm);
+
+    size_t size() const;
+    bool   contains(id_t id) const;
+    void   clear();
+
+    /** @} */
+
+    /** @name Detection and verification
+     *  @{ */
+
+    /** Returns the ranked loop closure candidates for an existing keyframe.
+     */
+    std::vector<Candidate> query(id_t kf) const;
+
+    /** Runs query(), emits the candidates through `on_candidates` (if not
+     * empty) and enqueues them for verification.
+     * \return The candidates.
+     */
+    std::vector<Candidate> detect(id_t kf);
+
+    /// Enqueues one candidate for verification.
+    std::future<Verification> verifyAsync(const Candidate& c);
+
+    /// Blocks until all enqueued verifications are done.
+    void waitForVerifications();
+
+    size_t pendingVerifications() const;
+
+    /** Sets the ICP pipelines for the default verifier, which aligns the
+     * local map of the query keyframe against that of the candidate. Up to
+     * one alignment per pipeline runs in parallel. */
+    void setICP(
+        const std::vector<mp2p_icp::ICP::Ptr>& pipelines,
+        const mp2p_icp::Parameters&            icpParameters);
+
+    std::function<void(const std::vector<Candidate>&)> on_candidates;
+    std::function<void(const Verification&)>           on_verified;
+
+    /// Custom verifier. If empty, ICP is used (see setICP())
+    verifier_t verifier;
+
+    /** @} */
+
+   private:
+    Parameters params_;
+
+    struct KeyFrame
+    {
+        mrpt::math::TPose3D         pose;
+        mutable mrpt::math::TPose3D indexed_pose;  //!< As in index_
+        double                      path_length = 0;  //!< From the first KF
+        std::optional<ScanContext>  descriptor;
+        local_map_t                 local_map;
+    };
+
+    mutable std::mutex       mtx_;
+    std::map<id_t, KeyFrame> keyframes_;
+    std::optional<id_t>      last_kf_;
+
+    // Descriptors are only indexed once their keyframes are min_path_length
+    // behind the newest one, so recent keyframes (which always look alike)
+    // do not crowd out the appearance-only candidates:
+    ScanContextIndex  descriptor_index_;
+    std::vector<id_t> descriptor_queue_;
+
+    void flush_descriptor_queue();
+
+    // Spatial index of keyframe poses, with their IDs. Rebuilt lazily:
+    mutable HashedSetSE3 index_;
+    mutable bool         index_dirty_ = false;
+
+    void insert_in_index(id_t id, const KeyFrame& kf) const;
+    void rebuild_index() const;
+
+    double search_radius(double pathLength) const;
+
+    // Default verifier:
+    struct ICPContext
+    {
+        std::vector<mp2p_icp::ICP::Ptr> pipelines;
+        std::vector<bool>               busy;
+        mp2p_icp::Parameters            parameters;
+        std::mutex                      mtx;
+        std::condition_variable         cv;
+    };
+    std::shared_ptr<ICPContext> icp_;
+
+    static Verification icp_verify(
+        ICPContext& icp, const local_map_t& local,
+        const local_map_t& reference, double minimumQuality,
+        const Candidate& c);
+
+    size_t                  pending_verifications_ = 0;
+    std::condition_variable cv_verifications_;
+
+    // Declared last, so it is destroyed (waiting for running verifications)
+    // before anything they use:
+    PriorityTaskExecutor verifier_pool_;
+};
+
+}  // namespace mola
@@ -0,0 +1,528 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   LoopClosureDetector.cpp
+ * @brief  Loop closure candidates among the keyframes of a SLAM map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/WorldModel.h>
+#include <mola_loop_closure/LoopClosureDetector.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/Lie/SO.h>
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+using namespace mola;
+
+namespace
+{
+PriorityTaskExecutor::Parameters verifier_pool_parameters(
+    const LoopClosureDetectorParameters& p)
+{
+    PriorityTaskExecutor::Parameters ep;
+    ep.num_threads = std::max<size_t>(1, p.verification_threads);
+    ep.name        = "loop_closure";
+    return ep;
+}
+
+double translation_distance(
+    const mrpt::math::TPose3D& a, const mrpt::math::TPose3D& b)
+{
+    return std::sqrt(
+        mrpt::square(a.x - b.x) + mrpt::square(a.y - b.y) +
+        mrpt::square(a.z - b.z));
+}
+
+}  // namespace
+
+LoopClosureDetector::LoopClosureDetector(const Parameters& p)
+    : params_(p),
+      descriptor_index_(p.descriptor_index),
+      verifier_pool_(verifier_pool_parameters(p))
+{
+    ASSERT_GT_(params_.index_voxel_size, 0.0);
+    ASSERT_GT_(params_.min_search_radius, 0.0);
+    ASSERT_GE_(params_.max_search_radius, params_.min_search_radius);
+
+    // Angular cells larger than any angle: the index is on translation only.
+    const double anyAngle = 4 * M_PI;
+    index_.setVoxelProperties(
+        params_.index_voxel_size, anyAngle, anyAngle, anyAngle);
+}
+
+LoopClosureDetector::~LoopClosureDetector() = default;
+
+void LoopClosureDetector::insertKeyFrame(
+    id_t id, const mrpt::math::TPose3D& pose,
+    const std::optional<ScanContext>& descriptor, const local_map_t& localMap)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    ASSERTMSG_(
+        keyframes_.count(id) == 0,
+        mrpt::format(
+            "Keyframe #%u already inserted", static_cast<unsigned>(id)));
+
+    KeyFrame kf;
+    kf.pose       = pose;
+    kf.descriptor = descriptor;
+    kf.local_map  = localMap;
+    if (last_kf_)
+    {
+        const auto& prev = keyframes_.at(*last_kf_);
+        kf.path_length =
+            prev.path_length + translation_distance(prev.pose, pose);
+    }
+
+    const auto& k = keyframes_[id] = std::move(kf);
+    last_kf_      = id;
+
+    if (!index_dirty_) insert_in_index(id, k);
+
+    if (descriptor) descriptor_queue_.push_back(id);
+    flush_descriptor_queue();
+}
+
+void LoopClosureDetector::updateKeyFramePose(
+    id_t id, const mrpt::math::TPose3D& pose)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    auto& kf = keyframes_.at(id);
+    kf.pose  = pose;
+
+    if (translation_distance(kf.indexed_pose, pose) >
+        params_.reindex_threshold)
+        index_dirty_ = true;
+}
+
+void LoopClosureDetector::setKeyFrameDescriptor(
+    id_t id, const ScanContext& descriptor)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    auto& kf = keyframes_.at(id);
+    ASSERTMSG_(
+        !kf.descriptor,
+        mrpt::format(
+            "Keyframe #%u already has a descriptor",
+            static_cast<unsigned>(id)));
+
+    kf.descriptor = descriptor;
+    descriptor_queue_.push_back(id);
+    flush_descriptor_queue();
+}
+
+void LoopClosureDetector::setKeyFrameLocalMap(
+    id_t id, const local_map_t& localMap)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    keyframes_.at(id).local_map = localMap;
+}
+
+std::vector<mola::id_t> LoopClosureDetector::syncFromWorldModel(WorldModel& wm)
+{
+    std::vector<std::pair<mola::id_t, mrpt::math::TPose3D>> kfs;
+
+    wm.entities_lock_for_read();
+    try
+    {
+        for (const auto id : wm.entity_all_ids())
+        {
+            const auto* kf = std::get_if<RelPose3KF>(&wm.entity_by_id(id));
+            if (kf) kfs.emplace_back(id, kf->relpose_value);
+        }
+    }
+    catch (...)
+    {
+        wm.entities_unlock_for_read();
+        throw;
+    }
+    wm.entities_unlock_for_read();
+
+    // IDs follow the creation order of keyframes:
+    std::sort(
+        kfs.begin(), kfs.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<mola::id_t> newIds;
+    for (const auto& [id, pose] : kfs)
+    {
+        if (contains(id))
+            updateKeyFramePose(id, pose);
+        else
+        {
+            insertKeyFrame(id, pose);
+            newIds.push_back(id);
+        }
+    }
+    return newIds;
+}
+
+size_t LoopClosureDetector::size() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return keyframes_.size();
+}
+
+bool LoopClosureDetector::contains(id_t id) const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return keyframes_.count(id) != 0;
+}
+
+void LoopClosureDetector::clear()
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    keyframes_.clear();
+    last_kf_.reset();
+    descriptor_index_.clear();
+    descriptor_queue_.clear();
+    index_.clear();
+    index_dirty_ = false;
+}
+
+void LoopClosureDetector::flush_descriptor_queue()
+{
+    if (!last_kf_) return;
+    const double maxPathLength =
+        keyframes_.at(*last_kf_).path_length - params_.min_path_length;
+
+    auto it = descriptor_queue_.begin();
+    while (it != descriptor_queue_.end())
+    {
+        const auto& kf = keyframes_.at(*it);
+        if (kf.path_length <= maxPathLength)
+        {
+            descriptor_index_.insert(*it, *kf.descriptor);
+            it = descriptor_queue_.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void LoopClosureDetector::insert_in_index(id_t id, const KeyFrame& kf) const
+{
+    kf.indexed_pose = kf.pose;
+    index_.insertPose(kf.pose, id);
+}
+
+void LoopClosureDetector::rebuild_index() const
+{
+    index_.clear();
+    for (const auto& [id, kf] : keyframes_) insert_in_index(id, kf);
+    index_dirty_ = false;
+}
+
+double LoopClosureDetector::search_radius(double pathLength) const
+{
+    return std::min(
+        params_.max_search_radius,
+        params_.min_search_radius + params_.drift_per_meter * pathLength);
+}
+
+std::vector<LoopClosureDetector::Candidate> LoopClosureDetector::query(
+    id_t kf) const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    const auto itQ = keyframes_.find(kf);
+    ASSERTMSG_(
+        itQ != keyframes_.end(),
+        mrpt::format("Unknown keyframe #%u", static_cast<unsigned>(kf)));
+    const KeyFrame& q = itQ->second;
+
+    std::vector<Candidate> cands;
+
+    // No keyframe is far enough along the path:
+    if (q.path_length < params_.min_path_length) return cands;
+
+    if (index_dirty_) rebuild_index();
+
+    const mrpt::poses::CPose3D qPose(q.pose);
+
+    auto lambdaCandidate = [&](id_t id, const KeyFrame& c)
+    {
+        Candidate cand;
+        cand.query_kf      = kf;
+        cand.candidate_kf  = id;
+        cand.relative_pose = (qPose - mrpt::poses::CPose3D(c.pose)).asTPose();
+        cand.distance      = translation_distance(q.pose, c.pose);
+        cand.path_length   = q.path_length - c.path_length;
+        cand.search_radius = search_radius(cand.path_length);
+        return cand;
+    };
+
+    // Spatial candidates, within the largest possible radius for this
+    // query, plus the maximum error of the indexed poses:
+    std::set<id_t> found;
+
+    const double maxRadius =
+        search_radius(q.path_length) + params_.reindex_threshold;
+
+    index_.visitPosesWithinRadius(
+        q.pose, maxRadius, M_PI,
+        [&](const mrpt::math::TPose3D&, HashedSetSE3::pose_id_t id)
+        {
+            if (found.count(id)) return;
+
+            const KeyFrame& c = keyframes_.at(id);
+            if (q.path_length - c.path_length < params_.min_path_length)
+                return;
+
+            Candidate cand = lambdaCandidate(id, c);
+            if (cand.distance > cand.search_radius) return;
+
+            const double rot = mrpt::poses::Lie::SO<3>::log(
+                                   mrpt::poses::CPose3D(cand.relative_pose)
+                                       .getRotationMatrix())
+                                   .norm();
+            if (rot > params_.max_rotation) return;
+
+            if (q.descriptor && c.descriptor)
+            {
+                cand.descriptor_distance =
+                    q.descriptor
+                        ->distance(
+                            *c.descriptor,
+                            params_.descriptor_index.shift_search_radius)
+                        .distance;
+                if (*cand.descriptor_distance > params_.max_descriptor_distance)
+                    return;
+            }
+
+            cand.score = cand.distance / cand.search_radius +
+                         params_.descriptor_weight *
+                             cand.descriptor_distance.value_or(.0);
+
+            found.insert(id);
+            cands.push_back(cand);
+        });
+
+    // Appearance-only candidates:
+    if (q.descriptor && params_.appearance_candidates > 0)
+    {
+        const auto matches = descriptor_index_.query(
+            *q.descriptor, params_.appearance_candidates);
+
+        for (const auto& m : matches)
+        {
+            const id_t id = m.keyframe_id;
+            if (found.count(id) ||
+                m.distance > params_.max_descriptor_distance)
+                continue;
+
+            const KeyFrame& c = keyframes_.at(id);
+            if (q.path_length - c.path_length < params_.min_path_length)
+                continue;
+
+            Candidate cand           = lambdaCandidate(id, c);
+            cand.appearance_only     = true;
+            cand.descriptor_distance = m.distance;
+            cand.relative_pose = mrpt::math::TPose3D(0, 0, 0, m.yaw, 0, 0);
+            cand.score = 1.0 + params_.descriptor_weight * m.distance;
+
+            found.insert(id);
+            cands.push_back(cand);
+        }
+    }
+
+    std::sort(
+        cands.begin(), cands.end(),
+        [](const Candidate& a, const Candidate& b)
+        {
+            return a.score < b.score ||
+                   (a.score == b.score && a.candidate_kf < b.candidate_kf);
+        });
+    if (cands.size() > params_.max_candidates)
+        cands.resize(params_.max_candidates);
+
+    return cands;
+}
+
+std::vector<LoopClosureDetector::Candidate> LoopClosureDetector::detect(
+    id_t kf)
+{
+    auto cands = query(kf);
+    if (cands.empty()) return cands;
+
+    if (on_candidates) on_candidates(cands);
+
+    bool canVerify = false;
+    {
+        auto lck  = mrpt::lockHelper(mtx_);
+        canVerify = verifier || icp_;
+    }
+    if (canVerify)
+        for (const auto& c : cands) verifyAsync(c);
+
+    return cands;
+}
+
+std::future<LoopClosureDetector::Verification>
+    LoopClosureDetector::verifyAsync(const Candidate& c)
+{
+    verifier_t f;
+    {
+        auto lck = mrpt::lockHelper(mtx_);
+
+        if (verifier)
+            f = verifier;
+        else
+        {
+            ASSERTMSG_(icp_, "Neither a verifier nor ICP pipelines were set");
+
+            const auto   local = keyframes_.at(c.query_kf).local_map;
+            const auto   ref   = keyframes_.at(c.candidate_kf).local_map;
+            const double minQ  = params_.icp_minimum_quality;
+
+            f = [icp = icp_, local, ref, minQ](const Candidate& cand)
+            { return icp_verify(*icp, local, ref, minQ, cand); };
+        }
+        pending_verifications_++;
+    }
+
+    return verifier_pool_.enqueue(
+        0,
+        [this, f = std::move(f), c]()
+        {
+            // Decrement the counter even if the callback throws:
+            struct Done
+            {
+                LoopClosureDetector& self;
+                ~Done()
+                {
+                    {
+                        auto lck = mrpt::lockHelper(self.mtx_);
+                        self.pending_verifications_--;
+                    }
+                    self.cv_verifications_.notify_all();
+                }
+            } done{*this};
+
+            Verification v;
+            try
+            {
+                v = f(c);
+            }
+            catch (const std::exception& e)
+            {
+                v           = Verification();
+                v.error_msg = e.what();
+            }
+            v.candidate = c;
+
+            if (on_verified) on_verified(v);
+            return v;
+        });
+}
+
+void LoopClosureDetector::waitForVerifications()
+{
+    std::unique_lock<std::mutex> lck(mtx_);
+    cv_verifications_.wait(
+        lck, [this]() { return pending_verifications_ == 0; });
+}
+
+size_t LoopClosureDetector::pendingVerifications() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return pending_verifications_;
+}
+
+void LoopClosureDetector::setICP(
+    const std::vector<mp2p_icp::ICP::Ptr>& pipelines,
+    const mp2p_icp::Parameters&            icpParameters)
+{
+    ASSERT_(!pipelines.empty());
+    for (const auto& p : pipelines) ASSERT_(p);
+
+    auto ctx        = std::make_shared<ICPContext>();
+    ctx->pipelines  = pipelines;
+    ctx->busy       = std::vector<bool>(pipelines.size(), false);
+    ctx->parameters = icpParameters;
+
+    auto lck = mrpt::lockHelper(mtx_);
+    icp_     = std::move(ctx);
+}
+
+LoopClosureDetector::Verification LoopClosureDetector::icp_verify(
+    ICPContext& icp, const local_map_t& local, const local_map_t& reference,
+    double minimumQuality, const Candidate& c)
+{
+    Verification v;
+    if (!local || !reference)
+    {
+        v.error_msg = "Missing local map of the query or candidate keyframe";
+        return v;
+    }
+
+    // Take a free pipeline, since they are not reentrant:
+    size_t idx = 0;
+    {
+        std::unique_lock<std::mutex> lck(icp.mtx);
+        icp.cv.wait(
+            lck,
+            [&]()
+            { return std::find(icp.busy.begin(), icp.busy.end(), false) !=
+                     icp.busy.end(); });
+        idx = std::find(icp.busy.begin(), icp.busy.end(), false) -
+              icp.busy.begin();
+        icp.busy[idx] = true;
+    }
+    auto lambdaRelease = [&]()
+    {
+        {
+            auto lck      = mrpt::lockHelper(icp.mtx);
+            icp.busy[idx] = false;
+        }
+        icp.cv.notify_one();
+    };
+
+    mp2p_icp::Results r;
+    try
+    {
+        icp.pipelines[idx]->align(
+            *local, *reference, c.relative_pose, icp.parameters, r);
+    }
+    catch (...)
+    {
+        lambdaRelease();
+        throw;
+    }
+    lambdaRelease();
+
+    v.quality       = r.quality;
+    v.relative_pose = r.optimal_tf.mean.asTPose();
+    v.cov           = r.optimal_tf.cov;
+    v.accepted      = r.quality >= minimumQuality;
+    return v;
+}
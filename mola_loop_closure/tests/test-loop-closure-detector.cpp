@@ -0,0 +1,409 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-loop-closure-detector.cpp
+ * @brief  Precision/recall of loop closure candidates on synthetic loops
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/WorldModel.h>
+#include <mola_loop_closure/LoopClosureDetector.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/math/TPose2D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <vector>
+
+namespace
+{
+// A rounded rectangle, counterclockwise: straight sides of 100 and 60 m,
+// joined by quarter circles of 10 m radius.
+const double SIDE_A = 100.0, SIDE_B = 60.0, CORNER = 10.0;
+const double LAP    = 2 * (SIDE_A + SIDE_B) + 2 * M_PI * CORNER;
+
+// Ground truth pose after traveling `s` meters, `lateral` meters to the
+// left of the nominal path:
+mrpt::math::TPose2D loop_pose(double s, double lateral)
+{
+    double x = 0, y = 0, phi = 0;
+
+    s = std::fmod(s, LAP);
+    for (int side = 0; side < 4; side++)
+    {
+        const double len = (side % 2 == 0) ? SIDE_A : SIDE_B;
+        const double d   = std::min(s, len);
+        x += d * std::cos(phi);
+        y += d * std::sin(phi);
+        s -= d;
+        if (s <= 0) break;
+
+        const double a = std::min(s / CORNER, M_PI / 2);
+        x += CORNER * (std::sin(phi + a) - std::sin(phi));
+        y -= CORNER * (std::cos(phi + a) - std::cos(phi));
+        phi += a;
+        s -= a * CORNER;
+        if (s <= 0) break;
+    }
+    return {x - lateral * std::sin(phi), y + lateral * std::cos(phi), phi};
+}
+
+struct Pillar
+{
+    double x, y, height;
+};
+
+struct Dataset
+{
+    std::vector<mrpt::math::TPose2D>  ground_truth;
+    std::vector<mrpt::math::TPose3D>  odometry;  //!< Dead reckoning
+    std::vector<mola::ScanContext>    descriptors;
+    std::vector<std::set<mola::id_t>> true_loops;  //!< For each keyframe
+};
+
+// Keyframes every 2 m along several laps, each one 1 m further inside the
+// loop. Odometry has a heading bias, so its drift grows with the path.
+Dataset synthetic_dataset(size_t numLaps, double minPathLength)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    std::vector<Pillar> world;
+    for (int i = 0; i < 500; i++)
+        world.push_back(
+            {rng.drawUniform(-60.0, 160.0), rng.drawUniform(-60.0, 120.0),
+             rng.drawUniform(1.0, 10.0)});
+
+    // Coarse bins, since pillars are sparse:
+    mola::ScanContext::Parameters scp;
+    scp.num_rings   = 10;
+    scp.num_sectors = 30;
+    scp.max_range   = 40.0;
+
+    Dataset ds;
+
+    const double step = 2.0, maxLoopDistance = 5.0;
+    const auto   n    = static_cast<size_t>(numLaps * LAP / step);
+
+    mrpt::poses::CPose3D odom, lastGt;
+    for (size_t i = 0; i < n; i++)
+    {
+        const double s   = i * step;
+        const auto   lap = std::floor(s / LAP);
+        const auto   gt  = loop_pose(s, 1.0 * lap);
+        ds.ground_truth.push_back(gt);
+
+        const mrpt::poses::CPose3D gt3(gt.x, gt.y, 0, gt.phi, 0, 0);
+        if (i > 0)
+        {
+            const auto inc = (gt3 - lastGt).asTPose();
+            odom           = odom + mrpt::poses::CPose3D(
+                                  inc.x * (1 + rng.drawGaussian1D(0, 0.01)),
+                                  inc.y + rng.drawGaussian1D(0, 0.01), 0,
+                                  inc.yaw + 1e-3 + rng.drawGaussian1D(0, 1e-3),
+                                  0, 0);
+        }
+        lastGt = gt3;
+        ds.odometry.push_back(odom.asTPose());
+
+        // Pillars as seen from a sensor 1.8 m over the ground:
+        const double     c = std::cos(gt.phi), sn = std::sin(gt.phi);
+        std::vector<float> xs, ys, zs;
+        for (const auto& p : world)
+        {
+            const double dx = p.x - gt.x, dy = p.y - gt.y;
+            if (dx * dx + dy * dy > scp.max_range * scp.max_range) continue;
+            for (double z = 0; z <= p.height; z += 0.5)
+            {
+                xs.push_back(c * dx + sn * dy);
+                ys.push_back(-sn * dx + c * dy);
+                zs.push_back(z - 1.8);
+            }
+        }
+        ds.descriptors.push_back(mola::ScanContext::FromPoints(
+            xs.data(), ys.data(), zs.data(), xs.size(), scp));
+
+        auto& loops = ds.true_loops.emplace_back();
+        for (size_t j = 0; j < i; j++)
+        {
+            const auto& o = ds.ground_truth[j];
+            if (s - j * step >= minPathLength &&
+                std::hypot(o.x - gt.x, o.y - gt.y) <= maxLoopDistance)
+                loops.insert(j);
+        }
+    }
+    return ds;
+}
+
+struct Metrics
+{
+    size_t candidates = 0, true_positives = 0;
+    size_t loop_keyframes = 0, detected_loop_keyframes = 0;
+    double query_time     = 0;  //!< Average, [s]
+
+    double precision() const
+    {
+        return candidates ? 1.0 * true_positives / candidates : 1.0;
+    }
+    double recall() const
+    {
+        return loop_keyframes ? 1.0 * detected_loop_keyframes / loop_keyframes
+                              : 1.0;
+    }
+};
+
+Metrics evaluate(
+    const Dataset& ds, const mola::LoopClosureDetector::Parameters& p,
+    bool useDescriptors)
+{
+    mola::LoopClosureDetector lcd(p);
+
+    Metrics               m;
+    mrpt::system::CTicTac tictac;
+
+    for (size_t i = 0; i < ds.odometry.size(); i++)
+    {
+        std::optional<mola::ScanContext> desc;
+        if (useDescriptors) desc = ds.descriptors[i];
+        lcd.insertKeyFrame(i, ds.odometry[i], desc);
+
+        tictac.Tic();
+        const auto cands = lcd.query(i);
+        m.query_time += tictac.Tac();
+
+        size_t tp = 0;
+        for (const auto& c : cands)
+        {
+            ASSERT_EQUAL_(c.query_kf, i);
+            ASSERT_LT_(c.candidate_kf, i);
+            ASSERT_GE_(c.path_length, p.min_path_length);
+            tp += ds.true_loops[i].count(c.candidate_kf);
+        }
+        ASSERT_LE_(cands.size(), p.max_candidates);
+        for (size_t k = 1; k < cands.size(); k++)
+            ASSERT_LE_(cands[k - 1].score, cands[k].score);
+
+        m.candidates += cands.size();
+        m.true_positives += tp;
+        if (!ds.true_loops[i].empty())
+        {
+            m.loop_keyframes++;
+            if (tp > 0) m.detected_loop_keyframes++;
+        }
+    }
+    m.query_time /= ds.odometry.size();
+    return m;
+}
+
+void test_precision_recall()
+{
+    mola::LoopClosureDetector::Parameters p;
+    p.min_search_radius = 5.0;
+    p.drift_per_meter   = 0.04;
+    p.min_path_length   = 30.0;
+    p.max_candidates    = 3;
+
+    const auto ds = synthetic_dataset(3, p.min_path_length);
+
+    // Fixed search radius:
+    auto pFixed              = p;
+    pFixed.drift_per_meter   = 0;
+    pFixed.max_search_radius = p.min_search_radius;
+
+    // Appearance-only candidates, for drift beyond the search radius:
+    auto pAppearance                  = pFixed;
+    pAppearance.appearance_candidates = 2;
+
+    struct Config
+    {
+        const char*                           name;
+        mola::LoopClosureDetector::Parameters params;
+        bool                                  descriptors;
+    };
+    const Config configs[] = {
+        {"fixed radius", pFixed, false},
+        {"drift-aware radius", p, false},
+        {"fixed+descriptors", pFixed, true},
+        {"drift-aware+descriptors", p, true},
+        {"fixed+appearance", pAppearance, true},
+    };
+
+    std::vector<Metrics> ms;
+    for (const auto& c : configs)
+    {
+        const auto& m = ms.emplace_back(evaluate(ds, c.params, c.descriptors));
+
+        std::cout << mrpt::format(
+            "[lcd] %-24s keyframes=%u candidates=%5u precision=%.03f "
+            "recall=%.03f (%u/%u) query=%.02f us\n",
+            c.name, static_cast<unsigned>(ds.odometry.size()),
+            static_cast<unsigned>(m.candidates), m.precision(), m.recall(),
+            static_cast<unsigned>(m.detected_loop_keyframes),
+            static_cast<unsigned>(m.loop_keyframes), 1e6 * m.query_time);
+    }
+
+    // Drift goes beyond the fixed radius in the later laps:
+    ASSERT_GT_(ms[1].recall(), ms[0].recall());
+    ASSERT_GT_(ms[3].recall(), ms[2].recall() + 0.1);
+
+    // Larger radii bring in many more false candidates, which descriptors
+    // discard:
+    ASSERT_GT_(ms[3].precision(), ms[1].precision() + 0.3);
+    ASSERT_GT_(ms[3].precision(), 0.9);
+    ASSERT_GT_(ms[3].recall(), 0.8);
+
+    // Appearance-only candidates make up for a too small radius:
+    ASSERT_GT_(ms[4].recall(), ms[2].recall() + 0.3);
+    ASSERT_GT_(ms[4].precision(), 0.9);
+}
+
+void test_verification()
+{
+    mola::LoopClosureDetector::Parameters p;
+    p.drift_per_meter      = 0.05;
+    p.verification_threads = 3;
+
+    const auto ds = synthetic_dataset(2, p.min_path_length);
+
+    mola::LoopClosureDetector lcd(p);
+
+    std::atomic<size_t> numEmitted{0}, numVerified{0}, numAccepted{0};
+    std::atomic<size_t> numErrors{0};
+
+    lcd.on_candidates = [&](const auto& cands) { numEmitted += cands.size(); };
+    lcd.on_verified   = [&](const mola::LoopClosureVerification& v)
+    {
+        numVerified++;
+        if (v.accepted) numAccepted++;
+        if (v.error_msg) numErrors++;
+    };
+
+    // A stand-in for ICP: accept true loops only.
+    lcd.verifier = [&](const mola::LoopClosureCandidate& c)
+    {
+        if (c.candidate_kf % 50 == 0) throw std::runtime_error("ICP diverged");
+
+        const auto& a = ds.ground_truth[c.query_kf];
+        const auto& b = ds.ground_truth[c.candidate_kf];
+
+        mola::LoopClosureVerification v;
+        v.accepted = std::hypot(a.x - b.x, a.y - b.y) < 5.0;
+        v.quality  = v.accepted ? 1.0 : 0.0;
+        return v;
+    };
+
+    size_t numCandidates = 0, numTrue = 0;
+    for (size_t i = 0; i < ds.odometry.size(); i++)
+    {
+        lcd.insertKeyFrame(i, ds.odometry[i]);
+        for (const auto& c : lcd.detect(i))
+        {
+            numCandidates++;
+            if (c.candidate_kf % 50 != 0)
+                numTrue += ds.true_loops[i].count(c.candidate_kf);
+        }
+    }
+
+    ASSERT_GT_(numCandidates, 0U);
+    lcd.waitForVerifications();
+    ASSERT_EQUAL_(lcd.pendingVerifications(), 0U);
+    ASSERT_EQUAL_(numEmitted.load(), numCandidates);
+    ASSERT_EQUAL_(numVerified.load(), numCandidates);
+    ASSERT_EQUAL_(numAccepted.load(), numTrue);
+    ASSERT_GT_(numErrors.load(), 0U);
+
+    // Waiting for one verification:
+    const auto cands = lcd.query(ds.odometry.size() - 1);
+    ASSERT_(!cands.empty());
+    const auto v = lcd.verifyAsync(cands.front()).get();
+    ASSERT_EQUAL_(v.candidate.candidate_kf, cands.front().candidate_kf);
+
+    std::cout << "[lcd] verification: candidates=" << numCandidates
+              << " accepted=" << numAccepted << " errors=" << numErrors
+              << std::endl;
+}
+
+void test_world_model()
+{
+    mola::WorldModel wm;
+    wm.setMinLoggingLevel(mrpt::system::LVL_ERROR);
+    wm.initialize(mola::Yaml::FromText("params: {}"));
+
+    // A straight path, then back to the start:
+    std::vector<mola::id_t> kfs;
+    wm.entities_lock_for_write();
+    wm.entity_emplace_back(mola::RefPose3());
+    for (int i = 0; i < 40; i++)
+    {
+        mola::RelPose3KF kf;
+        kf.relpose_value = {i < 20 ? 2.0 * i : 2.0 * (39 - i), 0, 0, 0, 0, 0};
+        kfs.push_back(wm.entity_emplace_back(std::move(kf)));
+    }
+    wm.entities_unlock_for_write();
+
+    mola::LoopClosureDetector lcd;
+    ASSERT_(lcd.syncFromWorldModel(wm) == kfs);
+    ASSERT_EQUAL_(lcd.size(), kfs.size());
+
+    const auto cands = lcd.query(kfs.back());
+    ASSERT_(!cands.empty());
+    ASSERT_EQUAL_(cands.front().candidate_kf, kfs.front());
+    ASSERT_NEAR_(cands.front().distance, 0.0, 1e-9);
+
+    // An optimization moves the first keyframe away:
+    wm.entities_lock_for_write();
+    std::get<mola::RelPose3KF>(wm.entity_by_id(kfs.front()))
+        .relpose_value.y = 50.0;
+    wm.entities_unlock_for_write();
+
+    ASSERT_(lcd.syncFromWorldModel(wm).empty());
+    for (const auto& c : lcd.query(kfs.back()))
+        ASSERT_(c.candidate_kf != kfs.front());
+
+    lcd.clear();
+    ASSERT_EQUAL_(lcd.size(), 0U);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_precision_recall();
+        test_verification();
+        test_world_model();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
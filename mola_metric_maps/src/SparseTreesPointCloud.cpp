@@ -25,6 +25,7 @@
  * @date   Nov 11, 2023
  */
 
+#include <mola_kernel/FrameArena.h>
 #include <mola_metric_maps/SparseTreesPointCloud.h>
 #include <mrpt/config/CConfigFileBase.h>  // MRPT_LOAD_CONFIG_VAR
 #include <mrpt/maps/CSimplePointsMap.h>
@@ -923,13 +924,16 @@ void SparseTreesPointCloud::internal_insertPointCloud3D(
 
     if (!num_pts) return;
 
-    // Make a temporary buffer for transformed point cloud.
-    // I'll do it in the stack to save alloc & free time:
-    float*   gXs = reinterpret_cast<float*>(::alloca(sizeof(float) * num_pts));
-    float*   gYs = reinterpret_cast<float*>(::alloca(sizeof(float) * num_pts));
-    float*   gZs = reinterpret_cast<float*>(::alloca(sizeof(float) * num_pts));
-    uint8_t* doInsert =
-        reinterpret_cast<uint8_t*>(::alloca(sizeof(uint8_t) * num_pts));
+    // Temporary buffer for the transformed point cloud. It is created in the
+    // per-thread frame arena, to save alloc & free time (a plain alloca()
+    // may overflow the stack of worker threads):
+    struct TransformedPoint
+    {
+        mrpt::math::TPoint3Df pt;
+        bool                  insert;
+    };
+    mola::frame_vector<TransformedPoint> gPts(mola::frame_memory_resource());
+    gPts.reserve(num_pts);
 
     const float minSqrDist =
         mrpt::square(insertionOptions.minimum_points_clearance);
@@ -939,9 +943,6 @@ void SparseTreesPointCloud::internal_insertPointCloud3D(
         // Transform the point from the scan reference to its global 3D
         // position:
         const auto gPt = pc_in_map.composePoint({xs[i], ys[i], zs[i]});
-        gXs[i]         = gPt.x;
-        gYs[i]         = gPt.y;
-        gZs[i]         = gPt.z;
 
         // check for closest existing point:
         mrpt::math::TPoint3Df neig;
@@ -949,13 +950,13 @@ void SparseTreesPointCloud::internal_insertPointCloud3D(
         uint64_t              nnId;
         bool found = nn_single_search(gPt, neig, nnSqrDist, nnId);
 
-        doInsert[i] = (!found || nnSqrDist > minSqrDist) ? 1 : 0;
+        gPts.push_back({gPt, !found || nnSqrDist > minSqrDist});
     }
 
     // Insert *after* the loop above, to prevent having to rebuild the
     // KD-Tree "N" times (!!!)
-    for (std::size_t i = 0; i < num_pts; i++)
-        if (doInsert[i]) insertPoint({gXs[i], gYs[i], gZs[i]});
+    for (const auto& p : gPts)
+        if (p.insert) insertPoint(p.pt);
 
     MRPT_TRY_END
 }
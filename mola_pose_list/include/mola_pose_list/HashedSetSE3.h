@@ -29,11 +29,19 @@
 #include <mrpt/core/round.h>
 #include <mrpt/math/TPose3D.h>
 
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <unordered_map>
+#include <vector>
 
 namespace mola
 {
 /** HashedSetSE3: a sparse hashed lattice of SE(3) poses
+ *
+ * Besides exact voxel lookup, neighborhood queries are provided by
+ * posesWithinRadius() and kNearestPoses(), which visit the voxels in shells of
+ * growing size around the query translation.
  */
 class HashedSetSE3
 {
@@ -100,16 +108,58 @@ class HashedSetSE3
 
     using pose_vector_t = std::vector<mrpt::math::TPose3D>;
 
+    /// Optional user ID stored along each pose, see insertPose()
+    using pose_id_t = uint64_t;
+
+    static constexpr pose_id_t INVALID_POSE_ID =
+        std::numeric_limits<pose_id_t>::max();
+
     struct VoxelData
     {
        public:
         VoxelData() = default;
 
-        auto poses() const { return poses_; }
-        void insertPose(const mrpt::math::TPose3D& p) { poses_.push_back(p); }
+        /// Read-only, copy-free view of the poses in a voxel
+        class PoseSpan
+        {
+           public:
+            PoseSpan(const mrpt::math::TPose3D* data, size_t n)
+                : data_(data), n_(n)
+            {
+            }
+
+            size_t size() const { return n_; }
+            bool   empty() const { return n_ == 0; }
+
+            const mrpt::math::TPose3D& operator[](size_t i) const
+            {
+                return data_[i];
+            }
+            const mrpt::math::TPose3D* begin() const { return data_; }
+            const mrpt::math::TPose3D* end() const { return data_ + n_; }
+
+           private:
+            const mrpt::math::TPose3D* data_;
+            const size_t               n_;
+        };
+
+        auto poses() const -> PoseSpan
+        {
+            return PoseSpan(poses_.data(), poses_.size());
+        }
+        /// The ID of the i-th pose in poses()
+        pose_id_t id(size_t i) const { return ids_[i]; }
+
+        void insertPose(
+            const mrpt::math::TPose3D& p, pose_id_t id = INVALID_POSE_ID)
+        {
+            poses_.push_back(p);
+            ids_.push_back(id);
+        }
 
        private:
-        pose_vector_t poses_;
+        pose_vector_t          poses_;
+        std::vector<pose_id_t> ids_;
     };
 
     using grids_map_t = std::unordered_map<
@@ -139,10 +189,10 @@ class HashedSetSE3
         auto it = voxels_.find(idx);
         if (it == voxels_.end())
         {
-            if (!createIfNew)
-                return nullptr;
-            else
-                voxel = &voxels_[idx];  // Create it
+            if (!createIfNew) return nullptr;
+
+            voxel = &voxels_[idx];  // Create it
+            translationIndex_[{idx.cx, idx.cy, idx.cz, 0, 0, 0}].push_back(idx);
         }
         else
         {
@@ -173,8 +223,10 @@ class HashedSetSE3
         return const_cast<HashedSetSE3*>(this)->voxelByCoords(pt, false);
     }
 
-    /** Insert one pose into the lattice */
-    void insertPose(const mrpt::math::TPose3D& pt);
+    /** Insert one pose into the lattice, optionally with a user ID that
+     * is handed back by visitPosesWithinRadius() */
+    void insertPose(
+        const mrpt::math::TPose3D& pt, pose_id_t id = INVALID_POSE_ID);
 
     const grids_map_t& voxels() const { return voxels_; }
 
@@ -185,6 +237,33 @@ class HashedSetSE3
         const std::function<void(const global_index3d_t&, const VoxelData&)>& f)
         const;
 
+    /** Returns all poses with a translation within `radius` [m] of `p`, and
+     * a rotation within `angular_tolerance` [rad] of that of `p`, measured as
+     * the angle of the relative rotation.
+     */
+    std::vector<mrpt::math::TPose3D> posesWithinRadius(
+        const mrpt::math::TPose3D& p, double radius,
+        double angular_tolerance = M_PI) const;
+
+    /** Like posesWithinRadius(), but invokes `f` with each pose and its ID
+     * instead of copying them into a vector. */
+    void visitPosesWithinRadius(
+        const mrpt::math::TPose3D& p, double radius, double angular_tolerance,
+        const std::function<void(const mrpt::math::TPose3D&, pose_id_t)>& f)
+        const;
+
+    /** Returns the (up to) `k` poses closest to `p`, sorted by ascending
+     * distance, using the SE(3) metric:
+     *
+     *  d^2 = |Δt|^2 + (rotation_weight * Δθ)^2
+     *
+     * with Δt the translation difference [m] and Δθ the angle [rad] of the
+     * relative rotation.
+     */
+    std::vector<mrpt::math::TPose3D> kNearestPoses(
+        const mrpt::math::TPose3D& p, size_t k,
+        double rotation_weight = 1.0) const;
+
     /** Save to a text file. Each line contains "X Y Z YAW PITCH ROLL".
      *  Returns false if any error occured, true elsewere.
      */
@@ -206,6 +285,21 @@ class HashedSetSE3
 
     /** Voxel map as a set of fixed-size grids */
     grids_map_t voxels_;
+
+    /** Index of voxels_ by their translation part only, for the
+     * neighborhood queries. Angular indices are always 0 in the keys. */
+    std::unordered_map<
+        global_index3d_t, std::vector<global_index3d_t>,
+        index_se3_t_hash<int32_t>>
+        translationIndex_;
+
+    global_index3d_t translationIdx(double x, double y, double z) const
+    {
+        return global_index3d_t(
+            static_cast<int32_t>(x * voxel_xyz_size_inv_),
+            static_cast<int32_t>(y * voxel_xyz_size_inv_),
+            static_cast<int32_t>(z * voxel_xyz_size_inv_), 0, 0, 0);
+    }
 };
 
 }  // namespace mola
@@ -0,0 +1,139 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   PoseClustering.h
+ * @brief  Incremental clustering of redundant SE(3) keyframe poses
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_pose_list/HashedSetSE3.h>
+#include <mrpt/math/CQuaternion.h>
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace mola
+{
+/** Incremental clustering of SE(3) poses, e.g. to find and summarize
+ * redundant keyframes of long-term mapping sessions revisiting the same
+ * places.
+ *
+ * Two poses are *neighbors* if their translations are within
+ * `max_translation` [m] and the angle of their relative rotation is below
+ * `max_rotation` [rad]. Clusters are the connected components of that
+ * neighborhood relation (single linkage), maintained with a union-find
+ * structure as poses are inserted. Neighbor search only visits the 27
+ * translation cells (of size `max_translation`) around each new pose,
+ * hashed as in HashedSetSE3.
+ *
+ * Poses are identified by their insertion order, starting at 0.
+ *
+ * \ingroup mola_pose_list_grp
+ */
+class PoseClustering
+{
+   public:
+    using pose_id_t = uint32_t;
+
+    PoseClustering(
+        double max_translation = 1.0,
+        double max_rotation    = mrpt::DEG2RAD(15.0));
+
+    /** Reset the thresholds, and *clears* all current contents */
+    void setThresholds(double max_translation, double max_rotation);
+
+    void clear();
+
+    size_t size() const { return poses_.size(); }
+    bool   empty() const { return poses_.empty(); }
+
+    /// Current number of clusters. O(1)
+    size_t numClusters() const { return numClusters_; }
+
+    /** Adds a new pose, merging it with the clusters of all its neighbors.
+     * Amortized cost is proportional to the number of poses in the nearby
+     * cells. Returns its ID.
+     */
+    pose_id_t insert(const mrpt::math::TPose3D& p);
+
+    const mrpt::math::TPose3D& pose(pose_id_t id) const
+    {
+        return poses_.at(id);
+    }
+
+    /** Returns an ID identifying the cluster of the given pose, the same for
+     * all its members. It may change after new insertions merge clusters.
+     */
+    pose_id_t clusterOf(pose_id_t id) const;
+
+    struct Cluster
+    {
+        /// The member closest to the mean translation of the cluster
+        pose_id_t representative = 0;
+
+        /// All members, in ascending order
+        std::vector<pose_id_t> members;
+    };
+
+    /** Returns all current clusters, sorted by their first member. O(N) */
+    std::vector<Cluster> clusters() const;
+
+   private:
+    double max_translation_ = 1.0;
+    double max_rotation_    = mrpt::DEG2RAD(15.0);
+
+    // Calculated from the above, in setThresholds()
+    double cell_size_inv_ = 1.0;
+    double min_cos_half_  = 1.0;  //!< cos(max_rotation_/2)
+
+    std::vector<mrpt::math::TPose3D>           poses_;
+    std::vector<mrpt::math::CQuaternionDouble> quats_;
+
+    // Union-find:
+    mutable std::vector<pose_id_t> parent_;
+    std::vector<pose_id_t>         clusterSize_;
+    size_t                         numClusters_ = 0;
+
+    pose_id_t find(pose_id_t id) const;
+    void      unite(pose_id_t a, pose_id_t b);
+
+    /// Pose IDs by translation cell. Angular indices are always 0.
+    std::unordered_map<
+        HashedSetSE3::global_index3d_t, std::vector<pose_id_t>,
+        index_se3_t_hash<int32_t>>
+        cells_;
+
+    HashedSetSE3::global_index3d_t cellIndex(const mrpt::math::TPose3D& p) const
+    {
+        return {
+            static_cast<int32_t>(std::floor(p.x * cell_size_inv_)),
+            static_cast<int32_t>(std::floor(p.y * cell_size_inv_)),
+            static_cast<int32_t>(std::floor(p.z * cell_size_inv_)),
+            0,
+            0,
+            0};
+    }
+};
+
+}  // namespace mola
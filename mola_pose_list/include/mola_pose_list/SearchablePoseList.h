@@ -28,11 +28,23 @@
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/poses/CPose3D.h>
 
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
 namespace mola
 {
 /** Data structure to search for nearby SE(3) poses.
  *
- *  It uses a KD-tree for the search.
+ * Poses are kept in a sparse hashed grid of cubic cells over their
+ * translation, so inserting one pose is O(1) (amortized) and never triggers
+ * rebuilding any index. Queries visit cells in rings of increasing size
+ * around the query, stopping as soon as no unvisited cell can hold a closer
+ * pose, hence their cost depends on the local density of poses, not on the
+ * total number of them.
  *
  * \ingroup mola_pose_list_grp
  */
@@ -51,10 +63,10 @@ class SearchablePoseList
         if (from_last_only_)  //
             return last_kf_ == mrpt::poses::CPose3D::Identity();
         else
-            return kf_poses_.empty();
+            return count_ == 0;
     }
 
-    size_t size() const { return from_last_only_ ? 1 : kf_poses_.size(); }
+    size_t size() const { return from_last_only_ ? 1 : count_; }
 
     void insert(const mrpt::poses::CPose3D& p)
     {
@@ -64,11 +76,15 @@ class SearchablePoseList
         }
         else
         {
-            kf_points_.insertPoint(p.translation());
-            kf_poses_.push_back(p);
+            cells_[cellIndex(p.x(), p.y(), p.z())].push_back(p);
+            count_++;
         }
     }
 
+    /** Finds the closest pose to `p`, using the heuristic SE(3) metric
+     * d_t^2 + d_R^2, with d_t the translation distance [m] and d_R the
+     * rotation angle [rad], and returns `p - closest`.
+     */
     [[nodiscard]] std::tuple<
         bool /*isFirst*/, mrpt::poses::CPose3D /*distanceToClosest*/>
         check(const mrpt::poses::CPose3D& p) const;
@@ -76,13 +92,64 @@ class SearchablePoseList
     void removeAllFartherThan(
         const mrpt::poses::CPose3D& p, const double maxTranslation);
 
+    void clear()
+    {
+        last_kf_ = mrpt::poses::CPose3D::Identity();
+        cells_.clear();
+        count_ = 0;
+    }
+
+    /** Edge length [m] of the cubic cells of the spatial index. Should be in
+     * the order of the distance between consecutive keyframes.
+     * Changing it re-inserts all existing poses.
+     */
+    void setCellSize(double cellSize);
+
+    double cellSize() const { return cell_size_; }
+
+    void visitAllPoses(
+        const std::function<void(const mrpt::poses::CPose3D&)>& f) const;
+
    private:
     // if from_last_only_==true
     mrpt::poses::CPose3D last_kf_ = mrpt::poses::CPose3D::Identity();
 
     // if from_last_only_==false
-    std::deque<mrpt::poses::CPose3D> kf_poses_;
-    mrpt::maps::CSimplePointsMap     kf_points_;
+    struct cell_index_t
+    {
+        int32_t cx = 0, cy = 0, cz = 0;
+
+        bool operator==(const cell_index_t& o) const noexcept
+        {
+            return cx == o.cx && cy == o.cy && cz == o.cz;
+        }
+    };
+    struct cell_index_hash
+    {
+        std::size_t operator()(const cell_index_t& k) const noexcept
+        {
+            // Large primes, as in Teschner et al. (2003):
+            return (static_cast<std::size_t>(k.cx) * 73856093) ^
+                   (static_cast<std::size_t>(k.cy) * 19349663) ^
+                   (static_cast<std::size_t>(k.cz) * 83492791);
+        }
+    };
+
+    cell_index_t cellIndex(double x, double y, double z) const
+    {
+        return {
+            static_cast<int32_t>(std::floor(x * cell_size_inv_)),
+            static_cast<int32_t>(std::floor(y * cell_size_inv_)),
+            static_cast<int32_t>(std::floor(z * cell_size_inv_))};
+    }
+
+    std::unordered_map<
+        cell_index_t, std::vector<mrpt::poses::CPose3D>, cell_index_hash>
+        cells_;
+
+    size_t count_         = 0;
+    double cell_size_     = 5.0;
+    double cell_size_inv_ = 1.0 / cell_size_;
 
     bool from_last_only_ = false;
 };
@@ -69,7 +69,12 @@ std::ostream& operator<<(std::ostream& o, const index_se3_t<cell_coord_t>& idx)
     return o;
 }
 
-/** This implements a hash for index_se3_t
+/** This implements a hash for index_se3_t, extending to 6 dimensions the
+ * spatial hash in:
+ *
+ *  Teschner, M., Heidelberger, B., Müller, M., Pomerantes, D., & Gross, M. H.
+ * (2003, November). Optimized spatial hashing for collision detection of
+ * deformable objects. In Vmv (Vol. 3, pp. 47-54).
  *
  */
 template <typename cell_coord_t = int32_t>
@@ -78,15 +83,12 @@ struct index_se3_t_hash
     /// Hash operator for unordered maps:
     std::size_t operator()(const index_se3_t<cell_coord_t>& k) const noexcept
     {
-        std::hash<cell_coord_t> h;
-        std::size_t             ret = 0;
-        ret ^= h(k.cx) | 1;
-        ret ^= h(k.cy) | 2;
-        ret ^= h(k.cz) | 3;
-        ret ^= h(k.cyaw) | 4;
-        ret ^= h(k.cpitch) | 5;
-        ret ^= h(k.croll) | 6;
-        return ret;
+        const auto h = [](cell_coord_t c, std::size_t prime)
+        { return static_cast<std::size_t>(c) * prime; };
+
+        return h(k.cx, 73856093) ^ h(k.cy, 19349663) ^ h(k.cz, 83492791) ^
+               h(k.cyaw, 25165843) ^ h(k.cpitch, 50331653) ^
+               h(k.croll, 100663319);
     }
 };
 
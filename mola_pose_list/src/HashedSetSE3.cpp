@@ -26,10 +26,39 @@
  */
 
 #include <mola_pose_list/HashedSetSE3.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/Lie/SO.h>
 #include <mrpt/system/os.h>
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <queue>
 
 using namespace mola;
 
+namespace
+{
+// Angle of the rotation Ra^T * Rb:
+double rotation_angle(
+    const mrpt::math::CMatrixDouble33& Ra,
+    const mrpt::math::CMatrixDouble33& Rb)
+{
+    return mrpt::poses::Lie::SO<3>::log(
+               mrpt::math::CMatrixDouble33(Ra.asEigen().transpose() *
+                                           Rb.asEigen()))
+        .norm();
+}
+
+double sqr_translation(
+    const mrpt::math::TPose3D& a, const mrpt::math::TPose3D& b)
+{
+    return mrpt::square(a.x - b.x) + mrpt::square(a.y - b.y) +
+           mrpt::square(a.z - b.z);
+}
+}  // namespace
+
 // VoxelData
 
 // Ctor:
@@ -66,6 +95,7 @@ void HashedSetSE3::clear()
 {
     //
     voxels_.clear();
+    translationIndex_.clear();
 }
 
 bool HashedSetSE3::empty() const
@@ -88,10 +118,10 @@ bool HashedSetSE3::saveToTextFile(const std::string& file) const
     return true;
 }
 
-void HashedSetSE3::insertPose(const mrpt::math::TPose3D& p)
+void HashedSetSE3::insertPose(const mrpt::math::TPose3D& p, pose_id_t id)
 {
     auto& v = *voxelByCoords(p, true /*create if new*/);
-    v.insertPose(p);
+    v.insertPose(p, id);
 }
 
 void HashedSetSE3::visitAllPoses(
@@ -108,3 +138,159 @@ void HashedSetSE3::visitAllVoxels(
 {
     for (const auto& [idx, v] : voxels_) f(idx, v);
 }
+
+std::vector<mrpt::math::TPose3D> HashedSetSE3::posesWithinRadius(
+    const mrpt::math::TPose3D& p, double radius, double angular_tolerance) const
+{
+    std::vector<mrpt::math::TPose3D> found;
+    visitPosesWithinRadius(
+        p, radius, angular_tolerance,
+        [&](const mrpt::math::TPose3D& c, pose_id_t) { found.push_back(c); });
+    return found;
+}
+
+void HashedSetSE3::visitPosesWithinRadius(
+    const mrpt::math::TPose3D& p, double radius, double angular_tolerance,
+    const std::function<void(const mrpt::math::TPose3D&, pose_id_t)>& f) const
+{
+    const double sqrRadius = mrpt::square(radius);
+    const auto   Rq        = mrpt::poses::CPose3D(p).getRotationMatrix();
+
+    const auto lambdaVisitVoxels =
+        [&](const std::vector<global_index3d_t>& idxs)
+    {
+        for (const auto& idx : idxs)
+        {
+            const auto* v     = voxelByGlobalIdxs(idx);
+            const auto  poses = v->poses();
+            for (size_t i = 0; i < poses.size(); i++)
+            {
+                const auto& c = poses[i];
+                if (sqr_translation(p, c) > sqrRadius) continue;
+                const auto Rc = mrpt::poses::CPose3D(c).getRotationMatrix();
+                if (rotation_angle(Rq, Rc) > angular_tolerance) continue;
+                f(c, v->id(i));
+            }
+        }
+    };
+
+    // Box of translation cells to visit:
+    const auto lo = translationIdx(p.x - radius, p.y - radius, p.z - radius);
+    const auto hi = translationIdx(p.x + radius, p.y + radius, p.z + radius);
+
+    const double boxCells = double(hi.cx - lo.cx + 1) *
+                            double(hi.cy - lo.cy + 1) *
+                            double(hi.cz - lo.cz + 1);
+
+    if (boxCells > translationIndex_.size())
+    {
+        // Cheaper to visit them all:
+        for (const auto& [tIdx, idxs] : translationIndex_)
+            lambdaVisitVoxels(idxs);
+        return;
+    }
+
+    for (int32_t cz = lo.cz; cz <= hi.cz; cz++)
+        for (int32_t cy = lo.cy; cy <= hi.cy; cy++)
+            for (int32_t cx = lo.cx; cx <= hi.cx; cx++)
+            {
+                const auto it = translationIndex_.find({cx, cy, cz, 0, 0, 0});
+                if (it != translationIndex_.end())
+                    lambdaVisitVoxels(it->second);
+            }
+}
+
+std::vector<mrpt::math::TPose3D> HashedSetSE3::kNearestPoses(
+    const mrpt::math::TPose3D& p, size_t k, double rotation_weight) const
+{
+    std::vector<mrpt::math::TPose3D> found;
+    if (k == 0 || voxels_.empty()) return found;
+
+    const auto Rq = mrpt::poses::CPose3D(p).getRotationMatrix();
+
+    // max-heap with the k best (squared distance, pose) so far:
+    using entry_t = std::pair<double, mrpt::math::TPose3D>;
+    const auto lambdaCmp = [](const entry_t& a, const entry_t& b)
+    { return a.first < b.first; };
+    std::priority_queue<entry_t, std::vector<entry_t>, decltype(lambdaCmp)>
+        best(lambdaCmp);
+
+    const auto lambdaVisitVoxels =
+        [&](const std::vector<global_index3d_t>& idxs)
+    {
+        for (const auto& idx : idxs)
+        {
+            const auto* v = voxelByGlobalIdxs(idx);
+            for (const auto& c : v->poses())
+            {
+                double d = sqr_translation(p, c);
+                // The rotation part can only make it larger:
+                if (best.size() == k && d >= best.top().first) continue;
+
+                const auto Rc = mrpt::poses::CPose3D(c).getRotationMatrix();
+                d += mrpt::square(rotation_weight * rotation_angle(Rq, Rc));
+
+                if (best.size() < k)
+                    best.emplace(d, c);
+                else if (d < best.top().first)
+                {
+                    best.pop();
+                    best.emplace(d, c);
+                }
+            }
+        }
+    };
+
+    const auto q = translationIdx(p.x, p.y, p.z);
+
+    // Visit shells of translation cells at Chebyshev distance r=0,1,2...
+    // Once shell r is done, no unvisited pose can be closer than
+    // r*voxel_xyz_size_ in translation (cells are never narrower than that).
+    // If the number of lookups would exceed the number of existing cells
+    // (sparse poses, far from the query), just visit all of them.
+    size_t lookups = 0;
+    for (int32_t r = 0;; r++)
+    {
+        const size_t side  = 2 * r + 1;
+        const size_t shell = r == 0 ? 1
+                                    : side * side * side -
+                                          (side - 2) * (side - 2) * (side - 2);
+        if (lookups + shell > translationIndex_.size())
+        {
+            while (!best.empty()) best.pop();
+            for (const auto& [tIdx, idxs] : translationIndex_)
+                lambdaVisitVoxels(idxs);
+            break;
+        }
+        lookups += shell;
+
+        for (int32_t dz = -r; dz <= r; dz++)
+        {
+            for (int32_t dy = -r; dy <= r; dy++)
+            {
+                const bool onFace = std::abs(dz) == r || std::abs(dy) == r;
+                for (int32_t dx = -r; dx <= r; dx += onFace ? 1 : 2 * r)
+                {
+                    const auto it = translationIndex_.find(
+                        {q.cx + dx, q.cy + dy, q.cz + dz, 0, 0, 0});
+                    if (it != translationIndex_.end())
+                        lambdaVisitVoxels(it->second);
+
+                    if (r == 0) break;
+                }
+            }
+        }
+
+        if (best.size() == k &&
+            best.top().first <= mrpt::square(r * voxel_xyz_size_))
+            break;
+    }
+
+    found.resize(best.size());
+    for (size_t i = found.size(); i > 0; i--)
+    {
+        found[i - 1] = best.top().second;
+        best.pop();
+    }
+    return found;
+}
@@ -0,0 +1,199 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   PoseClustering.cpp
+ * @brief  Incremental clustering of redundant SE(3) keyframe poses
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_pose_list/PoseClustering.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace mola;
+
+PoseClustering::PoseClustering(double max_translation, double max_rotation)
+{
+    setThresholds(max_translation, max_rotation);
+}
+
+void PoseClustering::setThresholds(double max_translation, double max_rotation)
+{
+    ASSERT_GT_(max_translation, .0);
+    ASSERT_GE_(max_rotation, .0);
+
+    max_translation_ = max_translation;
+    max_rotation_    = max_rotation;
+
+    // calculated fields:
+    cell_size_inv_ = 1.0 / max_translation_;
+    min_cos_half_  = std::cos(0.5 * std::min(max_rotation_, M_PI));
+
+    // clear all:
+    this->clear();
+}
+
+void PoseClustering::clear()
+{
+    poses_.clear();
+    quats_.clear();
+    parent_.clear();
+    clusterSize_.clear();
+    cells_.clear();
+    numClusters_ = 0;
+}
+
+PoseClustering::pose_id_t PoseClustering::find(pose_id_t id) const
+{
+    // Path halving:
+    while (parent_[id] != id)
+    {
+        parent_[id] = parent_[parent_[id]];
+        id          = parent_[id];
+    }
+    return id;
+}
+
+void PoseClustering::unite(pose_id_t a, pose_id_t b)
+{
+    a = find(a);
+    b = find(b);
+    if (a == b) return;
+
+    // Union by size:
+    if (clusterSize_[a] < clusterSize_[b]) std::swap(a, b);
+    parent_[b] = a;
+    clusterSize_[a] += clusterSize_[b];
+    numClusters_--;
+}
+
+PoseClustering::pose_id_t PoseClustering::insert(const mrpt::math::TPose3D& p)
+{
+    ASSERT_LT_(poses_.size(), std::numeric_limits<pose_id_t>::max());
+
+    const auto id = static_cast<pose_id_t>(poses_.size());
+
+    mrpt::math::CQuaternionDouble q;
+    mrpt::poses::CPose3D(p).getAsQuaternion(q);
+
+    poses_.push_back(p);
+    quats_.push_back(q);
+    parent_.push_back(id);
+    clusterSize_.push_back(1);
+    numClusters_++;
+
+    const double maxSqrDist = mrpt::square(max_translation_);
+    const auto   c          = cellIndex(p);
+
+    // Cells have the size of the translation threshold, so all neighbors are
+    // within the 3x3x3 block around the new pose:
+    for (int32_t dz = -1; dz <= 1; dz++)
+        for (int32_t dy = -1; dy <= 1; dy++)
+            for (int32_t dx = -1; dx <= 1; dx++)
+            {
+                const auto it =
+                    cells_.find({c.cx + dx, c.cy + dy, c.cz + dz, 0, 0, 0});
+                if (it == cells_.end()) continue;
+
+                for (const pose_id_t other : it->second)
+                {
+                    const auto&  o = poses_[other];
+                    const double d = mrpt::square(o.x - p.x) +
+                                     mrpt::square(o.y - p.y) +
+                                     mrpt::square(o.z - p.z);
+                    if (d > maxSqrDist) continue;
+
+                    // Relative rotation angle θ, from cos(θ/2) = |q1·q2|:
+                    const auto&  qo      = quats_[other];
+                    const double cosHalf = std::abs(
+                        q[0] * qo[0] + q[1] * qo[1] + q[2] * qo[2] +
+                        q[3] * qo[3]);
+                    if (cosHalf < min_cos_half_) continue;
+
+                    unite(id, other);
+                }
+            }
+
+    cells_[c].push_back(id);
+
+    return id;
+}
+
+PoseClustering::pose_id_t PoseClustering::clusterOf(pose_id_t id) const
+{
+    ASSERT_LT_(id, parent_.size());
+    return find(id);
+}
+
+std::vector<PoseClustering::Cluster> PoseClustering::clusters() const
+{
+    // Map from root ID to index in the output:
+    constexpr auto         NONE = std::numeric_limits<pose_id_t>::max();
+    std::vector<pose_id_t> rootToCluster(poses_.size(), NONE);
+    std::vector<Cluster>   ret;
+    ret.reserve(numClusters_);
+
+    for (pose_id_t id = 0; id < poses_.size(); id++)
+    {
+        auto& idx = rootToCluster[find(id)];
+        if (idx == NONE)
+        {
+            idx = static_cast<pose_id_t>(ret.size());
+            ret.emplace_back();
+        }
+        ret[idx].members.push_back(id);
+    }
+
+    // Representatives:
+    for (auto& cl : ret)
+    {
+        double mx = 0, my = 0, mz = 0;
+        for (const auto id : cl.members)
+        {
+            mx += poses_[id].x;
+            my += poses_[id].y;
+            mz += poses_[id].z;
+        }
+        const double n = static_cast<double>(cl.members.size());
+        mx /= n;
+        my /= n;
+        mz /= n;
+
+        double bestSqrDist = std::numeric_limits<double>::max();
+        for (const auto id : cl.members)
+        {
+            const auto&  p = poses_[id];
+            const double d = mrpt::square(p.x - mx) + mrpt::square(p.y - my) +
+                             mrpt::square(p.z - mz);
+            if (d < bestSqrDist)
+            {
+                bestSqrDist       = d;
+                cl.representative = id;
+            }
+        }
+    }
+
+    return ret;
+}
@@ -25,8 +25,13 @@
  */
 
 #include <mola_pose_list/SearchablePoseList.h>
+#include <mrpt/core/exceptions.h>
 #include <mrpt/poses/Lie/SO.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <optional>
+
 using namespace mola;
 
 std::tuple<bool /*isFirst*/, mrpt::poses::CPose3D /*distanceToClosest*/>
@@ -39,43 +44,80 @@ std::tuple<bool /*isFirst*/, mrpt::poses::CPose3D /*distanceToClosest*/>
     if (from_last_only_)
     {  //
         distanceToClosest = p - last_kf_;
+        return {isFirst, distanceToClosest};
     }
-    else
-    {
-        ASSERT_EQUAL_(kf_poses_.size(), kf_points_.size());
-
-        std::vector<mrpt::math::TPoint3Df> closest;
-        std::vector<float>                 closestSqrDist;
-        std::vector<uint64_t>              closestID;
 
-        kf_points_.nn_multiple_search(
-            p.translation().cast<float>(), 20, closest, closestSqrDist,
-            closestID);
-        ASSERT_(!closest.empty());  // empty()==false from check above
+    // Check for both, rotation and translation.
+    // Use a heuristic SE(3) metric to merge both parts:
+    constexpr double ROTATION_WEIGHT = 1.0;
 
-        // Check for both, rotation and translation.
-        // Use a heuristic SE(3) metric to merge both parts:
-        constexpr double ROTATION_WEIGHT = 1.0;
+    const mrpt::poses::CPose3D* best        = nullptr;
+    double                      bestSqrDist = 0;
 
-        std::optional<size_t> bestIdx;
-
-        for (size_t i = 0; i < closest.size(); i++)
+    const auto lambdaVisitCell = [&](const std::vector<mrpt::poses::CPose3D>& v)
+    {
+        for (const auto& candidate : v)
         {
-            const auto&  candidate = kf_poses_.at(closestID.at(i));
-            const double rot       = mrpt::poses::Lie::SO<3>::log(
-                                         (p - candidate).getRotationMatrix())
+            double d = (candidate.translation() - p.translation()).sqrNorm();
+            // The rotation part only adds to the distance:
+            if (best && d >= bestSqrDist) continue;
+
+            const double rot = mrpt::poses::Lie::SO<3>::log(
+                                   (p - candidate).getRotationMatrix())
                                    .norm();
+            d += ROTATION_WEIGHT * mrpt::square(rot);
+
+            if (!best || d < bestSqrDist)
+            {
+                best        = &candidate;
+                bestSqrDist = d;
+            }
+        }
+    };
 
-            closestSqrDist[i] += ROTATION_WEIGHT * mrpt::square(rot);
+    const auto c = cellIndex(p.x(), p.y(), p.z());
 
-            if (!bestIdx || closestSqrDist[i] < closestSqrDist[*bestIdx])
-                bestIdx = i;
+    // Visit rings of cells at Chebyshev distance r=0,1,2... from the query
+    // cell. Once ring r is done, no unvisited pose can be closer than
+    // r*cell_size_ in translation.
+    // If the number of cell lookups would exceed the number of existing
+    // cells (sparse poses, far from the query), just visit all of them.
+    size_t lookups = 0;
+    for (int32_t r = 0;; r++)
+    {
+        const size_t side      = 2 * r + 1;
+        const size_t ringCells = r == 0 ? 1 : side * side * side -
+                                                  (side - 2) * (side - 2) *
+                                                      (side - 2);
+        if (lookups + ringCells > cells_.size())
+        {
+            best = nullptr;
+            for (const auto& [idx, v] : cells_) lambdaVisitCell(v);
+            break;
         }
+        lookups += ringCells;
 
-        const auto& closestPose = kf_poses_.at(closestID.at(*bestIdx));
+        for (int32_t dz = -r; dz <= r; dz++)
+        {
+            for (int32_t dy = -r; dy <= r; dy++)
+            {
+                const bool onFace = std::abs(dz) == r || std::abs(dy) == r;
+                for (int32_t dx = -r; dx <= r; dx += onFace ? 1 : 2 * r)
+                {
+                    const auto it =
+                        cells_.find({c.cx + dx, c.cy + dy, c.cz + dz});
+                    if (it != cells_.end()) lambdaVisitCell(it->second);
+
+                    if (r == 0) break;
+                }
+            }
+        }
 
-        distanceToClosest = p - closestPose;
+        if (best && bestSqrDist <= mrpt::square(r * cell_size_)) break;
     }
+    ASSERT_(best != nullptr);  // empty()==false from check above
+
+    distanceToClosest = p - *best;
 
     return {isFirst, distanceToClosest};
 }
@@ -85,23 +127,73 @@ void SearchablePoseList::removeAllFartherThan(
 {
     if (from_last_only_) return;  // not applicable
 
-    std::deque<mrpt::poses::CPose3D> new_kf_poses;
-    mrpt::maps::CSimplePointsMap     new_kf_points;
-
     const double maxSqrDist = mrpt::square(maxTranslation);
     const auto   c          = p.translation();
 
-    for (size_t i = 0; i < kf_poses_.size(); i++)
+    for (auto it = cells_.begin(); it != cells_.end();)
+    {
+        auto& v = it->second;
+
+        // Whole-cell tests, with the nearest and farthest cell corners:
+        double nearSqr = 0, farSqr = 0;
+        for (const auto& [ci, x] :
+             {std::make_pair(it->first.cx, c.x),
+              std::make_pair(it->first.cy, c.y),
+              std::make_pair(it->first.cz, c.z)})
+        {
+            const double lo = ci * cell_size_, hi = lo + cell_size_;
+            nearSqr += mrpt::square(std::max({lo - x, .0, x - hi}));
+            farSqr += mrpt::square(std::max(x - lo, hi - x));
+        }
+        if (farSqr <= maxSqrDist)
+        {  // keep all
+            ++it;
+            continue;
+        }
+        if (nearSqr > maxSqrDist)
+        {  // remove all
+            count_ -= v.size();
+            it = cells_.erase(it);
+            continue;
+        }
+
+        const auto lambdaFar = [&](const mrpt::poses::CPose3D& kf)
+        { return (kf.translation() - c).sqrNorm() > maxSqrDist; };
+
+        const size_t oldSize = v.size();
+        v.erase(std::remove_if(v.begin(), v.end(), lambdaFar), v.end());
+        count_ -= oldSize - v.size();
+
+        if (v.empty())
+            it = cells_.erase(it);
+        else
+            ++it;
+    }
+}
+
+void SearchablePoseList::setCellSize(double cellSize)
+{
+    ASSERT_GT_(cellSize, .0);
+
+    auto oldCells = std::move(cells_);
+    cells_.clear();
+    count_ = 0;
+
+    cell_size_     = cellSize;
+    cell_size_inv_ = 1.0 / cellSize;
+
+    for (const auto& [idx, v] : oldCells)
+        for (const auto& kf : v) insert(kf);
+}
+
+void SearchablePoseList::visitAllPoses(
+    const std::function<void(const mrpt::poses::CPose3D&)>& f) const
+{
+    if (from_last_only_)
     {
-        mrpt::math::TPoint3D pt;
-        kf_points_.getPoint(i, pt.x, pt.y, pt.z);
-        if ((pt - c).sqrNorm() > maxSqrDist) continue;  // remove
-        // pass:
-        new_kf_points.insertPoint(pt);
-        new_kf_poses.push_back(kf_poses_.at(i));
+        if (!empty()) f(last_kf_);
+        return;
     }
-    // replace:
-    kf_poses_  = std::move(new_kf_poses);
-    kf_points_ = std::move(new_kf_points);
-    ASSERT_EQUAL_(kf_poses_.size(), kf_points_.size());
+    for (const auto& [idx, v] : cells_)
+        for (const auto& kf : v) f(kf);
 }
@@ -0,0 +1,187 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-hashed-set-se3.cpp
+ * @brief  Unit tests for HashedSetSE3 neighborhood queries
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_pose_list/HashedSetSE3.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/Lie/SO.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+double rotation_angle(
+    const mrpt::math::TPose3D& a, const mrpt::math::TPose3D& b)
+{
+    return mrpt::poses::Lie::SO<3>::log(
+               (mrpt::poses::CPose3D(a) - mrpt::poses::CPose3D(b))
+                   .getRotationMatrix())
+        .norm();
+}
+
+double sqr_translation(
+    const mrpt::math::TPose3D& a, const mrpt::math::TPose3D& b)
+{
+    return mrpt::square(a.x - b.x) + mrpt::square(a.y - b.y) +
+           mrpt::square(a.z - b.z);
+}
+
+mrpt::math::TPose3D random_pose(double xyRange)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    return {
+        rng.drawUniform(-xyRange, xyRange),
+        rng.drawUniform(-xyRange, xyRange),
+        rng.drawUniform(-5.0, 5.0),
+        rng.drawUniform(-M_PI, M_PI),
+        rng.drawUniform(-0.3, 0.3),
+        rng.drawUniform(-0.3, 0.3)};
+}
+}  // namespace
+
+static void test_queries_vs_brute_force()
+{
+    mrpt::random::getRandomGenerator().randomize(1234);
+
+    const size_t nPoses = 50000, nQueries = 100;
+    const double rotWeight = 2.0;
+
+    mola::HashedSetSE3               set(2.0);
+    std::vector<mrpt::math::TPose3D> all;
+    for (size_t i = 0; i < nPoses; i++)
+    {
+        all.push_back(random_pose(100.0));
+        set.insertPose(all.back(), i);
+    }
+
+    // Copy-free access:
+    size_t count = 0;
+    set.visitAllVoxels(
+        [&](const mola::HashedSetSE3::global_index3d_t&,
+            const mola::HashedSetSE3::VoxelData& v)
+        { count += v.poses().size(); });
+    ASSERT_EQUAL_(count, nPoses);
+
+    mrpt::system::CTicTac tictac;
+    double                tKnn = 0, tRadius = 0, tBrute = 0;
+
+    for (size_t q = 0; q < nQueries; q++)
+    {
+        const auto p = random_pose(120.0);
+
+        // kNN:
+        tictac.Tic();
+        const auto knn = set.kNearestPoses(p, 5, rotWeight);
+        tKnn += tictac.Tac();
+
+        tictac.Tic();
+        std::vector<double> dists;
+        for (const auto& c : all)
+            dists.push_back(
+                sqr_translation(p, c) +
+                mrpt::square(rotWeight * rotation_angle(p, c)));
+        std::sort(dists.begin(), dists.end());
+        tBrute += tictac.Tac();
+
+        ASSERT_EQUAL_(knn.size(), 5U);
+        for (size_t i = 0; i < knn.size(); i++)
+        {
+            const double rot = rotation_angle(p, knn[i]);
+            const double d =
+                sqr_translation(p, knn[i]) + mrpt::square(rotWeight * rot);
+            ASSERT_NEAR_(d, dists[i], 1e-6);
+        }
+
+        // Radius:
+        const double radius = 5.0, angTol = 0.5;
+
+        tictac.Tic();
+        const auto inRadius = set.posesWithinRadius(p, radius, angTol);
+        tRadius += tictac.Tac();
+
+        size_t expected = 0;
+        for (const auto& c : all)
+            if (sqr_translation(p, c) <= mrpt::square(radius) &&
+                rotation_angle(p, c) <= angTol)
+                expected++;
+
+        ASSERT_EQUAL_(inRadius.size(), expected);
+
+        // The IDs are handed back along their poses:
+        size_t visited = 0;
+        set.visitPosesWithinRadius(
+            p, radius, angTol,
+            [&](const mrpt::math::TPose3D& c,
+                mola::HashedSetSE3::pose_id_t id)
+            {
+                ASSERT_LT_(id, all.size());
+                ASSERT_(c == all[id]);
+                visited++;
+            });
+        ASSERT_EQUAL_(visited, expected);
+    }
+
+    std::cout << "[HashedSetSE3] " << nPoses << " poses, " << nQueries
+              << " queries: kNearestPoses()=" << 1e3 * tKnn / nQueries
+              << " ms, posesWithinRadius()=" << 1e3 * tRadius / nQueries
+              << " ms, brute-force kNN=" << 1e3 * tBrute / nQueries << " ms"
+              << std::endl;
+}
+
+static void test_sparse_set()
+{
+    // Far query, less poses than requested:
+    mola::HashedSetSE3 set;
+    set.insertPose({1000.0, 0, 0, 0, 0, 0});
+    set.insertPose({0, 0, 0, 0, 0, 0});
+
+    const auto knn = set.kNearestPoses({900.0, 0, 0, 0, 0, 0}, 5);
+    ASSERT_EQUAL_(knn.size(), 2U);
+    ASSERT_EQUAL_(knn.front().x, 1000.0);
+
+    set.clear();
+    ASSERT_(set.empty());
+    ASSERT_(set.kNearestPoses({0, 0, 0, 0, 0, 0}, 1).empty());
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_queries_vs_brute_force();
+        test_sparse_set();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,155 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-pose-clustering.cpp
+ * @brief  Unit tests for PoseClustering
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_pose_list/PoseClustering.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <cmath>
+#include <iostream>
+
+static void test_synthetic_revisits()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    // Keyframes every 2 m along the perimeter of a 40x40 m square, driven 3
+    // times in the same direction, then once in the opposite one:
+    const size_t numPerLap = 80;
+
+    const auto lambdaKeyframe = [&](size_t i, bool reversed)
+    {
+        const double s    = 2.0 * (i % numPerLap);
+        const size_t side = static_cast<size_t>(s / 40.0);
+        const double t    = s - 40.0 * side;
+
+        mrpt::math::TPose3D p;
+        switch (side)
+        {
+            case 0: p = {t, 0, 0, 0, 0, 0}; break;
+            case 1: p = {40.0, t, 0, M_PI / 2, 0, 0}; break;
+            case 2: p = {40.0 - t, 40.0, 0, M_PI, 0, 0}; break;
+            default: p = {0, 40.0 - t, 0, -M_PI / 2, 0, 0}; break;
+        }
+        if (reversed) p.yaw += M_PI;
+
+        // Small odometry noise:
+        p.x += rng.drawGaussian1D(0, 0.05);
+        p.y += rng.drawGaussian1D(0, 0.05);
+        p.yaw += rng.drawGaussian1D(0, 0.01);
+        return p;
+    };
+
+    mola::PoseClustering pc(1.0 /*m*/, mrpt::DEG2RAD(15.0));
+
+    for (size_t lap = 0; lap < 3; lap++)
+    {
+        for (size_t i = 0; i < numPerLap; i++)
+            pc.insert(lambdaKeyframe(i, false));
+
+        // Incremental: each place is already a cluster after the first lap:
+        ASSERT_EQUAL_(pc.numClusters(), numPerLap);
+    }
+
+    for (size_t i = 0; i < numPerLap; i++) pc.insert(lambdaKeyframe(i, true));
+
+    ASSERT_EQUAL_(pc.size(), 4 * numPerLap);
+    ASSERT_EQUAL_(pc.numClusters(), 2 * numPerLap);
+
+    const auto clusters = pc.clusters();
+    ASSERT_EQUAL_(clusters.size(), pc.numClusters());
+
+    for (const auto& c : clusters)
+    {
+        const auto id0 = c.members.front();
+        if (id0 < numPerLap)
+        {
+            // Same place, same direction, in the three first laps:
+            ASSERT_EQUAL_(c.members.size(), 3U);
+            ASSERT_EQUAL_(c.members.at(1), id0 + numPerLap);
+            ASSERT_EQUAL_(c.members.at(2), id0 + 2 * numPerLap);
+        }
+        else
+        {
+            // Opposite direction:
+            ASSERT_EQUAL_(c.members.size(), 1U);
+        }
+        ASSERT_EQUAL_(pc.clusterOf(c.representative), pc.clusterOf(id0));
+    }
+}
+
+static void test_benchmark_1M()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    // A long random walk, with keyframes every 0.5 m within a 1 km radius:
+    const size_t N = 1000000;
+
+    mola::PoseClustering pc(0.5 /*m*/, mrpt::DEG2RAD(15.0));
+
+    mrpt::system::CTicTac tictac;
+    tictac.Tic();
+
+    double x = 0, y = 0, yaw = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        yaw += rng.drawUniform(-0.2, 0.2);
+        x += 0.5 * std::cos(yaw);
+        y += 0.5 * std::sin(yaw);
+        if (std::hypot(x, y) > 1000.0) yaw += M_PI;
+
+        pc.insert({x, y, 0, yaw, 0, 0});
+    }
+    const double tInsert = tictac.Tac();
+
+    tictac.Tic();
+    const auto   clusters  = pc.clusters();
+    const double tClusters = tictac.Tac();
+
+    ASSERT_EQUAL_(clusters.size(), pc.numClusters());
+
+    std::cout << "[PoseClustering] " << N << " poses: insert()=" << tInsert
+              << " s, clusters()=" << tClusters << " s, "
+              << clusters.size() << " clusters." << std::endl;
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_synthetic_revisits();
+        test_benchmark_1M();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
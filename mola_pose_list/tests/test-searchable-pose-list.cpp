@@ -26,20 +26,184 @@
  */
 
 #include <mola_pose_list/SearchablePoseList.h>
+#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/poses/Lie/SE.h>
+#include <mrpt/poses/Lie/SO.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
 
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <optional>
 
-static void test1()
+namespace
 {
-    // write me!
+// A random walk, as a vehicle trajectory with keyframes every ~2 m:
+std::vector<mrpt::poses::CPose3D> synthetic_trajectory(size_t n)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    std::vector<mrpt::poses::CPose3D> traj;
+    double                            x = 0, y = 0, yaw = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        yaw += rng.drawUniform(-0.3, 0.3);
+        x += 2.0 * std::cos(yaw);
+        y += 2.0 * std::sin(yaw);
+        traj.push_back(mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+            x, y, rng.drawUniform(-1.0, 1.0), yaw, 0, 0));
+    }
+    return traj;
+}
+
+double se3_sqr_distance(
+    const mrpt::poses::CPose3D& a, const mrpt::poses::CPose3D& b)
+{
+    return (a.translation() - b.translation()).sqrNorm() +
+           mrpt::square(
+               mrpt::poses::Lie::SO<3>::log((a - b).getRotationMatrix())
+                   .norm());
+}
+
+// The former implementation, with a KD-tree which is rebuilt after each
+// insertion, kept as a reference for benchmarking:
+class KDTreePoseList
+{
+   public:
+    bool empty() const { return poses_.empty(); }
+
+    void insert(const mrpt::poses::CPose3D& p)
+    {
+        points_.insertPoint(p.translation());
+        poses_.push_back(p);
+    }
+
+    mrpt::poses::CPose3D check(const mrpt::poses::CPose3D& p) const
+    {
+        std::vector<mrpt::math::TPoint3Df> closest;
+        std::vector<float>                 closestSqrDist;
+        std::vector<uint64_t>              closestID;
+        points_.nn_multiple_search(
+            p.translation().cast<float>(), 20, closest, closestSqrDist,
+            closestID);
+
+        std::optional<size_t> bestIdx;
+        double                bestDist = 0;
+        for (size_t i = 0; i < closest.size(); i++)
+        {
+            const double d = se3_sqr_distance(p, poses_.at(closestID.at(i)));
+            if (!bestIdx || d < bestDist)
+            {
+                bestIdx  = i;
+                bestDist = d;
+            }
+        }
+        return p - poses_.at(closestID.at(*bestIdx));
+    }
+
+   private:
+    std::deque<mrpt::poses::CPose3D> poses_;
+    mrpt::maps::CSimplePointsMap     points_;
+};
+}  // namespace
+
+static void test_nearest_vs_brute_force()
+{
+    const auto traj = synthetic_trajectory(2000);
+
+    mola::SearchablePoseList pl;
+    ASSERT_(pl.empty());
+
+    for (size_t i = 0; i < traj.size(); i++)
+    {
+        const auto& p               = traj[i];
+        const auto [isFirst, delta] = pl.check(p);
+        ASSERT_EQUAL_(isFirst, i == 0);
+
+        if (!isFirst)
+        {
+            double best = std::numeric_limits<double>::max();
+            for (size_t j = 0; j < i; j++)
+                best = std::min(best, se3_sqr_distance(p, traj[j]));
+
+            const double found = se3_sqr_distance(p, p - delta);
+            ASSERT_NEAR_(found, best, 1e-6);
+        }
+        pl.insert(p);
+    }
+    ASSERT_EQUAL_(pl.size(), traj.size());
+
+    // Changing the cell size keeps all poses:
+    pl.setCellSize(1.0);
+    ASSERT_EQUAL_(pl.size(), traj.size());
+
+    // Remove far ones:
+    const auto&  center = traj.back();
+    const double radius = 50.0;
+
+    size_t expected = 0;
+    for (const auto& p : traj)
+        if ((p.translation() - center.translation()).norm() <= radius)
+            expected++;
+
+    pl.removeAllFartherThan(center, radius);
+    ASSERT_EQUAL_(pl.size(), expected);
+
+    pl.visitAllPoses(
+        [&](const mrpt::poses::CPose3D& p)
+        {
+            ASSERT_LE_(
+                (p.translation() - center.translation()).norm(), radius);
+        });
+
+    pl.clear();
+    ASSERT_(pl.empty());
+}
+
+static void test_benchmark_vs_kdtree()
+{
+    const auto traj = synthetic_trajectory(5000);
+
+    mrpt::system::CTicTac tictac;
+
+    // Typical usage: check() each new pose, then insert() it:
+    KDTreePoseList kd;
+    tictac.Tic();
+    for (const auto& p : traj)
+    {
+        if (!kd.empty()) (void)kd.check(p);
+        kd.insert(p);
+    }
+    const double tKD = tictac.Tac();
+
+    mola::SearchablePoseList pl;
+    tictac.Tic();
+    for (const auto& p : traj)
+    {
+        (void)pl.check(p);
+        pl.insert(p);
+    }
+    const double tHash = tictac.Tac();
+
+    tictac.Tic();
+    pl.removeAllFartherThan(traj.back(), 100.0);
+    const double tRemove = tictac.Tac();
+
+    std::cout << "[pose_list] " << traj.size()
+              << " check()+insert(): kd-tree=" << tKD
+              << " s, hashed grid=" << tHash
+              << " s. removeAllFartherThan()=" << 1e3 * tRemove << " ms"
+              << std::endl;
 }
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 {
     try
     {
-        test1();
+        test_nearest_vs_brute_force();
+        test_benchmark_vs_kdtree();
 
         std::cout << "Test successful." << std::endl;
     }
@@ -0,0 +1,178 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ScanContext.h
+ * @brief  Scan Context place recognition descriptors and index
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mrpt::maps
+{
+class CPointsMap;
+}
+
+namespace mola
+{
+/** Parameters for building ScanContext descriptors */
+struct ScanContextParameters
+{
+    ScanContextParameters() = default;
+
+    size_t num_rings   = 20;
+    size_t num_sectors = 60;
+    double max_range   = 80.0;  //!< [m]
+
+    /// Added to point heights, so that ground points in the sensor frame
+    /// become >=0 (empty bins are 0).
+    double z_offset = 2.0;
+};
+
+/** Scan Context lidar descriptor (Kim & Kim, IROS 2018).
+ *
+ * The horizontal plane around the sensor is split into `num_rings` x
+ * `num_sectors` polar bins, each one holding the maximum height of the
+ * points falling inside. A rotation of the sensor around its vertical axis
+ * becomes a circular shift of the sector columns, so:
+ * - The *ring key* (the fraction of non-empty bins in each ring) is invariant
+ *   to yaw, and used for fast retrieval of candidates.
+ * - The distance between two descriptors is evaluated for all (or some)
+ *   column shifts, the best one giving an estimate of the relative yaw.
+ *
+ * \sa ScanContextIndex
+ * \ingroup mola_relocalization_grp
+ */
+class ScanContext
+{
+   public:
+    using Parameters = ScanContextParameters;
+
+    ScanContext() = default;
+
+    /// Builds the descriptor from points in the sensor frame (Z pointing up)
+    static ScanContext FromPoints(
+        const float* xs, const float* ys, const float* zs, size_t n,
+        const Parameters& p = Parameters());
+
+    /// \overload
+    static ScanContext FromPointCloud(
+        const mrpt::maps::CPointsMap& pc, const Parameters& p = Parameters());
+
+    size_t num_rings() const { return numRings_; }
+    size_t num_sectors() const { return numSectors_; }
+    bool   empty() const { return cells_.empty(); }
+
+    /// Maximum height in a bin, or 0 if empty
+    float cell(size_t ring, size_t sector) const
+    {
+        return cells_[ring * numSectors_ + sector];
+    }
+
+    /// Yaw-invariant key, one entry per ring
+    const std::vector<float>& ring_key() const { return ringKey_; }
+
+    /// Mean height of each sector column, used to pre-align descriptors
+    const std::vector<float>& sector_key() const { return sectorKey_; }
+
+    struct Distance
+    {
+        double distance = 1.0;  //!< In the range [0,1], 0 is a perfect match
+
+        /** Yaw [rad] of this scan relative to the other one, i.e. such that
+         * pose_this ≈ pose_other ⊕ (0,0,0,yaw,0,0) */
+        double yaw = .0;
+    };
+
+    /** Column-shift distance (1 minus the average cosine similarity of
+     * non-empty columns) for the best alignment.
+     *
+     * \param search_radius If 0, all shifts are evaluated. Otherwise, the
+     * descriptors are first aligned with the sector keys, and only shifts
+     * within this number of sectors from that alignment are evaluated.
+     */
+    Distance distance(const ScanContext& other, size_t search_radius = 0) const;
+
+   private:
+    size_t             numRings_ = 0, numSectors_ = 0;
+    std::vector<float> cells_;  //!< ring-major
+    std::vector<float> colNorms_;
+    std::vector<float> ringKey_, sectorKey_;
+
+    double column_shift_distance(
+        const ScanContext& other, size_t shift) const;
+};
+
+/** A set of ScanContext descriptors for keyframes, searchable by ring key
+ * (flat, brute-force L2 index over contiguous memory) and then refined with
+ * the column-shift distance.
+ *
+ * \ingroup mola_relocalization_grp
+ */
+class ScanContextIndex
+{
+   public:
+    struct Parameters
+    {
+        Parameters() = default;
+
+        /// Number of nearest ring keys to evaluate with the full distance
+        size_t num_candidates = 10;
+
+        /// See ScanContext::distance()
+        size_t shift_search_radius = 0;
+    };
+
+    ScanContextIndex() = default;
+    explicit ScanContextIndex(const Parameters& p) : params_(p) {}
+
+    Parameters params_;
+
+    void insert(uint64_t keyframe_id, const ScanContext& desc);
+
+    size_t size() const { return ids_.size(); }
+    bool   empty() const { return ids_.empty(); }
+    void   clear();
+
+    struct Match
+    {
+        uint64_t keyframe_id = 0;
+        double   distance    = 1.0;  //!< See ScanContext::distance()
+        double   yaw         = .0;  //!< See ScanContext::distance()
+    };
+
+    /** Returns up to `k` keyframes, sorted by ascending distance, whose
+     * descriptors best match the query. Each one comes with an estimate of
+     * the relative yaw, useful to seed ICP or the lattice-based methods.
+     */
+    std::vector<Match> query(const ScanContext& q, size_t k = 1) const;
+
+   private:
+    size_t                   ringKeyLen_ = 0;
+    std::vector<float>       ringKeys_;  //!< flat: size() x ringKeyLen_
+    std::vector<ScanContext> descriptors_;
+    std::vector<uint64_t>    ids_;
+};
+
+}  // namespace mola
@@ -29,11 +29,19 @@
 #include <mp2p_icp/ICP.h>
 #include <mp2p_icp/Parameters.h>
 #include <mp2p_icp/metricmap.h>
+#include <mrpt/math/TPoint3D.h>
 #include <mrpt/math/TPose2D.h>
+#include <mrpt/math/TPose3D.h>
 #include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/poses/CPosePDFGrid.h>
 
+#include <cmath>
+#include <limits>
 #include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace mola
 {
@@ -49,6 +57,18 @@ namespace mola
  * - observations: pointclouds/2d_scan, reference_map: 2D gridmap
  * - observations: pointclouds, reference_map: pointclouds
  *
+ * The lattice is evaluated in parallel (see Input::num_threads). Each task
+ * evaluates one φ bin over a block of x rows, using its own copy of the
+ * observations already rotated by φ: point clouds (CObservationPointCloud)
+ * have their points transformed into the rotated vehicle frame, and other
+ * observations have their sensor poses rotated, so each (x,y) cell only
+ * needs a translation. The likelihood values are those of evaluating each
+ * lattice pose directly (up to floating point rounding).
+ * Results do not depend on the number of threads. Since evaluation of map
+ * likelihood functions runs concurrently, map types with lazily-filled
+ * likelihood caches (e.g. `enableLikelihoodCache` in 2D gridmaps) should
+ * have them disabled, or num_threads set to 1.
+ *
  * \todo Implement likelihood of observations GNSS datum within georeferenced
  *       maps.
  *
@@ -64,6 +84,10 @@ struct RelocalizationLikelihood_SE2
         double                   resolution_xy  = 0.5;
         double                   resolution_phi = mrpt::DEG2RAD(30.0);
 
+        /** Number of parallel threads. 0 means as many as hardware threads;
+         *  1 runs everything in the calling thread. */
+        size_t num_threads = 0;
+
         Input() = default;
     };
 
@@ -88,6 +112,10 @@ struct RelocalizationLikelihood_SE2
  * This method is based on mp2p_icp ICP pipelines, refer to the project
  * documentation.
  *
+ * Optionally, a coarse-to-fine cascade (see Input::Cascade) first runs cheap
+ * ICP on a decimated local map from all lattice cells, then only refines the
+ * best, mutually distinct, results with the full pipeline.
+ *
  * \ingroup mola_relocalization_grp
  */
 struct RelocalizationICP_SE2
@@ -100,6 +128,11 @@ struct RelocalizationICP_SE2
         size_t              total_cells  = 0;
         mrpt::math::TPose3D cell_init_guess;
         double              obtained_icp_quality = .0;
+
+        /// With the cascade enabled, false for the coarse stage (cells are
+        /// lattice cells), true for the refinement stage (cells are the
+        /// coarse results being refined).
+        bool refinement_stage = false;
     };
 
     struct Input
@@ -131,6 +164,38 @@ struct RelocalizationICP_SE2
         };
         OutputLattice output_lattice;
 
+        struct Cascade
+        {
+            bool enabled = false;
+
+            /// One out of N points of each local map point layer is kept
+            /// for the coarse stage:
+            size_t local_map_decimation = 10;
+
+            /// Pipelines and parameters for the coarse stage. If not
+            /// provided, icp_pipeline and icp_parameters are used.
+            std::vector<mp2p_icp::ICP::Ptr>     coarse_icp_pipeline;
+            std::optional<mp2p_icp::Parameters> coarse_icp_parameters;
+            double                              coarse_minimum_quality = .0;
+
+            /// Maximum number of coarse results to refine:
+            size_t max_survivors = 10;
+
+            /// Non-maximum suppression: coarse results closer than both
+            /// thresholds to a better one converged to the same basin, and
+            /// are not refined.
+            double nms_distance_xy  = 1.0;
+            double nms_distance_yaw = mrpt::DEG2RAD(20.0);
+
+            /// If >0, the refinement stage stops as soon as one result
+            /// reaches this quality. Refined results after (in coarse
+            /// quality order) the first one reaching it are discarded.
+            double early_stop_quality = .0;
+        };
+        Cascade cascade;
+
+        /// Called from the worker threads, possibly concurrently, after
+        /// each ICP run.
         std::function<void(const ProgressFeedback&)> on_progress_callback;
 
         Input() = default;
@@ -141,12 +206,195 @@ struct RelocalizationICP_SE2
         mola::HashedSetSE3 found_poses;
         double             time_cost = .0;  //!< [s]
 
+        size_t coarse_icp_runs = 0;  //!< Only with the cascade enabled
+        size_t fine_icp_runs   = 0;  //!< Full-resolution ICP runs
+
+        Output() = default;
+    };
+
+    static Output run(const Input& in);
+};
+
+/** Global SE(2) relocalization by branch-and-bound, in the style of real-time
+ *  correlative scan matching (Olson, 2009) as used in Cartographer.
+ *
+ * A 2D score grid in the range [0,1] is built from one layer of the reference
+ * map (either a point cloud, or a 2D occupancy grid, whose occupied cells are
+ * used as points), by splatting a Gaussian of width `sigma` around each
+ * point. Then, a pyramid of max-pooled versions of that grid provides upper
+ * bounds of the score of whole blocks of translations, which are explored
+ * best-first, discarding those blocks whose bound is below `min_score`.
+ *
+ * The score of a pose is the average grid value over the (decimated) points
+ * of the local map. The search is exact: the returned poses are the
+ * `max_results` best ones in the lattice defined by the ROI, `resolution_xy`
+ * and `resolution_phi`, as an exhaustive evaluation would find, but visiting
+ * a small fraction of the lattice.
+ *
+ * \ingroup mola_relocalization_grp
+ */
+struct RelocalizationBranchAndBound_SE2
+{
+    struct Input
+    {
+        mp2p_icp::metric_map_t reference_map;
+
+        /// Layer of reference_map to use. If empty, the first point cloud or
+        /// occupancy grid layer will be used.
+        std::string reference_layer;
+
+        /// The points of all its point cloud layers are used as query:
+        mp2p_icp::metric_map_t local_map;
+
+        mrpt::math::TPose2D corner_min, corner_max;
+
+        /// Resolution of the score grid, and of the translation search
+        double resolution_xy = 0.10;
+
+        /// Angular resolution. If 0, it is automatically set so that the
+        /// farthest query point moves by about resolution_xy.
+        double resolution_phi = 0;
+
+        double sigma             = 0.20;  //!< [m] Score smoothing
+        double max_corr_distance = 0.60;  //!< [m] Score = 0 beyond this
+
+        /// Only points within this height range (in both maps) are used:
+        double z_min = -std::numeric_limits<double>::max();
+        double z_max = std::numeric_limits<double>::max();
+
+        /// The local map is uniformly decimated down to this number of points
+        size_t max_query_points = 500;
+
+        /// Number of levels of the pyramid (the coarsest one has blocks of
+        /// 2^(depth-1) x 2^(depth-1) translations).
+        size_t branch_and_bound_depth = 7;
+
+        double min_score   = 0.30;  //!< In the range [0,1]
+        size_t max_results = 10;
+
+        Input() = default;
+    };
+
+    struct Output
+    {
+        /// Best poses, sorted by score (higher values are better matches),
+        /// in the same format as find_best_poses_se2()
+        std::map<double, mrpt::math::TPose2D> best_poses;
+
+        double time_cost       = .0;  //!< [s]
+        size_t evaluated_nodes = 0;  //!< Number of evaluated bounds/scores
+
         Output() = default;
     };
 
     static Output run(const Input& in);
 };
 
+/** Global SE(3) relocalization for 3D maps (e.g. multi-level buildings or
+ *  ramps), taking the vehicle pitch and roll as known (e.g. from the IMU
+ *  gravity vector, see pitch_roll_from_gravity()) and sampling candidates
+ *  over a regular (x,y,z,yaw) lattice.
+ *
+ * Candidates are scored in parallel with a sparse voxel likelihood field,
+ * precomputed from a mola::HashedVoxelPointCloud layer of the reference map:
+ * each field voxel stores exp(-0.5*d²/σ²), d being the distance to the
+ * closest occupied voxel, up to max_corr_distance. The score of a pose is the
+ * average field value over the (decimated) local map points.
+ *
+ * The best candidates, after non-maximum suppression, are optionally refined
+ * with ICP if a pipeline is provided.
+ *
+ * \ingroup mola_relocalization_grp
+ */
+struct RelocalizationVoxelLikelihood_SE3
+{
+    struct Input
+    {
+        mp2p_icp::metric_map_t reference_map;
+
+        /// Layer of reference_map to use, which must be a
+        /// mola::HashedVoxelPointCloud. If empty, the first one is used.
+        std::string reference_layer;
+
+        /// The points of all its point cloud layers are used as query:
+        mp2p_icp::metric_map_t local_map;
+
+        /// Translation search volume:
+        mrpt::math::TPoint3D corner_min, corner_max;
+        double               yaw_min = -M_PI, yaw_max = M_PI;
+
+        double resolution_xy  = 0.5;
+        double resolution_z   = 0.5;
+        double resolution_yaw = mrpt::DEG2RAD(10.0);
+
+        /// Gravity-aligned attitude of the vehicle [rad]:
+        double pitch = .0, roll = .0;
+
+        /** @name Likelihood field
+         *  @{ */
+        double likelihood_field_resolution = 0.20;  //!< [m]
+        double sigma                       = 0.30;  //!< [m]
+        double max_corr_distance           = 0.60;  //!< [m]
+        /** @} */
+
+        /// The local map is uniformly decimated down to this number of points
+        size_t max_query_points = 1000;
+
+        /// Candidates with lower scores (in the range [0,1]) are discarded
+        double min_score = 0.10;
+
+        /// Number of candidates to return (and refine, if enabled):
+        size_t max_candidates = 5;
+
+        /// Non-maximum suppression: candidates closer than both thresholds
+        /// to a better one are discarded.
+        double nms_distance_xyz = 1.0;
+        double nms_distance_yaw = mrpt::DEG2RAD(20.0);
+
+        /// Number of parallel threads. 0 means as many as hardware threads.
+        size_t num_threads = 0;
+
+        /// If not empty, the best candidates are refined with ICP:
+        std::vector<mp2p_icp::ICP::Ptr> icp_pipeline;
+        mp2p_icp::Parameters            icp_parameters;
+
+        Input() = default;
+    };
+
+    struct Candidate
+    {
+        mrpt::math::TPose3D pose;
+        double              score = .0;  //!< Likelihood field score
+
+        /// ICP quality, if refinement was enabled (then, `pose` is the
+        /// refined one).
+        std::optional<double> icp_quality;
+    };
+
+    struct Output
+    {
+        /// Sorted by descending ICP quality if refined, or score otherwise
+        std::vector<Candidate> candidates;
+
+        double time_cost         = .0;  //!< [s] Total
+        double time_cost_scoring = .0;  //!< [s] Field and scoring only
+        size_t evaluated_poses   = 0;
+
+        Output() = default;
+    };
+
+    static Output run(const Input& in);
+};
+
+/** Returns the (pitch, roll) angles [rad] of a static vehicle from its
+ *  accelerometer reading, i.e. the specific force (pointing upwards, opposite
+ *  to gravity) in the vehicle frame.
+ *
+ * \ingroup mola_relocalization_grp
+ */
+auto pitch_roll_from_gravity(const mrpt::math::TVector3D& acc)
+    -> std::pair<double, double>;
+
 /** Finds the SE(2) poses with the top given percentile likelihood, and returns
  *  them sorted by likelihood (higher values are better matches).
  *
@@ -0,0 +1,234 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   RelocalizationBranchAndBound_SE2.cpp
+ * @brief  Branch-and-bound SE(2) relocalization
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_relocalization/relocalization.h>
+#include <mrpt/core/Clock.h>
+#include <mrpt/core/bits_math.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/wrap2pi.h>
+
+#include <cmath>
+
+#include "bnb_se2_search.h"
+
+namespace
+{
+// Calls f(x,y) for each "point" of the map layer within the z range:
+template <typename F>
+void for_each_reference_point(
+    const mrpt::maps::CMetricMap&                         m,
+    const mola::RelocalizationBranchAndBound_SE2::Input& in, F&& f)
+{
+    if (const auto* pts = dynamic_cast<const mrpt::maps::CPointsMap*>(&m); pts)
+    {
+        const auto& xs = pts->getPointsBufferRef_x();
+        const auto& ys = pts->getPointsBufferRef_y();
+        const auto& zs = pts->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            if (zs[i] < in.z_min || zs[i] > in.z_max) continue;
+            f(xs[i], ys[i]);
+        }
+        return;
+    }
+    if (const auto* grid =
+            dynamic_cast<const mrpt::maps::COccupancyGridMap2D*>(&m);
+        grid)
+    {
+        // Occupied cells are used as points:
+        for (unsigned int cy = 0; cy < grid->getSizeY(); cy++)
+        {
+            for (unsigned int cx = 0; cx < grid->getSizeX(); cx++)
+            {
+                if (grid->getCell(cx, cy) >= 0.5f) continue;  // free/unknown
+                f(grid->idx2x(cx), grid->idx2y(cy));
+            }
+        }
+        return;
+    }
+    THROW_EXCEPTION("Unsupported reference map layer class");
+}
+
+bool is_supported_layer(const mrpt::maps::CMetricMap::Ptr& m)
+{
+    return m && (std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(m) ||
+                 std::dynamic_pointer_cast<mrpt::maps::COccupancyGridMap2D>(m));
+}
+}  // namespace
+
+// METHOD: branch-and-bound
+mola::RelocalizationBranchAndBound_SE2::Output
+    mola::RelocalizationBranchAndBound_SE2::run(const Input& in)
+{
+    using namespace mola::internal;
+
+    Output result;
+
+    const double t0 = mrpt::Clock::nowDouble();
+
+    ASSERT_GT_(in.resolution_xy, .0);
+    ASSERT_GT_(in.sigma, .0);
+    ASSERT_GE_(in.max_corr_distance, .0);
+    ASSERT_GE_(in.branch_and_bound_depth, 1U);
+    ASSERT_LE_(in.corner_min.x, in.corner_max.x);
+    ASSERT_LE_(in.corner_min.y, in.corner_max.y);
+    ASSERT_LE_(in.corner_min.phi, in.corner_max.phi);
+
+    // Select the reference layer:
+    mrpt::maps::CMetricMap::Ptr refLayer;
+    if (!in.reference_layer.empty())
+    {
+        ASSERTMSG_(
+            in.reference_map.layers.count(in.reference_layer) != 0,
+            mrpt::format(
+                "Reference map has no layer named '%s'",
+                in.reference_layer.c_str()));
+        refLayer = in.reference_map.layers.at(in.reference_layer);
+        ASSERTMSG_(
+            is_supported_layer(refLayer),
+            "Reference layer must be a point cloud or an occupancy grid");
+    }
+    else
+    {
+        for (const auto& [name, layer] : in.reference_map.layers)
+        {
+            if (!is_supported_layer(layer)) continue;
+            refLayer = layer;
+            break;
+        }
+        ASSERTMSG_(
+            refLayer,
+            "Reference map has no point cloud or occupancy grid layer");
+    }
+
+    // Query points:
+    BnBQuery q;
+    for (const auto& [name, layer] : in.local_map.layers)
+    {
+        const auto pts =
+            std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+        if (!pts) continue;
+
+        const auto& xs = pts->getPointsBufferRef_x();
+        const auto& ys = pts->getPointsBufferRef_y();
+        const auto& zs = pts->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            if (zs[i] < in.z_min || zs[i] > in.z_max) continue;
+            q.xs.push_back(xs[i]);
+            q.ys.push_back(ys[i]);
+        }
+    }
+    ASSERTMSG_(!q.xs.empty(), "Local map has no points");
+
+    if (in.max_query_points > 0 && q.xs.size() > in.max_query_points)
+    {
+        const size_t       n = q.xs.size();
+        std::vector<float> xs, ys;
+        xs.reserve(in.max_query_points);
+        ys.reserve(in.max_query_points);
+        for (size_t i = 0; i < in.max_query_points; i++)
+        {
+            const size_t idx = (i * n) / in.max_query_points;
+            xs.push_back(q.xs[idx]);
+            ys.push_back(q.ys[idx]);
+        }
+        q.xs = std::move(xs);
+        q.ys = std::move(ys);
+    }
+
+    double maxRange = 0;
+    for (size_t i = 0; i < q.xs.size(); i++)
+        mrpt::keep_max(maxRange, std::hypot(q.xs[i], q.ys[i]));
+
+    // Score grid: only the area reachable from the search ROI is needed.
+    const double margin = maxRange + in.max_corr_distance + in.resolution_xy;
+
+    ScoreGrid grid;
+    grid.resolution = in.resolution_xy;
+    grid.x_min      = in.corner_min.x - margin;
+    grid.y_min      = in.corner_min.y - margin;
+    grid.resize(
+        static_cast<int32_t>(
+            std::ceil((in.corner_max.x + margin - grid.x_min) / grid.resolution)),
+        static_cast<int32_t>(
+            std::ceil((in.corner_max.y + margin - grid.y_min) / grid.resolution)));
+
+    const double xMax = grid.x_min + grid.nx * grid.resolution;
+    const double yMax = grid.y_min + grid.ny * grid.resolution;
+    const double d    = in.max_corr_distance;
+
+    for_each_reference_point(
+        *refLayer, in,
+        [&](double x, double y)
+        {
+            if (x < grid.x_min - d || y < grid.y_min - d || x > xMax + d ||
+                y > yMax + d)
+                return;
+            grid.splat_gaussian(x, y, in.sigma, in.max_corr_distance);
+        });
+
+    ScorePyramid pyramid;
+    pyramid.build(grid, in.branch_and_bound_depth);
+
+    // Search lattice:
+    const double res = in.resolution_xy;
+    q.tx_min         = static_cast<int32_t>(std::ceil(in.corner_min.x / res));
+    q.tx_max         = static_cast<int32_t>(std::floor(in.corner_max.x / res));
+    q.ty_min         = static_cast<int32_t>(std::ceil(in.corner_min.y / res));
+    q.ty_max         = static_cast<int32_t>(std::floor(in.corner_max.y / res));
+
+    double resPhi = in.resolution_phi;
+    if (resPhi <= 0)
+    {
+        // The farthest point moves by ~res for each angular step:
+        resPhi = maxRange > res
+                     ? std::acos(1.0 - mrpt::square(res) /
+                                           (2 * mrpt::square(maxRange)))
+                     : mrpt::DEG2RAD(5.0);
+    }
+    for (double phi = in.corner_min.phi; phi <= in.corner_max.phi + 1e-9;
+         phi += resPhi)
+        q.phis.push_back(phi);
+
+    q.min_score   = static_cast<float>(in.min_score);
+    q.max_results = in.max_results;
+
+    BnBStats         stats;
+    const auto found = branch_and_bound_se2(pyramid, q, stats);
+
+    for (const auto& r : found)
+    {
+        result.best_poses[r.score] = {
+            r.tx * res, r.ty * res, mrpt::math::wrapToPi(q.phis[r.phi_idx])};
+    }
+
+    result.evaluated_nodes = stats.evaluated_nodes;
+    result.time_cost       = mrpt::Clock::nowDouble() - t0;
+
+    return result;
+}
@@ -27,8 +27,156 @@
 #include <mola_relocalization/relocalization.h>
 #include <mrpt/core/Clock.h>
 #include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/wrap2pi.h>
 #include <mrpt/version.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <tuple>
+
+namespace
+{
+using ProgressHandler =
+    std::function<void(size_t /*idx*/, const mp2p_icp::Results&)>;
+using ResultHandler =
+    std::function<bool(size_t /*idx*/, const mp2p_icp::Results&)>;
+
+// Runs ICP from all initial guesses, in one thread per pipeline.
+// onProgress() is called as soon as each alignment ends, from the worker
+// thread. onResult() is then called (serialized) for each result; if it
+// returns false, pending alignments with a larger index are skipped, so all
+// those with a smaller index are always run. Returns the number of ICP runs.
+size_t align_all(
+    const std::vector<mp2p_icp::ICP::Ptr>& pipelines,
+    const mp2p_icp::Parameters& params, const mp2p_icp::metric_map_t& local,
+    const mp2p_icp::metric_map_t&           global,
+    const std::vector<mrpt::math::TPose3D>& initGuesses,
+    const ProgressHandler& onProgress, const ResultHandler& onResult)
+{
+    ASSERT_(!pipelines.empty());
+
+    const size_t nPipelines = pipelines.size();
+
+    mrpt::WorkerThreadsPool pool(
+        nPipelines, mrpt::WorkerThreadsPool::POLICY_FIFO,
+        "RelocalizationICP_SE2"  // threads name
+    );
+    std::vector<std::mutex>        pipelineMtx(nPipelines);
+    std::mutex                     resultMtx;
+    std::vector<std::future<void>> futs;
+    std::atomic_size_t             stopIdx = initGuesses.size();
+    std::atomic_size_t             nRuns   = 0;
+
+    for (size_t i = 0; i < initGuesses.size(); i++)
+    {
+        auto f = pool.enqueue(
+            [i, nPipelines, &pipelines, &params, &local, &global, &initGuesses,
+             &onProgress, &onResult, &resultMtx, &pipelineMtx, &stopIdx,
+             &nRuns]()
+            {
+                if (i > stopIdx) return;
+
+                size_t threadIdx = i % nPipelines;
+
+                mp2p_icp::Results icpResult;
+                {
+                    auto lck1 = mrpt::lockHelper(pipelineMtx.at(threadIdx));
+
+                    pipelines.at(threadIdx)->align(
+                        local, global, initGuesses[i], params, icpResult);
+                    nRuns++;
+                }
+
+                onProgress(i, icpResult);
+
+                auto lck2 = mrpt::lockHelper(resultMtx);
+                if (!onResult(i, icpResult) && i < stopIdx) stopIdx = i;
+            });
+
+        futs.emplace_back(std::move(f));
+    }
+
+    // wait for all of them to end:
+    for (auto& f : futs) f.get();
+
+    return nRuns;
+}
+
+// Shallow copy of the map, with decimated copies of its point layers:
+mp2p_icp::metric_map_t decimated_map(
+    const mp2p_icp::metric_map_t& m, const size_t decimation)
+{
+    mp2p_icp::metric_map_t ret = m;
+    if (decimation <= 1) return ret;
+
+    for (auto& [name, layer] : ret.layers)
+    {
+        const auto pts = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+        if (!pts) continue;
+
+        auto d = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+            pts->duplicateGetSmartPtr());
+        ASSERT_(d);
+
+        std::vector<bool> deletionMask(d->size());
+        for (size_t i = 0; i < deletionMask.size(); i++)
+            deletionMask[i] = (i % decimation) != 0;
+        d->applyDeletionMask(deletionMask);
+
+        layer = d;
+    }
+    return ret;
+}
+
+struct CoarseResult
+{
+    double              quality = .0;
+    mrpt::math::TPose3D pose;
+};
+
+// Keeps the best results which are not too close to a better one:
+std::vector<CoarseResult> non_maximum_suppression(
+    std::vector<CoarseResult>                                   candidates,
+    const mola::RelocalizationICP_SE2::Input::Cascade& c)
+{
+    // Ties are broken by pose, so the result does not depend on the input
+    // order:
+    std::sort(
+        candidates.begin(), candidates.end(),
+        [](const CoarseResult& a, const CoarseResult& b)
+        {
+            if (a.quality != b.quality) return a.quality > b.quality;
+            return std::tie(a.pose.yaw, a.pose.x, a.pose.y) <
+                   std::tie(b.pose.yaw, b.pose.x, b.pose.y);
+        });
+
+    std::vector<CoarseResult> kept;
+    for (const auto& cand : candidates)
+    {
+        if (kept.size() >= c.max_survivors) break;
+
+        const bool suppressed = std::any_of(
+            kept.begin(), kept.end(),
+            [&](const CoarseResult& k)
+            {
+                const double dxy = std::hypot(
+                    cand.pose.x - k.pose.x, cand.pose.y - k.pose.y);
+                const double dyaw =
+                    std::abs(mrpt::math::wrapToPi(cand.pose.yaw - k.pose.yaw));
+                return dxy < c.nms_distance_xy && dyaw < c.nms_distance_yaw;
+            });
+        if (!suppressed) kept.push_back(cand);
+    }
+    return kept;
+}
+}  // namespace
+
 // METHOD: ICP
 mola::RelocalizationICP_SE2::Output mola::RelocalizationICP_SE2::run(
     const Input& in)
@@ -56,71 +204,136 @@ mola::RelocalizationICP_SE2::Output mola::RelocalizationICP_SE2::run(
 
     ASSERT_(!in.icp_pipeline.empty());
 
-    const size_t nPipelines = in.icp_pipeline.size();
+    const auto& ol = in.output_lattice;
+    result.found_poses.setVoxelProperties(
+        ol.resolution_xyz, ol.resolution_yaw, ol.resolution_pitch,
+        ol.resolution_roll);
 
-    mrpt::WorkerThreadsPool pool(
-        nPipelines, mrpt::WorkerThreadsPool::POLICY_FIFO,
-        "RelocalizationICP_SE2"  // threads name
-    );
-    std::vector<std::mutex>        pipelineMtx(nPipelines);
-    std::mutex                     resultMtx;
-    std::vector<std::future<void>> futs;
+    std::vector<mrpt::math::TPose3D> cellGuesses;
+    cellGuesses.reserve(nCells);
 
-    // evaluate over the grid:
-    for (size_t iX = 0, iGlobal = 0; iX < nX; iX++)
+    for (size_t iX = 0; iX < nX; iX++)
     {
         const double x = grid.idx2x(iX);
         for (size_t iY = 0; iY < nY; iY++)
         {
             const double y = grid.idx2y(iY);
-            for (size_t iPhi = 0; iPhi < nPhi; iPhi++, iGlobal++)
+            for (size_t iPhi = 0; iPhi < nPhi; iPhi++)
             {
                 const double phi = grid.idx2phi(iPhi);
+                cellGuesses.emplace_back(x, y, 0, phi, 0, 0);
+            }
+        }
+    }
+
+    // report progress to the user, if enabled:
+    const auto lambdaProgress =
+        [&in](
+            size_t idx, size_t total, const mrpt::math::TPose3D& initGuess,
+            const mp2p_icp::Results& icpResult, bool refinement)
+    {
+        if (!in.on_progress_callback) return;
 
-                const auto initGuessPose =
-                    mrpt::math::TPose3D(x, y, 0, phi, 0, 0);
+        ProgressFeedback p;
+        p.cell_init_guess      = initGuess;
+        p.current_cell         = idx;
+        p.total_cells          = total;
+        p.obtained_icp_quality = icpResult.quality;
+        p.refinement_stage     = refinement;
 
-                auto f = pool.enqueue(
-                    [initGuessPose, iGlobal, nCells, nPipelines, &in,
-                     &resultMtx, &result, &pipelineMtx]()
-                    {
-                        size_t threadIdx = iGlobal % nPipelines;
+        in.on_progress_callback(p);
+    };
 
-                        auto lck1 = mrpt::lockHelper(pipelineMtx.at(threadIdx));
+    // Full-resolution ICP from these initial guesses. Accepted poses are
+    // inserted in guess order, up to the first one reaching the early-stop
+    // quality, so the output does not depend on thread scheduling:
+    const auto lambdaFineStage =
+        [&](const std::vector<mrpt::math::TPose3D>& guesses, bool refinement)
+    {
+        const double earlyStop =
+            refinement ? in.cascade.early_stop_quality : .0;
 
-                        mp2p_icp::Results icpResult;
+        std::vector<std::optional<mrpt::math::TPose3D>> accepted(
+            guesses.size());
+        size_t lastIdx = guesses.size();
 
-                        in.icp_pipeline.at(threadIdx)->align(
-                            in.local_map, in.reference_map, initGuessPose,
-                            in.icp_parameters, icpResult);
+        const size_t nRuns = align_all(
+            in.icp_pipeline, in.icp_parameters, in.local_map,
+            in.reference_map, guesses,
+            [&](size_t idx, const mp2p_icp::Results& icpResult)
+            {
+                lambdaProgress(
+                    idx, guesses.size(), guesses[idx], icpResult, refinement);
+            },
+            [&](size_t idx, const mp2p_icp::Results& icpResult)
+            {
+                if (icpResult.quality < in.icp_minimum_quality) return true;
 
-                        // report progress to the user, if enabled:
-                        if (in.on_progress_callback)
-                        {
-                            ProgressFeedback p;
-                            p.cell_init_guess      = initGuessPose;
-                            p.current_cell         = iGlobal;
-                            p.total_cells          = nCells;
-                            p.obtained_icp_quality = icpResult.quality;
+                accepted[idx] = icpResult.optimal_tf.mean.asTPose();
 
-                            in.on_progress_callback(p);
-                        }
+                if (!(earlyStop > 0 && icpResult.quality >= earlyStop))
+                    return true;
 
-                        if (icpResult.quality < in.icp_minimum_quality) return;
+                lastIdx = std::min(lastIdx, idx);
+                return false;
+            });
 
-                        // accept result:
-                        auto lck2 = mrpt::lockHelper(resultMtx);
-                        result.found_poses.insertPose(
-                            icpResult.optimal_tf.mean.asTPose());
-                    });
+        for (size_t i = 0; i < accepted.size() && i <= lastIdx; i++)
+            if (accepted[i]) result.found_poses.insertPose(*accepted[i]);
 
-                futs.emplace_back(std::move(f));
-            }
-        }
+        return nRuns;
+    };
+
+    if (!in.cascade.enabled)
+    {
+        result.fine_icp_runs = lambdaFineStage(cellGuesses, false);
     }
+    else
+    {
+        const auto& c = in.cascade;
 
-    // wait for all of them to end:
-    for (auto& f : futs) f.get();
+        // Stage 1: cheap ICP, from all cells:
+        const mp2p_icp::metric_map_t coarseLocalMap =
+            decimated_map(in.local_map, c.local_map_decimation);
+
+        // Results indexed by cell, so their order does not depend on thread
+        // scheduling:
+        std::vector<std::optional<CoarseResult>> perCell(cellGuesses.size());
+
+        result.coarse_icp_runs = align_all(
+            c.coarse_icp_pipeline.empty() ? in.icp_pipeline
+                                          : c.coarse_icp_pipeline,
+            c.coarse_icp_parameters.value_or(in.icp_parameters),
+            coarseLocalMap, in.reference_map, cellGuesses,
+            [&](size_t idx, const mp2p_icp::Results& icpResult)
+            {
+                lambdaProgress(
+                    idx, cellGuesses.size(), cellGuesses[idx], icpResult,
+                    false);
+            },
+            [&](size_t idx, const mp2p_icp::Results& icpResult)
+            {
+                if (icpResult.quality >= c.coarse_minimum_quality)
+                {
+                    perCell[idx] = CoarseResult{
+                        icpResult.quality,
+                        icpResult.optimal_tf.mean.asTPose()};
+                }
+                return true;
+            });
+
+        std::vector<CoarseResult> coarse;
+        for (const auto& r : perCell)
+            if (r) coarse.push_back(*r);
+
+        // Stage 2: refine the best, distinct, results:
+        const auto survivors = non_maximum_suppression(std::move(coarse), c);
+
+        std::vector<mrpt::math::TPose3D> refineGuesses;
+        for (const auto& sv : survivors) refineGuesses.push_back(sv.pose);
+
+        result.fine_icp_runs = lambdaFineStage(refineGuesses, true);
+    }
 
     result.time_cost = mrpt::Clock::nowDouble() - t0;
 
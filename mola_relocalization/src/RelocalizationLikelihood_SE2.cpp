@@ -27,14 +27,126 @@
 #include <mola_relocalization/relocalization.h>
 #include <mrpt/core/Clock.h>
 #include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/obs/CObservationPointCloud.h>
 #include <mrpt/version.h>
 
+#include <algorithm>
+#include <cmath>
+#include <future>
 #include <optional>
+#include <thread>
+#include <vector>
 
 /** \defgroup mola_relocalization_grp mola-relocalization
  * Algorithms for localization starting with large uncertainty.
  */
 
+namespace
+{
+// Returns a deep copy of the observations, rotated by "phi" around the
+// vehicle Z axis, so evaluating them at (x,y,phi) is the same as evaluating
+// the copy at (x,y,0). Point clouds are transformed into the rotated vehicle
+// frame, so the maps do not need to transform them again for each cell.
+// Other observations just get their sensor poses rotated. Each task uses its
+// own copy, which also keeps lazily-built observation caches (e.g. 2D scans
+// as point clouds) private to its thread.
+mrpt::obs::CSensoryFrame rotated_observations(
+    const mrpt::obs::CSensoryFrame& sf, const double phi)
+{
+    const auto rot =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(0, 0, 0, phi, 0, 0);
+
+    mrpt::obs::CSensoryFrame ret;
+    for (const auto& o : sf)
+    {
+        ASSERT_(o);
+        auto obs = std::dynamic_pointer_cast<mrpt::obs::CObservation>(
+            o->duplicateGetSmartPtr());
+        ASSERT_(obs);
+
+        mrpt::poses::CPose3D sensorPose;
+        obs->getSensorPose(sensorPose);
+
+        auto pc = std::dynamic_pointer_cast<mrpt::obs::CObservationPointCloud>(
+            obs);
+        if (pc && pc->pointcloud)
+        {
+            // Same map class (and fields), with the points rotated:
+            auto pts = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+                pc->pointcloud->duplicateGetSmartPtr());
+            ASSERT_(pts);
+            pts->changeCoordinatesReference(rot + sensorPose);
+            pc->pointcloud = pts;
+            pc->setSensorPose(mrpt::poses::CPose3D::Identity());
+        }
+        else
+        {
+            obs->setSensorPose(rot + sensorPose);
+        }
+
+        ret.insert(obs);
+    }
+    return ret;
+}
+
+// Range of log-likelihood values, of all map layers:
+struct LogLikRange
+{
+    std::optional<double> minW, maxW;
+
+    void update(const double logLik)
+    {
+        if (!minW || logLik < *minW) minW = logLik;
+        if (!maxW || logLik > *maxW) maxW = logLik;
+    }
+    void merge(const LogLikRange& o)
+    {
+        if (o.minW) update(*o.minW);
+        if (o.maxW) update(*o.maxW);
+    }
+};
+
+// Evaluates all (x,y) cells for a given phi bin and range of x indices.
+// As in evaluating each lattice pose directly, each map layer overwrites
+// the cell, but all of them count for the range of values.
+LogLikRange evaluate_phi_bin(
+    const mola::RelocalizationLikelihood_SE2::Input& in,
+    mrpt::poses::CPosePDFGrid& grid, const size_t iPhi, const size_t iX0,
+    const size_t iX1)
+{
+    const auto obs = rotated_observations(in.observations, grid.idx2phi(iPhi));
+
+    const size_t nY = grid.getSizeY();
+
+    LogLikRange range;
+    for (size_t iX = iX0; iX < iX1; iX++)
+    {
+        const double x = grid.idx2x(iX);
+        for (size_t iY = 0; iY < nY; iY++)
+        {
+            const double y = grid.idx2y(iY);
+
+            const auto pose =
+                mrpt::poses::CPose3D::FromXYZYawPitchRoll(x, y, 0, 0, 0, 0);
+
+            for (const auto& [layerName, map] : in.reference_map.layers)
+            {
+                const double logLik =
+                    map->computeObservationsLikelihood(obs, pose);
+
+                double* cell = grid.getByIndex(iX, iY, iPhi);
+                ASSERT_(cell);
+                *cell = logLik;
+
+                range.update(logLik);
+            }
+        }
+    }
+    return range;
+}
+}  // namespace
+
 // METHOD: likelihood
 mola::RelocalizationLikelihood_SE2::Output
     mola::RelocalizationLikelihood_SE2::run(const Input& in)
@@ -44,6 +156,8 @@ mola::RelocalizationLikelihood_SE2::Output
     const double t0 = mrpt::Clock::nowDouble();
 
     ASSERT_(!in.reference_map.layers.empty());
+    for (const auto& [layerName, map] : in.reference_map.layers)
+        ASSERT_(map);
 
     result.likelihood_grid = mrpt::poses::CPosePDFGrid(
         in.corner_min.x, in.corner_max.x, in.corner_min.y, in.corner_max.y,
@@ -59,56 +173,71 @@ mola::RelocalizationLikelihood_SE2::Output
     const size_t nCells = nX * nY * nPhi;
     ASSERT_(nCells > 0);
 
-    // evaluate over the grid:
-    std::optional<double> minW, maxW;
+    // Each task evaluates a phi bin over a block of x rows:
+    const size_t nThreads =
+        in.num_threads != 0
+            ? in.num_threads
+            : std::max<size_t>(1, std::thread::hardware_concurrency());
 
-    for (size_t iX = 0, iGlobal = 0; iX < nX; iX++)
-    {
-        const double x = grid.idx2x(iX);
-        for (size_t iY = 0; iY < nY; iY++)
-        {
-            const double y = grid.idx2y(iY);
-            for (size_t iPhi = 0; iPhi < nPhi; iPhi++, iGlobal++)
-            {
-                const double phi = grid.idx2phi(iPhi);
+    const size_t xBlocksPerPhi =
+        std::clamp<size_t>((4 * nThreads + nPhi - 1) / nPhi, 1, nX);
 
-                const auto pose = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
-                    x, y, 0, phi, 0, 0);
+    LogLikRange range;
 
-                for (const auto& [layerName, map] : in.reference_map.layers)
-                {
-                    ASSERT_(map);
-                    const double logLik = map->computeObservationsLikelihood(
-                        in.observations, pose);
+    if (nThreads == 1)
+    {
+        for (size_t iPhi = 0; iPhi < nPhi; iPhi++)
+            range.merge(evaluate_phi_bin(in, grid, iPhi, 0, nX));
+    }
+    else
+    {
+        // Evaluate one pose first, from this thread, so lazily-built map
+        // structures (e.g. KD-trees) exist before running concurrently:
+        range.merge(evaluate_phi_bin(in, grid, 0, 0, 1));
+
+        mrpt::WorkerThreadsPool pool(
+            nThreads, mrpt::WorkerThreadsPool::POLICY_FIFO,
+            "RelocalizationLikelihood_SE2"  // threads name
+        );
+        std::vector<std::future<LogLikRange>> futs;
 
-                    double* cell = grid.getByIndex(iX, iY, iPhi);
-                    ASSERT_(cell);
-                    *cell = logLik;
+        for (size_t iPhi = 0; iPhi < nPhi; iPhi++)
+        {
+            for (size_t b = 0; b < xBlocksPerPhi; b++)
+            {
+                const size_t iX0 = (nX * b) / xBlocksPerPhi;
+                const size_t iX1 = (nX * (b + 1)) / xBlocksPerPhi;
+                if (iX0 == iX1) continue;
 
-                    if (!minW || logLik < *minW) minW = logLik;
-                    if (!maxW || logLik > *maxW) maxW = logLik;
-                }
+                futs.emplace_back(pool.enqueue(
+                    [&, iPhi, iX0, iX1]()
+                    { return evaluate_phi_bin(in, grid, iPhi, iX0, iX1); }));
             }
         }
+
+        // wait for all of them to end:
+        for (auto& f : futs) range.merge(f.get());
     }
 
+    double minW = *range.minW, maxW = *range.maxW;
+
     // normalizeWeights and convert log-lik ==> likelihood
     for (size_t iX = 0; iX < nX; iX++)
         for (size_t iY = 0; iY < nY; iY++)
             for (size_t iPhi = 0; iPhi < nPhi; iPhi++)
             {
                 double& cell = *grid.getByIndex(iX, iY, iPhi);
-                cell -= *maxW;
+                cell -= maxW;
                 cell = std::exp(cell);
             }
-    *minW -= *maxW;
+    minW -= maxW;
 
     // Normalize PDF:
     grid.normalize();
 
     result.time_cost          = mrpt::Clock::nowDouble() - t0;
     result.max_log_likelihood = 0;  // by definition of the normalization above
-    result.min_log_likelihood = *minW;
+    result.min_log_likelihood = minW;
 
     return result;
 }
@@ -0,0 +1,380 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   RelocalizationVoxelLikelihood_SE3.cpp
+ * @brief  SE(3) relocalization with a voxel likelihood field
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_metric_maps/HashedVoxelPointCloud.h>
+#include <mola_metric_maps/index3d_t.h>
+#include <mola_relocalization/relocalization.h>
+#include <mrpt/core/Clock.h>
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace
+{
+// Sparse voxel likelihood field, see RelocalizationVoxelLikelihood_SE3 docs
+class VoxelLikelihoodField
+{
+   public:
+    using index_t = mola::index3d_t<int32_t>;
+    using hash_t  = mola::index3d_hash<int32_t>;
+
+    void build(
+        const mola::HashedVoxelPointCloud& map, double resolution,
+        double sigma, double maxDist)
+    {
+        ASSERT_GT_(resolution, .0);
+        ASSERT_GT_(sigma, .0);
+
+        resolution_     = resolution;
+        resolution_inv_ = 1.0 / resolution;
+        cells_.clear();
+
+        // Occupied voxels:
+        std::unordered_set<index_t, hash_t> occupied;
+        map.visitAllPoints([&](const mrpt::math::TPoint3Df& pt)
+                           { occupied.insert(coordToIdx(pt)); });
+
+        // Splat a truncated Gaussian around each of them:
+        const int32_t r = static_cast<int32_t>(std::ceil(maxDist / resolution));
+        const double  k = -0.5 / mrpt::square(sigma);
+
+        std::vector<std::pair<index_t, float>> kernel;
+        for (int32_t dz = -r; dz <= r; dz++)
+            for (int32_t dy = -r; dy <= r; dy++)
+                for (int32_t dx = -r; dx <= r; dx++)
+                {
+                    const double d2 = mrpt::square(resolution) *
+                                      (dx * dx + dy * dy + dz * dz);
+                    if (d2 > mrpt::square(maxDist)) continue;
+                    kernel.emplace_back(
+                        index_t(dx, dy, dz),
+                        static_cast<float>(std::exp(k * d2)));
+                }
+
+        cells_.reserve(occupied.size() * kernel.size() / 4);
+        for (const auto& idx : occupied)
+        {
+            for (const auto& [d, v] : kernel)
+            {
+                float& c = cells_[idx + d];
+                c        = std::max(c, v);
+            }
+        }
+    }
+
+    float at(float x, float y, float z) const
+    {
+        const auto it = cells_.find(coordToIdx({x, y, z}));
+        return it == cells_.end() ? 0.0f : it->second;
+    }
+
+    size_t size() const { return cells_.size(); }
+
+   private:
+    double resolution_ = 0.2, resolution_inv_ = 5.0;
+
+    std::unordered_map<index_t, float, hash_t> cells_;
+
+    index_t coordToIdx(const mrpt::math::TPoint3Df& pt) const
+    {
+        return {
+            static_cast<int32_t>(std::floor(pt.x * resolution_inv_)),
+            static_cast<int32_t>(std::floor(pt.y * resolution_inv_)),
+            static_cast<int32_t>(std::floor(pt.z * resolution_inv_))};
+    }
+};
+
+using Candidate = mola::RelocalizationVoxelLikelihood_SE3::Candidate;
+
+std::vector<Candidate> non_maximum_suppression(
+    std::vector<Candidate>                                   candidates,
+    const mola::RelocalizationVoxelLikelihood_SE3::Input& in)
+{
+    // Ties (common in flat regions of the likelihood field) are broken by
+    // pose, so the result does not depend on the input order:
+    std::sort(
+        candidates.begin(), candidates.end(),
+        [](const Candidate& a, const Candidate& b)
+        {
+            if (a.score != b.score) return a.score > b.score;
+            return std::tie(a.pose.yaw, a.pose.x, a.pose.y, a.pose.z) <
+                   std::tie(b.pose.yaw, b.pose.x, b.pose.y, b.pose.z);
+        });
+
+    std::vector<Candidate> kept;
+    for (const auto& cand : candidates)
+    {
+        if (kept.size() >= in.max_candidates) break;
+
+        const bool suppressed = std::any_of(
+            kept.begin(), kept.end(),
+            [&](const Candidate& k)
+            {
+                const double dxyz = (cand.pose.translation() -
+                                     k.pose.translation())
+                                        .norm();
+                const double dyaw =
+                    std::abs(mrpt::math::wrapToPi(cand.pose.yaw - k.pose.yaw));
+                return dxyz < in.nms_distance_xyz && dyaw < in.nms_distance_yaw;
+            });
+        if (!suppressed) kept.push_back(cand);
+    }
+    return kept;
+}
+
+std::vector<double> linspace_by_step(double from, double to, double step)
+{
+    ASSERT_GT_(step, .0);
+    ASSERT_LE_(from, to);
+    std::vector<double> ret;
+    const size_t        n = static_cast<size_t>((to - from) / step + 1e-6) + 1;
+    for (size_t i = 0; i < n; i++) ret.push_back(from + i * step);
+    return ret;
+}
+}  // namespace
+
+auto mola::pitch_roll_from_gravity(const mrpt::math::TVector3D& acc)
+    -> std::pair<double, double>
+{
+    ASSERT_GT_(acc.norm(), .0);
+
+    // At rest, acc = R^T * [0 0 g], with R=Rz(yaw)*Ry(pitch)*Rx(roll):
+    const double pitch = std::atan2(-acc.x, std::hypot(acc.y, acc.z));
+    const double roll  = std::atan2(acc.y, acc.z);
+    return {pitch, roll};
+}
+
+// METHOD: voxel likelihood field, SE(3)
+mola::RelocalizationVoxelLikelihood_SE3::Output
+    mola::RelocalizationVoxelLikelihood_SE3::run(const Input& in)
+{
+    Output result;
+
+    const double t0 = mrpt::Clock::nowDouble();
+
+    // Select the reference layer:
+    std::shared_ptr<mola::HashedVoxelPointCloud> refMap;
+    if (!in.reference_layer.empty())
+    {
+        ASSERTMSG_(
+            in.reference_map.layers.count(in.reference_layer) != 0,
+            mrpt::format(
+                "Reference map has no layer named '%s'",
+                in.reference_layer.c_str()));
+        refMap = std::dynamic_pointer_cast<mola::HashedVoxelPointCloud>(
+            in.reference_map.layers.at(in.reference_layer));
+    }
+    else
+    {
+        for (const auto& [name, layer] : in.reference_map.layers)
+        {
+            refMap =
+                std::dynamic_pointer_cast<mola::HashedVoxelPointCloud>(layer);
+            if (refMap) break;
+        }
+    }
+    ASSERTMSG_(refMap, "A HashedVoxelPointCloud reference layer is required");
+
+    // Query points:
+    std::vector<mrpt::math::TPoint3Df> queryPts;
+    for (const auto& [name, layer] : in.local_map.layers)
+    {
+        const auto pts =
+            std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(layer);
+        if (!pts) continue;
+
+        const auto& xs = pts->getPointsBufferRef_x();
+        const auto& ys = pts->getPointsBufferRef_y();
+        const auto& zs = pts->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+            queryPts.emplace_back(xs[i], ys[i], zs[i]);
+    }
+    ASSERTMSG_(!queryPts.empty(), "Local map has no points");
+
+    if (in.max_query_points > 0 && queryPts.size() > in.max_query_points)
+    {
+        std::vector<mrpt::math::TPoint3Df> decim;
+        decim.reserve(in.max_query_points);
+        for (size_t i = 0; i < in.max_query_points; i++)
+        {
+            decim.push_back(
+                queryPts[(i * queryPts.size()) / in.max_query_points]);
+        }
+        queryPts = std::move(decim);
+    }
+
+    // Likelihood field:
+    VoxelLikelihoodField field;
+    field.build(
+        *refMap, in.likelihood_field_resolution, in.sigma,
+        in.max_corr_distance);
+
+    // Candidate lattice:
+    const auto xs =
+        linspace_by_step(in.corner_min.x, in.corner_max.x, in.resolution_xy);
+    const auto ys =
+        linspace_by_step(in.corner_min.y, in.corner_max.y, in.resolution_xy);
+    const auto zs =
+        linspace_by_step(in.corner_min.z, in.corner_max.z, in.resolution_z);
+    const auto yaws =
+        linspace_by_step(in.yaw_min, in.yaw_max, in.resolution_yaw);
+
+    // Evaluate in parallel, one task per yaw: query points are rotated once,
+    // then only translated for each (x,y,z):
+    const size_t nThreads =
+        in.num_threads != 0
+            ? in.num_threads
+            : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    // Results of each yaw, merged in yaw order:
+    std::vector<std::vector<Candidate>> perYaw(yaws.size());
+
+    const auto lambdaEvalYaw = [&](const size_t iYaw)
+    {
+        const double yaw = yaws[iYaw];
+        const auto R = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                           0, 0, 0, yaw, in.pitch, in.roll)
+                           .getRotationMatrix();
+
+        std::vector<mrpt::math::TPoint3Df> rotated;
+        rotated.reserve(queryPts.size());
+        for (const auto& p : queryPts)
+        {
+            const auto lambdaRow = [&](int r)
+            {
+                return static_cast<float>(
+                    R(r, 0) * p.x + R(r, 1) * p.y + R(r, 2) * p.z);
+            };
+            rotated.emplace_back(lambdaRow(0), lambdaRow(1), lambdaRow(2));
+        }
+
+        const float invN = 1.0f / static_cast<float>(rotated.size());
+
+        std::vector<Candidate> local;
+        for (const double x : xs)
+            for (const double y : ys)
+                for (const double z : zs)
+                {
+                    const auto fx = static_cast<float>(x);
+                    const auto fy = static_cast<float>(y);
+                    const auto fz = static_cast<float>(z);
+
+                    float sum = 0;
+                    for (const auto& p : rotated)
+                        sum += field.at(p.x + fx, p.y + fy, p.z + fz);
+
+                    const double score = sum * invN;
+                    if (score < in.min_score) continue;
+
+                    Candidate c;
+                    c.pose  = {x, y, z, yaw, in.pitch, in.roll};
+                    c.score = score;
+                    local.push_back(c);
+                }
+
+        // Only the best ones of this yaw can survive:
+        perYaw[iYaw] = non_maximum_suppression(std::move(local), in);
+    };
+
+    if (nThreads == 1)
+    {
+        for (size_t i = 0; i < yaws.size(); i++) lambdaEvalYaw(i);
+    }
+    else
+    {
+        mrpt::WorkerThreadsPool pool(
+            nThreads, mrpt::WorkerThreadsPool::POLICY_FIFO,
+            "RelocalizationVoxelLikelihood_SE3"  // threads name
+        );
+        std::vector<std::future<void>> futs;
+        for (size_t i = 0; i < yaws.size(); i++)
+            futs.emplace_back(pool.enqueue(lambdaEvalYaw, i));
+
+        for (auto& f : futs) f.get();
+    }
+
+    std::vector<Candidate> candidates;
+    for (const auto& c : perYaw)
+        candidates.insert(candidates.end(), c.begin(), c.end());
+
+    result.evaluated_poses = xs.size() * ys.size() * zs.size() * yaws.size();
+    result.candidates      = non_maximum_suppression(std::move(candidates), in);
+    result.time_cost_scoring = mrpt::Clock::nowDouble() - t0;
+
+    // Optional ICP refinement:
+    if (!in.icp_pipeline.empty() && !result.candidates.empty())
+    {
+        const size_t nPipelines = in.icp_pipeline.size();
+
+        mrpt::WorkerThreadsPool pool(
+            nPipelines, mrpt::WorkerThreadsPool::POLICY_FIFO,
+            "RelocalizationVoxelLikelihood_SE3_icp"  // threads name
+        );
+        std::vector<std::mutex>        pipelineMtx(nPipelines);
+        std::vector<std::future<void>> futs;
+
+        for (size_t i = 0; i < result.candidates.size(); i++)
+        {
+            futs.emplace_back(pool.enqueue(
+                [i, nPipelines, &in, &result, &pipelineMtx]()
+                {
+                    const size_t threadIdx = i % nPipelines;
+                    auto lck = mrpt::lockHelper(pipelineMtx.at(threadIdx));
+
+                    auto& c = result.candidates.at(i);
+
+                    mp2p_icp::Results icpResult;
+                    in.icp_pipeline.at(threadIdx)->align(
+                        in.local_map, in.reference_map, c.pose,
+                        in.icp_parameters, icpResult);
+
+                    c.pose        = icpResult.optimal_tf.mean.asTPose();
+                    c.icp_quality = icpResult.quality;
+                }));
+        }
+        for (auto& f : futs) f.get();
+
+        std::sort(
+            result.candidates.begin(), result.candidates.end(),
+            [](const Candidate& a, const Candidate& b)
+            { return *a.icp_quality > *b.icp_quality; });
+    }
+
+    result.time_cost = mrpt::Clock::nowDouble() - t0;
+
+    return result;
+}
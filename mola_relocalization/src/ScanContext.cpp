@@ -0,0 +1,261 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   ScanContext.cpp
+ * @brief  Scan Context place recognition descriptors and index
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_relocalization/ScanContext.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CPointsMap.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+using namespace mola;
+
+ScanContext ScanContext::FromPoints(
+    const float* xs, const float* ys, const float* zs, size_t n,
+    const Parameters& p)
+{
+    ASSERT_GT_(p.num_rings, 0U);
+    ASSERT_GT_(p.num_sectors, 0U);
+    ASSERT_GT_(p.max_range, .0);
+
+    ScanContext sc;
+    sc.numRings_   = p.num_rings;
+    sc.numSectors_ = p.num_sectors;
+    sc.cells_.assign(p.num_rings * p.num_sectors, 0.0f);
+
+    const double ringsPerMeter = p.num_rings / p.max_range;
+    const double sectorsPerRad = p.num_sectors / (2 * M_PI);
+    const auto   maxSectorIdx  = static_cast<int>(p.num_sectors) - 1;
+    const auto   maxRingIdx    = static_cast<int>(p.num_rings) - 1;
+    const double sqrMaxRange   = p.max_range * p.max_range;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        const double r2 = double(xs[i]) * xs[i] + double(ys[i]) * ys[i];
+        if (r2 >= sqrMaxRange || r2 == 0) continue;
+
+        const int ring = std::min(
+            maxRingIdx, static_cast<int>(std::sqrt(r2) * ringsPerMeter));
+        const int sector = std::clamp(
+            static_cast<int>((std::atan2(ys[i], xs[i]) + M_PI) * sectorsPerRad),
+            0, maxSectorIdx);
+
+        float& c = sc.cells_[ring * p.num_sectors + sector];
+        c        = std::max(c, static_cast<float>(zs[i] + p.z_offset));
+    }
+
+    // Keys and column norms:
+    sc.ringKey_.assign(p.num_rings, 0.0f);
+    sc.sectorKey_.assign(p.num_sectors, 0.0f);
+    sc.colNorms_.assign(p.num_sectors, 0.0f);
+
+    for (size_t ri = 0; ri < p.num_rings; ri++)
+    {
+        size_t nonEmpty = 0;
+        for (size_t si = 0; si < p.num_sectors; si++)
+        {
+            const float v = sc.cell(ri, si);
+            if (v > 0) nonEmpty++;
+            sc.sectorKey_[si] += v;
+            sc.colNorms_[si] += v * v;
+        }
+        sc.ringKey_[ri] = static_cast<float>(nonEmpty) / p.num_sectors;
+    }
+    for (size_t si = 0; si < p.num_sectors; si++)
+    {
+        sc.sectorKey_[si] /= p.num_rings;
+        sc.colNorms_[si] = std::sqrt(sc.colNorms_[si]);
+    }
+
+    return sc;
+}
+
+ScanContext ScanContext::FromPointCloud(
+    const mrpt::maps::CPointsMap& pc, const Parameters& p)
+{
+    const auto& xs = pc.getPointsBufferRef_x();
+    const auto& ys = pc.getPointsBufferRef_y();
+    const auto& zs = pc.getPointsBufferRef_z();
+
+    return FromPoints(xs.data(), ys.data(), zs.data(), xs.size(), p);
+}
+
+double ScanContext::column_shift_distance(
+    const ScanContext& other, size_t shift) const
+{
+    // Column j of this descriptor against column j+shift of the other one:
+    double sumSim = 0;
+    size_t n      = 0;
+    for (size_t j = 0; j < numSectors_; j++)
+    {
+        const size_t jo = (j + shift) % numSectors_;
+
+        const float na = colNorms_[j], nb = other.colNorms_[jo];
+        if (na == 0 || nb == 0) continue;
+
+        float dot = 0;
+        for (size_t ri = 0; ri < numRings_; ri++)
+            dot += cell(ri, j) * other.cell(ri, jo);
+
+        sumSim += dot / (na * nb);
+        n++;
+    }
+    return n == 0 ? 1.0 : 1.0 - sumSim / n;
+}
+
+ScanContext::Distance ScanContext::distance(
+    const ScanContext& other, size_t search_radius) const
+{
+    ASSERT_EQUAL_(numRings_, other.numRings_);
+    ASSERT_EQUAL_(numSectors_, other.numSectors_);
+
+    const size_t N = numSectors_;
+
+    Distance best;
+    size_t   bestShift = 0;
+
+    const auto lambdaEval = [&](size_t shift)
+    {
+        const double d = column_shift_distance(other, shift);
+        if (d < best.distance)
+        {
+            best.distance = d;
+            bestShift     = shift;
+        }
+    };
+
+    if (search_radius == 0 || 2 * search_radius + 1 >= N)
+    {
+        for (size_t s = 0; s < N; s++) lambdaEval(s);
+    }
+    else
+    {
+        // Coarse alignment with the sector keys:
+        size_t initShift = 0;
+        float  minErr    = std::numeric_limits<float>::max();
+        for (size_t s = 0; s < N; s++)
+        {
+            float err = 0;
+            for (size_t j = 0; j < N; j++)
+            {
+                const float d = sectorKey_[j] - other.sectorKey_[(j + s) % N];
+                err += d * d;
+            }
+            if (err < minErr)
+            {
+                minErr    = err;
+                initShift = s;
+            }
+        }
+        for (size_t k = 0; k <= 2 * search_radius; k++)
+            lambdaEval((initShift + N + k - search_radius) % N);
+    }
+
+    // Shift => yaw, in the range (-pi,pi]:
+    const double sectorWidth = 2 * M_PI / N;
+    best.yaw                 = bestShift * sectorWidth;
+    if (best.yaw > M_PI) best.yaw -= 2 * M_PI;
+
+    return best;
+}
+
+void ScanContextIndex::insert(uint64_t keyframe_id, const ScanContext& desc)
+{
+    ASSERT_(!desc.empty());
+    if (ids_.empty())
+        ringKeyLen_ = desc.num_rings();
+    else
+        ASSERT_EQUAL_(desc.num_rings(), ringKeyLen_);
+
+    const auto& rk = desc.ring_key();
+    ringKeys_.insert(ringKeys_.end(), rk.begin(), rk.end());
+    descriptors_.push_back(desc);
+    ids_.push_back(keyframe_id);
+}
+
+void ScanContextIndex::clear()
+{
+    ringKeyLen_ = 0;
+    ringKeys_.clear();
+    descriptors_.clear();
+    ids_.clear();
+}
+
+std::vector<ScanContextIndex::Match> ScanContextIndex::query(
+    const ScanContext& q, size_t k) const
+{
+    std::vector<Match> matches;
+    if (ids_.empty() || k == 0) return matches;
+
+    ASSERT_EQUAL_(q.num_rings(), ringKeyLen_);
+
+    // 1) Ring key candidates, by brute force over contiguous memory:
+    const size_t       n  = ids_.size();
+    const float*       qk = q.ring_key().data();
+    std::vector<float> sqrDists(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        const float* rk = &ringKeys_[i * ringKeyLen_];
+        float        d  = 0;
+        for (size_t j = 0; j < ringKeyLen_; j++)
+        {
+            const float e = rk[j] - qk[j];
+            d += e * e;
+        }
+        sqrDists[i] = d;
+    }
+
+    const size_t nCand = std::min(n, std::max(k, params_.num_candidates));
+
+    std::vector<size_t> idxs(n);
+    std::iota(idxs.begin(), idxs.end(), 0);
+    std::partial_sort(
+        idxs.begin(), idxs.begin() + nCand, idxs.end(),
+        [&](size_t a, size_t b) { return sqrDists[a] < sqrDists[b]; });
+
+    // 2) Full column-shift distance:
+    for (size_t c = 0; c < nCand; c++)
+    {
+        const size_t i = idxs[c];
+        const auto   d =
+            q.distance(descriptors_[i], params_.shift_search_radius);
+
+        Match m;
+        m.keyframe_id = ids_[i];
+        m.distance    = d.distance;
+        m.yaw         = d.yaw;
+        matches.push_back(m);
+    }
+
+    std::sort(
+        matches.begin(), matches.end(),
+        [](const Match& a, const Match& b) { return a.distance < b.distance; });
+    if (matches.size() > k) matches.resize(k);
+
+    return matches;
+}
@@ -0,0 +1,224 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   bnb_se2_search.cpp
+ * @brief  Internal branch-and-bound SE(2) search over a score grid pyramid.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include "bnb_se2_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+using namespace mola::internal;
+
+int32_t ScoreGrid::x2idx(double x) const
+{
+    return static_cast<int32_t>(std::floor((x - x_min) / resolution));
+}
+
+int32_t ScoreGrid::y2idx(double y) const
+{
+    return static_cast<int32_t>(std::floor((y - y_min) / resolution));
+}
+
+void ScoreGrid::splat_gaussian(
+    double x, double y, double sigma, double maxDist)
+{
+    const int32_t r  = static_cast<int32_t>(std::ceil(maxDist / resolution));
+    const int32_t cx = x2idx(x), cy = y2idx(y);
+
+    const double k = -0.5 / (sigma * sigma);
+
+    for (int32_t iy = std::max(0, cy - r); iy <= std::min(ny - 1, cy + r);
+         iy++)
+    {
+        const double dy = y_min + (iy + 0.5) * resolution - y;
+        for (int32_t ix = std::max(0, cx - r); ix <= std::min(nx - 1, cx + r);
+             ix++)
+        {
+            const double dx = x_min + (ix + 0.5) * resolution - x;
+            const double d2 = dx * dx + dy * dy;
+            if (d2 > maxDist * maxDist) continue;
+
+            float& c = at(ix, iy);
+            c        = std::max(c, static_cast<float>(std::exp(k * d2)));
+        }
+    }
+}
+
+void ScorePyramid::build(const ScoreGrid& base, size_t numLevels)
+{
+    base_ = base;
+    levels_.clear();
+    levels_.resize(std::max<size_t>(1, numLevels));
+
+    // Level 0: the base grid itself
+    levels_[0].pad   = 0;
+    levels_[0].nx    = base.nx;
+    levels_[0].ny    = base.ny;
+    levels_[0].cells = base.cells;
+
+    // Level k from k-1: a window of width w=2^k is the union of four windows
+    // of width w/2 in the previous level:
+    for (size_t k = 1; k < levels_.size(); k++)
+    {
+        const int32_t w = 1 << k, h = w / 2;
+
+        auto& l = levels_[k];
+        l.pad   = w - 1;
+        l.nx    = base.nx + l.pad;
+        l.ny    = base.ny + l.pad;
+        l.cells.assign(static_cast<size_t>(l.nx) * l.ny, 0.0f);
+
+        for (int32_t j = 0; j < l.ny; j++)
+        {
+            const int32_t iy = j - l.pad;
+            for (int32_t i = 0; i < l.nx; i++)
+            {
+                const int32_t ix = i - l.pad;
+
+                l.cells[j * l.nx + i] = std::max(
+                    std::max(at(k - 1, ix, iy), at(k - 1, ix + h, iy)),
+                    std::max(at(k - 1, ix, iy + h), at(k - 1, ix + h, iy + h)));
+            }
+        }
+    }
+}
+
+namespace
+{
+struct Node
+{
+    float   score = 0;
+    int32_t level = 0;
+    int32_t tx = 0, ty = 0;
+    size_t  phi_idx = 0;
+
+    bool operator<(const Node& o) const
+    {
+        // Ties: prefer exact (lower level) nodes first
+        return score < o.score || (score == o.score && level > o.level);
+    }
+};
+
+// Query points, rotated for one orientation, as integer base grid cells:
+struct RotatedQuery
+{
+    std::vector<int32_t> px, py;
+};
+}  // namespace
+
+std::vector<BnBResult> mola::internal::branch_and_bound_se2(
+    const ScorePyramid& pyr, const BnBQuery& q, BnBStats& stats)
+{
+    std::vector<BnBResult> results;
+
+    const size_t nPts = q.xs.size();
+    if (nPts == 0 || q.phis.empty() || q.max_results == 0) return results;
+    if (q.tx_min > q.tx_max || q.ty_min > q.ty_max) return results;
+
+    const ScoreGrid& g = pyr.base();
+
+    std::vector<RotatedQuery> rotated(q.phis.size());
+    for (size_t a = 0; a < q.phis.size(); a++)
+    {
+        const double c = std::cos(q.phis[a]), s = std::sin(q.phis[a]);
+        auto&        r = rotated[a];
+        r.px.resize(nPts);
+        r.py.resize(nPts);
+        for (size_t i = 0; i < nPts; i++)
+        {
+            r.px[i] = g.x2idx(c * q.xs[i] - s * q.ys[i]);
+            r.py[i] = g.y2idx(s * q.xs[i] + c * q.ys[i]);
+        }
+    }
+
+    const auto lambdaScore = [&](int32_t level, size_t phiIdx, int32_t tx,
+                                 int32_t ty)
+    {
+        stats.evaluated_nodes++;
+        const auto& r   = rotated[phiIdx];
+        float       sum = 0;
+        for (size_t i = 0; i < nPts; i++)
+            sum += pyr.at(level, r.px[i] + tx, r.py[i] + ty);
+        return sum / static_cast<float>(nPts);
+    };
+
+    std::priority_queue<Node> queue;
+
+    // Initial candidates, at the coarsest level:
+    const int32_t top = static_cast<int32_t>(pyr.levels()) - 1;
+    const int32_t wTop = 1 << top;
+
+    for (size_t a = 0; a < q.phis.size(); a++)
+    {
+        for (int32_t tx = q.tx_min; tx <= q.tx_max; tx += wTop)
+        {
+            for (int32_t ty = q.ty_min; ty <= q.ty_max; ty += wTop)
+            {
+                Node n;
+                n.level   = top;
+                n.tx      = tx;
+                n.ty      = ty;
+                n.phi_idx = a;
+                n.score   = lambdaScore(top, a, tx, ty);
+                if (n.score >= q.min_score) queue.push(n);
+            }
+        }
+    }
+
+    // Best-first expansion:
+    while (!queue.empty() && results.size() < q.max_results)
+    {
+        const Node n = queue.top();
+        queue.pop();
+
+        if (n.level == 0)
+        {
+            // Exact score, and no other node can beat it:
+            results.push_back({n.score, n.tx, n.ty, n.phi_idx});
+            continue;
+        }
+
+        const int32_t h = 1 << (n.level - 1);
+        for (int32_t dx = 0; dx <= h; dx += h)
+        {
+            if (n.tx + dx > q.tx_max) continue;
+            for (int32_t dy = 0; dy <= h; dy += h)
+            {
+                if (n.ty + dy > q.ty_max) continue;
+
+                Node c;
+                c.level   = n.level - 1;
+                c.tx      = n.tx + dx;
+                c.ty      = n.ty + dy;
+                c.phi_idx = n.phi_idx;
+                c.score   = lambdaScore(c.level, c.phi_idx, c.tx, c.ty);
+                if (c.score >= q.min_score) queue.push(c);
+            }
+        }
+    }
+
+    return results;
+}
@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   bnb_se2_search.h
+ * @brief  Internal branch-and-bound SE(2) search over a score grid pyramid.
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mola::internal
+{
+/** A 2D grid of scores in the range [0,1]. Cell (ix,iy) covers
+ *  [x_min + ix*resolution, x_min + (ix+1)*resolution) (same for y).
+ */
+struct ScoreGrid
+{
+    double             x_min = 0, y_min = 0, resolution = 0.1;
+    int32_t            nx = 0, ny = 0;
+    std::vector<float> cells;  //!< row-major: iy*nx + ix
+
+    void resize(int32_t nX, int32_t nY)
+    {
+        nx = nX;
+        ny = nY;
+        cells.assign(static_cast<size_t>(nx) * ny, 0.0f);
+    }
+
+    float& at(int32_t ix, int32_t iy) { return cells[iy * nx + ix]; }
+
+    int32_t x2idx(double x) const;
+    int32_t y2idx(double y) const;
+
+    /// Raises the cells around (x,y) to exp(-0.5*d²/σ²), up to a distance
+    /// maxDist.
+    void splat_gaussian(double x, double y, double sigma, double maxDist);
+};
+
+/** Max-pooled multi-resolution version of a ScoreGrid: in level k, the value
+ *  of cell (ix,iy) is the maximum of the base grid over the 2^k x 2^k cells
+ *  [ix, ix+2^k) x [iy, iy+2^k). Cells outside of the base grid count as 0.
+ */
+class ScorePyramid
+{
+   public:
+    ScorePyramid() = default;
+
+    void build(const ScoreGrid& base, size_t numLevels);
+
+    size_t           levels() const { return levels_.size(); }
+    const ScoreGrid& base() const { return base_; }
+
+    float at(size_t level, int32_t ix, int32_t iy) const
+    {
+        const auto& l = levels_[level];
+        ix += l.pad;
+        iy += l.pad;
+        if (ix < 0 || iy < 0 || ix >= l.nx || iy >= l.ny) return 0.0f;
+        return l.cells[iy * l.nx + ix];
+    }
+
+   private:
+    struct Level
+    {
+        // Indices are shifted by "pad" = 2^k-1 so that windows starting
+        // before the grid origin are also stored:
+        int32_t            pad = 0, nx = 0, ny = 0;
+        std::vector<float> cells;
+    };
+
+    ScoreGrid          base_;
+    std::vector<Level> levels_;
+};
+
+struct BnBQuery
+{
+    /// Query points (in the local frame of the searched pose)
+    std::vector<float> xs, ys;
+
+    /// Translation search window, in integer cells of the base grid
+    /// (translation = index*resolution), both limits included:
+    int32_t tx_min = 0, tx_max = 0, ty_min = 0, ty_max = 0;
+
+    /// Orientations to evaluate [rad]
+    std::vector<double> phis;
+
+    /// Candidates with (an upper bound of) score below this are discarded
+    float min_score = 0.0f;
+
+    /// Number of best results to return
+    size_t max_results = 1;
+};
+
+struct BnBResult
+{
+    float   score = 0;
+    int32_t tx = 0, ty = 0;
+    size_t  phi_idx = 0;
+};
+
+struct BnBStats
+{
+    size_t evaluated_nodes = 0;
+};
+
+/** Best-first branch and bound: returns the max_results translations and
+ *  orientations with the highest scores (average of the base grid over the
+ *  transformed query points), sorted by descending score.
+ *
+ *  Nodes are expanded in order of their upper bound, so results are exact
+ *  with respect to an exhaustive evaluation of the same lattice.
+ */
+std::vector<BnBResult> branch_and_bound_se2(
+    const ScorePyramid& pyr, const BnBQuery& q, BnBStats& stats);
+
+}  // namespace mola::internal
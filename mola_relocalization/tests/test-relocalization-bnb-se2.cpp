@@ -0,0 +1,211 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-relocalization-bnb-se2.cpp
+ * @brief  Unit tests for branch-and-bound relocalization, on a synthetic map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_relocalization/relocalization.h>
+#include <mrpt/core/bits_math.h>  // .0_deg literal
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservationPointCloud.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+// An (asymmetric) floor plan made of walls, sampled every 5 cm:
+mrpt::maps::CSimplePointsMap::Ptr synthetic_map()
+{
+    auto m = mrpt::maps::CSimplePointsMap::Create();
+
+    const auto lambdaWall = [&](double x0, double y0, double x1, double y1)
+    {
+        const double L = std::hypot(x1 - x0, y1 - y0);
+        for (double s = 0; s <= L; s += 0.05)
+            m->insertPoint(x0 + (x1 - x0) * s / L, y0 + (y1 - y0) * s / L, 1.0);
+    };
+
+    lambdaWall(0, 0, 40, 0);
+    lambdaWall(40, 0, 40, 30);
+    lambdaWall(40, 30, 0, 30);
+    lambdaWall(0, 30, 0, 0);
+    lambdaWall(10, 0, 10, 12);
+    lambdaWall(10, 18, 10, 30);
+    lambdaWall(25, 8, 25, 30);
+    lambdaWall(25, 8, 33, 8);
+    lambdaWall(18, 15, 22, 20);
+    lambdaWall(3, 22, 7, 26);
+    lambdaWall(30, 20, 36, 20);
+    return m;
+}
+
+// Points of the map within a radius of the pose, in its local frame, with
+// some noise:
+mrpt::maps::CSimplePointsMap::Ptr synthetic_scan(
+    const mrpt::maps::CPointsMap& map, const mrpt::poses::CPose2D& pose,
+    double maxRange)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    auto scan = mrpt::maps::CSimplePointsMap::Create();
+
+    const auto& xs = map.getPointsBufferRef_x();
+    const auto& ys = map.getPointsBufferRef_y();
+    const auto& zs = map.getPointsBufferRef_z();
+    for (size_t i = 0; i < xs.size(); i++)
+    {
+        double lx, ly;
+        pose.inverseComposePoint(xs[i], ys[i], lx, ly);
+        if (std::hypot(lx, ly) > maxRange) continue;
+        scan->insertPoint(
+            lx + rng.drawGaussian1D(0, 0.02), ly + rng.drawGaussian1D(0, 0.02),
+            zs[i]);
+    }
+    return scan;
+}
+}  // namespace
+
+static void test_bnb_vs_exhaustive()
+{
+    using namespace mrpt::literals;  // _deg
+
+    const auto refMap = synthetic_map();
+
+    const auto groundTruth = mrpt::poses::CPose2D(12.3, 7.1, 25.0_deg);
+    const auto scan        = synthetic_scan(*refMap, groundTruth, 10.0);
+
+    // Branch-and-bound over the whole map and all orientations:
+    mola::RelocalizationBranchAndBound_SE2::Input in;
+    in.reference_map.layers["points"] = refMap;
+    in.local_map.layers["raw"]        = scan;
+    in.corner_min                     = {0.0, 0.0, -M_PI};
+    in.corner_max                     = {40.0, 30.0, M_PI - 1.0_deg};
+    in.resolution_xy                  = 0.10;
+    in.resolution_phi                 = 1.0_deg;
+    in.max_results                    = 5;
+
+    const auto out = mola::RelocalizationBranchAndBound_SE2::run(in);
+
+    std::cout << "[bnb] full map: time_cost=" << out.time_cost
+              << " evaluated_nodes=" << out.evaluated_nodes << std::endl;
+
+    ASSERT_(!out.best_poses.empty());
+    const auto& best = out.best_poses.rbegin()->second;
+    std::cout << "[bnb] best pose: " << best
+              << " score: " << out.best_poses.rbegin()->first << std::endl;
+
+    ASSERT_NEAR_(best.x, groundTruth.x(), 0.15);
+    ASSERT_NEAR_(best.y, groundTruth.y(), 0.15);
+    ASSERT_NEAR_(best.phi, groundTruth.phi(), 1.5_deg);
+
+    // Compare against the exhaustive likelihood method, on a smaller ROI
+    // (the full one would take too long):
+    const mrpt::math::TPose2D roiMin = {10.0, 5.0, 15.0_deg};
+    const mrpt::math::TPose2D roiMax = {15.0, 10.0, 35.0_deg};
+
+    in.corner_min     = roiMin;
+    in.corner_max     = roiMax;
+    const auto outRoi = mola::RelocalizationBranchAndBound_SE2::run(in);
+
+    auto& likOpts             = refMap->likelihoodOptions;
+    likOpts.max_corr_distance = 0.6;
+    likOpts.decimation        = 20;
+    likOpts.sigma_dist        = 0.2;
+
+    auto obs        = mrpt::obs::CObservationPointCloud::Create();
+    obs->pointcloud = scan;
+
+    mola::RelocalizationLikelihood_SE2::Input inLik;
+    inLik.reference_map.layers["points"] = refMap;
+    inLik.observations.insert(obs);
+    inLik.corner_min     = roiMin;
+    inLik.corner_max     = roiMax;
+    inLik.resolution_xy  = in.resolution_xy;
+    inLik.resolution_phi = in.resolution_phi;
+
+    const auto outLik = mola::RelocalizationLikelihood_SE2::run(inLik);
+
+    std::cout << "[bnb] ROI: bnb time_cost=" << outRoi.time_cost
+              << " (nodes=" << outRoi.evaluated_nodes
+              << ") exhaustive likelihood time_cost=" << outLik.time_cost
+              << " (cells=" << outLik.likelihood_grid.getSizeX() *
+                                   outLik.likelihood_grid.getSizeY() *
+                                   outLik.likelihood_grid.getSizePhi()
+              << ")" << std::endl;
+
+    const auto bestLik =
+        mola::find_best_poses_se2(outLik.likelihood_grid, 0.99);
+    ASSERT_(!bestLik.empty());
+    ASSERT_(!outRoi.best_poses.empty());
+
+    const auto& pLik = bestLik.rbegin()->second;
+    const auto& pBnB = outRoi.best_poses.rbegin()->second;
+    std::cout << "[bnb] ROI best: bnb=" << pBnB << " exhaustive=" << pLik
+              << std::endl;
+
+    ASSERT_NEAR_(pBnB.x, pLik.x, 0.2);
+    ASSERT_NEAR_(pBnB.y, pLik.y, 0.2);
+    ASSERT_NEAR_(pBnB.phi, pLik.phi, 2.0_deg);
+}
+
+static void test_bnb_no_match()
+{
+    // A query that does not fit anywhere must return nothing above the
+    // minimum score:
+    const auto refMap = synthetic_map();
+
+    auto scan = mrpt::maps::CSimplePointsMap::Create();
+    for (int i = 0; i < 100; i++)
+        scan->insertPoint(2.0 * std::cos(i * 0.3), 2.0 * std::sin(i * 0.3), 0);
+
+    mola::RelocalizationBranchAndBound_SE2::Input in;
+    in.reference_map.layers["points"] = refMap;
+    in.local_map.layers["raw"]        = scan;
+    in.corner_min                     = {0.0, 0.0, 0.0};
+    in.corner_max                     = {40.0, 30.0, 0.0};
+    in.min_score                      = 0.9;
+
+    const auto out = mola::RelocalizationBranchAndBound_SE2::run(in);
+    ASSERT_(out.best_poses.empty());
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_bnb_vs_exhaustive();
+        test_bnb_no_match();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,211 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-relocalization-likelihood-se2.cpp
+ * @brief  Regression test of RelocalizationLikelihood_SE2 vs. evaluating
+ *         each lattice pose directly, on a synthetic map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_relocalization/relocalization.h>
+#include <mrpt/core/bits_math.h>  // .0_deg literal
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CObservationPointCloud.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cmath>
+#include <iostream>
+#include <optional>
+
+namespace
+{
+// A room with a few walls inside, sampled every 5 cm:
+mrpt::maps::CSimplePointsMap::Ptr synthetic_map(double dx)
+{
+    auto m = mrpt::maps::CSimplePointsMap::Create();
+
+    const auto lambdaWall = [&](double x0, double y0, double x1, double y1)
+    {
+        const double L = std::hypot(x1 - x0, y1 - y0);
+        for (double s = 0; s <= L; s += 0.05)
+            m->insertPoint(
+                dx + x0 + (x1 - x0) * s / L, y0 + (y1 - y0) * s / L, 0.5);
+    };
+
+    lambdaWall(0, 0, 12, 0);
+    lambdaWall(12, 0, 12, 8);
+    lambdaWall(12, 8, 0, 8);
+    lambdaWall(0, 8, 0, 0);
+    lambdaWall(4, 0, 4, 3);
+    lambdaWall(8, 5, 10, 7);
+    return m;
+}
+
+// The reference implementation: evaluates each lattice pose directly, in
+// the calling thread, as RelocalizationLikelihood_SE2 did before being
+// parallelized.
+mola::RelocalizationLikelihood_SE2::Output direct_evaluation(
+    const mola::RelocalizationLikelihood_SE2::Input& in)
+{
+    mola::RelocalizationLikelihood_SE2::Output result;
+
+    result.likelihood_grid = mrpt::poses::CPosePDFGrid(
+        in.corner_min.x, in.corner_max.x, in.corner_min.y, in.corner_max.y,
+        in.resolution_xy, in.resolution_phi, in.corner_min.phi,
+        in.corner_max.phi);
+    auto& grid = result.likelihood_grid;
+
+    std::optional<double> minW, maxW;
+    for (size_t iX = 0; iX < grid.getSizeX(); iX++)
+        for (size_t iY = 0; iY < grid.getSizeY(); iY++)
+            for (size_t iPhi = 0; iPhi < grid.getSizePhi(); iPhi++)
+            {
+                const auto pose = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+                    grid.idx2x(iX), grid.idx2y(iY), 0, grid.idx2phi(iPhi), 0,
+                    0);
+                for (const auto& [layerName, map] : in.reference_map.layers)
+                {
+                    const double logLik = map->computeObservationsLikelihood(
+                        in.observations, pose);
+                    *grid.getByIndex(iX, iY, iPhi) = logLik;
+                    if (!minW || logLik < *minW) minW = logLik;
+                    if (!maxW || logLik > *maxW) maxW = logLik;
+                }
+            }
+
+    for (size_t iX = 0; iX < grid.getSizeX(); iX++)
+        for (size_t iY = 0; iY < grid.getSizeY(); iY++)
+            for (size_t iPhi = 0; iPhi < grid.getSizePhi(); iPhi++)
+            {
+                double& cell = *grid.getByIndex(iX, iY, iPhi);
+                cell         = std::exp(cell - *maxW);
+            }
+    grid.normalize();
+
+    result.min_log_likelihood = *minW - *maxW;
+    return result;
+}
+}  // namespace
+
+static void test_vs_direct_evaluation()
+{
+    using namespace mrpt::literals;  // _deg
+
+    const auto sensorPose =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(0.3, -0.1, 0.4, 0.2, 0, 0);
+    const auto truePose =
+        mrpt::poses::CPose3D::FromXYZYawPitchRoll(5.0, 4.0, 0, 30.0_deg, 0, 0);
+
+    // Two layers, with different likelihood parameters:
+    const auto layerA = synthetic_map(0.0);
+    const auto layerB = synthetic_map(0.2);
+    for (const auto& m : {layerA, layerB})
+    {
+        m->likelihoodOptions.max_corr_distance = 0.8;
+        m->likelihoodOptions.decimation        = 5;
+    }
+    layerA->likelihoodOptions.sigma_dist = 0.3;
+    layerB->likelihoodOptions.sigma_dist = 0.1;
+
+    // A point cloud observation, in the sensor frame:
+    auto pc = mrpt::maps::CSimplePointsMap::Create();
+    {
+        const auto& xs = layerA->getPointsBufferRef_x();
+        const auto& ys = layerA->getPointsBufferRef_y();
+        const auto& zs = layerA->getPointsBufferRef_z();
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            const auto p = (truePose + sensorPose)
+                               .inverseComposePoint({xs[i], ys[i], zs[i]});
+            if (p.norm() < 6.0) pc->insertPoint(p);
+        }
+    }
+    auto obsPc        = mrpt::obs::CObservationPointCloud::Create();
+    obsPc->pointcloud = pc;
+    obsPc->sensorPose = sensorPose;
+
+    // ...and a 2D scan, which the maps evaluate through its own point cloud:
+    auto scan        = mrpt::obs::CObservation2DRangeScan::Create();
+    scan->aperture   = 180.0_deg;
+    scan->maxRange   = 10.0;
+    scan->sensorPose = mrpt::poses::CPose3D(0.1, 0, 0.2, 0, 0, 0);
+
+    const size_t nRays = 91;
+    scan->resizeScan(nRays);
+    for (size_t i = 0; i < nRays; i++)
+        scan->setScanRange(i, 2.0f + 0.02f * static_cast<float>(i));
+    for (size_t i = 0; i < nRays; i++) scan->setScanRangeValidity(i, true);
+
+    mola::RelocalizationLikelihood_SE2::Input in;
+    in.reference_map.layers["a"] = layerA;
+    in.reference_map.layers["b"] = layerB;
+    in.observations.insert(obsPc);
+    in.observations.insert(scan);
+    in.corner_min     = {4.0, 3.0, 0.0_deg};
+    in.corner_max     = {6.0, 5.0, 60.0_deg};
+    in.resolution_xy  = 0.25;
+    in.resolution_phi = 10.0_deg;
+
+    const auto  ref = direct_evaluation(in);
+    const auto& gR  = ref.likelihood_grid;
+
+    for (const size_t nThreads : {1, 4})
+    {
+        in.num_threads = nThreads;
+        const auto  out = mola::RelocalizationLikelihood_SE2::run(in);
+        const auto& g   = out.likelihood_grid;
+
+        std::cout << "[likelihood-se2] threads=" << nThreads
+                  << " time_cost=" << out.time_cost << std::endl;
+
+        ASSERT_EQUAL_(g.getSizeX(), gR.getSizeX());
+        ASSERT_EQUAL_(g.getSizeY(), gR.getSizeY());
+        ASSERT_EQUAL_(g.getSizePhi(), gR.getSizePhi());
+        for (size_t iX = 0; iX < g.getSizeX(); iX++)
+            for (size_t iY = 0; iY < g.getSizeY(); iY++)
+                for (size_t iPhi = 0; iPhi < g.getSizePhi(); iPhi++)
+                {
+                    const double r = *gR.getByIndex(iX, iY, iPhi);
+                    ASSERT_NEAR_(
+                        *g.getByIndex(iX, iY, iPhi), r, 1e-6 + 1e-4 * r);
+                }
+        ASSERT_NEAR_(
+            out.min_log_likelihood, ref.min_log_likelihood,
+            1e-4 * (1.0 + std::abs(ref.min_log_likelihood)));
+    }
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_vs_direct_evaluation();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -26,11 +26,17 @@
  */
 
 #include <mola_relocalization/relocalization.h>
+#include <mp2p_icp/icp_pipeline_from_yaml.h>
 #include <mrpt/core/bits_math.h>  // .0_deg literal
 #include <mrpt/obs/CObservationPointCloud.h>
 #include <mrpt/obs/CRawlog.h>
 #include <mrpt/system/filesystem.h>
 
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
 const std::string datasetsRoot = TEST_DATASETS_ROOT;
 
 static void test1()
@@ -129,6 +135,186 @@ static void test1()
     ASSERT_NEAR_(best.phi, 0.0, 0.1);
 
     std::cout << "best pose: " << best << std::endl;
+
+    // The result must not depend on the number of threads:
+    in.num_threads         = 1;
+    const auto outSerial   = mola::RelocalizationLikelihood_SE2::run(in);
+    in.num_threads         = 4;
+    const auto outParallel = mola::RelocalizationLikelihood_SE2::run(in);
+
+    std::cout << "time_cost: serial=" << outSerial.time_cost
+              << " parallel(4)=" << outParallel.time_cost
+              << " default=" << out.time_cost << std::endl;
+
+    const auto& gS = outSerial.likelihood_grid;
+    const auto& gP = outParallel.likelihood_grid;
+    ASSERT_EQUAL_(gS.getSizeX(), gP.getSizeX());
+    ASSERT_EQUAL_(gS.getSizeY(), gP.getSizeY());
+    ASSERT_EQUAL_(gS.getSizePhi(), gP.getSizePhi());
+    for (size_t iX = 0; iX < gS.getSizeX(); iX++)
+        for (size_t iY = 0; iY < gS.getSizeY(); iY++)
+            for (size_t iPhi = 0; iPhi < gS.getSizePhi(); iPhi++)
+                ASSERT_EQUAL_(
+                    *gS.getByIndex(iX, iY, iPhi), *gP.getByIndex(iX, iY, iPhi));
+    ASSERT_EQUAL_(outSerial.min_log_likelihood, outParallel.min_log_likelihood);
+
+    // And log-likelihood differences must match those from evaluating each
+    // pose directly:
+    const auto lambdaDirect = [&](size_t iX, size_t iY, size_t iPhi)
+    {
+        const auto p = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+            gS.idx2x(iX), gS.idx2y(iY), 0, gS.idx2phi(iPhi), 0, 0);
+        return obs1->pointcloud->computeObservationsLikelihood(querySf, p);
+    };
+    const size_t iXA = gS.x2idx(1.5), iYA = gS.y2idx(0.0),
+                 iPhiA = gS.phi2idx(0.0_deg);
+    const size_t iXB = gS.x2idx(0.0), iYB = gS.y2idx(0.5),
+                 iPhiB = gS.phi2idx(10.0_deg);
+
+    const double directDiff =
+        lambdaDirect(iXA, iYA, iPhiA) - lambdaDirect(iXB, iYB, iPhiB);
+    const double gridDiff = std::log(*gS.getByIndex(iXA, iYA, iPhiA)) -
+                            std::log(*gS.getByIndex(iXB, iYB, iPhiB));
+    ASSERT_NEAR_(directDiff, gridDiff, 1e-3 * (1.0 + std::abs(directDiff)));
+}
+
+static const char* icpPipelineYaml = R"###(
+class_name: mp2p_icp::ICP
+
+params:
+  maxIterations: 50
+  minAbsStep_trans: 1e-4
+  minAbsStep_rot: 5e-5
+
+solvers:
+  - class: mp2p_icp::Solver_Horn
+    params: {}
+
+matchers:
+  - class: mp2p_icp::Matcher_Points_DistanceThreshold
+    params:
+      threshold: 1.0
+
+quality:
+  - class: mp2p_icp::QualityEvaluator_PairedRatio
+    params: {}
+)###";
+
+static void test_icp_cascade()
+{
+    using namespace mrpt::literals;  // _deg
+
+    mrpt::obs::CRawlog kitti;
+    const auto         fil = mrpt::system::pathJoin(
+                {datasetsRoot, "kitti", "kitti_00_extract.rawlog"});
+    ASSERT_FILE_EXISTS_(fil);
+    ASSERT_(kitti.loadFromRawLogFile(fil));
+
+    auto obs1 = std::dynamic_pointer_cast<mrpt::obs::CObservationPointCloud>(
+        kitti.getAsObservation(0));
+    auto obs2 = std::dynamic_pointer_cast<mrpt::obs::CObservationPointCloud>(
+        kitti.getAsObservation(8));
+    ASSERT_(obs1);
+    ASSERT_(obs2);
+
+    // Decimate the query cloud, to keep this test fast:
+    auto query = std::dynamic_pointer_cast<mrpt::maps::CPointsMap>(
+        obs2->pointcloud->duplicateGetSmartPtr());
+    {
+        std::vector<bool> deletionMask(query->size());
+        for (size_t i = 0; i < deletionMask.size(); i++)
+            deletionMask[i] = (i % 10) != 0;
+        query->applyDeletionMask(deletionMask);
+    }
+
+    mola::RelocalizationICP_SE2::Input in;
+    in.reference_map.layers["raw"] = obs1->pointcloud;
+    in.local_map.layers["raw"]     = query;
+
+    for (int i = 0; i < 4; i++)
+    {
+        auto [icp, icpParams] = mp2p_icp::icp_pipeline_from_yaml(
+            mrpt::containers::yaml::FromText(icpPipelineYaml));
+        in.icp_pipeline.push_back(icp);
+        in.icp_parameters = icpParams;
+    }
+    in.icp_minimum_quality = 0.60;
+
+    in.initial_guess_lattice.corner_min     = {-2.0, -1.0, -30.0_deg};
+    in.initial_guess_lattice.corner_max     = {+5.0, +1.0, +30.0_deg};
+    in.initial_guess_lattice.resolution_xy  = 1.0;
+    in.initial_guess_lattice.resolution_phi = 15.0_deg;
+
+    // success: any of the found poses is close to the ground truth:
+    const auto lambdaSuccess = [](const mola::HashedSetSE3& found)
+    {
+        bool ok = false;
+        found.visitAllPoses(
+            [&](const mrpt::math::TPose3D& p)
+            {
+                if (std::abs(p.x - 1.5) < 0.3 && std::abs(p.y) < 0.3 &&
+                    std::abs(p.yaw) < 3.0_deg)
+                    ok = true;
+            });
+        return ok;
+    };
+
+    // Exhaustive:
+    const auto outFull = mola::RelocalizationICP_SE2::run(in);
+
+    // Cascade:
+    in.cascade.enabled              = true;
+    in.cascade.local_map_decimation = 10;
+    in.cascade.max_survivors        = 5;
+    in.cascade.coarse_icp_parameters.emplace(in.icp_parameters);
+    in.cascade.coarse_icp_parameters->maxIterations = 15;
+
+    const auto outCascade = mola::RelocalizationICP_SE2::run(in);
+
+    // Cascade, with early termination:
+    in.cascade.early_stop_quality = 0.80;
+    const auto outEarly           = mola::RelocalizationICP_SE2::run(in);
+
+    const bool okFull    = lambdaSuccess(outFull.found_poses);
+    const bool okCascade = lambdaSuccess(outCascade.found_poses);
+    const bool okEarly   = lambdaSuccess(outEarly.found_poses);
+
+    std::cout << "[icp] exhaustive: time_cost=" << outFull.time_cost
+              << " runs=" << outFull.fine_icp_runs << " success=" << okFull
+              << "\n";
+    std::cout << "[icp] cascade: time_cost=" << outCascade.time_cost
+              << " coarse_runs=" << outCascade.coarse_icp_runs
+              << " fine_runs=" << outCascade.fine_icp_runs
+              << " success=" << okCascade
+              << " speedup=" << outFull.time_cost / outCascade.time_cost
+              << "\n";
+    std::cout << "[icp] cascade+early stop: time_cost=" << outEarly.time_cost
+              << " fine_runs=" << outEarly.fine_icp_runs
+              << " success=" << okEarly
+              << " speedup=" << outFull.time_cost / outEarly.time_cost << "\n";
+
+    ASSERT_(okFull);
+    ASSERT_(okCascade);
+    ASSERT_LE_(outCascade.fine_icp_runs, in.cascade.max_survivors);
+
+    // The found poses must not depend on thread scheduling:
+    const auto lambdaPoses = [](const mola::HashedSetSE3& found)
+    {
+        std::vector<mrpt::math::TPose3D> poses;
+        found.visitAllPoses([&](const mrpt::math::TPose3D& p)
+                            { poses.push_back(p); });
+        std::sort(
+            poses.begin(), poses.end(),
+            [](const auto& a, const auto& b)
+            {
+                return std::tie(a.yaw, a.x, a.y) < std::tie(b.yaw, b.x, b.y);
+            });
+        return poses;
+    };
+    const auto outEarly2 = mola::RelocalizationICP_SE2::run(in);
+    ASSERT_(
+        lambdaPoses(outEarly.found_poses) ==
+        lambdaPoses(outEarly2.found_poses));
 }
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
@@ -136,6 +322,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
     try
     {
         test1();
+        test_icp_cascade();
 
         std::cout << "Test successful." << std::endl;
     }
@@ -0,0 +1,219 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-relocalization-se3.cpp
+ * @brief  Unit tests for SE(3) relocalization, on a synthetic multi-level map
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_metric_maps/HashedVoxelPointCloud.h>
+#include <mola_relocalization/relocalization.h>
+#include <mrpt/core/bits_math.h>  // .0_deg literal
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cmath>
+#include <iostream>
+#include <tuple>
+
+namespace
+{
+constexpr double LEVEL_HEIGHT = 3.0;
+constexpr double MAP_SIZE_X   = 30.0;
+constexpr double MAP_SIZE_Y   = 20.0;
+
+// A two-level garage: floors, ceilings, outer walls and pillars, with a
+// different pillar layout in each level so they can be told apart.
+std::vector<mrpt::math::TPoint3Df> synthetic_garage()
+{
+    std::vector<mrpt::math::TPoint3Df> pts;
+
+    const auto lambdaPlaneZ = [&](double z)
+    {
+        for (double x = 0; x <= MAP_SIZE_X; x += 0.25)
+            for (double y = 0; y <= MAP_SIZE_Y; y += 0.25)
+                pts.emplace_back(x, y, z);
+    };
+    const auto lambdaPillar = [&](double cx, double cy, double z0)
+    {
+        for (double z = z0; z <= z0 + LEVEL_HEIGHT; z += 0.1)
+            for (double d = -0.2; d <= 0.2; d += 0.1)
+            {
+                pts.emplace_back(cx + d, cy - 0.2, z);
+                pts.emplace_back(cx + d, cy + 0.2, z);
+                pts.emplace_back(cx - 0.2, cy + d, z);
+                pts.emplace_back(cx + 0.2, cy + d, z);
+            }
+    };
+    const auto lambdaWall =
+        [&](double x0, double y0, double x1, double y1, double z0)
+    {
+        const double L = std::hypot(x1 - x0, y1 - y0);
+        for (double s = 0; s <= L; s += 0.1)
+            for (double z = z0; z <= z0 + LEVEL_HEIGHT; z += 0.2)
+                pts.emplace_back(
+                    x0 + (x1 - x0) * s / L, y0 + (y1 - y0) * s / L, z);
+    };
+
+    for (int level = 0; level < 2; level++)
+    {
+        const double z0 = level * LEVEL_HEIGHT;
+        lambdaPlaneZ(z0);
+        lambdaWall(0, 0, MAP_SIZE_X, 0, z0);
+        lambdaWall(MAP_SIZE_X, 0, MAP_SIZE_X, MAP_SIZE_Y, z0);
+        lambdaWall(MAP_SIZE_X, MAP_SIZE_Y, 0, MAP_SIZE_Y, z0);
+        lambdaWall(0, MAP_SIZE_Y, 0, 0, z0);
+    }
+    lambdaPlaneZ(2 * LEVEL_HEIGHT);
+
+    // Level 0 pillars: a regular grid
+    for (double x = 5; x < MAP_SIZE_X; x += 8)
+        for (double y = 5; y < MAP_SIZE_Y; y += 8) lambdaPillar(x, y, 0);
+
+    // Level 1 pillars: an irregular layout
+    lambdaPillar(7.0, 12.5, LEVEL_HEIGHT);
+    lambdaPillar(11.5, 6.0, LEVEL_HEIGHT);
+    lambdaPillar(18.0, 11.0, LEVEL_HEIGHT);
+    lambdaPillar(16.5, 3.5, LEVEL_HEIGHT);
+    lambdaPillar(24.0, 15.0, LEVEL_HEIGHT);
+    lambdaWall(20, 6, 26, 6, LEVEL_HEIGHT);
+
+    return pts;
+}
+}  // namespace
+
+static void test_pitch_roll_from_gravity()
+{
+    using namespace mrpt::literals;  // _deg
+
+    const double pitch = 5.0_deg, roll = -3.0_deg;
+
+    const auto R = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        0, 0, 0, 1.0 /*yaw: irrelevant*/, pitch, roll);
+
+    // acc = R^T * (0,0,g)
+    mrpt::math::TVector3D acc;
+    R.inverseComposePoint(0, 0, 9.81, acc.x, acc.y, acc.z);
+
+    const auto [p, r] = mola::pitch_roll_from_gravity(acc);
+    ASSERT_NEAR_(p, pitch, 1e-9);
+    ASSERT_NEAR_(r, roll, 1e-9);
+}
+
+static void test_multilevel()
+{
+    using namespace mrpt::literals;  // _deg
+
+    const auto mapPts = synthetic_garage();
+
+    auto refMap = mola::HashedVoxelPointCloud::Create(0.20f);
+    for (const auto& p : mapPts) refMap->insertPoint(p);
+
+    // Vehicle on the upper level, slightly tilted:
+    const auto groundTruth = mrpt::poses::CPose3D::FromXYZYawPitchRoll(
+        14.0, 9.0, LEVEL_HEIGHT, 40.0_deg, 2.0_deg, -1.0_deg);
+
+    // Simulated scan: points of the upper level within a radius:
+    auto scan = mrpt::maps::CSimplePointsMap::Create();
+    for (const auto& p : mapPts)
+    {
+        if (p.z < LEVEL_HEIGHT - 0.01 || p.z > 2 * LEVEL_HEIGHT + 0.01)
+            continue;
+        if (std::hypot(p.x - groundTruth.x(), p.y - groundTruth.y()) > 12.0)
+            continue;
+        double lx, ly, lz;
+        groundTruth.inverseComposePoint(p.x, p.y, p.z, lx, ly, lz);
+        scan->insertPoint(lx, ly, lz);
+    }
+
+    // IMU reading at rest:
+    mrpt::math::TVector3D acc;
+    groundTruth.inverseComposePoint(
+        groundTruth.x(), groundTruth.y(), groundTruth.z() + 9.81, acc.x, acc.y,
+        acc.z);
+
+    mola::RelocalizationVoxelLikelihood_SE3::Input in;
+    in.reference_map.layers["voxels"] = refMap;
+    in.local_map.layers["raw"]        = scan;
+    in.corner_min                     = {0.0, 0.0, 0.0};
+    in.corner_max                     = {MAP_SIZE_X, MAP_SIZE_Y, 4.0};
+    in.resolution_xy                  = 1.0;
+    in.resolution_z                   = 1.0;
+    in.resolution_yaw                 = 10.0_deg;
+    in.yaw_min                        = -180.0_deg;
+    in.yaw_max                        = 170.0_deg;
+    in.max_query_points               = 300;
+    std::tie(in.pitch, in.roll)       = mola::pitch_roll_from_gravity(acc);
+
+    const auto out = mola::RelocalizationVoxelLikelihood_SE3::run(in);
+
+    std::cout << "[se3] time_cost=" << out.time_cost
+              << " scoring=" << out.time_cost_scoring
+              << " evaluated_poses=" << out.evaluated_poses << "\n";
+    for (const auto& c : out.candidates)
+        std::cout << "[se3] candidate: " << c.pose << " score=" << c.score
+                  << "\n";
+
+    ASSERT_(!out.candidates.empty());
+    const auto& best = out.candidates.front().pose;
+
+    ASSERT_NEAR_(best.x, groundTruth.x(), 0.6);
+    ASSERT_NEAR_(best.y, groundTruth.y(), 0.6);
+    ASSERT_NEAR_(best.z, groundTruth.z(), 0.6);  // right level
+    ASSERT_NEAR_(
+        mrpt::math::wrapToPi(best.yaw - groundTruth.yaw()), 0.0, 6.0_deg);
+    ASSERT_NEAR_(best.pitch, groundTruth.pitch(), 1e-6);
+    ASSERT_NEAR_(best.roll, groundTruth.roll(), 1e-6);
+
+    // Results must not depend on the number of threads:
+    in.num_threads        = 1;
+    const auto outSerial = mola::RelocalizationVoxelLikelihood_SE3::run(in);
+    ASSERT_EQUAL_(outSerial.candidates.size(), out.candidates.size());
+    for (size_t i = 0; i < out.candidates.size(); i++)
+    {
+        const auto& a = outSerial.candidates[i];
+        const auto& b = out.candidates[i];
+        ASSERT_EQUAL_(a.score, b.score);
+        ASSERT_EQUAL_(a.pose.x, b.pose.x);
+        ASSERT_EQUAL_(a.pose.y, b.pose.y);
+        ASSERT_EQUAL_(a.pose.z, b.pose.z);
+        ASSERT_EQUAL_(a.pose.yaw, b.pose.yaw);
+    }
+    std::cout << "[se3] serial time_cost=" << outSerial.time_cost << "\n";
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_pitch_roll_from_gravity();
+        test_multilevel();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
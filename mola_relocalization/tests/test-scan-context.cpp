@@ -0,0 +1,207 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-scan-context.cpp
+ * @brief  Unit tests for Scan Context descriptors, on synthetic scans
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_relocalization/ScanContext.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/math/TPose2D.h>
+#include <mrpt/math/wrap2pi.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+struct Pillar
+{
+    double x, y, height;
+};
+
+// Pillars of random heights, scattered over a 300x300 m area:
+std::vector<Pillar> synthetic_world()
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    std::vector<Pillar> world;
+    for (int i = 0; i < 800; i++)
+        world.push_back(
+            {rng.drawUniform(0.0, 300.0), rng.drawUniform(0.0, 300.0),
+             rng.drawUniform(1.0, 10.0)});
+    return world;
+}
+
+// Pillars as seen from a sensor at the given pose, 1.8 m over the ground:
+mrpt::maps::CSimplePointsMap synthetic_scan(
+    const std::vector<Pillar>& world, const mrpt::math::TPose2D& pose)
+{
+    const double c = std::cos(pose.phi), s = std::sin(pose.phi);
+
+    mrpt::maps::CSimplePointsMap scan;
+    for (const auto& p : world)
+    {
+        const double dx = p.x - pose.x, dy = p.y - pose.y;
+        if (dx * dx + dy * dy > 80.0 * 80.0) continue;
+        for (double z = 0; z <= p.height; z += 0.5)
+            scan.insertPoint(c * dx + s * dy, -s * dx + c * dy, z - 1.8);
+    }
+    return scan;
+}
+}  // namespace
+
+static void test_yaw_estimate()
+{
+    const auto world = synthetic_world();
+
+    const mrpt::math::TPose2D poseA = {150.0, 150.0, 0.3};
+    const mrpt::math::TPose2D poseB = {150.0, 150.0, 0.3 + 1.2};
+
+    const auto scanA = synthetic_scan(world, poseA);
+    const auto scanB = synthetic_scan(world, poseB);
+    const auto a     = mola::ScanContext::FromPointCloud(scanA);
+    const auto b     = mola::ScanContext::FromPointCloud(scanB);
+
+    ASSERT_EQUAL_(a.num_rings(), 20U);
+    ASSERT_EQUAL_(a.num_sectors(), 60U);
+
+    // Ring keys are yaw invariant:
+    for (size_t i = 0; i < a.num_rings(); i++)
+        ASSERT_NEAR_(a.ring_key()[i], b.ring_key()[i], 0.05);
+
+    const auto d = b.distance(a);
+    std::cout << "[sc] distance=" << d.distance << " yaw=" << d.yaw
+              << std::endl;
+
+    const double sectorWidth = 2 * M_PI / a.num_sectors();
+    ASSERT_LT_(d.distance, 0.1);
+    ASSERT_NEAR_(mrpt::math::wrapToPi(d.yaw - 1.2), 0.0, sectorWidth);
+
+    // Same result with the sector-key pre-alignment:
+    const auto d2 = b.distance(a, 3);
+    ASSERT_NEAR_(mrpt::math::wrapToPi(d2.yaw - 1.2), 0.0, sectorWidth);
+}
+
+static void test_index_recall()
+{
+    const auto world = synthetic_world();
+    auto&      rng   = mrpt::random::getRandomGenerator();
+
+    const size_t numKeyframes = 2000, numQueries = 100;
+
+    std::vector<mrpt::math::TPose2D> keyframes;
+    mola::ScanContextIndex           index;
+
+    mrpt::system::CTicTac tictac;
+    double                tDescriptors = 0, tInsert = 0;
+
+    for (size_t i = 0; i < numKeyframes; i++)
+    {
+        const mrpt::math::TPose2D p = {
+            rng.drawUniform(20.0, 280.0), rng.drawUniform(20.0, 280.0),
+            rng.drawUniform(-M_PI, M_PI)};
+        keyframes.push_back(p);
+
+        const auto scan = synthetic_scan(world, p);
+
+        tictac.Tic();
+        const auto desc = mola::ScanContext::FromPointCloud(scan);
+        tDescriptors += tictac.Tac();
+
+        tictac.Tic();
+        index.insert(i, desc);
+        tInsert += tictac.Tac();
+    }
+    ASSERT_EQUAL_(index.size(), numKeyframes);
+
+    std::cout << "[sc] build: " << numKeyframes
+              << " keyframes, descriptors=" << 1e3 * tDescriptors / numKeyframes
+              << " ms/kf, insert=" << 1e6 * tInsert / numKeyframes << " us/kf"
+              << std::endl;
+
+    for (const size_t radius : {0U, 3U})
+    {
+        index.params_.shift_search_radius = radius;
+
+        size_t hits = 0;
+        double tQuery = 0;
+        for (size_t q = 0; q < numQueries; q++)
+        {
+            const size_t kf   = (q * 17) % numKeyframes;
+            const double dYaw = rng.drawUniform(-M_PI, M_PI);
+
+            // Revisit, slightly displaced and with a different heading:
+            const mrpt::math::TPose2D p = {
+                keyframes[kf].x + rng.drawUniform(-0.3, 0.3),
+                keyframes[kf].y + rng.drawUniform(-0.3, 0.3),
+                keyframes[kf].phi + dYaw};
+
+            const auto desc =
+                mola::ScanContext::FromPointCloud(synthetic_scan(world, p));
+
+            tictac.Tic();
+            const auto matches = index.query(desc, 5);
+            tQuery += tictac.Tac();
+
+            ASSERT_(!matches.empty());
+            if (matches.front().keyframe_id != kf) continue;
+
+            hits++;
+            ASSERT_NEAR_(
+                mrpt::math::wrapToPi(matches.front().yaw - dYaw), 0.0,
+                2 * 2 * M_PI / desc.num_sectors());
+        }
+
+        std::cout << "[sc] query (shift_search_radius=" << radius
+                  << "): recall@1=" << hits << "/" << numQueries
+                  << " time=" << 1e3 * tQuery / numQueries << " ms/query"
+                  << std::endl;
+
+        ASSERT_GE_(hits, numQueries * 9 / 10);
+    }
+
+    index.clear();
+    ASSERT_(index.empty());
+}
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_yaw_estimate();
+        test_index_recall();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
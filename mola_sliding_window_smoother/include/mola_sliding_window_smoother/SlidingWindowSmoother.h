@@ -0,0 +1,171 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   SlidingWindowSmoother.h
+ * @brief  Reference SLAM back-end: fixed-lag smoother of SE(3) keyframes
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_kernel/interfaces/BackEndBase.h>
+#include <mola_kernel/interfaces/LocalizationSourceBase.h>
+#include <mrpt/core/pimpl.h>
+#include <mrpt/math/TPose3D.h>
+
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+
+namespace mola
+{
+/** Parameters of SlidingWindowSmoother, loaded from the `params` YAML entry.
+ *
+ * \ingroup mola_sliding_window_smoother_grp
+ */
+struct SlidingWindowSmootherParameters
+{
+    /** Keyframes older than the newest one by more than this are
+     * marginalized out of the smoother [s] */
+    double window_length = 10.0;
+
+    /// iSAM2 relinearization threshold and period (in updates)
+    double relinearize_threshold = 0.1;
+    int    relinearize_skip      = 1;
+
+    /** Uncertainty of the prior on the first keyframe, which defines the
+     * origin of the reference frame [m] and [rad] */
+    double first_kf_sigma_xyz = 1e-3;
+    double first_kf_sigma_rot = 1e-3;
+
+    /// Frame of reference of published localization updates
+    std::string reference_frame = "map";
+};
+
+/** A reference SLAM back-end, keeping a fixed-lag smoother (iSAM2-based) of
+ * the keyframe poses within a sliding time window.
+ *
+ * - doAddKeyFrame() creates a RelPose3KF entity in the WorldModel, relative to
+ *   a single RefPose3 entity (the reference frame), created with the first
+ *   keyframe. The first keyframe gets a prior at the origin.
+ * - doAddFactor() stores the factor in the WorldModel. Relative pose
+ *   factors (FactorRelativePose3) between keyframes in the window are also
+ *   added to the smoother, and the initial estimate of new keyframes is taken
+ *   from the first factor connecting them with a keyframe in the window.
+ *   Other factors, and factors involving marginalized keyframes, are only
+ *   kept in the WorldModel.
+ * - After each smoother update, the estimated poses are written back into
+ *   the WorldModel keyframes. Marginalized keyframes are added to the
+ *   WorldModel as priors: relative pose factors from the reference frame with
+ *   their last estimate and marginal covariance.
+ * - The pose of the newest keyframe is published as a localization update
+ *   after each smoother update, and so are front-end poses relative to
+ *   keyframes sent via advertiseUpdatedLocalization().
+ *
+ * Configuration block:
+ * \code
+ * params:
+ *   window_length: 10.0  # [s]
+ *   relinearize_threshold: 0.1
+ *   relinearize_skip: 1
+ *   first_kf_sigma_xyz: 1e-3  # [m]
+ *   first_kf_sigma_rot: 1e-3  # [rad]
+ *   reference_frame: 'map'
+ * \endcode
+ *
+ * \ingroup mola_sliding_window_smoother_grp
+ */
+class SlidingWindowSmoother : public BackEndBase, public LocalizationSourceBase
+{
+    DEFINE_MRPT_OBJECT(SlidingWindowSmoother, mola)
+
+   public:
+    SlidingWindowSmoother();
+    ~SlidingWindowSmoother() override;
+
+    using Parameters = SlidingWindowSmootherParameters;
+
+    Parameters params_;
+
+    // Both bases have an advertiseUpdatedLocalization(): expose the back-end
+    // one, the other is for this class to publish.
+    using BackEndBase::advertiseUpdatedLocalization;
+
+    // See docs in base classes:
+    void initialize_backend(const Yaml& cfg) override;
+    void spinOnce() override;
+
+    ProposeKF_Output doAddKeyFrame(const ProposeKF_Input& i) override;
+
+    /** Stores the factor and runs a smoother update. If the update fails
+     * (e.g. a factor cannot be converted, or the system is degenerate), it is
+     * dropped: its factors are only kept in the WorldModel, and reported with
+     * `success=false`, and its new keyframes never enter the smoother. */
+    AddFactor_Output doAddFactor(Factor& f) override;
+
+    /// One smoother update for the whole batch, see doAddFactor()
+    std::vector<AddFactor_Output> doAddFactors(
+        std::vector<Factor>& fs) override;
+
+    void doAdvertiseUpdatedLocalization(
+        const AdvertiseUpdatedLocalization_Input& l) override;
+
+    /** The last estimated pose of a keyframe wrt the reference frame, either
+     * in the window or marginalized, or std::nullopt if it has no estimate
+     * yet. */
+    std::optional<mrpt::math::TPose3D> keyframePose(id_t kf) const;
+
+    struct Stats
+    {
+        size_t keyframes           = 0;
+        size_t window_keyframes    = 0;  //!< Currently in the smoother
+        size_t marginalized        = 0;
+        size_t smoother_factors    = 0;  //!< Added to the smoother
+        size_t world_model_factors = 0;  //!< Only stored in the WorldModel
+        size_t updates             = 0;
+        size_t failed_updates      = 0;  //!< Dropped, see doAddFactor()
+        double last_update_time    = 0;  //!< [s]
+        double total_update_time   = 0;  //!< [s]
+    };
+
+    Stats stats() const;
+
+   private:
+    // Everything related to gtsam is hidden in the public API via pimpl
+    struct Impl;
+    mrpt::pimpl<Impl> impl_;
+
+    /// Serializes all tasks, which run in the BackEndBase executor threads
+    mutable std::mutex mtx_;
+
+    // Methods below require mtx_ to be locked:
+    AddFactor_Output addFactorNoLock(Factor& f);
+    void             storeFactor(Factor&& f, AddFactor_Output& o);
+    void             writeBackEstimates();
+    void             publishNewestKeyFrame();
+
+    /// \return The error, if the update failed and was dropped. Then,
+    ///         `dropped` gets the IDs of its factors.
+    std::optional<std::string> updateSmoother(
+        std::set<fid_t>* dropped = nullptr);
+};
+
+}  // namespace mola
@@ -0,0 +1,722 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   SlidingWindowSmoother.cpp
+ * @brief  Reference SLAM back-end: fixed-lag smoother of SE(3) keyframes
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/FactorGraphBuilder.h>
+#include <mola_kernel/variant_helper.h>
+#include <mola_sliding_window_smoother/SlidingWindowSmoother.h>
+#include <mola_yaml/yaml_helpers.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/gtsam_wrappers.h>
+#include <mrpt/system/datetime.h>
+
+// GTSAM:
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/ISAM2Params.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/Symbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/slam/BetweenFactor.h>
+// Its location depends on the GTSAM version:
+#if __has_include(<gtsam/nonlinear/IncrementalFixedLagSmoother.h>)
+#include <gtsam/nonlinear/IncrementalFixedLagSmoother.h>
+#else
+#include <gtsam_unstable/nonlinear/IncrementalFixedLagSmoother.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <tuple>
+
+using namespace mola;
+
+using gtsam::symbol_shorthand::X;  // Keyframe pose (Pose3)
+
+// arguments: class_name, parent_class, class namespace
+IMPLEMENTS_MRPT_OBJECT(SlidingWindowSmoother, BackEndBase, mola)
+
+namespace
+{
+gtsam::Pose3 toPose3(const mrpt::math::TPose3D& p)
+{
+    return mrpt::gtsam_wrappers::toPose3(mrpt::poses::CPose3D(p));
+}
+
+// Note that FactorRelativePose3 covariances already are in the GTSAM order
+// for Pose3 (rotation first, then translation):
+gtsam::SharedNoiseModel noise_model(const FactorRelativePose3& f)
+{
+    namespace nm = gtsam::noiseModel;
+
+    gtsam::SharedNoiseModel n;
+    if (f.noise_model_)
+    {
+        n = nm::Gaussian::Covariance(f.noise_model_->asEigen());
+    }
+    else
+    {
+        const double r = f.noise_model_diag_rot_, t = f.noise_model_diag_xyz_;
+        n = nm::Diagonal::Sigmas((gtsam::Vector6() << r, r, r, t, t, t)
+                                     .finished());
+    }
+
+    const double k = f.robust_param_;
+    switch (f.robust_type_)
+    {
+        case mola::Robust::REGULAR_L2:
+            return n;
+        case mola::Robust::HUBER:
+            return nm::Robust::Create(nm::mEstimator::Huber::Create(k), n);
+        case mola::Robust::CAUCHY:
+            return nm::Robust::Create(nm::mEstimator::Cauchy::Create(k), n);
+        case mola::Robust::TUKEY:
+            return nm::Robust::Create(nm::mEstimator::Tukey::Create(k), n);
+        case mola::Robust::WELSH:
+            return nm::Robust::Create(nm::mEstimator::Welsch::Create(k), n);
+        case mola::Robust::GEMANMCCLURE:
+            return nm::Robust::Create(
+                nm::mEstimator::GemanMcClure::Create(k), n);
+    }
+    THROW_EXCEPTION("Unknown robust kernel type");
+}
+
+using FactorPtr = gtsam::NonlinearFactor::shared_ptr;
+
+// Converts the WorldModel factors handled by the smoother into GTSAM ones:
+FactorPtr to_gtsam_factor(const Factor& f)
+{
+    return std::visit(
+        overloaded{
+            [](const FactorRelativePose3& r) -> FactorPtr {
+                return FactorPtr(new gtsam::BetweenFactor<gtsam::Pose3>(
+                    X(r.from_kf_), X(r.to_kf_), toPose3(r.rel_pose_),
+                    noise_model(r)));
+            },
+            [](const auto&) -> FactorPtr { return {}; }},
+        f);
+}
+
+// Smoother updates only have a few new factors: no need for more threads.
+FactorGraphBuilderParameters builder_params()
+{
+    FactorGraphBuilderParameters p;
+    p.num_threads = 1;
+    return p;
+}
+
+// Reports a factor dropped in a failed smoother update:
+void mark_dropped(
+    BackEndBase::AddFactor_Output& o, const std::set<fid_t>& dropped,
+    const std::string& error)
+{
+    if (!o.new_factor_id || !dropped.count(*o.new_factor_id)) return;
+    o.success   = false;
+    o.error_msg = "Smoother update failed: " + error;
+}
+
+// Write-locks the WorldModel entities and factors, always in this order:
+class WorldModelWriteLock
+{
+   public:
+    explicit WorldModelWriteLock(WorldModel& wm) : wm_(wm)
+    {
+        wm_.entities_lock_for_write();
+        wm_.factors_lock_for_write();
+    }
+    ~WorldModelWriteLock()
+    {
+        wm_.factors_unlock_for_write();
+        wm_.entities_unlock_for_write();
+    }
+
+   private:
+    WorldModel& wm_;
+};
+
+}  // namespace
+
+struct SlidingWindowSmoother::Impl
+{
+    std::optional<gtsam::IncrementalFixedLagSmoother> smoother;
+
+    /// Last estimate of all keyframes in the smoother
+    gtsam::Values estimate;
+
+    /// Data for the next smoother update. WorldModel factors are converted
+    /// by `builder` right before the update, from their IDs.
+    gtsam::NonlinearFactorGraph              newFactors;
+    std::vector<fid_t>                       newFactorIds;
+    gtsam::Values                            newValues;
+    gtsam::FixedLagSmoother::KeyTimestampMap newTimestamps;
+
+    FactorGraphBuilder<FactorPtr> builder{to_gtsam_factor, builder_params()};
+
+    /// Marginalized keyframes, whose pose is to be written back
+    std::vector<std::tuple<id_t, mrpt::math::TPose3D>> newMarginalized;
+
+    /// Relative pose factors between keyframes with no estimate yet. They
+    /// are added to the smoother once any of them gets one. Their `my_id_`
+    /// is the WorldModel factor ID.
+    std::vector<FactorRelativePose3> deferred;
+
+    std::optional<mrpt::Clock::time_point> t0;  //!< First keyframe stamp
+    double                                 tNewest    = 0;  //!< [s] since t0
+    id_t                                   refFrameId = INVALID_ID;
+
+    struct KeyFrameInfo
+    {
+        mrpt::Clock::time_point stamp;
+        double                  t = 0;  //!< [s] since t0
+    };
+    std::map<id_t, KeyFrameInfo> keyframes;
+
+    std::set<id_t> pending;  //!< No estimate yet: no factor connects them
+    std::set<id_t> window;  //!< In the smoother, or about to be
+    std::map<id_t, gtsam::Pose3> marginalized;
+
+    Stats stats;
+
+    bool hasEstimate(id_t kf) const
+    {
+        return newValues.exists(X(kf)) || estimate.exists(X(kf));
+    }
+    gtsam::Pose3 currentEstimate(id_t kf) const
+    {
+        return newValues.exists(X(kf)) ? newValues.at<gtsam::Pose3>(X(kf))
+                                       : estimate.at<gtsam::Pose3>(X(kf));
+    }
+    bool tooOld(id_t kf, double windowLength) const
+    {
+        return keyframes.at(kf).t < tNewest - windowLength;
+    }
+    void initKeyFrame(id_t kf, const gtsam::Pose3& p)
+    {
+        newValues.insert(X(kf), p);
+        newTimestamps[X(kf)] = keyframes.at(kf).t;
+        pending.erase(kf);
+        window.insert(kf);
+    }
+
+    /** Adds a relative pose factor between keyframes in the window, setting
+     * the initial estimate of one of them if needed.
+     * \return false if none of them has an estimate yet. */
+    bool tryAddToSmoother(const FactorRelativePose3& f)
+    {
+        const bool hasFrom = hasEstimate(f.from_kf_);
+        const bool hasTo   = hasEstimate(f.to_kf_);
+        if (!hasFrom && !hasTo) return false;
+
+        const gtsam::Pose3 rel = toPose3(f.rel_pose_);
+        if (!hasTo) initKeyFrame(f.to_kf_, currentEstimate(f.from_kf_) * rel);
+        if (!hasFrom)
+            initKeyFrame(f.from_kf_, currentEstimate(f.to_kf_) * rel.inverse());
+
+        newFactorIds.push_back(f.my_id_);
+        return true;
+    }
+
+    /// Retries deferred factors until no more of them can be added.
+    void addDeferred()
+    {
+        for (bool progress = true; progress;)
+        {
+            progress = false;
+            for (auto it = deferred.begin(); it != deferred.end();)
+            {
+                if (tryAddToSmoother(*it))
+                {
+                    it       = deferred.erase(it);
+                    progress = true;
+                }
+                else
+                    ++it;
+            }
+        }
+    }
+};
+
+SlidingWindowSmoother::SlidingWindowSmoother()
+    : impl_(mrpt::make_impl<SlidingWindowSmoother::Impl>())
+{
+}
+
+// Tasks use impl_, so they must end before it is destroyed:
+SlidingWindowSmoother::~SlidingWindowSmoother() { stopTasks(); }
+
+void SlidingWindowSmoother::initialize_backend(const Yaml& c)
+{
+    MRPT_TRY_START
+
+    auto lck = mrpt::lockHelper(mtx_);
+
+    // Load params:
+    auto cfg = c["params"];
+    MRPT_LOG_DEBUG_STREAM("Loading these params:\n" << cfg);
+
+    YAML_LOAD_OPT(params_, window_length, double);
+    YAML_LOAD_OPT(params_, relinearize_threshold, double);
+    YAML_LOAD_OPT(params_, relinearize_skip, int);
+    YAML_LOAD_OPT(params_, first_kf_sigma_xyz, double);
+    YAML_LOAD_OPT(params_, first_kf_sigma_rot, double);
+    YAML_LOAD_OPT(params_, reference_frame, std::string);
+
+    ASSERT_GT_(params_.window_length, 0.0);
+
+    gtsam::ISAM2Params isamParams;
+    isamParams.relinearizeThreshold = params_.relinearize_threshold;
+    isamParams.relinearizeSkip      = params_.relinearize_skip;
+
+    impl_->smoother.emplace(params_.window_length, isamParams);
+
+    MRPT_TRY_END
+}
+
+void SlidingWindowSmoother::spinOnce()
+{
+    // Nothing to do: all the work is done in the back-end executor tasks.
+}
+
+BackEndBase::ProposeKF_Output SlidingWindowSmoother::doAddKeyFrame(
+    const ProposeKF_Input& i)
+{
+    MRPT_TRY_START
+
+    ProposeKF_Output ret;
+
+    auto  lck = mrpt::lockHelper(mtx_);
+    auto& d   = *impl_;
+
+    ASSERTMSG_(d.smoother, "initialize() must be called first");
+    ASSERTMSG_(
+        i.timestamp != mrpt::Clock::time_point(),
+        "Keyframe timestamps must be valid");
+
+    if (!d.t0) d.t0 = i.timestamp;
+    const double t = mrpt::system::timeDifference(*d.t0, i.timestamp);
+
+    RelPose3KF kf;
+    kf.timestamp_ = i.timestamp;
+    if (i.observations)
+        kf.raw_observations_ =
+            std::make_shared<mrpt::obs::CSensoryFrame>(*i.observations);
+
+    id_t kfId = INVALID_ID;
+    {
+        WorldModelWriteLock wmLock(*worldmodel_);
+
+        // The frame of reference of all keyframes:
+        if (d.refFrameId == INVALID_ID)
+        {
+            RefPose3 ref;
+            ref.timestamp_ = i.timestamp;
+            d.refFrameId   = worldmodel_->entity_emplace_back(std::move(ref));
+        }
+        kf.base_id_ = d.refFrameId;
+        kfId        = worldmodel_->entity_emplace_back(std::move(kf));
+    }
+
+    const bool first  = d.keyframes.empty();
+    d.keyframes[kfId] = {i.timestamp, t};
+    d.stats.keyframes++;
+
+    if (first)
+    {
+        // The first keyframe defines the origin of coordinates:
+        const double sr = params_.first_kf_sigma_rot;
+        const double st = params_.first_kf_sigma_xyz;
+
+        d.newFactors.emplace_shared<gtsam::PriorFactor<gtsam::Pose3>>(
+            X(kfId), gtsam::Pose3::Identity(),
+            gtsam::noiseModel::Diagonal::Sigmas(
+                (gtsam::Vector6() << sr, sr, sr, st, st, st).finished()));
+        d.initKeyFrame(kfId, gtsam::Pose3::Identity());
+        if (const auto err = updateSmoother(); err)
+        {
+            // The keyframe is in the world model, but not in the smoother:
+            ret.success   = false;
+            ret.new_kf_id = kfId;
+            ret.error_msg = "Smoother update failed: " + *err;
+            return ret;
+        }
+    }
+    else
+    {
+        // Wait for a factor connecting it to the window:
+        d.pending.insert(kfId);
+    }
+
+    ret.success   = true;
+    ret.new_kf_id = kfId;
+    return ret;
+
+    MRPT_TRY_END
+}
+
+BackEndBase::AddFactor_Output SlidingWindowSmoother::doAddFactor(Factor& f)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    auto ret = addFactorNoLock(f);
+
+    std::set<fid_t> dropped;
+    if (const auto err = updateSmoother(&dropped); err)
+        mark_dropped(ret, dropped, *err);
+    return ret;
+}
+
+std::vector<BackEndBase::AddFactor_Output> SlidingWindowSmoother::doAddFactors(
+    std::vector<Factor>& fs)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+
+    std::vector<AddFactor_Output> outs;
+    outs.reserve(fs.size());
+    for (auto& f : fs) outs.push_back(addFactorNoLock(f));
+
+    std::set<fid_t> dropped;
+    if (const auto err = updateSmoother(&dropped); err)
+        for (auto& o : outs) mark_dropped(o, dropped, *err);
+    return outs;
+}
+
+BackEndBase::AddFactor_Output SlidingWindowSmoother::addFactorNoLock(
+    Factor& f)
+{
+    AddFactor_Output ret;
+    auto&            d = *impl_;
+
+    try
+    {
+        ASSERTMSG_(d.smoother, "initialize() must be called first");
+
+        const auto* rp = std::get_if<FactorRelativePose3>(&f);
+        if (!rp)
+        {
+            // Not handled by the smoother, just keep it in the world model:
+            storeFactor(std::move(f), ret);
+            d.stats.world_model_factors++;
+            return ret;
+        }
+
+        for (const id_t kf : {rp->from_kf_, rp->to_kf_})
+            ASSERTMSG_(
+                d.keyframes.count(kf) != 0,
+                mrpt::format(
+                    "FactorRelativePose3 refers to unknown keyframe #%u",
+                    static_cast<unsigned>(kf)));
+
+        // Keyframes out of the window can't be in the smoother anymore:
+        bool inWindow = true;
+        for (const id_t kf : {rp->from_kf_, rp->to_kf_})
+        {
+            const bool isPending = d.pending.count(kf) != 0;
+            if ((!isPending && d.window.count(kf) == 0) ||
+                (isPending && d.tooOld(kf, params_.window_length)))
+                inWindow = false;
+        }
+
+        FactorRelativePose3 copy = *rp;
+        storeFactor(std::move(f), ret);
+        copy.my_id_ = ret.new_factor_id.value();
+
+        if (!inWindow)
+        {
+            d.stats.world_model_factors++;
+            return ret;
+        }
+
+        if (d.tryAddToSmoother(copy))
+            d.addDeferred();
+        else
+            d.deferred.push_back(copy);
+    }
+    catch (const std::exception& e)
+    {
+        ret.success   = false;
+        ret.error_msg = e.what();
+    }
+    return ret;
+}
+
+void SlidingWindowSmoother::storeFactor(Factor&& f, AddFactor_Output& o)
+{
+    WorldModelWriteLock wmLock(*worldmodel_);
+
+    o.new_factor_id = worldmodel_->factor_emplace_back(std::move(f));
+    o.success       = true;
+}
+
+std::optional<std::string> SlidingWindowSmoother::updateSmoother(
+    std::set<fid_t>* dropped)
+{
+    auto& d = *impl_;
+
+    if (d.newFactorIds.empty() && d.newFactors.empty() && d.newValues.empty())
+        return {};
+
+    const auto tStart = std::chrono::steady_clock::now();
+
+    double tNewest = d.tNewest;
+    for (const auto& [key, t] : d.newTimestamps)
+        tNewest = std::max(tNewest, t);
+    const double cutoff = tNewest - params_.window_length;
+
+    // The smoother marginalizes out keyframes older than the cutoff. Save
+    // their estimate and covariance now, since they will be gone after the
+    // update:
+    std::vector<std::tuple<id_t, gtsam::Pose3, std::optional<gtsam::Matrix6>>>
+        leaving;
+
+    std::optional<std::string> error;
+    try
+    {
+        for (const id_t kf : d.window)
+        {
+            if (d.keyframes.at(kf).t >= cutoff) continue;
+
+            if (d.estimate.exists(X(kf)))
+                leaving.emplace_back(
+                    kf, d.estimate.at<gtsam::Pose3>(X(kf)),
+                    gtsam::Matrix6(d.smoother->marginalCovariance(X(kf))));
+            else if (d.newValues.exists(X(kf)))
+                // Added and marginalized in the same update: no covariance.
+                leaving.emplace_back(
+                    kf, d.newValues.at<gtsam::Pose3>(X(kf)), std::nullopt);
+        }
+
+        d.builder.build(*worldmodel_, d.newFactorIds, [&](const FactorPtr& f) {
+            if (f) d.newFactors.add(f);
+        });
+
+        d.smoother->update(d.newFactors, d.newValues, d.newTimestamps);
+        d.estimate = d.smoother->calculateEstimate();
+    }
+    catch (const std::exception& e)
+    {
+        error = e.what();
+    }
+
+    // Each factor goes into the smoother only once:
+    for (const fid_t id : d.newFactorIds) d.builder.eraseFromCache(id);
+
+    if (error)
+    {
+        // Drop this update: its factors remain in the world model only, and
+        // its new keyframes will never get into the smoother. Older
+        // keyframes stay in the window, since nothing was marginalized.
+        MRPT_LOG_ERROR_STREAM(
+            "Smoother update failed, dropping "
+            << d.newFactorIds.size() << " factors and " << d.newValues.size()
+            << " keyframes: " << *error);
+        for (const auto key : d.newValues.keys())
+            d.window.erase(static_cast<id_t>(gtsam::Symbol(key).index()));
+        if (dropped)
+            dropped->insert(d.newFactorIds.begin(), d.newFactorIds.end());
+
+        d.newFactors.resize(0);
+        d.newFactorIds.clear();
+        d.newValues.clear();
+        d.newTimestamps.clear();
+
+        d.stats.failed_updates++;
+        d.stats.window_keyframes = d.window.size();
+        return error;
+    }
+
+    d.tNewest = tNewest;
+    d.stats.smoother_factors += d.newFactorIds.size();
+
+    d.newFactors.resize(0);
+    d.newFactorIds.clear();
+    d.newValues.clear();
+    d.newTimestamps.clear();
+
+    // Keep marginalized keyframes as priors wrt the reference frame:
+    std::vector<Factor> priors;
+    for (const auto& [kf, pose, cov] : leaving)
+    {
+        d.window.erase(kf);
+        d.marginalized[kf] = pose;
+        d.newMarginalized.emplace_back(
+            kf, mrpt::gtsam_wrappers::toTPose3D(pose));
+        d.stats.marginalized++;
+
+        if (!cov) continue;
+
+        FactorRelativePose3 prior(
+            d.refFrameId, kf, mrpt::gtsam_wrappers::toTPose3D(pose));
+        prior.noise_model_ = mrpt::math::CMatrixDouble66(*cov);
+        priors.emplace_back(std::move(prior));
+    }
+    for (auto& f : priors)
+    {
+        AddFactor_Output o;
+        storeFactor(std::move(f), o);
+    }
+
+    // Keyframes which will never get into the smoother:
+    for (auto it = d.pending.begin(); it != d.pending.end();)
+    {
+        if (d.keyframes.at(*it).t < cutoff)
+            it = d.pending.erase(it);
+        else
+            ++it;
+    }
+    d.deferred.erase(
+        std::remove_if(
+            d.deferred.begin(), d.deferred.end(),
+            [&](const FactorRelativePose3& f) {
+                return !d.pending.count(f.from_kf_) ||
+                       !d.pending.count(f.to_kf_);
+            }),
+        d.deferred.end());
+
+    writeBackEstimates();
+    publishNewestKeyFrame();
+
+    const double dt = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - tStart)
+                          .count();
+    d.stats.updates++;
+    d.stats.window_keyframes = d.window.size();
+    d.stats.last_update_time = dt;
+    d.stats.total_update_time += dt;
+    return {};
+}
+
+void SlidingWindowSmoother::writeBackEstimates()
+{
+    auto& d = *impl_;
+
+    WorldModelWriteLock wmLock(*worldmodel_);
+
+    auto setPose = [&](id_t kf, const mrpt::math::TPose3D& p) {
+        std::get<RelPose3KF>(worldmodel_->entity_by_id(kf)).relpose_value = p;
+    };
+
+    for (const id_t kf : d.window)
+        if (d.estimate.exists(X(kf)))
+            setPose(
+                kf, mrpt::gtsam_wrappers::toTPose3D(
+                        d.estimate.at<gtsam::Pose3>(X(kf))));
+
+    for (const auto& [kf, p] : d.newMarginalized) setPose(kf, p);
+    d.newMarginalized.clear();
+}
+
+void SlidingWindowSmoother::publishNewestKeyFrame()
+{
+    auto& d = *impl_;
+
+    std::optional<id_t> newest;
+    for (const id_t kf : d.window)
+        if (d.estimate.exists(X(kf)) &&
+            (!newest || d.keyframes.at(kf).t > d.keyframes.at(*newest).t))
+            newest = kf;
+    if (!newest) return;
+
+    const auto pose = d.estimate.at<gtsam::Pose3>(X(*newest));
+
+    LocalizationUpdate lu;
+    lu.timestamp       = d.keyframes.at(*newest).stamp;
+    lu.reference_frame = params_.reference_frame;
+    lu.method          = "slam";
+    lu.pose            = mrpt::gtsam_wrappers::toTPose3D(pose);
+
+    // Only if someone is listening, since it is costly:
+    if (anyUpdateLocalizationSubscriber())
+    {
+        // In mrpt order: xyz, then rotation:
+        const gtsam::Matrix6 c = d.smoother->marginalCovariance(X(*newest));
+
+        mrpt::math::CMatrixDouble66 cov;
+        cov.asEigen().block<3, 3>(0, 0) = c.block<3, 3>(3, 3);
+        cov.asEigen().block<3, 3>(3, 3) = c.block<3, 3>(0, 0);
+        cov.asEigen().block<3, 3>(0, 3) = c.block<3, 3>(3, 0);
+        cov.asEigen().block<3, 3>(3, 0) = c.block<3, 3>(0, 3);
+        lu.cov                          = cov;
+    }
+
+    LocalizationSourceBase::advertiseUpdatedLocalization(lu);
+}
+
+void SlidingWindowSmoother::doAdvertiseUpdatedLocalization(
+    const AdvertiseUpdatedLocalization_Input& l)
+{
+    MRPT_TRY_START
+
+    std::optional<mrpt::math::TPose3D> kfPose;
+    if (l.reference_kf != INVALID_ID)
+    {
+        kfPose = keyframePose(l.reference_kf);
+        ASSERTMSG_(
+            kfPose.has_value(),
+            mrpt::format(
+                "No estimate yet for reference keyframe #%u",
+                static_cast<unsigned>(l.reference_kf)));
+    }
+
+    LocalizationUpdate lu;
+    lu.timestamp       = l.timestamp;
+    lu.reference_frame = params_.reference_frame;
+    lu.method          = "slam";
+    lu.pose            = kfPose ? (mrpt::poses::CPose3D(*kfPose) +
+                        mrpt::poses::CPose3D(l.pose))
+                                      .asTPose()
+                                : l.pose;
+    lu.cov = l.cov;
+
+    LocalizationSourceBase::advertiseUpdatedLocalization(lu);
+
+    MRPT_TRY_END
+}
+
+std::optional<mrpt::math::TPose3D> SlidingWindowSmoother::keyframePose(
+    id_t kf) const
+{
+    auto        lck = mrpt::lockHelper(mtx_);
+    const auto& d   = *impl_;
+
+    if (d.estimate.exists(X(kf)))
+        return mrpt::gtsam_wrappers::toTPose3D(
+            d.estimate.at<gtsam::Pose3>(X(kf)));
+
+    if (const auto it = d.marginalized.find(kf); it != d.marginalized.end())
+        return mrpt::gtsam_wrappers::toTPose3D(it->second);
+
+    return std::nullopt;
+}
+
+SlidingWindowSmoother::Stats SlidingWindowSmoother::stats() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return impl_->stats;
+}
@@ -0,0 +1,406 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   test-sliding-window-smoother.cpp
+ * @brief  Offline regression test and benchmark of SlidingWindowSmoother
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_kernel/WorldModel.h>
+#include <mola_sliding_window_smoother/SlidingWindowSmoother.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/core/lock_helper.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/random/RandomGenerators.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+using mrpt::poses::CPose3D;
+
+// A synthetic dataset: keyframes along a noisy circle, with odometry factors
+// between consecutive keyframes and short loop closures within the window.
+struct SyntheticDataset
+{
+    double kf_period   = 0.1;  // [s]
+    size_t num_kfs     = 300;
+    double radius      = 10.0;  // [m]
+    double sigma_xyz   = 0.01;  // [m]
+    double sigma_rot   = 0.001;  // [rad]
+    size_t loop_offset = 5;  // keyframes
+
+    CPose3D ground_truth(size_t i) const
+    {
+        const double a = 2 * M_PI * static_cast<double>(i) / 200.0;
+        return CPose3D(
+            radius * std::sin(a), radius * (1 - std::cos(a)), 0.05 * a, a, 0,
+            0);
+    }
+
+    mola::FactorRelativePose3 noisy_factor(
+        size_t i, size_t j, mola::id_t from, mola::id_t to) const
+    {
+        auto& rng = mrpt::random::getRandomGenerator();
+
+        const CPose3D rel = ground_truth(j) - ground_truth(i);
+        const CPose3D noise(
+            rng.drawGaussian1D(0, sigma_xyz), rng.drawGaussian1D(0, sigma_xyz),
+            rng.drawGaussian1D(0, sigma_xyz), rng.drawGaussian1D(0, sigma_rot),
+            rng.drawGaussian1D(0, sigma_rot), rng.drawGaussian1D(0, sigma_rot));
+
+        mola::FactorRelativePose3 f(from, to, (rel + noise).asTPose());
+        f.noise_model_diag_xyz_ = sigma_xyz;
+        f.noise_model_diag_rot_ = sigma_rot;
+        return f;
+    }
+};
+
+struct TestSetup
+{
+    std::shared_ptr<mola::WorldModel>            wm;
+    std::shared_ptr<mola::SlidingWindowSmoother> sws;
+};
+
+TestSetup create_smoother(double windowLength)
+{
+    TestSetup s;
+    s.wm = std::make_shared<mola::WorldModel>();
+    s.wm->setMinLoggingLevel(mrpt::system::LVL_ERROR);
+    s.wm->initialize(mola::Yaml::FromText("params: {}"));
+
+    s.sws = std::make_shared<mola::SlidingWindowSmoother>();
+    s.sws->setMinLoggingLevel(mrpt::system::LVL_ERROR);
+
+    auto wm            = s.wm;
+    s.sws->nameServer_ = [wm](const std::string& name)
+        -> mola::ExecutableBase::Ptr {
+        if (name == "[0") return wm;
+        return {};
+    };
+
+    s.sws->initialize(mola::Yaml::FromText(mrpt::format(
+        "params:\n"
+        "  window_length: %f\n"
+        "executor:\n"
+        "  num_threads: 1\n",
+        windowLength)));
+    return s;
+}
+
+// Feeds the whole dataset, one keyframe and its factors at a time, like a
+// front-end would do. Returns the keyframe IDs.
+std::vector<mola::id_t> run_dataset(
+    mola::SlidingWindowSmoother& sws, const SyntheticDataset& ds)
+{
+    mrpt::random::getRandomGenerator().randomize(1234);
+
+    const auto t0 = mrpt::Clock::now();
+
+    std::vector<mola::id_t> kfs;
+    for (size_t i = 0; i < ds.num_kfs; i++)
+    {
+        mola::BackEndBase::ProposeKF_Input kf;
+        kf.timestamp = mrpt::Clock::fromDouble(
+            mrpt::Clock::toDouble(t0) + ds.kf_period * i);
+
+        const auto kfOut = sws.addKeyFrame(kf).get();
+        ASSERT_(kfOut.success);
+        kfs.push_back(kfOut.new_kf_id.value());
+
+        std::vector<mola::Factor> fs;
+        if (i > 0)
+            fs.emplace_back(ds.noisy_factor(i - 1, i, kfs[i - 1], kfs[i]));
+        if (i >= ds.loop_offset)
+        {
+            const size_t j = i - ds.loop_offset;
+            fs.emplace_back(ds.noisy_factor(j, i, kfs[j], kfs[i]));
+        }
+        if (fs.empty()) continue;
+
+        for (const auto& o : sws.addFactors(fs).get())
+            ASSERTMSG_(o.success, o.error_msg.value_or(""));
+    }
+    return kfs;
+}
+
+void test_synthetic_circle()
+{
+    const double windowLength = 2.0;
+
+    auto [wm, sws] = create_smoother(windowLength);
+
+    std::mutex                                         locMtx;
+    std::optional<mola::LocalizationSourceBase::LocalizationUpdate> lastLoc;
+    sws->subscribeToLocalizationUpdates(
+        [&](const mola::LocalizationSourceBase::LocalizationUpdate& l) {
+            auto lck = mrpt::lockHelper(locMtx);
+            lastLoc  = l;
+        },
+        mola::SubscriberOptions::LatestOnly());
+
+    SyntheticDataset ds;
+    const auto       kfs = run_dataset(*sws, ds);
+
+    const auto st = sws->stats();
+    ASSERT_EQUAL_(st.keyframes, ds.num_kfs);
+    ASSERT_GT_(st.marginalized, 0U);
+    ASSERT_EQUAL_(st.marginalized + st.window_keyframes, ds.num_kfs);
+    ASSERT_LE_(
+        st.window_keyframes,
+        static_cast<size_t>(windowLength / ds.kf_period) + 2);
+
+    // Estimates vs ground truth. The first keyframe is the origin:
+    const CPose3D gt0 = ds.ground_truth(0);
+    double        maxErr = 0, maxRelErr = 0;
+    for (size_t i = 0; i < kfs.size(); i++)
+    {
+        const auto p = sws->keyframePose(kfs[i]);
+        ASSERT_(p.has_value());
+
+        const CPose3D gt  = ds.ground_truth(i) - gt0;
+        const double  err = (CPose3D(*p) - gt).translation().norm();
+        maxErr            = std::max(maxErr, err);
+
+        if (i == 0) continue;
+        const CPose3D estRel = CPose3D(*p) - *sws->keyframePose(kfs[i - 1]);
+        const CPose3D gtRel  = ds.ground_truth(i) - ds.ground_truth(i - 1);
+        maxRelErr = std::max(maxRelErr, (estRel - gtRel).translation().norm());
+    }
+    std::cout << mrpt::format(
+        "[SlidingWindowSmoother] max error: absolute=%.03f m relative=%.03f "
+        "m\n",
+        maxErr, maxRelErr);
+    ASSERT_LT_(maxErr, 1.0);
+    ASSERT_LT_(maxRelErr, 10 * ds.sigma_xyz);
+
+    // Marginalized keyframes must be kept as priors in the world model, and
+    // the estimated poses written back into the keyframe entities:
+    size_t numPriors = 0;
+    wm->entities_lock_for_read();
+    wm->factors_lock_for_read();
+    const auto& kf0 =
+        std::get<mola::RelPose3KF>(wm->entity_by_id(kfs.front()));
+    const mola::id_t refId = kf0.base_id_;
+    ASSERT_(std::holds_alternative<mola::RefPose3>(wm->entity_by_id(refId)));
+
+    for (const auto fid : wm->factor_all_ids())
+    {
+        const auto* f =
+            std::get_if<mola::FactorRelativePose3>(&wm->factor_by_id(fid));
+        if (!f || f->from_kf_ != refId) continue;
+        ASSERT_(f->noise_model_.has_value());
+        numPriors++;
+    }
+    for (const auto kf : kfs)
+    {
+        const auto& e = std::get<mola::RelPose3KF>(wm->entity_by_id(kf));
+        ASSERT_EQUAL_(e.base_id_, refId);
+        ASSERT_(
+            CPose3D(e.relpose_value) == CPose3D(*sws->keyframePose(kf)));
+    }
+    const auto lastStamp = mola::entity_get_base(wm->entity_by_id(kfs.back()))
+                               .timestamp_;
+    wm->factors_unlock_for_read();
+    wm->entities_unlock_for_read();
+
+    ASSERT_EQUAL_(numPriors, st.marginalized);
+
+    // The last localization update is the newest keyframe:
+    bool gotLast = false;
+    for (int retry = 0; retry < 100 && !gotLast; retry++)
+    {
+        {
+            auto lck = mrpt::lockHelper(locMtx);
+            gotLast  = lastLoc && lastLoc->timestamp == lastStamp;
+        }
+        if (!gotLast)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_(gotLast);
+    ASSERT_EQUAL_(lastLoc->reference_frame, "map");
+    ASSERT_(lastLoc->cov.has_value());
+    ASSERT_(
+        CPose3D(lastLoc->pose) == CPose3D(*sws->keyframePose(kfs.back())));
+}
+
+// Factors may arrive before the one connecting their keyframes to the
+// window, and may refer to keyframes already marginalized:
+void test_factor_order()
+{
+    auto [wm, sws] = create_smoother(1.0);
+
+    const auto t0 = mrpt::Clock::now();
+
+    std::vector<mola::id_t> kfs;
+    for (int i = 0; i < 4; i++)
+    {
+        mola::BackEndBase::ProposeKF_Input kf;
+        kf.timestamp =
+            mrpt::Clock::fromDouble(mrpt::Clock::toDouble(t0) + 0.1 * i);
+        kfs.push_back(sws->addKeyFrame(kf).get().new_kf_id.value());
+    }
+
+    const mrpt::math::TPose3D step(1.0, 0, 0, 0, 0, 0);
+
+    std::vector<mola::Factor> fs;
+    fs.emplace_back(mola::FactorRelativePose3(kfs[2], kfs[3], step));
+    fs.emplace_back(mola::FactorRelativePose3(kfs[1], kfs[2], step));
+    fs.emplace_back(mola::FactorRelativePose3(kfs[0], kfs[1], step));
+    for (const auto& o : sws->addFactors(fs).get()) ASSERT_(o.success);
+
+    ASSERT_EQUAL_(sws->stats().smoother_factors, 3U);
+    for (int i = 0; i < 4; i++)
+        ASSERT_LT_(std::abs(sws->keyframePose(kfs[i])->x - i), 1e-3);
+
+    // Unknown keyframes:
+    mola::Factor bad = mola::FactorRelativePose3(kfs[0], 1000, step);
+    const auto   o   = sws->addFactor(bad).get();
+    ASSERT_(!o.success);
+    ASSERT_(o.error_msg.has_value());
+
+    // A keyframe 2 s later marginalizes all others:
+    mola::BackEndBase::ProposeKF_Input kf;
+    kf.timestamp = mrpt::Clock::fromDouble(mrpt::Clock::toDouble(t0) + 2.3);
+    kfs.push_back(sws->addKeyFrame(kf).get().new_kf_id.value());
+    ASSERT_(!sws->keyframePose(kfs[4]).has_value());
+
+    mola::Factor f = mola::FactorRelativePose3(kfs[3], kfs[4], step);
+    ASSERT_(sws->addFactor(f).get().success);
+    ASSERT_EQUAL_(sws->stats().marginalized, 4U);
+    ASSERT_LT_(std::abs(sws->keyframePose(kfs[4])->x - 4), 1e-3);
+
+    // ...so factors to them are only stored in the world model:
+    mola::Factor lc = mola::FactorRelativePose3(kfs[0], kfs[4], step);
+    ASSERT_(sws->addFactor(lc).get().success);
+
+    const auto st = sws->stats();
+    ASSERT_EQUAL_(st.world_model_factors, 1U);
+    ASSERT_EQUAL_(st.smoother_factors, 4U);
+}
+
+// A failed smoother update is reported for the factors in it, which are only
+// kept in the world model, and nothing is marginalized:
+void test_failed_update()
+{
+    auto [wm, sws] = create_smoother(1.0);
+
+    const auto t0 = mrpt::Clock::now();
+
+    std::vector<mola::id_t> kfs;
+    auto addKeyFrame = [&](double t) {
+        mola::BackEndBase::ProposeKF_Input kf;
+        kf.timestamp = mrpt::Clock::fromDouble(mrpt::Clock::toDouble(t0) + t);
+        kfs.push_back(sws->addKeyFrame(kf).get().new_kf_id.value());
+    };
+    for (int i = 0; i < 3; i++) addKeyFrame(0.1 * i);
+
+    const mrpt::math::TPose3D step(1.0, 0, 0, 0, 0, 0);
+
+    mola::Factor f01 = mola::FactorRelativePose3(kfs[0], kfs[1], step);
+    ASSERT_(sws->addFactor(f01).get().success);
+
+    // A keyframe late enough to marginalize the first one, and a factor
+    // which cannot be converted into a smoother factor:
+    addKeyFrame(1.05);
+    mola::FactorRelativePose3 broken(kfs[1], kfs[2], step);
+    broken.robust_type_ = static_cast<mola::Robust>(255);
+
+    std::vector<mola::Factor> fs;
+    fs.emplace_back(broken);
+    fs.emplace_back(mola::FactorRelativePose3(kfs[2], kfs[3], step));
+    for (const auto& o : sws->addFactors(fs).get())
+    {
+        ASSERT_(!o.success);
+        ASSERT_(o.error_msg.has_value());
+        ASSERT_(o.new_factor_id.has_value());  // Still in the world model
+    }
+
+    auto st = sws->stats();
+    ASSERT_EQUAL_(st.failed_updates, 1U);
+    ASSERT_EQUAL_(st.smoother_factors, 1U);
+    ASSERT_EQUAL_(st.marginalized, 0U);
+    ASSERT_EQUAL_(st.window_keyframes, 2U);
+    ASSERT_(!sws->keyframePose(kfs[2]).has_value());
+    ASSERT_(!sws->keyframePose(kfs[3]).has_value());
+
+    // The smoother keeps working afterwards:
+    addKeyFrame(1.08);
+    mola::Factor f14 = mola::FactorRelativePose3(kfs[1], kfs[4], step);
+    ASSERT_(sws->addFactor(f14).get().success);
+
+    st = sws->stats();
+    ASSERT_EQUAL_(st.failed_updates, 1U);
+    ASSERT_EQUAL_(st.smoother_factors, 2U);
+    ASSERT_EQUAL_(st.marginalized, 1U);
+    ASSERT_LT_(std::abs(sws->keyframePose(kfs[4])->x - 2), 1e-3);
+}
+
+// Smoother throughput vs. the window length:
+void benchmark_window_length()
+{
+    for (const double windowLength : {1.0, 2.0, 5.0, 10.0})
+    {
+        auto [wm, sws] = create_smoother(windowLength);
+
+        SyntheticDataset ds;
+        ds.num_kfs = 500;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        run_dataset(*sws, ds);
+        const double dt = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - t0)
+                              .count();
+
+        const auto st = sws->stats();
+        std::cout << mrpt::format(
+            "[SlidingWindowSmoother] window=%5.01f s (%4u KFs): %8.01f KF/s "
+            "| update: mean=%7.03f ms last=%7.03f ms\n",
+            windowLength, static_cast<unsigned>(st.window_keyframes),
+            ds.num_kfs / dt, 1e3 * st.total_update_time / st.updates,
+            1e3 * st.last_update_time);
+    }
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_synthetic_circle();
+        test_factor_order();
+        test_failed_update();
+        benchmark_window_length();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,148 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   TrajectoryMetrics.h
+ * @brief  Absolute (ATE) and relative (RPE) trajectory error metrics
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/poses/CPose3D.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mola
+{
+/** Two trajectories with their poses paired by timestamp.
+ * \sa associate_trajectories()
+ */
+struct AssociatedTrajectories
+{
+    std::vector<double>               timestamps;  //!< Those of `est`
+    std::vector<mrpt::poses::CPose3D> gt, est;
+
+    size_t size() const { return timestamps.size(); }
+    bool   empty() const { return timestamps.empty(); }
+};
+
+/** Pairs each pose in `est` with the pose in `gt` with the closest timestamp,
+ * if it is within `max_time_offset` [s]. Each `gt` pose is used at most once.
+ * Cost is O(n log n), using the time-sorted `gt` container.
+ */
+AssociatedTrajectories associate_trajectories(
+    const mrpt::poses::CPose3DInterpolator& gt,
+    const mrpt::poses::CPose3DInterpolator& est,
+    double                                  max_time_offset = 0.01);
+
+/** Result of umeyama_alignment(): `gt ≈ scale * R * est + t`, with `R,t`
+ * stored in `transform`. */
+struct UmeyamaResult
+{
+    mrpt::poses::CPose3D transform;
+    double               scale = 1.0;
+};
+
+/** Closed-form least-squares similarity (Sim(3), if `with_scale`) or rigid
+ * (SE(3)) transformation between two sets of corresponding points.
+ *
+ * Umeyama, S. (1991). Least-squares estimation of transformation parameters
+ * between two point patterns. IEEE TPAMI, 13(4), 376-380.
+ */
+UmeyamaResult umeyama_alignment(
+    const std::vector<mrpt::math::TPoint3D>& est,
+    const std::vector<mrpt::math::TPoint3D>& gt, bool with_scale);
+
+enum class TrajectoryAlignment
+{
+    None = 0,
+    SE3,
+    Sim3
+};
+
+/** Summary statistics of a set of errors */
+struct ErrorStatistics
+{
+    size_t count  = 0;
+    double rmse   = 0;
+    double mean   = 0;
+    double median = 0;
+    double std    = 0;
+    double min    = 0;
+    double max    = 0;
+
+    static ErrorStatistics FromErrors(std::vector<double> errors);
+};
+
+/** Parameters for compute_trajectory_metrics() */
+struct TrajectoryMetricsParameters
+{
+    TrajectoryMetricsParameters() = default;
+
+    TrajectoryAlignment alignment = TrajectoryAlignment::SE3;
+
+    /// If >0, only the first this number of associated poses are used
+    /// to estimate the alignment (evo's --n_to_align). Default: all.
+    size_t align_first_n = 0;
+
+    enum class DeltaUnit
+    {
+        Frames = 0,
+        Meters,  //!< Distance traveled, along the ground truth
+        Seconds
+    };
+
+    /// Relative pose errors are evaluated between poses `i` and the first
+    /// `j>i` separated by at least this delta:
+    double    rpe_delta      = 1.0;
+    DeltaUnit rpe_delta_unit = DeltaUnit::Frames;
+
+    /// Number of parallel threads (0=hardware concurrency)
+    size_t num_threads = 0;
+};
+
+/** All metrics computed by compute_trajectory_metrics() */
+struct TrajectoryMetrics
+{
+    UmeyamaResult alignment;
+
+    /** @name Absolute trajectory error (ATE), after alignment
+     *  @{ */
+    std::vector<double> ate_timestamps;
+    std::vector<double> ate_translation;  //!< [m]
+    std::vector<double> ate_rotation;  //!< [rad]
+    ErrorStatistics     ate_translation_stats, ate_rotation_stats;
+    /** @} */
+
+    /** @name Relative pose error (RPE)
+     *  @{ */
+    std::vector<double> rpe_timestamps_from, rpe_timestamps_to;
+    std::vector<double> rpe_translation;  //!< [m]
+    std::vector<double> rpe_rotation;  //!< [rad]
+    ErrorStatistics     rpe_translation_stats, rpe_rotation_stats;
+    /** @} */
+
+    /// Writes all statistics, and the alignment, as a JSON object
+    void saveAsJSON(std::ostream& o) const;
+
+    /// Writes `<prefix>_ate.csv` and `<prefix>_rpe.csv` with one row per
+    /// error sample, ready for plotting. Returns false on any I/O error.
+    bool saveAsCSV(const std::string& prefix) const;
+};
+
+/** Aligns the associated trajectories (if enabled) and computes the ATE and
+ * RPE metrics. Per-pose errors are evaluated in parallel threads.
+ */
+TrajectoryMetrics compute_trajectory_metrics(
+    const AssociatedTrajectories&      trajs,
+    const TrajectoryMetricsParameters& params = TrajectoryMetricsParameters());
+
+}  // namespace mola
@@ -0,0 +1,156 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   TrajectoryPipeline.h
+ * @brief  Streaming reader, writer, and composable operations on trajectories
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/math/TPose3D.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mola
+{
+/** One timestamped pose of a trajectory */
+struct TrajectorySample
+{
+    double              t = 0;  //!< [s] UNIX timestamp
+    mrpt::math::TPose3D pose;
+};
+
+/** Supported text formats for trajectory files */
+enum class TrajectoryFileFormat
+{
+    /** `t x y z qx qy qz qw`, space separated */
+    TUM = 0,
+    /** `t x y z yaw pitch roll` (radians), space separated */
+    YPR,
+    /** Same columns as TUM, comma separated, with an optional header */
+    CSV
+};
+
+/** Parses "tum", "ypr", or "csv". Throws on unknown names. */
+TrajectoryFileFormat trajectory_format_from_string(const std::string& s);
+
+/** Guesses the format from a file extension (".csv", ".ypr"), TUM otherwise */
+TrajectoryFileFormat trajectory_format_from_filename(const std::string& file);
+
+/** Reads one sample at a time from a trajectory file (or stdin for "-"),
+ *  so memory usage does not depend on the file length. Comment lines
+ *  ('#') and non-numeric lines (e.g. CSV headers) are skipped.
+ */
+class TrajectoryReader
+{
+   public:
+    TrajectoryReader(const std::string& file, TrajectoryFileFormat fmt);
+
+    /// Returns false at the end of the stream. Throws on malformed lines.
+    bool next(TrajectorySample& s);
+
+    size_t line_number() const { return lineNumber_; }
+
+   private:
+    std::ifstream        file_;
+    std::istream*        in_ = nullptr;
+    TrajectoryFileFormat fmt_;
+    std::string          line_;
+    size_t               lineNumber_ = 0;
+};
+
+/** Writes trajectory samples to a file (or stdout for "-"). */
+class TrajectoryWriter
+{
+   public:
+    TrajectoryWriter(const std::string& file, TrajectoryFileFormat fmt);
+
+    void write(const TrajectorySample& s);
+    void flush() { out_->flush(); }
+
+   private:
+    std::ofstream        file_;
+    std::ostream*        out_ = nullptr;
+    TrajectoryFileFormat fmt_;
+};
+
+/** Linear interpolation of translation and SLERP of rotation, for a time
+ *  `t` between those of `a` and `b`. */
+TrajectorySample interpolate_samples(
+    const TrajectorySample& a, const TrajectorySample& b, double t);
+
+/** Base class for the stages of a TrajectoryPipeline.
+ *
+ * Each input sample is passed to process(), which emits zero or more samples
+ * to the next stage. Operations only keep the state they need (e.g. the
+ * previous sample), so that arbitrarily long trajectories can be processed in
+ * a single pass.
+ */
+class TrajectoryOperation
+{
+   public:
+    using Ptr  = std::shared_ptr<TrajectoryOperation>;
+    using Emit = std::function<void(const TrajectorySample&)>;
+
+    virtual ~TrajectoryOperation() = default;
+
+    virtual void process(const TrajectorySample& s, const Emit& emit) = 0;
+
+    /// Called once at the end of the stream, to flush any buffered samples
+    virtual void finish([[maybe_unused]] const Emit& emit) {}
+
+    /** Creates an operation from a textual spec, the operation name followed
+     *  by its space-separated arguments. Angles are in degrees:
+     *  - `rebase [x y z yaw pitch roll]`: moves the trajectory so its first
+     *    pose becomes the given one (like `traj_rebase`).
+     *  - `tf-left [x y z yaw pitch roll]`: `T (+) (p (-) p0)` for each pose
+     *    `p`, with `p0` the first one (like `traj_tf_left`).
+     *  - `tf-right [x y z yaw pitch roll]`: `p (+) T` for each pose `p`.
+     *  - `crop T0 T1`: keeps samples with timestamps in [T0,T1]. Either bound
+     *    can be `-` for no limit.
+     *  - `decimate N`: keeps one out of every N samples.
+     *  - `resample PERIOD`: interpolates poses every PERIOD seconds, starting
+     *    at the first timestamp.
+     *  - `interpolate FILE`: interpolates poses at the timestamps in the first
+     *    column of FILE (sorted, e.g. another TUM file or sensor stamps).
+     *  - `align REF_FILE [N] [se3|sim3]`: aligns to a reference trajectory
+     *    (Umeyama, see TrajectoryMetrics.h) using the first N associated
+     *    samples (default: 1000; 0=all, which buffers the whole trajectory).
+     */
+    static Ptr FromString(const std::string& spec);
+};
+
+/** A chain of TrajectoryOperation's, applied in order in a single pass */
+class TrajectoryPipeline
+{
+   public:
+    TrajectoryPipeline() = default;
+
+    void add(const TrajectoryOperation::Ptr& op) { ops_.push_back(op); }
+    void add(const std::string& spec)
+    {
+        add(TrajectoryOperation::FromString(spec));
+    }
+
+    size_t size() const { return ops_.size(); }
+
+    /** Streams all samples from `in` through the operations into `out`.
+     *  Returns the number of samples read. */
+    size_t run(TrajectoryReader& in, const TrajectoryOperation::Emit& out);
+
+   private:
+    std::vector<TrajectoryOperation::Ptr> ops_;
+};
+
+}  // namespace mola
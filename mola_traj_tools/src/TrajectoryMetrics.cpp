@@ -0,0 +1,387 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   TrajectoryMetrics.cpp
+ * @brief  Absolute (ATE) and relative (RPE) trajectory error metrics
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_traj_tools/TrajectoryMetrics.h>
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/math/CQuaternion.h>
+#include <mrpt/poses/Lie/SO.h>
+
+#include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <future>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+using namespace mola;
+
+namespace
+{
+// Runs f(first,last) over chunks of [0,n), in parallel:
+template <typename FUNC>
+void parallel_for_chunks(size_t n, size_t numThreads, FUNC&& f)
+{
+    if (numThreads == 0)
+        numThreads = std::max(1U, std::thread::hardware_concurrency());
+
+    constexpr size_t MIN_CHUNK = 1000;
+
+    const size_t nChunks =
+        std::clamp<size_t>(n / MIN_CHUNK, 1, 4 * numThreads);
+
+    if (nChunks == 1)
+    {
+        f(0, n);
+        return;
+    }
+
+    mrpt::WorkerThreadsPool pool(
+        std::min(numThreads, nChunks), mrpt::WorkerThreadsPool::POLICY_FIFO,
+        "traj_metrics");
+
+    std::vector<std::future<void>> futs;
+    for (size_t c = 0; c < nChunks; c++)
+    {
+        const size_t first = (n * c) / nChunks;
+        const size_t last  = (n * (c + 1)) / nChunks;
+        futs.emplace_back(
+            pool.enqueue([&f, first, last]() { f(first, last); }));
+    }
+    for (auto& fut : futs) fut.get();
+}
+
+void writeStatsJSON(
+    std::ostream& o, const char* name, const ErrorStatistics& s, bool last)
+{
+    o << mrpt::format(
+        "    \"%s\": {\"count\": %zu, \"rmse\": %.9g, \"mean\": %.9g, "
+        "\"median\": %.9g, \"std\": %.9g, \"min\": %.9g, \"max\": %.9g}%s\n",
+        name, s.count, s.rmse, s.mean, s.median, s.std, s.min, s.max,
+        last ? "" : ",");
+}
+}  // namespace
+
+AssociatedTrajectories mola::associate_trajectories(
+    const mrpt::poses::CPose3DInterpolator& gt,
+    const mrpt::poses::CPose3DInterpolator& est, double max_time_offset)
+{
+    AssociatedTrajectories ret;
+
+    // Sorted ground truth timestamps, for binary search:
+    std::vector<double>              gtTimes;
+    std::vector<mrpt::math::TPose3D> gtPoses;
+    gtTimes.reserve(gt.size());
+    gtPoses.reserve(gt.size());
+    for (const auto& [t, p] : gt)
+    {
+        gtTimes.push_back(mrpt::Clock::toDouble(t));
+        gtPoses.push_back(p);
+    }
+    if (gtTimes.empty()) return ret;
+
+    // est is also sorted by time, so matched gt indices never decrease, and
+    // only the last one may be claimed twice:
+    std::optional<size_t> lastMatched;
+
+    for (const auto& [tp, p] : est)
+    {
+        const double t  = mrpt::Clock::toDouble(tp);
+        const auto   it = std::lower_bound(gtTimes.begin(), gtTimes.end(), t);
+
+        size_t best = static_cast<size_t>(it - gtTimes.begin());
+        if (best == gtTimes.size() ||
+            (best > 0 && t - gtTimes[best - 1] < gtTimes[best] - t))
+            best--;
+
+        if (std::abs(gtTimes[best] - t) > max_time_offset) continue;
+        if (lastMatched && *lastMatched == best) continue;
+        lastMatched = best;
+
+        ret.timestamps.push_back(t);
+        ret.gt.emplace_back(gtPoses[best]);
+        ret.est.emplace_back(p);
+    }
+    return ret;
+}
+
+UmeyamaResult mola::umeyama_alignment(
+    const std::vector<mrpt::math::TPoint3D>& est,
+    const std::vector<mrpt::math::TPoint3D>& gt, bool with_scale)
+{
+    ASSERT_EQUAL_(est.size(), gt.size());
+    ASSERT_GE_(est.size(), 3U);
+
+    const size_t n = est.size();
+
+    Eigen::Vector3d muE = Eigen::Vector3d::Zero();
+    Eigen::Vector3d muG = Eigen::Vector3d::Zero();
+    for (size_t i = 0; i < n; i++)
+    {
+        muE += Eigen::Vector3d(est[i].x, est[i].y, est[i].z);
+        muG += Eigen::Vector3d(gt[i].x, gt[i].y, gt[i].z);
+    }
+    muE /= n;
+    muG /= n;
+
+    Eigen::Matrix3d cov    = Eigen::Matrix3d::Zero();
+    double          sigmaE = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        const Eigen::Vector3d e =
+            Eigen::Vector3d(est[i].x, est[i].y, est[i].z) - muE;
+        const Eigen::Vector3d g =
+            Eigen::Vector3d(gt[i].x, gt[i].y, gt[i].z) - muG;
+        cov += g * e.transpose();
+        sigmaE += e.squaredNorm();
+    }
+    cov /= n;
+    sigmaE /= n;
+
+    Eigen::JacobiSVD<Eigen::Matrix3d> svd(
+        cov, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+    // Avoid reflections:
+    Eigen::Vector3d s = Eigen::Vector3d::Ones();
+    if (svd.matrixU().determinant() * svd.matrixV().determinant() < 0)
+        s.z() = -1;
+
+    const Eigen::Matrix3d R =
+        svd.matrixU() * s.asDiagonal() * svd.matrixV().transpose();
+
+    UmeyamaResult ret;
+    if (with_scale)
+    {
+        ASSERT_GT_(sigmaE, .0);
+        ret.scale = svd.singularValues().dot(s) / sigmaE;
+    }
+    const Eigen::Vector3d t = muG - ret.scale * R * muE;
+
+    ret.transform = mrpt::poses::CPose3D::FromRotationAndTranslation(
+        mrpt::math::CMatrixDouble33(R),
+        mrpt::math::TVector3D(t.x(), t.y(), t.z()));
+
+    return ret;
+}
+
+ErrorStatistics ErrorStatistics::FromErrors(std::vector<double> errors)
+{
+    ErrorStatistics s;
+    s.count = errors.size();
+    if (errors.empty()) return s;
+
+    double sum = 0, sqrSum = 0;
+    for (const double e : errors)
+    {
+        sum += e;
+        sqrSum += e * e;
+    }
+    s.mean = sum / s.count;
+    s.rmse = std::sqrt(sqrSum / s.count);
+    s.std  = std::sqrt(std::max(.0, sqrSum / s.count - s.mean * s.mean));
+
+    const auto mid = errors.begin() + s.count / 2;
+    std::nth_element(errors.begin(), mid, errors.end());
+    s.median = *mid;
+    if (s.count % 2 == 0)
+        s.median = 0.5 * (s.median + *std::max_element(errors.begin(), mid));
+
+    const auto [itMin, itMax] =
+        std::minmax_element(errors.begin(), errors.end());
+    s.min = *itMin;
+    s.max = *itMax;
+
+    return s;
+}
+
+TrajectoryMetrics mola::compute_trajectory_metrics(
+    const AssociatedTrajectories& trajs, const TrajectoryMetricsParameters& p)
+{
+    using DeltaUnit = TrajectoryMetricsParameters::DeltaUnit;
+
+    const size_t n = trajs.size();
+    ASSERT_EQUAL_(trajs.gt.size(), n);
+    ASSERT_EQUAL_(trajs.est.size(), n);
+    ASSERT_GT_(p.rpe_delta, .0);
+
+    TrajectoryMetrics m;
+
+    // 1) Alignment:
+    if (p.alignment != TrajectoryAlignment::None)
+    {
+        const size_t nAlign =
+            p.align_first_n == 0 ? n : std::min(n, p.align_first_n);
+
+        std::vector<mrpt::math::TPoint3D> e(nAlign), g(nAlign);
+        for (size_t i = 0; i < nAlign; i++)
+        {
+            e[i] = trajs.est[i].translation();
+            g[i] = trajs.gt[i].translation();
+        }
+        m.alignment = umeyama_alignment(
+            e, g, p.alignment == TrajectoryAlignment::Sim3);
+    }
+    const auto&  T = m.alignment.transform;
+    const double s = m.alignment.scale;
+
+    // 2) ATE:
+    m.ate_timestamps = trajs.timestamps;
+    m.ate_translation.resize(n);
+    m.ate_rotation.resize(n);
+
+    parallel_for_chunks(
+        n, p.num_threads,
+        [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                const auto& gt  = trajs.gt[i];
+                const auto& est = trajs.est[i];
+
+                const auto tEst = T.rotateVector(est.translation() * s) +
+                                  T.translation();
+                const Eigen::Matrix3d RErr =
+                    gt.getRotationMatrix().asEigen().transpose() *
+                    T.getRotationMatrix().asEigen() *
+                    est.getRotationMatrix().asEigen();
+
+                m.ate_translation[i] = (gt.translation() - tEst).norm();
+                m.ate_rotation[i]    = mrpt::poses::Lie::SO<3>::log(
+                                        mrpt::math::CMatrixDouble33(RErr))
+                                        .norm();
+            }
+        });
+
+    m.ate_translation_stats = ErrorStatistics::FromErrors(m.ate_translation);
+    m.ate_rotation_stats    = ErrorStatistics::FromErrors(m.ate_rotation);
+
+    // 3) RPE:
+    // Accumulated distance along ground truth:
+    std::vector<double> dist(n, 0.0);
+    for (size_t i = 1; i < n; i++)
+        dist[i] = dist[i - 1] +
+                  (trajs.gt[i].translation() - trajs.gt[i - 1].translation())
+                      .norm();
+
+    const auto lambdaPairedIndex = [&](size_t i) -> size_t
+    {
+        switch (p.rpe_delta_unit)
+        {
+            case DeltaUnit::Frames:
+                return i + std::max<size_t>(1, std::lround(p.rpe_delta));
+            case DeltaUnit::Meters:
+                return std::lower_bound(
+                           dist.begin() + i + 1, dist.end(),
+                           dist[i] + p.rpe_delta) -
+                       dist.begin();
+            case DeltaUnit::Seconds:
+                return std::lower_bound(
+                           trajs.timestamps.begin() + i + 1,
+                           trajs.timestamps.end(),
+                           trajs.timestamps[i] + p.rpe_delta) -
+                       trajs.timestamps.begin();
+        };
+        return n;
+    };
+
+    std::vector<size_t> pairedIdx(n, n);
+    std::vector<double> rpeT(n), rpeR(n);
+
+    parallel_for_chunks(
+        n, p.num_threads,
+        [&](size_t first, size_t last)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                const size_t j = lambdaPairedIndex(i);
+                if (j >= n) continue;
+                pairedIdx[i] = j;
+
+                const auto dGt  = trajs.gt[j] - trajs.gt[i];
+                auto       dEst = trajs.est[j] - trajs.est[i];
+                dEst.x(dEst.x() * s);
+                dEst.y(dEst.y() * s);
+                dEst.z(dEst.z() * s);
+
+                const auto err = dEst - dGt;
+                rpeT[i]        = err.translation().norm();
+                rpeR[i] = mrpt::poses::Lie::SO<3>::log(err.getRotationMatrix())
+                              .norm();
+            }
+        });
+
+    // Gather in order:
+    for (size_t i = 0; i < n; i++)
+    {
+        if (pairedIdx[i] >= n) continue;
+        m.rpe_timestamps_from.push_back(trajs.timestamps[i]);
+        m.rpe_timestamps_to.push_back(trajs.timestamps[pairedIdx[i]]);
+        m.rpe_translation.push_back(rpeT[i]);
+        m.rpe_rotation.push_back(rpeR[i]);
+    }
+    m.rpe_translation_stats = ErrorStatistics::FromErrors(m.rpe_translation);
+    m.rpe_rotation_stats    = ErrorStatistics::FromErrors(m.rpe_rotation);
+
+    return m;
+}
+
+void TrajectoryMetrics::saveAsJSON(std::ostream& o) const
+{
+    const auto& T = alignment.transform;
+
+    mrpt::math::CQuaternionDouble q;
+    T.getAsQuaternion(q);
+
+    o << "{\n";
+    o << "  \"alignment\": {\n";
+    o << mrpt::format(
+        "    \"scale\": %.12g,\n"
+        "    \"translation\": [%.12g, %.12g, %.12g],\n"
+        "    \"quaternion_xyzw\": [%.12g, %.12g, %.12g, %.12g]\n",
+        alignment.scale, T.x(), T.y(), T.z(), q.x(), q.y(), q.z(), q.r());
+    o << "  },\n";
+    o << "  \"ate\": {\n";
+    writeStatsJSON(o, "translation", ate_translation_stats, false);
+    writeStatsJSON(o, "rotation_rad", ate_rotation_stats, true);
+    o << "  },\n";
+    o << "  \"rpe\": {\n";
+    writeStatsJSON(o, "translation", rpe_translation_stats, false);
+    writeStatsJSON(o, "rotation_rad", rpe_rotation_stats, true);
+    o << "  }\n";
+    o << "}\n";
+}
+
+bool TrajectoryMetrics::saveAsCSV(const std::string& prefix) const
+{
+    std::ofstream fAte(prefix + "_ate.csv");
+    if (!fAte.is_open()) return false;
+
+    fAte << "timestamp,translation,rotation_rad\n";
+    for (size_t i = 0; i < ate_timestamps.size(); i++)
+        fAte << mrpt::format(
+            "%.9f,%.9g,%.9g\n", ate_timestamps[i], ate_translation[i],
+            ate_rotation[i]);
+
+    std::ofstream fRpe(prefix + "_rpe.csv");
+    if (!fRpe.is_open()) return false;
+
+    fRpe << "timestamp_from,timestamp_to,translation,rotation_rad\n";
+    for (size_t i = 0; i < rpe_timestamps_from.size(); i++)
+        fRpe << mrpt::format(
+            "%.9f,%.9f,%.9g,%.9g\n", rpe_timestamps_from[i],
+            rpe_timestamps_to[i], rpe_translation[i], rpe_rotation[i]);
+
+    return fAte.good() && fRpe.good();
+}
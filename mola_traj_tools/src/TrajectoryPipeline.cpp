@@ -0,0 +1,522 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   TrajectoryPipeline.cpp
+ * @brief  Streaming reader, writer, and composable operations on trajectories
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_traj_tools/TrajectoryMetrics.h>
+#include <mola_traj_tools/TrajectoryPipeline.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/math/CQuaternion.h>
+#include <mrpt/math/slerp.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <sstream>
+
+using namespace mola;
+
+TrajectoryFileFormat mola::trajectory_format_from_string(const std::string& s)
+{
+    if (s == "tum") return TrajectoryFileFormat::TUM;
+    if (s == "ypr") return TrajectoryFileFormat::YPR;
+    if (s == "csv") return TrajectoryFileFormat::CSV;
+    THROW_EXCEPTION_FMT("Unknown trajectory format: '%s'", s.c_str());
+}
+
+TrajectoryFileFormat mola::trajectory_format_from_filename(
+    const std::string& file)
+{
+    const auto ends_with = [&](const char* ext)
+    {
+        const std::string e = ext;
+        return file.size() >= e.size() &&
+               file.compare(file.size() - e.size(), e.size(), e) == 0;
+    };
+    if (ends_with(".csv")) return TrajectoryFileFormat::CSV;
+    if (ends_with(".ypr")) return TrajectoryFileFormat::YPR;
+    return TrajectoryFileFormat::TUM;
+}
+
+// ------------------------------------------------------------------
+// TrajectoryReader / TrajectoryWriter
+// ------------------------------------------------------------------
+TrajectoryReader::TrajectoryReader(
+    const std::string& file, TrajectoryFileFormat fmt)
+    : fmt_(fmt)
+{
+    if (file == "-") { in_ = &std::cin; }
+    else
+    {
+        file_.open(file);
+        ASSERTMSG_(
+            file_.is_open(),
+            mrpt::format("Cannot open for reading: '%s'", file.c_str()));
+        in_ = &file_;
+    }
+}
+
+bool TrajectoryReader::next(TrajectorySample& s)
+{
+    const size_t nCols = fmt_ == TrajectoryFileFormat::YPR ? 7 : 8;
+
+    while (std::getline(*in_, line_))
+    {
+        lineNumber_++;
+
+        // Skip blank, comment, and header lines:
+        const auto first = line_.find_first_not_of(" \t\r");
+        if (first == std::string::npos) continue;
+        const char c0 = line_[first];
+        if (!std::isdigit(static_cast<unsigned char>(c0)) && c0 != '-' &&
+            c0 != '+' && c0 != '.')
+            continue;
+
+        if (fmt_ == TrajectoryFileFormat::CSV)
+            std::replace(line_.begin(), line_.end(), ',', ' ');
+
+        double      v[8];
+        const char* p = line_.c_str() + first;
+        for (size_t i = 0; i < nCols; i++)
+        {
+            char* end = nullptr;
+            v[i]      = std::strtod(p, &end);
+            ASSERTMSG_(
+                end != p, mrpt::format(
+                              "Malformed trajectory line %zu: '%s'",
+                              lineNumber_, line_.c_str()));
+            p = end;
+        }
+
+        s.t = v[0];
+        if (fmt_ == TrajectoryFileFormat::YPR)
+        {
+            s.pose = mrpt::math::TPose3D(v[1], v[2], v[3], v[4], v[5], v[6]);
+        }
+        else
+        {
+            // Normalize, to tolerate the limited precision of text files:
+            const double n = std::sqrt(
+                v[4] * v[4] + v[5] * v[5] + v[6] * v[6] + v[7] * v[7]);
+            ASSERT_GT_(n, .0);
+            const mrpt::math::CQuaternionDouble q(
+                v[7] / n, v[4] / n, v[5] / n, v[6] / n);
+            s.pose = mrpt::poses::CPose3D(q, v[1], v[2], v[3]).asTPose();
+        }
+        return true;
+    }
+    return false;
+}
+
+TrajectoryWriter::TrajectoryWriter(
+    const std::string& file, TrajectoryFileFormat fmt)
+    : fmt_(fmt)
+{
+    if (file == "-") { out_ = &std::cout; }
+    else
+    {
+        file_.open(file);
+        ASSERTMSG_(
+            file_.is_open(),
+            mrpt::format("Cannot open for writing: '%s'", file.c_str()));
+        out_ = &file_;
+    }
+    if (fmt_ == TrajectoryFileFormat::CSV)
+        *out_ << "timestamp,x,y,z,qx,qy,qz,qw\n";
+}
+
+void TrajectoryWriter::write(const TrajectorySample& s)
+{
+    char       buf[256];
+    int        len = 0;
+    const auto& p  = s.pose;
+
+    if (fmt_ == TrajectoryFileFormat::YPR)
+    {
+        len = std::snprintf(
+            buf, sizeof(buf), "%.9f %.9g %.9g %.9g %.9g %.9g %.9g\n", s.t, p.x,
+            p.y, p.z, p.yaw, p.pitch, p.roll);
+    }
+    else
+    {
+        mrpt::math::CQuaternionDouble q;
+        mrpt::poses::CPose3D(p).getAsQuaternion(q);
+
+        const char* f = fmt_ == TrajectoryFileFormat::CSV
+                            ? "%.9f,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n"
+                            : "%.9f %.9g %.9g %.9g %.9g %.9g %.9g %.9g\n";
+        len = std::snprintf(
+            buf, sizeof(buf), f, s.t, p.x, p.y, p.z, q.x(), q.y(), q.z(),
+            q.r());
+    }
+    out_->write(buf, len);
+}
+
+TrajectorySample mola::interpolate_samples(
+    const TrajectorySample& a, const TrajectorySample& b, double t)
+{
+    TrajectorySample r;
+    r.t = t;
+
+    const double dt = b.t - a.t;
+    if (dt <= 0)
+    {
+        r.pose = a.pose;
+        return r;
+    }
+    mrpt::math::slerp(a.pose, b.pose, (t - a.t) / dt, r.pose);
+    return r;
+}
+
+// ------------------------------------------------------------------
+// Operations
+// ------------------------------------------------------------------
+namespace
+{
+class OpRebase : public TrajectoryOperation
+{
+   public:
+    explicit OpRebase(const mrpt::poses::CPose3D& newStart)
+        : newStart_(newStart)
+    {
+    }
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        const mrpt::poses::CPose3D p(s.pose);
+        if (!tf_) tf_ = newStart_ - p;
+        emit({s.t, (*tf_ + p).asTPose()});
+    }
+
+   private:
+    mrpt::poses::CPose3D                newStart_;
+    std::optional<mrpt::poses::CPose3D> tf_;
+};
+
+class OpComposeLeft : public TrajectoryOperation
+{
+   public:
+    explicit OpComposeLeft(const mrpt::poses::CPose3D& tf) : tf_(tf) {}
+
+    // As traj_tf_left, relative to the first pose:
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        if (!p0_) p0_ = s.pose;
+        emit({s.t, (tf_ + mrpt::poses::CPose3D(s.pose - *p0_)).asTPose()});
+    }
+
+   private:
+    mrpt::poses::CPose3D               tf_;
+    std::optional<mrpt::math::TPose3D> p0_;
+};
+
+class OpComposeRight : public TrajectoryOperation
+{
+   public:
+    explicit OpComposeRight(const mrpt::poses::CPose3D& tf) : tf_(tf) {}
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        emit({s.t, (mrpt::poses::CPose3D(s.pose) + tf_).asTPose()});
+    }
+
+   private:
+    mrpt::poses::CPose3D tf_;
+};
+
+class OpCrop : public TrajectoryOperation
+{
+   public:
+    OpCrop(double t0, double t1) : t0_(t0), t1_(t1) {}
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        if (s.t >= t0_ && s.t <= t1_) emit(s);
+    }
+
+   private:
+    double t0_, t1_;
+};
+
+class OpDecimate : public TrajectoryOperation
+{
+   public:
+    explicit OpDecimate(size_t n) : n_(n) { ASSERT_GE_(n_, 1U); }
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        if (counter_++ % n_ == 0) emit(s);
+    }
+
+   private:
+    size_t n_, counter_ = 0;
+};
+
+class OpResample : public TrajectoryOperation
+{
+   public:
+    explicit OpResample(double period) : period_(period)
+    {
+        ASSERT_GT_(period_, .0);
+    }
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        if (!t0_) t0_ = s.t;
+
+        // Computed from t0 (not accumulated) to avoid drift:
+        double t;
+        while ((t = *t0_ + k_ * period_) <= s.t)
+        {
+            if (t == s.t || !prev_) emit({t, s.pose});
+            else
+                emit(interpolate_samples(*prev_, s, t));
+            k_++;
+        }
+        prev_ = s;
+    }
+
+   private:
+    double                          period_;
+    std::optional<double>           t0_;
+    size_t                          k_ = 0;
+    std::optional<TrajectorySample> prev_;
+};
+
+class OpInterpolate : public TrajectoryOperation
+{
+   public:
+    explicit OpInterpolate(const std::string& queryFile) : f_(queryFile)
+    {
+        ASSERTMSG_(
+            f_.is_open(),
+            mrpt::format("Cannot open for reading: '%s'", queryFile.c_str()));
+        q_ = nextQuery();
+    }
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        while (q_ && *q_ <= s.t)
+        {
+            if (*q_ == s.t) emit(s);
+            else if (prev_)
+                emit(interpolate_samples(*prev_, s, *q_));
+            // else: before the first sample, can't interpolate.
+
+            q_ = nextQuery();
+        }
+        prev_ = s;
+    }
+
+   private:
+    std::ifstream                   f_;
+    std::string                     line_;
+    std::optional<double>           q_;
+    std::optional<TrajectorySample> prev_;
+
+    std::optional<double> nextQuery()
+    {
+        while (std::getline(f_, line_))
+        {
+            const char* p   = line_.c_str();
+            char*       end = nullptr;
+            const auto  t   = std::strtod(p, &end);
+            if (end != p) return t;  // else: comment, header, blank...
+        }
+        return {};
+    }
+};
+
+class OpAlign : public TrajectoryOperation
+{
+   public:
+    OpAlign(const std::string& refFile, size_t n, bool withScale)
+        : n_(n), withScale_(withScale)
+    {
+        TrajectoryReader rd(refFile, trajectory_format_from_filename(refFile));
+        TrajectorySample s;
+        while (rd.next(s)) ref_.insert(mrpt::Clock::fromDouble(s.t), s.pose);
+        ASSERTMSG_(
+            !ref_.empty(),
+            mrpt::format("Empty reference trajectory: '%s'", refFile.c_str()));
+    }
+
+    void process(const TrajectorySample& s, const Emit& emit) override
+    {
+        if (alignment_)
+        {
+            emit(transform(s));
+            return;
+        }
+        buffer_.push_back(s);
+        if (n_ != 0 && buffer_.size() >= n_) flush(emit);
+    }
+
+    void finish(const Emit& emit) override
+    {
+        if (!alignment_) flush(emit);
+    }
+
+   private:
+    size_t                           n_;
+    bool                             withScale_;
+    mrpt::poses::CPose3DInterpolator ref_;
+    std::vector<TrajectorySample>    buffer_;
+    std::optional<UmeyamaResult>     alignment_;
+
+    void flush(const Emit& emit)
+    {
+        if (buffer_.empty()) return;
+
+        mrpt::poses::CPose3DInterpolator est;
+        for (const auto& s : buffer_)
+            est.insert(mrpt::Clock::fromDouble(s.t), s.pose);
+
+        const auto trajs = associate_trajectories(ref_, est);
+        ASSERTMSG_(
+            trajs.size() >= 3,
+            mrpt::format(
+                "align: only %zu samples could be associated with the "
+                "reference trajectory",
+                trajs.size()));
+
+        std::vector<mrpt::math::TPoint3D> e, g;
+        for (size_t i = 0; i < trajs.size(); i++)
+        {
+            e.push_back(trajs.est[i].translation());
+            g.push_back(trajs.gt[i].translation());
+        }
+        alignment_ = umeyama_alignment(e, g, withScale_);
+
+        for (const auto& s : buffer_) emit(transform(s));
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+    }
+
+    TrajectorySample transform(const TrajectorySample& s) const
+    {
+        mrpt::poses::CPose3D p(s.pose);
+        p.x(p.x() * alignment_->scale);
+        p.y(p.y() * alignment_->scale);
+        p.z(p.z() * alignment_->scale);
+        return {s.t, (alignment_->transform + p).asTPose()};
+    }
+};
+
+double parse_time_bound(const std::string& s, double valueIfNone)
+{
+    if (s == "-") return valueIfNone;
+    return std::stod(s);
+}
+
+}  // namespace
+
+TrajectoryOperation::Ptr TrajectoryOperation::FromString(
+    const std::string& spec)
+{
+    std::istringstream ss(spec);
+    std::string        name;
+    ss >> name;
+
+    std::string rest;
+    std::getline(ss, rest);
+    rest.erase(0, rest.find_first_not_of(" \t"));
+
+    std::istringstream       args(rest);
+    std::vector<std::string> tokens;
+    for (std::string tok; args >> tok;) tokens.push_back(tok);
+
+    const auto lambdaAssertArgs = [&](size_t minN, size_t maxN)
+    {
+        ASSERTMSG_(
+            tokens.size() >= minN && tokens.size() <= maxN,
+            mrpt::format(
+                "Wrong number of arguments for operation: '%s'",
+                spec.c_str()));
+    };
+
+    if (name == "rebase" || name == "tf-left" || name == "tf-right")
+    {
+        const auto tf = mrpt::poses::CPose3D::FromString(rest);
+        if (name == "rebase") return std::make_shared<OpRebase>(tf);
+        if (name == "tf-left") return std::make_shared<OpComposeLeft>(tf);
+        return std::make_shared<OpComposeRight>(tf);
+    }
+    if (name == "crop")
+    {
+        lambdaAssertArgs(2, 2);
+        constexpr double inf = std::numeric_limits<double>::infinity();
+        return std::make_shared<OpCrop>(
+            parse_time_bound(tokens[0], -inf),
+            parse_time_bound(tokens[1], inf));
+    }
+    if (name == "decimate")
+    {
+        lambdaAssertArgs(1, 1);
+        return std::make_shared<OpDecimate>(std::stoul(tokens[0]));
+    }
+    if (name == "resample")
+    {
+        lambdaAssertArgs(1, 1);
+        return std::make_shared<OpResample>(std::stod(tokens[0]));
+    }
+    if (name == "interpolate")
+    {
+        lambdaAssertArgs(1, 1);
+        return std::make_shared<OpInterpolate>(tokens[0]);
+    }
+    if (name == "align")
+    {
+        lambdaAssertArgs(1, 3);
+        const size_t n = tokens.size() >= 2 ? std::stoul(tokens[1]) : 1000;
+        bool         withScale = false;
+        if (tokens.size() == 3)
+        {
+            ASSERTMSG_(
+                tokens[2] == "se3" || tokens[2] == "sim3",
+                "align: last argument must be 'se3' or 'sim3'");
+            withScale = tokens[2] == "sim3";
+        }
+        return std::make_shared<OpAlign>(tokens[0], n, withScale);
+    }
+
+    THROW_EXCEPTION_FMT("Unknown trajectory operation: '%s'", spec.c_str());
+}
+
+size_t TrajectoryPipeline::run(
+    TrajectoryReader& in, const TrajectoryOperation::Emit& out)
+{
+    // emits[i] feeds the i-th operation, the last one is the output:
+    std::vector<TrajectoryOperation::Emit> emits(ops_.size() + 1);
+    emits.back() = out;
+    for (size_t i = ops_.size(); i-- > 0;)
+    {
+        emits[i] = [op = ops_[i].get(), &next = emits[i + 1]](
+                       const TrajectorySample& s) { op->process(s, next); };
+    }
+
+    size_t           nRead = 0;
+    TrajectorySample s;
+    while (in.next(s))
+    {
+        emits.front()(s);
+        nRead++;
+    }
+
+    // Flush in order, so buffered samples still go through later stages:
+    for (size_t i = 0; i < ops_.size(); i++) ops_[i]->finish(emits[i + 1]);
+
+    return nRead;
+}
@@ -0,0 +1,154 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   traj_metrics.cpp
+ * @brief  CLI to evaluate ATE and RPE of a trajectory vs. its ground truth
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_traj_tools/TrajectoryMetrics.h>
+#include <mrpt/3rdparty/tclap/CmdLine.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <fstream>
+#include <iostream>
+
+// Declare supported cli switches ===========
+struct Cli
+{
+    TCLAP::CmdLine cmd{"traj_metrics"};
+
+    TCLAP::ValueArg<std::string> argGT{
+        "g", "gt", "Ground truth trajectory, in TUM format",
+        true, "gt.tum", "gt.tum", cmd};
+
+    TCLAP::ValueArg<std::string> argEst{
+        "e", "est", "Trajectory to evaluate, in TUM format",
+        true, "est.tum", "est.tum", cmd};
+
+    TCLAP::ValueArg<std::string> argAlign{
+        "a", "align", "Alignment before computing ATE: none|se3|sim3",
+        false, "se3", "se3", cmd};
+
+    TCLAP::ValueArg<size_t> argAlignFirstN{
+        "", "align-first-n",
+        "Use only the first N associated poses for alignment (0=all)",
+        false, 0, "0", cmd};
+
+    TCLAP::ValueArg<double> argMaxTimeDiff{
+        "", "max-time-diff",
+        "Maximum timestamp difference [s] to associate poses",
+        false, 0.01, "0.01", cmd};
+
+    TCLAP::ValueArg<double> argRpeDelta{
+        "", "rpe-delta", "Separation between pose pairs for RPE",
+        false, 1.0, "1.0", cmd};
+
+    TCLAP::ValueArg<std::string> argRpeUnit{
+        "", "rpe-unit", "Unit of --rpe-delta: frames|m|s",
+        false, "frames", "frames", cmd};
+
+    TCLAP::ValueArg<std::string> argJSON{
+        "", "json", "Write the statistics to this JSON file",
+        false, "", "metrics.json", cmd};
+
+    TCLAP::ValueArg<std::string> argCSV{
+        "", "csv-prefix",
+        "Write per-pose errors to <PREFIX>_ate.csv and <PREFIX>_rpe.csv",
+        false, "", "metrics", cmd};
+
+    TCLAP::ValueArg<size_t> argNumThreads{
+        "", "num-threads", "Number of parallel threads (0=all cores)",
+        false, 0, "0", cmd};
+};
+
+static void printStats(const char* name, const mola::ErrorStatistics& s)
+{
+    std::cout << name << ": rmse=" << s.rmse << " mean=" << s.mean
+              << " median=" << s.median << " std=" << s.std
+              << " min=" << s.min << " max=" << s.max << " (" << s.count
+              << " samples)\n";
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        Cli cli;
+        if (!cli.cmd.parse(argc, argv)) return 1;  // should exit.
+
+        using DeltaUnit = mola::TrajectoryMetricsParameters::DeltaUnit;
+
+        mola::TrajectoryMetricsParameters params;
+        params.align_first_n = cli.argAlignFirstN.getValue();
+        params.rpe_delta     = cli.argRpeDelta.getValue();
+        params.num_threads   = cli.argNumThreads.getValue();
+
+        if (const auto& a = cli.argAlign.getValue(); a == "none")
+            params.alignment = mola::TrajectoryAlignment::None;
+        else if (a == "se3")
+            params.alignment = mola::TrajectoryAlignment::SE3;
+        else if (a == "sim3")
+            params.alignment = mola::TrajectoryAlignment::Sim3;
+        else
+            THROW_EXCEPTION_FMT("Invalid --align value: '%s'", a.c_str());
+
+        if (const auto& u = cli.argRpeUnit.getValue(); u == "frames")
+            params.rpe_delta_unit = DeltaUnit::Frames;
+        else if (u == "m")
+            params.rpe_delta_unit = DeltaUnit::Meters;
+        else if (u == "s")
+            params.rpe_delta_unit = DeltaUnit::Seconds;
+        else
+            THROW_EXCEPTION_FMT("Invalid --rpe-unit value: '%s'", u.c_str());
+
+        mrpt::poses::CPose3DInterpolator gt, est;
+        ASSERT_(gt.loadFromTextFile_TUM(cli.argGT.getValue()));
+        ASSERT_(est.loadFromTextFile_TUM(cli.argEst.getValue()));
+
+        std::cout << "Loaded: " << gt.size() << " ground truth poses, "
+                  << est.size() << " estimated poses.\n";
+
+        mrpt::system::CTicTac tictac;
+
+        const auto trajs = mola::associate_trajectories(
+            gt, est, cli.argMaxTimeDiff.getValue());
+
+        std::cout << "Associated: " << trajs.size() << " poses.\n";
+        ASSERT_(!trajs.empty());
+
+        const auto m = mola::compute_trajectory_metrics(trajs, params);
+
+        std::cout << "Computed metrics in " << tictac.Tac() << " s.\n";
+        std::cout << "Alignment: " << m.alignment.transform
+                  << " scale=" << m.alignment.scale << "\n";
+        printStats("ATE translation [m]  ", m.ate_translation_stats);
+        printStats("ATE rotation [rad]   ", m.ate_rotation_stats);
+        printStats("RPE translation [m]  ", m.rpe_translation_stats);
+        printStats("RPE rotation [rad]   ", m.rpe_rotation_stats);
+
+        if (cli.argJSON.isSet())
+        {
+            std::ofstream f(cli.argJSON.getValue());
+            ASSERT_(f.is_open());
+            m.saveAsJSON(f);
+        }
+        if (cli.argCSV.isSet())
+        {
+            ASSERT_(m.saveAsCSV(cli.argCSV.getValue()));
+        }
+
+        return 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+}
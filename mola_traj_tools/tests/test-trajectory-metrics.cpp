@@ -0,0 +1,247 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-trajectory-metrics.cpp
+ * @brief  Unit tests for ATE/RPE metrics and Umeyama alignment
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_traj_tools/TrajectoryMetrics.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+constexpr double T0 = 1700000000.0;  // [s] a realistic UNIX timestamp
+constexpr double DT = 0.1;  // [s]
+
+// A 3D spiral trajectory, with heading along the path:
+mrpt::poses::CPose3DInterpolator synthetic_gt(size_t n)
+{
+    mrpt::poses::CPose3DInterpolator gt;
+    for (size_t i = 0; i < n; i++)
+    {
+        const double a = i * 0.01;
+        gt.insert(
+            mrpt::Clock::fromDouble(T0 + i * DT),
+            mrpt::math::TPose3D(
+                20.0 * std::cos(a), 20.0 * std::sin(a), 0.05 * i, a + M_PI_2,
+                0.1 * std::sin(3 * a), 0.05 * std::cos(2 * a)));
+    }
+    return gt;
+}
+
+// est = T^{-1} (applied to gt), with positions scaled by 1/scale, and
+// optional additive noise in positions:
+mrpt::poses::CPose3DInterpolator transformed_est(
+    const mrpt::poses::CPose3DInterpolator& gt, const mrpt::poses::CPose3D& T,
+    double scale, double noise_std, double time_offset = 0,
+    size_t decimation = 1)
+{
+    auto& rng = mrpt::random::getRandomGenerator();
+    rng.randomize(1234);
+
+    const auto Tinv = -T;
+
+    mrpt::poses::CPose3DInterpolator est;
+    size_t                           i = 0;
+    for (const auto& [t, p] : gt)
+    {
+        if (i++ % decimation != 0) continue;
+
+        auto q = Tinv + mrpt::poses::CPose3D(p);
+        q.x(q.x() / scale + rng.drawGaussian1D(0, noise_std));
+        q.y(q.y() / scale + rng.drawGaussian1D(0, noise_std));
+        q.z(q.z() / scale + rng.drawGaussian1D(0, noise_std));
+
+        est.insert(
+            mrpt::Clock::fromDouble(mrpt::Clock::toDouble(t) + time_offset),
+            q.asTPose());
+    }
+    return est;
+}
+
+void check_pose_near(
+    const mrpt::poses::CPose3D& a, const mrpt::poses::CPose3D& b, double tol)
+{
+    const auto d = a - b;
+    ASSERT_LT_(d.translation().norm(), tol);
+    ASSERT_LT_(std::abs(d.yaw()), tol);
+    ASSERT_LT_(std::abs(d.pitch()), tol);
+    ASSERT_LT_(std::abs(d.roll()), tol);
+}
+
+const auto T_true = mrpt::poses::CPose3D(5.0, -3.0, 1.0, 0.7, 0.1, -0.2);
+
+void test_se3_noiseless()
+{
+    const auto gt  = synthetic_gt(500);
+    const auto est = transformed_est(gt, T_true, 1.0, 0.0);
+
+    const auto trajs = mola::associate_trajectories(gt, est);
+    ASSERT_EQUAL_(trajs.size(), 500U);
+
+    const auto m = mola::compute_trajectory_metrics(trajs);
+
+    check_pose_near(m.alignment.transform, T_true, 1e-6);
+    ASSERT_NEAR_(m.alignment.scale, 1.0, 1e-9);
+    ASSERT_LT_(m.ate_translation_stats.max, 1e-6);
+    ASSERT_LT_(m.ate_rotation_stats.max, 1e-6);
+    ASSERT_EQUAL_(m.rpe_translation.size(), 499U);
+    ASSERT_LT_(m.rpe_translation_stats.max, 1e-6);
+    ASSERT_LT_(m.rpe_rotation_stats.max, 1e-6);
+
+    // Without alignment, the ATE is that of the rigid transform:
+    mola::TrajectoryMetricsParameters p;
+    p.alignment      = mola::TrajectoryAlignment::None;
+    const auto mNone = mola::compute_trajectory_metrics(trajs, p);
+    ASSERT_GT_(mNone.ate_translation_stats.min, 1.0);
+    ASSERT_LT_(mNone.rpe_translation_stats.max, 1e-6);
+}
+
+void test_sim3()
+{
+    const double scale = 2.5;
+    const auto   gt    = synthetic_gt(500);
+    const auto   est   = transformed_est(gt, T_true, scale, 0.0);
+    const auto   trajs = mola::associate_trajectories(gt, est);
+
+    mola::TrajectoryMetricsParameters p;
+    p.alignment  = mola::TrajectoryAlignment::Sim3;
+    const auto m = mola::compute_trajectory_metrics(trajs, p);
+
+    check_pose_near(m.alignment.transform, T_true, 1e-6);
+    ASSERT_NEAR_(m.alignment.scale, scale, 1e-6);
+    ASSERT_LT_(m.ate_translation_stats.max, 1e-6);
+    ASSERT_LT_(m.rpe_translation_stats.max, 1e-6);
+
+    // SE(3) alignment can't fix the scale:
+    p.alignment     = mola::TrajectoryAlignment::SE3;
+    const auto mSE3 = mola::compute_trajectory_metrics(trajs, p);
+    ASSERT_GT_(mSE3.ate_translation_stats.rmse, 1.0);
+}
+
+void test_noise()
+{
+    const double sigma = 0.05;
+    const auto   gt    = synthetic_gt(5000);
+    const auto   est   = transformed_est(gt, T_true, 1.0, sigma);
+    const auto   trajs = mola::associate_trajectories(gt, est);
+
+    const auto m = mola::compute_trajectory_metrics(trajs);
+
+    check_pose_near(m.alignment.transform, T_true, 1e-2);
+
+    // E[|e|^2] = 3 sigma^2 for isotropic noise:
+    ASSERT_NEAR_(
+        m.ate_translation_stats.rmse, std::sqrt(3.0) * sigma, 0.1 * sigma);
+    // Relative errors combine two samples:
+    ASSERT_NEAR_(
+        m.rpe_translation_stats.rmse, std::sqrt(6.0) * sigma, 0.2 * sigma);
+    ASSERT_LT_(m.ate_rotation_stats.max, 1e-2);
+}
+
+void test_association()
+{
+    // Estimated poses at half the rate, with a small time offset:
+    const auto gt  = synthetic_gt(1000);
+    const auto est = transformed_est(gt, T_true, 1.0, 0.0, 3e-3, 2);
+
+    const auto trajs = mola::associate_trajectories(gt, est, 0.01);
+    ASSERT_EQUAL_(trajs.size(), 500U);
+
+    const auto m = mola::compute_trajectory_metrics(trajs);
+    ASSERT_LT_(m.ate_translation_stats.max, 1e-6);
+
+    // Too strict:
+    ASSERT_(mola::associate_trajectories(gt, est, 1e-3).empty());
+}
+
+void test_rpe_units()
+{
+    const auto gt    = synthetic_gt(1000);
+    const auto est   = transformed_est(gt, T_true, 1.0, 0.01);
+    const auto trajs = mola::associate_trajectories(gt, est);
+
+    using DeltaUnit = mola::TrajectoryMetricsParameters::DeltaUnit;
+
+    mola::TrajectoryMetricsParameters p;
+    p.rpe_delta_unit = DeltaUnit::Seconds;
+    p.rpe_delta      = 10 * DT - 1e-6;
+    auto m           = mola::compute_trajectory_metrics(trajs, p);
+    ASSERT_EQUAL_(m.rpe_translation.size(), 990U);
+    ASSERT_NEAR_(m.rpe_timestamps_to[0] - m.rpe_timestamps_from[0], 1.0, 1e-4);
+
+    p.rpe_delta_unit = DeltaUnit::Meters;
+    p.rpe_delta      = 5.0;
+    m                = mola::compute_trajectory_metrics(trajs, p);
+    ASSERT_(!m.rpe_translation.empty());
+    ASSERT_LT_(m.rpe_translation.size(), 1000U);
+
+    // Results must not depend on the number of threads:
+    p.num_threads = 1;
+    const auto m1 = mola::compute_trajectory_metrics(trajs, p);
+    ASSERT_(m1.rpe_translation == m.rpe_translation);
+    ASSERT_(m1.ate_translation == m.ate_translation);
+
+    std::stringstream ss;
+    m.saveAsJSON(ss);
+    ASSERT_(ss.str().find("\"rmse\"") != std::string::npos);
+}
+
+void benchmark_large()
+{
+    const auto gt    = synthetic_gt(200000);
+    const auto est   = transformed_est(gt, T_true, 1.0, 0.02);
+    const auto trajs = mola::associate_trajectories(gt, est);
+
+    mola::TrajectoryMetricsParameters p;
+    p.rpe_delta_unit = mola::TrajectoryMetricsParameters::DeltaUnit::Meters;
+    p.rpe_delta      = 10.0;
+
+    mrpt::system::CTicTac tictac;
+    p.num_threads   = 1;
+    const auto   m1 = mola::compute_trajectory_metrics(trajs, p);
+    const double t1 = tictac.Tac();
+
+    tictac.Tic();
+    p.num_threads   = 0;
+    const auto   mN = mola::compute_trajectory_metrics(trajs, p);
+    const double tN = tictac.Tac();
+
+    std::cout << "[benchmark] " << trajs.size() << " poses: 1 thread=" << t1
+              << " s, all threads=" << tN << " s" << std::endl;
+
+    ASSERT_(m1.rpe_translation == mN.rpe_translation);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_se3_noiseless();
+        test_sim3();
+        test_noise();
+        test_association();
+        test_rpe_units();
+        benchmark_large();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
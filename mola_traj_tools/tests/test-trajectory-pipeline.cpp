@@ -0,0 +1,291 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-trajectory-pipeline.cpp
+ * @brief  Unit tests and benchmark for streaming trajectory operations
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_traj_tools/TrajectoryPipeline.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/system/CTicTac.h>
+#include <mrpt/system/filesystem.h>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+constexpr double T0 = 1700000000.0;  // [s]
+constexpr double DT = 0.1;  // [s]
+
+// A straight line along +X at 1 m/s, with a constant yaw rate:
+mola::TrajectorySample synthetic_sample(size_t i)
+{
+    return {
+        T0 + i * DT, mrpt::math::TPose3D(i * DT, 2.0, 0.5, 0.01 * i, 0, 0)};
+}
+
+std::string write_synthetic(size_t n, mola::TrajectoryFileFormat fmt)
+{
+    const auto file = mrpt::system::getTempFileName();
+
+    mola::TrajectoryWriter w(file, fmt);
+    for (size_t i = 0; i < n; i++) w.write(synthetic_sample(i));
+    return file;
+}
+
+std::vector<mola::TrajectorySample> run_pipeline(
+    const std::string& file, const std::vector<std::string>& ops,
+    mola::TrajectoryFileFormat fmt = mola::TrajectoryFileFormat::TUM)
+{
+    mola::TrajectoryPipeline pipeline;
+    for (const auto& op : ops) pipeline.add(op);
+
+    std::vector<mola::TrajectorySample> out;
+    mola::TrajectoryReader              in(file, fmt);
+    pipeline.run(
+        in, [&](const mola::TrajectorySample& s) { out.push_back(s); });
+    return out;
+}
+
+void check_pose_near(
+    const mrpt::poses::CPose3D& a, const mrpt::poses::CPose3D& b, double tol)
+{
+    const auto d = a - b;
+    ASSERT_LT_(d.translation().norm(), tol);
+    ASSERT_LT_(std::abs(d.yaw()), tol);
+    ASSERT_LT_(std::abs(d.pitch()), tol);
+    ASSERT_LT_(std::abs(d.roll()), tol);
+}
+
+void test_formats()
+{
+    for (const auto fmt :
+         {mola::TrajectoryFileFormat::TUM, mola::TrajectoryFileFormat::YPR,
+          mola::TrajectoryFileFormat::CSV})
+    {
+        const auto file = write_synthetic(100, fmt);
+        const auto out  = run_pipeline(file, {}, fmt);
+        ASSERT_EQUAL_(out.size(), 100U);
+        for (size_t i = 0; i < out.size(); i++)
+        {
+            const auto gt = synthetic_sample(i);
+            ASSERT_NEAR_(out[i].t, gt.t, 1e-6);
+            check_pose_near(
+                mrpt::poses::CPose3D(out[i].pose),
+                mrpt::poses::CPose3D(gt.pose), 1e-6);
+        }
+    }
+}
+
+void test_compose()
+{
+    const auto file = write_synthetic(100, mola::TrajectoryFileFormat::TUM);
+
+    const auto A = mrpt::poses::CPose3D::FromString("[1 2 3 10 20 30]");
+    const auto B = mrpt::poses::CPose3D::FromString("[-1 0 4 -45 0 5]");
+
+    const auto out = run_pipeline(
+        file, {"tf-left [1 2 3 10 20 30]", "tf-right [-1 0 4 -45 0 5]"});
+    ASSERT_EQUAL_(out.size(), 100U);
+    const auto p0 = mrpt::poses::CPose3D(synthetic_sample(0).pose);
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        const auto p = mrpt::poses::CPose3D(synthetic_sample(i).pose);
+        check_pose_near(
+            mrpt::poses::CPose3D(out[i].pose), A + (p - p0) + B, 1e-6);
+    }
+
+    const auto rebased = run_pipeline(file, {"rebase [0 0 0 0 0 0]"});
+    check_pose_near(
+        mrpt::poses::CPose3D(rebased.front().pose), mrpt::poses::CPose3D(),
+        1e-6);
+    // Relative poses are kept:
+    const auto p9 = mrpt::poses::CPose3D(synthetic_sample(99).pose);
+    check_pose_near(mrpt::poses::CPose3D(rebased.back().pose), p9 - p0, 1e-6);
+}
+
+void test_crop_decimate()
+{
+    const auto file = write_synthetic(100, mola::TrajectoryFileFormat::TUM);
+
+    const auto cropped = run_pipeline(
+        file, {mrpt::format("crop %f %f", T0 + 1.0 - 1e-3, T0 + 2.0 + 1e-3)});
+    ASSERT_EQUAL_(cropped.size(), 11U);
+
+    const auto cropped2 =
+        run_pipeline(file, {mrpt::format("crop - %f", T0 + 1.0 + 1e-3)});
+    ASSERT_EQUAL_(cropped2.size(), 11U);
+
+    const auto decimated = run_pipeline(file, {"decimate 10"});
+    ASSERT_EQUAL_(decimated.size(), 10U);
+    ASSERT_NEAR_(decimated[1].t, T0 + 1.0, 1e-6);
+}
+
+void test_resample_interpolate()
+{
+    const auto file = write_synthetic(100, mola::TrajectoryFileFormat::TUM);
+
+    // 4x the input rate, so 3 out of 4 samples are interpolated:
+    const auto out = run_pipeline(file, {"resample 0.025"});
+    // 396 or 397 depending on round-off of the last timestamp:
+    ASSERT_GE_(out.size(), 396U);
+    ASSERT_LE_(out.size(), 397U);
+    for (const auto& s : out)
+    {
+        // Exact for the synthetic trajectory:
+        const double u = (s.t - T0) / DT;
+        ASSERT_NEAR_(s.pose.x, u * DT, 1e-5);
+        ASSERT_NEAR_(s.pose.y, 2.0, 1e-6);
+        ASSERT_NEAR_(s.pose.yaw, 0.01 * u, 1e-5);
+    }
+
+    // Query timestamps, some out of the trajectory time range:
+    const auto queryFile = mrpt::system::getTempFileName();
+    {
+        std::ofstream f(queryFile);
+        f << "# timestamps\n";
+        f << mrpt::format("%.9f\n", T0 - 1.0);
+        f << mrpt::format("%.9f\n", T0 + 0.55);
+        f << mrpt::format("%.9f\n", T0 + 3.33);
+        f << mrpt::format("%.9f\n", T0 + 100.0);
+    }
+    const auto interp = run_pipeline(file, {"interpolate " + queryFile});
+    ASSERT_EQUAL_(interp.size(), 2U);
+    ASSERT_NEAR_(interp[0].pose.x, 0.55, 1e-5);
+    ASSERT_NEAR_(interp[1].pose.x, 3.33, 1e-5);
+}
+
+void test_align()
+{
+    // Reference trajectory, with more interesting motion for alignment:
+    const auto refFile = mrpt::system::getTempFileName();
+    const auto estFile = mrpt::system::getTempFileName();
+
+    const auto T = mrpt::poses::CPose3D::FromString("[5 -3 1 40 5 -10]");
+    {
+        mola::TrajectoryWriter wRef(refFile, mola::TrajectoryFileFormat::TUM);
+        mola::TrajectoryWriter wEst(estFile, mola::TrajectoryFileFormat::TUM);
+        for (size_t i = 0; i < 2000; i++)
+        {
+            const double a = i * 0.01;
+            const auto   p = mrpt::poses::CPose3D(
+                10 * std::cos(a), 10 * std::sin(a), 0.02 * i, a, 0, 0);
+            wRef.write({T0 + i * DT, p.asTPose()});
+            wEst.write({T0 + i * DT, ((-T) + p).asTPose()});
+        }
+    }
+
+    const auto out = run_pipeline(estFile, {"align " + refFile + " 100"});
+    ASSERT_EQUAL_(out.size(), 2000U);
+
+    mola::TrajectoryReader ref(refFile, mola::TrajectoryFileFormat::TUM);
+    mola::TrajectorySample s;
+    for (size_t i = 0; ref.next(s); i++)
+        check_pose_near(
+            mrpt::poses::CPose3D(out[i].pose), mrpt::poses::CPose3D(s.pose),
+            1e-4);
+}
+
+// Compare against the traditional approach of chaining the single-purpose
+// apps (traj_rebase, traj_tf_left, traj_tf_right), each one loading and
+// saving the whole trajectory with CPose3DInterpolator:
+void benchmark_vs_chained_apps()
+{
+    const size_t N    = 200000;
+    const auto   file = write_synthetic(N, mola::TrajectoryFileFormat::TUM);
+
+    const auto newStart = mrpt::poses::CPose3D::FromString("[1 2 3 0 0 0]");
+    const auto A = mrpt::poses::CPose3D::FromString("[1 2 3 10 20 30]");
+    const auto B = mrpt::poses::CPose3D::FromString("[-1 0 4 -45 0 5]");
+
+    mrpt::system::CTicTac tictac;
+
+    std::string lastFile = file;
+    for (int step = 0; step < 3; step++)
+    {
+        mrpt::poses::CPose3DInterpolator traj;
+        ASSERT_(traj.loadFromTextFile_TUM(lastFile));
+
+        // The same operations as each app:
+        const auto in0 = traj.begin()->second;
+        const auto tfRebase = newStart - mrpt::poses::CPose3D(in0);
+        for (auto& [t, pose] : traj)
+        {
+            switch (step)
+            {
+                case 0:
+                    pose = (tfRebase + mrpt::poses::CPose3D(pose)).asTPose();
+                    break;
+                case 1:
+                    pose = (A + mrpt::poses::CPose3D(pose - in0)).asTPose();
+                    break;
+                case 2:
+                    pose = (mrpt::poses::CPose3D(pose) + B).asTPose();
+                    break;
+            };
+        }
+        lastFile = mrpt::system::getTempFileName();
+        traj.saveToTextFile_TUM(lastFile);
+    }
+    const double tChained = tictac.Tac();
+
+    tictac.Tic();
+    const auto outFile = mrpt::system::getTempFileName();
+    {
+        mola::TrajectoryPipeline pipeline;
+        pipeline.add("rebase [1 2 3 0 0 0]");
+        pipeline.add("tf-left [1 2 3 10 20 30]");
+        pipeline.add("tf-right [-1 0 4 -45 0 5]");
+
+        mola::TrajectoryReader in(file, mola::TrajectoryFileFormat::TUM);
+        mola::TrajectoryWriter out(outFile, mola::TrajectoryFileFormat::TUM);
+        pipeline.run(
+            in, [&](const mola::TrajectorySample& s) { out.write(s); });
+    }
+    const double tPipeline = tictac.Tac();
+
+    std::cout << "[benchmark] " << N << " poses: chained apps=" << tChained
+              << " s, single-pass pipeline=" << tPipeline << " s"
+              << std::endl;
+
+    // Both must give the same trajectory:
+    mrpt::poses::CPose3DInterpolator a, b;
+    ASSERT_(a.loadFromTextFile_TUM(lastFile));
+    ASSERT_(b.loadFromTextFile_TUM(outFile));
+    ASSERT_EQUAL_(a.size(), b.size());
+    for (auto itA = a.begin(), itB = b.begin(); itA != a.end(); ++itA, ++itB)
+        check_pose_near(
+            mrpt::poses::CPose3D(itA->second),
+            mrpt::poses::CPose3D(itB->second), 1e-3);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_formats();
+        test_compose();
+        test_crop_decimate();
+        test_resample_interpolate();
+        test_align();
+        benchmark_vs_chained_apps();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,109 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   CoalescingTaskQueue.h
+ * @brief  Task queue where a new task replaces a pending one with same key
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mola
+{
+/** A multiple-producer task queue, drained by one consumer (e.g. the GUI
+ * thread), where tasks with a key are "latest wins": pushing a task with the
+ * key of a pending one replaces it, and moves it to the end of the queue, so
+ * it still runs after everything pushed before it.
+ *
+ * Keyed tasks are also bounded: once `capacity` of them are pending, the
+ * oldest one is dropped. Tasks without a key are never coalesced nor dropped,
+ * and are always run in order.
+ *
+ * Each task is invoked exactly once, with `true` when the consumer runs it, or
+ * `false` (from the producer thread) if it was superseded or dropped, so it
+ * can fulfill its promise and release any captured object right away.
+ */
+class CoalescingTaskQueue
+{
+   public:
+    using task_t = std::function<void(bool run)>;
+    using key_t  = std::string;
+
+    /// \param capacity Must be >=1, as in setCapacity()
+    explicit CoalescingTaskQueue(size_t capacity = 256);
+
+    struct Stats
+    {
+        uint64_t pushed      = 0;
+        uint64_t executed    = 0;  //!< Handed to the consumer
+        uint64_t coalesced   = 0;  //!< Replaced by a newer task, same key
+        uint64_t dropped     = 0;  //!< Discarded due to the capacity limit
+        size_t   pending     = 0;
+        size_t   max_pending = 0;  //!< High-water mark
+    };
+
+    /// Maximum number of pending keyed tasks
+    void   setCapacity(size_t capacity);
+    size_t capacity() const;
+
+    /// Enqueues a task that is never coalesced nor dropped
+    void push(task_t task);
+
+    /// Enqueues a task, replacing any pending task with the same key
+    void push(const key_t& key, task_t task);
+
+    /// Moves out all pending tasks, in order. Run them with `task(true)`.
+    std::vector<task_t> take_all();
+
+    /// Convenience: take_all() and run the tasks with the given executor
+    /// (by default, just invoke them). Returns the number of tasks run.
+    size_t run_pending(
+        const std::function<void(task_t&)>& executor =
+            [](task_t& t) { t(true); });
+
+    Stats  stats() const;
+    size_t size() const;
+
+   private:
+    struct Entry
+    {
+        key_t  key;  //!< Empty for non-coalescing tasks
+        task_t task;
+    };
+
+    mutable std::mutex                                    mtx_;
+    size_t                                                capacity_;
+    std::list<Entry>                                      queue_;
+    std::unordered_map<key_t, std::list<Entry>::iterator> byKey_;
+    Stats                                                 stats_;
+
+    void updatePendingStats();
+};
+
+}  // namespace mola
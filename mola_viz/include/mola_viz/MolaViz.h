@@ -28,8 +28,13 @@
 #include <mola_kernel/interfaces/Dataset_UI.h>
 #include <mola_kernel/interfaces/ExecutableBase.h>
 #include <mola_kernel/interfaces/VizInterface.h>
+#include <mola_viz/CoalescingTaskQueue.h>
+#include <mola_viz/PointCloudLOD.h>
+#include <mrpt/core/WorkerThreadsPool.h>
+#include <mrpt/core/lock_helper.h>
 #include <mrpt/gui/CDisplayWindowGUI.h>
 
+#include <atomic>
 #include <future>
 #include <memory>
 #include <shared_mutex>
@@ -122,6 +127,21 @@ class MolaViz : public ExecutableBase, public VizInterface
     static void register_gui_handler(
         class_name_t name, update_handler_t handler);
 
+    /** Second stage of a handler registered with
+     * register_gui_handler_with_preprocessing(), run in the GUI thread. */
+    using gui_stage_t = std::function<void(
+        nanogui::Window* subWin, window_name_t parentWin, MolaViz* instance)>;
+
+    /** First stage of a two-stage GUI handler: it is run in a worker thread,
+     * so CPU-heavy work (e.g. decimating point clouds) does not stall the GUI.
+     * It must not touch any GUI object; instead, it returns the second stage
+     * (or an empty function, if there is nothing to show). */
+    using preprocess_handler_t = std::function<gui_stage_t(
+        const mrpt::rtti::CObject::Ptr&, MolaViz* instance)>;
+
+    static void register_gui_handler_with_preprocessing(
+        class_name_t name, preprocess_handler_t handler);
+
     /** @} */
 
     /** @name mola-viz module parameters
@@ -131,13 +151,46 @@ class MolaViz : public ExecutableBase, public VizInterface
     unsigned int max_console_lines_        = 5;
     bool         show_rgbd_as_point_cloud_ = false;  // too CPU demanding!
 
+    /** Maximum pending updates of 3D objects, subwindows, etc. for the GUI
+     * thread. A new update for the same object replaces the pending one;
+     * beyond this limit, the oldest ones are dropped. */
+    unsigned int max_pending_gui_tasks_ = 256;
+
+    /** Point clouds shown in subwindows are decimated to at most this number
+     * of points (0: no limit), in a worker thread. */
+    unsigned int max_points_per_subwindow_ = 200000;
+
+    /// Decimation method: uniform voxel grid (true), or one every N (false)
+    bool decimate_with_voxel_grid_ = true;
+
+    /** Colored point clouds of at least this size within 3D objects (e.g. map
+     * layers) are split into chunks, each decimated according to its
+     * distance to the camera, so only changed chunks are re-uploaded to the
+     * GPU. 0 disables it. See ChunkedPointCloud. */
+    unsigned int map_lod_min_points_ = 100000;
+
+    float        map_lod_chunk_size_    = 20.0f;  //!< [m]
+    float        map_lod_near_distance_ = 30.0f;  //!< [m]
+    float        map_lod_voxel_size_    = 0.25f;  //!< [m]
+    unsigned int map_lod_max_level_     = 4;
+
+    /// Worker threads for the CPU-side preprocessing of GUI updates
+    unsigned int preprocessing_threads_ = 2;
+
     /** @} */
 
     void markWindowForReLayout(const window_name_t& name)
     {
+        auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
         guiThreadMustReLayoutTheseWindows_.insert(name);
     }
 
+    /// Counters of GUI updates run, coalesced, and dropped
+    CoalescingTaskQueue::Stats gui_task_queue_stats() const
+    {
+        return guiTasks_.stats();
+    }
+
    private:
     static MolaViz*          instance_;
     static std::shared_mutex instanceMtx_;
@@ -158,10 +211,39 @@ class MolaViz : public ExecutableBase, public VizInterface
     std::thread guiThread_;
     void        gui_thread();
 
-    using task_queue_t = std::vector<std::function<void()>>;
-    task_queue_t            guiThreadPendingTasks_;
+    CoalescingTaskQueue     guiTasks_;
     std::set<window_name_t> guiThreadMustReLayoutTheseWindows_;
-    std::mutex              guiThreadPendingTasksMtx_;
+    std::mutex              guiThreadMustReLayoutMtx_;
+
+    /** State of the updates of one object (subwindow, 3D object) that go
+     * through the preprocessing worker threads. */
+    struct PreprocessState
+    {
+        /// Held while preprocessing: serializes updates of the same object
+        std::mutex mtx;
+
+        /// Sequence number of the most recent update. Older ones are skipped.
+        std::atomic<uint64_t> latest{0};
+
+        /// Chunked point clouds of a 3D object, by child index
+        std::map<size_t, ChunkedPointCloud> chunkedClouds;
+    };
+    std::map<std::string, std::shared_ptr<PreprocessState>> preprocStates_;
+    std::mutex                                               preprocStatesMtx_;
+
+    /** Runs `preprocess` in a worker thread, then enqueues `guiTask` for the
+     * GUI thread with the given key. Updates of the same key are kept in
+     * order, and superseded ones are skipped. */
+    void enqueue_with_preprocessing(
+        const std::string&                    key,
+        std::function<void(PreprocessState&)> preprocess,
+        CoalescingTaskQueue::task_t           guiTask);
+
+    bool has_preprocess_state(const std::string& key);
+
+    /// Latest camera position of each window, for the LOD of 3D objects
+    std::map<window_name_t, mrpt::math::TPoint3Df> cameraPositions_;
+    std::mutex                                     cameraPositionsMtx_;
 
     double lastTimeCheckForNewModules_ = 0;
     double lastTimeUpdateDatasetUIs_   = 0;
@@ -180,6 +262,9 @@ class MolaViz : public ExecutableBase, public VizInterface
 
     void dataset_ui_check_new_modules();
     void dataset_ui_update();
+
+    /// Declared last, so it is destroyed before anything its tasks use.
+    std::unique_ptr<mrpt::WorkerThreadsPool> preprocWorkers_;
 };
 
 }  // namespace mola
@@ -0,0 +1,126 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   PointCloudLOD.h
+ * @brief  CPU-side decimation and level of detail (LOD) for point clouds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mrpt/math/TPoint3D.h>
+#include <mrpt/opengl/CPointCloudColoured.h>
+#include <mrpt/opengl/CSetOfObjects.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace mola
+{
+/** Method used to fit a point cloud into a maximum number of points */
+enum class PointCloudDecimation : uint8_t
+{
+    /** Keeps one out of every N points. The fastest method. */
+    Ratio = 0,
+
+    /** Keeps one point per voxel, with the voxel size estimated from the
+     *  cloud bounding box, so density becomes uniform. Falls back to Ratio
+     *  for the last few excess points. */
+    VoxelGrid
+};
+
+/** Decimates `pc` in place so it has at most `maxPoints` points (0: no
+ * limit), keeping the relative order of surviving points.
+ * \return The number of points after decimation.
+ */
+size_t decimate_point_cloud(
+    mrpt::opengl::CPointCloudColoured& pc, size_t maxPoints,
+    PointCloudDecimation method = PointCloudDecimation::VoxelGrid);
+
+/** Parameters of the distance-based level of detail of ChunkedPointCloud */
+struct PointCloudLODParams
+{
+    /// [m] Side length of the cubic chunks
+    float chunk_size = 20.0f;
+
+    /// [m] Chunks closer than this to the viewpoint keep all their points
+    float near_distance = 30.0f;
+
+    /** [m] Voxel size of the first LOD level, for chunks between 1x and 2x
+     *  `near_distance`. It doubles with each further level. */
+    float voxel_size = 0.25f;
+
+    /// Maximum LOD level (the voxel size stops growing beyond it)
+    uint8_t max_level = 4;
+};
+
+/** Splits a large point cloud (e.g. a map layer) into cubic chunks, each
+ * decimated according to its distance to a viewpoint.
+ *
+ * The chunk objects from the last update() are kept, and reused as they are
+ * when neither the points in a chunk nor its LOD level changed. Since their
+ * vertex buffers are already in the GPU, only new or changed chunks are
+ * uploaded again after the scene is updated.
+ *
+ * Note that LOD levels are only re-evaluated on update(), not as the camera
+ * moves. This class is not thread-safe.
+ */
+class ChunkedPointCloud
+{
+   public:
+    ChunkedPointCloud() = default;
+
+    PointCloudLODParams params;
+
+    struct Stats
+    {
+        size_t input_points  = 0;
+        size_t output_points = 0;
+        size_t chunks        = 0;
+        size_t reused_chunks = 0;  //!< Unchanged since the last update()
+    };
+
+    /** Returns a container with one point cloud object (with the same
+     *  rendering properties as `pc`) per non-empty chunk.
+     *  \param viewpoint The camera position, in the frame of the parent of
+     *  `pc` (i.e. the pose of `pc` is taken into account).
+     */
+    mrpt::opengl::CSetOfObjects::Ptr update(
+        const mrpt::opengl::CPointCloudColoured& pc,
+        const mrpt::math::TPoint3Df&             viewpoint);
+
+    /// Statistics of the last call to update()
+    const Stats& lastStats() const { return stats_; }
+
+    /// Forgets all cached chunks
+    void clear() { chunks_.clear(); }
+
+   private:
+    struct Chunk
+    {
+        uint64_t                               hash = 0;
+        mrpt::opengl::CPointCloudColoured::Ptr obj;
+    };
+    std::unordered_map<uint64_t, Chunk> chunks_;
+    Stats                               stats_;
+};
+
+}  // namespace mola
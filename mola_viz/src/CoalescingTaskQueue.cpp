@@ -0,0 +1,145 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   CoalescingTaskQueue.cpp
+ * @brief  Task queue where a new task replaces a pending one with same key
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_viz/CoalescingTaskQueue.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/lock_helper.h>
+
+#include <algorithm>
+
+using namespace mola;
+
+CoalescingTaskQueue::CoalescingTaskQueue(size_t capacity) : capacity_(capacity)
+{
+    ASSERT_GE_(capacity, 1U);
+}
+
+void CoalescingTaskQueue::setCapacity(size_t capacity)
+{
+    ASSERT_GE_(capacity, 1U);
+    auto lck  = mrpt::lockHelper(mtx_);
+    capacity_ = capacity;
+}
+
+size_t CoalescingTaskQueue::capacity() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return capacity_;
+}
+
+void CoalescingTaskQueue::push(task_t task)
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    stats_.pushed++;
+    queue_.push_back({{}, std::move(task)});
+    updatePendingStats();
+}
+
+void CoalescingTaskQueue::push(const key_t& key, task_t task)
+{
+    if (key.empty())
+    {
+        push(std::move(task));
+        return;
+    }
+
+    // Discarded tasks are notified after releasing the lock, since they may
+    // destroy large objects or wake up waiting threads:
+    task_t discarded;
+
+    auto lck = mrpt::lockHelper(mtx_);
+    stats_.pushed++;
+
+    if (auto it = byKey_.find(key); it != byKey_.end())
+    {
+        // Latest wins:
+        discarded        = std::move(it->second->task);
+        it->second->task = std::move(task);
+        queue_.splice(queue_.end(), queue_, it->second);
+        stats_.coalesced++;
+    }
+    else
+    {
+        if (byKey_.size() >= capacity_)
+        {
+            // Drop the oldest keyed task:
+            auto itOld = std::find_if(
+                queue_.begin(), queue_.end(),
+                [](const Entry& e) { return !e.key.empty(); });
+            discarded = std::move(itOld->task);
+            byKey_.erase(itOld->key);
+            queue_.erase(itOld);
+            stats_.dropped++;
+        }
+        queue_.push_back({key, std::move(task)});
+        byKey_[key] = std::prev(queue_.end());
+    }
+    updatePendingStats();
+    lck.unlock();
+
+    if (discarded) discarded(false);
+}
+
+std::vector<CoalescingTaskQueue::task_t> CoalescingTaskQueue::take_all()
+{
+    std::vector<task_t> tasks;
+
+    auto lck = mrpt::lockHelper(mtx_);
+    tasks.reserve(queue_.size());
+    for (auto& e : queue_) tasks.push_back(std::move(e.task));
+    queue_.clear();
+    byKey_.clear();
+    stats_.executed += tasks.size();
+    stats_.pending = 0;
+
+    return tasks;
+}
+
+size_t CoalescingTaskQueue::run_pending(
+    const std::function<void(task_t&)>& executor)
+{
+    auto tasks = take_all();
+    for (auto& t : tasks) executor(t);
+    return tasks.size();
+}
+
+CoalescingTaskQueue::Stats CoalescingTaskQueue::stats() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return stats_;
+}
+
+size_t CoalescingTaskQueue::size() const
+{
+    auto lck = mrpt::lockHelper(mtx_);
+    return queue_.size();
+}
+
+void CoalescingTaskQueue::updatePendingStats()
+{
+    stats_.pending     = queue_.size();
+    stats_.max_pending = std::max(stats_.max_pending, stats_.pending);
+}
@@ -50,7 +50,10 @@
 #include <mrpt/system/thread_name.h>
 #include <mrpt/version.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <type_traits>
 
 #include "mola_icon_64x64.h"
 
@@ -70,12 +73,40 @@ struct HandlersContainer
                guiHandlers_;
     std::mutex guiHandlersMtx_;
 
+    // Separate mutex, since guiHandlersMtx_ is held by the GUI thread while
+    // running tasks:
+    std::multimap<MolaViz::class_name_t, MolaViz::preprocess_handler_t>
+               guiPreprocessHandlers_;
+    std::mutex guiPreprocessHandlersMtx_;
+
    private:
     HandlersContainer() = default;
 };
 
 namespace
 {
+/** Wraps a GUI task so that its future is fulfilled (with a default value:
+ * false, nullptr...) without running it if the task queue discards it. */
+template <typename R, typename F>
+CoalescingTaskQueue::task_t make_gui_task(std::future<R>& outFuture, F&& f)
+{
+    auto task = std::make_shared<std::packaged_task<R(bool)>>(
+        [f = std::forward<F>(f)](bool run) -> R
+        {
+            if constexpr (std::is_void_v<R>)
+            {
+                if (run) f();
+            }
+            else
+            {
+                if (!run) return R();
+                return f();
+            }
+        });
+    outFuture = task->get_future();
+    return [task](bool run) { (*task)(run); };
+}
+
 void gui_handler_show_common_sensor_info(
     const mrpt::obs::CObservation& obs, nanogui::Window* w,
     const std::vector<std::string>& additionalMsgs = {})
@@ -243,90 +274,41 @@ void gui_handler_images(
 // CObservation3DRangeScan
 // CObservationRotatingScan
 // CObservationVelodyneScan
-void gui_handler_point_cloud(
-    const mrpt::rtti::CObject::Ptr& o, nanogui::Window* w,
-    MolaViz::window_name_t parentWin, MolaViz* instance)
+//
+// Run in a worker thread: builds the colored, decimated point cloud to show.
+MolaViz::gui_stage_t gui_preprocess_point_cloud(
+    const mrpt::rtti::CObject::Ptr& o, MolaViz* instance)
 {
     using namespace mrpt::obs;
 
-    mrpt::gui::MRPT2NanoguiGLCanvas*            glControl;
-    mrpt::opengl::CPointCloudColoured::Ptr      glPc;
-    mrpt::opengl::CSetOfObjects::Ptr            glCornerRef, glCornerSensor;
-    std::optional<mrpt::LockHelper<std::mutex>> lck;
-    bool                                        recolorizeAtEnd = true;
-
-    if (w->children().size() == 1)
-    {
-        // Create on first use:
-        glControl = w->add<mrpt::gui::MRPT2NanoguiGLCanvas>();
-
-        lck.emplace(&glControl->scene_mtx);
-
-        glControl->scene = mrpt::opengl::COpenGLScene::Create();
+    auto obs = std::dynamic_pointer_cast<CObservation>(o);
+    if (!obs) return {};
 
-        glPc = mrpt::opengl::CPointCloudColoured::Create();
-        glControl->scene->insert(glPc);
+    auto glPc = mrpt::opengl::CPointCloudColoured::Create();
+    glPc->setPointSize(3.0);
 
-        glCornerRef    = mrpt::opengl::stock_objects::CornerXYZ(1.0f);
-        glCornerSensor = mrpt::opengl::stock_objects::CornerXYZ(0.5f);
-        glControl->scene->insert(glCornerRef);
-        glControl->scene->insert(glCornerSensor);
-
-        glPc->setPointSize(3.0);
-        instance->markWindowForReLayout(parentWin);
-    }
-    else
-    {
-        // Reuse from past iterations:
-        glControl =
-            dynamic_cast<mrpt::gui::MRPT2NanoguiGLCanvas*>(w->children().at(1));
-        lck.emplace(&glControl->scene_mtx);
-
-        glPc =
-            glControl->scene->getByClass<mrpt::opengl::CPointCloudColoured>();
-
-        glCornerRef =
-            glControl->scene->getByClass<mrpt::opengl::CSetOfObjects>(0);
-        glCornerSensor =
-            glControl->scene->getByClass<mrpt::opengl::CSetOfObjects>(1);
-    }
-    ASSERT_(glControl != nullptr);
-    ASSERT_(glPc);
-    ASSERT_(glCornerRef);
-    ASSERT_(glCornerSensor);
-
-    glPc->setPose(mrpt::poses::CPose3D::Identity());
-
-    if (auto obs = std::dynamic_pointer_cast<CObservation>(o); obs)
-    {
-        mrpt::poses::CPose3D p;
-        obs->getSensorPose(p);
-        glCornerSensor->setPose(p);
-    }
+    std::vector<std::string> infoLines;
+    bool                     recolorizeAtEnd = true;
 
     if (auto objPc = std::dynamic_pointer_cast<CObservationPointCloud>(o);
         objPc)
     {
         objPc->load();
-        if (!objPc->pointcloud) return;
+        if (!objPc->pointcloud) return {};
         glPc->loadFromPointsMap(objPc->pointcloud.get());
         glPc->setPose(objPc->sensorPose);
 
-        gui_handler_show_common_sensor_info(
-            *objPc, w,
-            {
-                mrpt::format("Point count: %zu", objPc->pointcloud->size()),
-                mrpt::format(
-                    "Type: %s",
-                    objPc->pointcloud->GetRuntimeClass()->className),
-            });
+        infoLines = {
+            mrpt::format("Point count: %zu", objPc->pointcloud->size()),
+            mrpt::format(
+                "Type: %s", objPc->pointcloud->GetRuntimeClass()->className),
+        };
     }
     else if (auto objRS =
                  std::dynamic_pointer_cast<CObservationRotatingScan>(o);
              objRS)
     {
         objRS->load();
-        glPc->clear();
         mrpt::math::TBoundingBoxf bbox =
             mrpt::math::TBoundingBoxf::PlusMinusInfinity();
 
@@ -344,8 +326,6 @@ void gui_handler_point_cloud(
             }
         }
         glPc->recolorizeByCoordinate(bbox.min.z, bbox.max.z);
-
-        gui_handler_show_common_sensor_info(*objRS, w);
     }
     else if (auto obj3D = std::dynamic_pointer_cast<CObservation3DRangeScan>(o);
              instance->show_rgbd_as_point_cloud_ && obj3D)
@@ -378,7 +358,6 @@ void gui_handler_point_cloud(
             }
             else { obj3D->unprojectInto(*glPc, pp); }
         }
-        gui_handler_show_common_sensor_info(*obj3D, w);
     }
     else if (auto obj2D = std::dynamic_pointer_cast<CObservation2DRangeScan>(o);
              obj2D)
@@ -386,14 +365,12 @@ void gui_handler_point_cloud(
         mrpt::maps::CSimplePointsMap auxMap;
         auxMap.insertObservationPtr(obj2D);
         glPc->loadFromPointsMap(&auxMap);
-
-        gui_handler_show_common_sensor_info(*obj2D, w);
     }
     else if (auto objVel =
                  std::dynamic_pointer_cast<CObservationVelodyneScan>(o);
              objVel)
     {
-        if (objVel->point_cloud.size() == 0) return;
+        if (objVel->point_cloud.size() == 0) return {};
 
         mrpt::maps::CPointsMapXYZI pts;
         const auto&                pc = objVel->point_cloud;
@@ -406,14 +383,20 @@ void gui_handler_point_cloud(
         }
         glPc->loadFromPointsMap(&pts);
 
-        gui_handler_show_common_sensor_info(
-            *objVel, w,
-            {
-                mrpt::format("Point count: %zu", N),
-            });
+        infoLines = {mrpt::format("Point count: %zu", N)};
     }
     else
-        return;
+        return {};
+
+    // Fit into the point budget of the subwindow:
+    const size_t nTotal = glPc->size();
+    const size_t nShown = decimate_point_cloud(
+        *glPc, instance->max_points_per_subwindow_,
+        instance->decimate_with_voxel_grid_ ? PointCloudDecimation::VoxelGrid
+                                            : PointCloudDecimation::Ratio);
+    if (nShown != nTotal)
+        infoLines.push_back(
+            mrpt::format("Shown points: %zu of %zu", nShown, nTotal));
 
     // viz options:
     if (recolorizeAtEnd)
@@ -421,6 +404,60 @@ void gui_handler_point_cloud(
         const auto bb = glPc->getBoundingBox();
         glPc->recolorizeByCoordinate(bb.min.z, bb.max.z);
     }
+
+    mrpt::poses::CPose3D sensorPose;
+    obs->getSensorPose(sensorPose);
+
+    // Run in the GUI thread: replaces the cloud in the subwindow scene.
+    return [obs, glPc, sensorPose, infoLines](
+               nanogui::Window* w, MolaViz::window_name_t parentWin,
+               MolaViz* instance)
+    {
+        mrpt::gui::MRPT2NanoguiGLCanvas*            glControl;
+        std::optional<mrpt::LockHelper<std::mutex>> lck;
+
+        if (w->children().size() == 1)
+        {
+            // Create on first use:
+            glControl = w->add<mrpt::gui::MRPT2NanoguiGLCanvas>();
+            lck.emplace(&glControl->scene_mtx);
+            glControl->scene = mrpt::opengl::COpenGLScene::Create();
+            instance->markWindowForReLayout(parentWin);
+        }
+        else
+        {
+            // Reuse from past iterations:
+            glControl = dynamic_cast<mrpt::gui::MRPT2NanoguiGLCanvas*>(
+                w->children().at(1));
+            ASSERT_(glControl != nullptr);
+            lck.emplace(&glControl->scene_mtx);
+        }
+        ASSERT_(glControl->scene);
+        auto& scene = glControl->scene;
+
+        mrpt::opengl::CSetOfObjects::Ptr glCornerRef, glCornerSensor;
+
+        glCornerRef = scene->getByClass<mrpt::opengl::CSetOfObjects>(0);
+        if (!glCornerRef)
+        {
+            glCornerRef    = mrpt::opengl::stock_objects::CornerXYZ(1.0f);
+            glCornerSensor = mrpt::opengl::stock_objects::CornerXYZ(0.5f);
+            scene->insert(glCornerRef);
+            scene->insert(glCornerSensor);
+        }
+        glCornerSensor = scene->getByClass<mrpt::opengl::CSetOfObjects>(1);
+        ASSERT_(glCornerSensor);
+        glCornerSensor->setPose(sensorPose);
+
+        // Replace the former cloud object, instead of copying points into it:
+        if (auto oldPc =
+                scene->getByClass<mrpt::opengl::CPointCloudColoured>();
+            oldPc)
+            scene->removeObject(oldPc);
+        scene->insert(glPc);
+
+        gui_handler_show_common_sensor_info(*obs, w, infoLines);
+    };
 }
 
 // CObservationGPS
@@ -494,12 +531,14 @@ MRPT_INITIALIZER(do_register_MolaViz)
     // clang-format off
     MolaViz::register_gui_handler("mrpt::obs::CObservationImage", &gui_handler_images);
     MolaViz::register_gui_handler("mrpt::obs::CObservationGPS", &gui_handler_gps);
-    MolaViz::register_gui_handler("mrpt::obs::CObservationPointCloud",   &gui_handler_point_cloud);
-    MolaViz::register_gui_handler("mrpt::obs::CObservation3DRangeScan",  &gui_handler_point_cloud);
     MolaViz::register_gui_handler("mrpt::obs::CObservation3DRangeScan",  &gui_handler_images);
-    MolaViz::register_gui_handler("mrpt::obs::CObservation2DRangeScan",  &gui_handler_point_cloud);
-    MolaViz::register_gui_handler("mrpt::obs::CObservationRotatingScan", &gui_handler_point_cloud);
-    MolaViz::register_gui_handler("mrpt::obs::CObservationVelodyneScan", &gui_handler_point_cloud);
+
+    // Point clouds are decimated in a worker thread before reaching the GUI:
+    MolaViz::register_gui_handler_with_preprocessing("mrpt::obs::CObservationPointCloud",   &gui_preprocess_point_cloud);
+    MolaViz::register_gui_handler_with_preprocessing("mrpt::obs::CObservation3DRangeScan",  &gui_preprocess_point_cloud);
+    MolaViz::register_gui_handler_with_preprocessing("mrpt::obs::CObservation2DRangeScan",  &gui_preprocess_point_cloud);
+    MolaViz::register_gui_handler_with_preprocessing("mrpt::obs::CObservationRotatingScan", &gui_preprocess_point_cloud);
+    MolaViz::register_gui_handler_with_preprocessing("mrpt::obs::CObservationVelodyneScan", &gui_preprocess_point_cloud);
     // clang-format on
 }
 
@@ -514,6 +553,14 @@ void MolaViz::register_gui_handler(class_name_t name, update_handler_t handler)
     hc.guiHandlers_.emplace(name, handler);
 }
 
+void MolaViz::register_gui_handler_with_preprocessing(
+    class_name_t name, preprocess_handler_t handler)
+{
+    auto& hc  = HandlersContainer::Instance();
+    auto  lck = mrpt::lockHelper(hc.guiPreprocessHandlersMtx_);
+    hc.guiPreprocessHandlers_.emplace(name, handler);
+}
+
 MolaViz::MolaViz() {}
 
 MolaViz::~MolaViz()
@@ -522,6 +569,9 @@ MolaViz::~MolaViz()
     instance_ = nullptr;
     instanceMtx_.unlock();
 
+    // Wait for running preprocessing tasks, and discard pending ones:
+    preprocWorkers_.reset();
+
     nanogui::leave();
     if (guiThread_.joinable()) guiThread_.join();
 }
@@ -546,6 +596,21 @@ void MolaViz::initialize(const Yaml& c)
     YAML_LOAD_MEMBER_OPT(max_console_lines, unsigned int);
     YAML_LOAD_MEMBER_OPT(console_text_font_size, double);
     YAML_LOAD_MEMBER_OPT(show_rgbd_as_point_cloud, bool);
+    YAML_LOAD_MEMBER_OPT(max_pending_gui_tasks, unsigned int);
+    YAML_LOAD_MEMBER_OPT(max_points_per_subwindow, unsigned int);
+    YAML_LOAD_MEMBER_OPT(decimate_with_voxel_grid, bool);
+    YAML_LOAD_MEMBER_OPT(map_lod_min_points, unsigned int);
+    YAML_LOAD_MEMBER_OPT(map_lod_chunk_size, float);
+    YAML_LOAD_MEMBER_OPT(map_lod_near_distance, float);
+    YAML_LOAD_MEMBER_OPT(map_lod_voxel_size, float);
+    YAML_LOAD_MEMBER_OPT(map_lod_max_level, unsigned int);
+    YAML_LOAD_MEMBER_OPT(preprocessing_threads, unsigned int);
+
+    guiTasks_.setCapacity(max_pending_gui_tasks_);
+
+    preprocWorkers_ = std::make_unique<mrpt::WorkerThreadsPool>(
+        std::max(1U, preprocessing_threads_),
+        mrpt::WorkerThreadsPool::POLICY_FIFO, "MolaViz::preprocessing");
 
     // Mark as initialized and up:
     instanceMtx_.lock();
@@ -741,12 +806,11 @@ void MolaViz::gui_thread()
         {
             ProfilerEntry pe(profiler_, "loopCallback lambda");
 
-            // Get a copy of the tasks:
-            task_queue_t tasks;
-            auto         lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-            tasks            = std::move(guiThreadPendingTasks_);
-            guiThreadPendingTasks_ = task_queue_t();
-            auto winsToReLayout    = guiThreadMustReLayoutTheseWindows_;
+            // Get a copy of the tasks (already coalesced):
+            auto tasks = guiTasks_.take_all();
+
+            auto lck            = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
+            auto winsToReLayout = guiThreadMustReLayoutTheseWindows_;
             guiThreadMustReLayoutTheseWindows_.clear();
             lck.unlock();
 
@@ -757,7 +821,7 @@ void MolaViz::gui_thread()
             {
                 try
                 {
-                    t();
+                    t(true);
                 }
                 catch (const std::exception& e)
                 {
@@ -770,6 +834,21 @@ void MolaViz::gui_thread()
 
             for (const auto& winName : winsToReLayout)
                 windows_.at(winName).win->performLayout();
+
+            // Publish camera positions, for the LOD of 3D objects:
+            auto lckCam = mrpt::lockHelper(cameraPositionsMtx_);
+            for (const auto& [winName, winData] : windows_)
+            {
+                const auto&  cam = winData.win->camera();
+                const double az  = mrpt::DEG2RAD(cam.getAzimuthDegrees());
+                const double el  = mrpt::DEG2RAD(cam.getElevationDegrees());
+                const double d   = cam.getZoomDistance();
+
+                cameraPositions_[winName] = mrpt::math::TPoint3Df(
+                    cam.getCameraPointingX() + d * std::cos(el) * std::cos(az),
+                    cam.getCameraPointingY() + d * std::cos(el) * std::sin(az),
+                    cam.getCameraPointingZ() + d * std::sin(el));
+            }
         });
 
     // A call to "nanogui::leave()" is required to end the infinite loop
@@ -786,19 +865,83 @@ void MolaViz::gui_thread()
     MRPT_LOG_DEBUG("gui_thread() quitted.");
 }
 
+bool MolaViz::has_preprocess_state(const std::string& key)
+{
+    auto lck = mrpt::lockHelper(preprocStatesMtx_);
+    return preprocStates_.count(key) != 0;
+}
+
+void MolaViz::enqueue_with_preprocessing(
+    const std::string& key, std::function<void(PreprocessState&)> preprocess,
+    CoalescingTaskQueue::task_t guiTask)
+{
+    std::shared_ptr<PreprocessState> st;
+    {
+        auto  lck = mrpt::lockHelper(preprocStatesMtx_);
+        auto& ptr = preprocStates_[key];
+        if (!ptr) ptr = std::make_shared<PreprocessState>();
+        st = ptr;
+    }
+    const uint64_t seq = ++st->latest;
+
+    ASSERT_(preprocWorkers_);
+    preprocWorkers_->enqueue(
+        [this, key, st, seq, preprocess = std::move(preprocess),
+         guiTask = std::move(guiTask)]()
+        {
+            auto lck = mrpt::lockHelper(st->mtx);
+
+            // Skip updates superseded while waiting in the worker queue:
+            if (st->latest != seq)
+            {
+                guiTask(false);
+                return;
+            }
+            try
+            {
+                preprocess(*st);
+            }
+            catch (const std::exception& e)
+            {
+                MRPT_LOG_ERROR_STREAM(
+                    "Exception preprocessing GUI update '" << key << "':\n"
+                                                           << e.what());
+            }
+            // Enqueue while holding the lock, so that a newer update of the
+            // same object can never be enqueued before this one:
+            guiTasks_.push(key, guiTask);
+        });
+}
+
 std::future<bool> MolaViz::subwindow_update_visualization(
     const mrpt::rtti::CObject::Ptr& obj, const std::string& subWindowTitle,
     const std::string& parentWindow)
 {
     using return_type = bool;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        [this, obj, subWindowTitle, parentWindow]()
+    const char* objClassName = obj->GetRuntimeClass()->className;
+
+    // Preprocessing stages for this class, if any:
+    std::vector<preprocess_handler_t> preprocessors;
+    {
+        auto& hc  = HandlersContainer::Instance();
+        auto  lck = mrpt::lockHelper(hc.guiPreprocessHandlersMtx_);
+        for (auto [it, rangeEnd] =
+                 hc.guiPreprocessHandlers_.equal_range(objClassName);
+             it != rangeEnd; ++it)
+            preprocessors.push_back(it->second);
+    }
+    // Filled in by the worker thread, if preprocessing is needed:
+    auto guiStages = std::make_shared<std::vector<gui_stage_t>>();
+
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
+        [this, obj, objClassName, guiStages, subWindowTitle, parentWindow]()
         {
             try
             {
-                const char* objClassName = obj->GetRuntimeClass()->className;
-
                 MRPT_LOG_DEBUG_STREAM(
                     "subwindow_update_visualization() title='"
                     << subWindowTitle << "' obj of class: '" << objClassName
@@ -833,6 +976,11 @@ std::future<bool> MolaViz::subwindow_update_visualization(
                     it->second(obj, subWin, parentWindow, this);
                     any = true;
                 }
+                for (const auto& stage : *guiStages)
+                {
+                    stage(subWin, parentWindow, this);
+                    any = true;
+                }
                 if (any)
                 {  // done
                     return true;
@@ -858,9 +1006,28 @@ std::future<bool> MolaViz::subwindow_update_visualization(
             }
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
-    return task->get_future();
+    const std::string key = "subwindow:" + parentWindow + "/" + subWindowTitle;
+
+    // Once an object used the worker threads, its updates must keep doing
+    // so, to stay in order:
+    if (preprocessors.empty() && !has_preprocess_state(key))
+    {
+        // Latest wins:
+        guiTasks_.push(key, std::move(task));
+        return fut;
+    }
+
+    enqueue_with_preprocessing(
+        key,
+        [this, obj, preprocessors, guiStages](PreprocessState&)
+        {
+            for (const auto& p : preprocessors)
+                if (auto stage = p(obj, this); stage)
+                    guiStages->push_back(std::move(stage));
+        },
+        std::move(task));
+
+    return fut;
 }
 
 std::future<nanogui::Window*> MolaViz::create_subwindow(
@@ -868,7 +1035,10 @@ std::future<nanogui::Window*> MolaViz::create_subwindow(
 {
     using return_type = nanogui::Window*;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
         [this, subWindowTitle, parentWindow]()
         {
             MRPT_LOG_DEBUG_STREAM(
@@ -928,10 +1098,11 @@ std::future<nanogui::Window*> MolaViz::create_subwindow(
             return subw;
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
+    guiTasks_.push(std::move(task));
+
+    auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
     guiThreadMustReLayoutTheseWindows_.insert(parentWindow);
-    return task->get_future();
+    return fut;
 }
 
 std::future<bool> MolaViz::update_3d_object(
@@ -941,12 +1112,21 @@ std::future<bool> MolaViz::update_3d_object(
 {
     using return_type = bool;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
-        [this, objName, obj, viewportName, parentWindow]()
+    // The object to show: either `obj`, or a copy with its large point clouds
+    // replaced by chunked ones, filled in by the worker thread:
+    auto objToShow = std::make_shared<mrpt::opengl::CSetOfObjects::Ptr>(obj);
+
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
+        [this, objName, objToShow, viewportName, parentWindow]()
         {
             MRPT_LOG_DEBUG_STREAM(
                 "update_3d_object() objName='" << objName << "'");
 
+            const auto& obj = *objToShow;
+
             ASSERT_(windows_.count(parentWindow));
             auto topWin = windows_.at(parentWindow).win;
             ASSERT_(topWin);
@@ -981,10 +1161,89 @@ std::future<bool> MolaViz::update_3d_object(
             return true;
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
+    const std::string key =
+        "3d_object:" + parentWindow + "/" + viewportName + "/" + objName;
+
+    const auto isLargeCloud =
+        [this](const mrpt::opengl::CRenderizable::Ptr& o)
+    {
+        auto pc =
+            std::dynamic_pointer_cast<mrpt::opengl::CPointCloudColoured>(o);
+        return map_lod_min_points_ != 0 && pc &&
+               pc->size() >= map_lod_min_points_;
+    };
+
+    if (std::none_of(obj->begin(), obj->end(), isLargeCloud) &&
+        !has_preprocess_state(key))
+    {
+        // Latest wins:
+        guiTasks_.push(key, std::move(task));
+    }
+    else
+    {
+        enqueue_with_preprocessing(
+            key,
+            [this, obj, objToShow, isLargeCloud,
+             parentWindow](PreprocessState& st)
+            {
+                mrpt::math::TPoint3Df eye;
+                {
+                    auto lck = mrpt::lockHelper(cameraPositionsMtx_);
+                    if (auto it = cameraPositions_.find(parentWindow);
+                        it != cameraPositions_.end())
+                        eye = it->second;
+                }
+                // Camera position, in the frame of the object children:
+                const auto viewpoint = mrpt::math::TPoint3Df(
+                    obj->getCPose().inverseComposePoint(
+                        mrpt::math::TPoint3D(eye)));
+
+                // Shallow copy of the container (pose, etc.), children are
+                // re-inserted one by one:
+                auto out = mrpt::opengl::CSetOfObjects::Create();
+                *out     = *obj;
+                out->clear();
+
+                std::set<size_t> usedChunkedClouds;
+                size_t           idx = 0;
+                for (const auto& o : *obj)
+                {
+                    const size_t i = idx++;
+                    if (!isLargeCloud(o))
+                    {
+                        out->insert(o);
+                        continue;
+                    }
+                    auto& chunked = st.chunkedClouds[i];
+                    chunked.params.chunk_size    = map_lod_chunk_size_;
+                    chunked.params.near_distance = map_lod_near_distance_;
+                    chunked.params.voxel_size    = map_lod_voxel_size_;
+                    chunked.params.max_level     = map_lod_max_level_;
+
+                    out->insert(chunked.update(
+                        *std::dynamic_pointer_cast<
+                            mrpt::opengl::CPointCloudColoured>(o),
+                        viewpoint));
+                    usedChunkedClouds.insert(i);
+                }
+                // Release chunks of clouds that are gone:
+                for (auto it = st.chunkedClouds.begin();
+                     it != st.chunkedClouds.end();)
+                {
+                    if (usedChunkedClouds.count(it->first))
+                        ++it;
+                    else
+                        it = st.chunkedClouds.erase(it);
+                }
+
+                *objToShow = out;
+            },
+            std::move(task));
+    }
+
+    auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
     guiThreadMustReLayoutTheseWindows_.insert(parentWindow);
-    return task->get_future();
+    return fut;
 }
 
 std::future<bool> MolaViz::update_viewport_look_at(
@@ -993,7 +1252,10 @@ std::future<bool> MolaViz::update_viewport_look_at(
 {
     using return_type = bool;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
         [this, lookAt, viewportName, parentWindow]()
         {
             MRPT_LOG_DEBUG_STREAM(
@@ -1011,10 +1273,14 @@ std::future<bool> MolaViz::update_viewport_look_at(
             return true;
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
+    // Latest wins:
+    guiTasks_.push(
+        "look_at:" + parentWindow + "/" + viewportName,
+        std::move(task));
+
+    auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
     guiThreadMustReLayoutTheseWindows_.insert(parentWindow);
-    return task->get_future();
+    return fut;
 }
 
 std::future<bool> MolaViz::update_viewport_camera_azimuth(
@@ -1023,7 +1289,10 @@ std::future<bool> MolaViz::update_viewport_camera_azimuth(
 {
     using return_type = bool;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
         [this, azimuth, absolute_falseForRelative, viewportName, parentWindow]()
         {
             MRPT_LOG_DEBUG_STREAM(
@@ -1048,10 +1317,16 @@ std::future<bool> MolaViz::update_viewport_camera_azimuth(
             return true;
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
+    // Relative rotations must not be coalesced:
+    if (absolute_falseForRelative)
+        guiTasks_.push(
+            "azimuth:" + parentWindow + "/" + viewportName, std::move(task));
+    else
+        guiTasks_.push(std::move(task));
+
+    auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
     guiThreadMustReLayoutTheseWindows_.insert(parentWindow);
-    return task->get_future();
+    return fut;
 }
 
 std::future<bool> MolaViz::output_console_message(
@@ -1059,7 +1334,10 @@ std::future<bool> MolaViz::output_console_message(
 {
     using return_type = bool;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
         [this, msg, parentWindow]()
         {
             MRPT_LOG_DEBUG_STREAM("output_console_message() msg=" << msg);
@@ -1105,10 +1383,11 @@ std::future<bool> MolaViz::output_console_message(
             return true;
         });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
+    guiTasks_.push(std::move(task));
+
+    auto lck = mrpt::lockHelper(guiThreadMustReLayoutMtx_);
     guiThreadMustReLayoutTheseWindows_.insert(parentWindow);
-    return task->get_future();
+    return fut;
 }
 
 std::future<void> MolaViz::enqueue_custom_nanogui_code(
@@ -1116,12 +1395,14 @@ std::future<void> MolaViz::enqueue_custom_nanogui_code(
 {
     using return_type = void;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::future<return_type> fut;
+
+    auto task = make_gui_task(
+        fut,
         [=]() { userCode(); });
 
-    auto lck = mrpt::lockHelper(guiThreadPendingTasksMtx_);
-    guiThreadPendingTasks_.emplace_back([=]() { (*task)(); });
-    return task->get_future();
+    guiTasks_.push(std::move(task));
+    return fut;
 }
 
 #if 0
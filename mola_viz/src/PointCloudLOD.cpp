@@ -0,0 +1,351 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   PointCloudLOD.cpp
+ * @brief  CPU-side decimation and level of detail (LOD) for point clouds
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_viz/PointCloudLOD.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/poses/CPose3D.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace mola;
+
+namespace
+{
+using mrpt::opengl::CPointCloudColoured;
+
+mrpt::math::TPoint3Df point_xyz(const CPointCloudColoured& pc, size_t i)
+{
+    const auto& p = pc.getPoint(i);
+    return {p.x, p.y, p.z};
+}
+
+// Packs three signed integer cell indices into one 64bit key.
+// Indices wrap around beyond +-2^20 cells, which is harmless: at worst, two
+// far away cells share a voxel (or chunk).
+uint64_t cell_key(int32_t ix, int32_t iy, int32_t iz)
+{
+    constexpr uint64_t MASK = (uint64_t(1) << 21) - 1;
+    return (static_cast<uint64_t>(ix) & MASK) |
+           ((static_cast<uint64_t>(iy) & MASK) << 21) |
+           ((static_cast<uint64_t>(iz) & MASK) << 42);
+}
+
+uint64_t cell_key(const mrpt::math::TPoint3Df& p, float cellSize)
+{
+    return cell_key(
+        static_cast<int32_t>(std::floor(p.x / cellSize)),
+        static_cast<int32_t>(std::floor(p.y / cellSize)),
+        static_cast<int32_t>(std::floor(p.z / cellSize)));
+}
+
+// Hash of a sequence of trivially-copyable values, mixing 64bit words
+// (FNV-like, but word-wise, since it runs over every point of large maps):
+struct Hasher
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    template <typename T>
+    void add(const T& v)
+    {
+        constexpr size_t NW = (sizeof(T) + 7) / 8;
+        uint64_t         w[NW] = {};
+        std::memcpy(w, &v, sizeof(T));
+        for (size_t i = 0; i < NW; i++)
+        {
+            h = (h ^ w[i]) * 0x9E3779B97F4A7C15ULL;
+            h ^= h >> 32;
+        }
+    }
+};
+
+// A minimal open-addressing (linear probing) set of cell keys. It is several
+// times faster than std::unordered_set for the large, short-lived sets of the
+// voxel filter. Keys from cell_key() never have the MSB set, hence EMPTY.
+class CellKeySet
+{
+   public:
+    explicit CellKeySet(size_t expectedSize)
+    {
+        size_t capacity = 64;
+        while (capacity < 2 * expectedSize) capacity <<= 1;
+        slots_.assign(capacity, EMPTY);
+    }
+
+    /// Returns true if the key was not in the set
+    bool insert(uint64_t key)
+    {
+        if (2 * (count_ + 1) > slots_.size()) grow();
+        if (!insertNoGrow(slots_, key)) return false;
+        count_++;
+        return true;
+    }
+
+   private:
+    static constexpr uint64_t EMPTY = ~uint64_t(0);
+
+    std::vector<uint64_t> slots_;
+    size_t                count_ = 0;
+
+    static bool insertNoGrow(std::vector<uint64_t>& slots, uint64_t key)
+    {
+        const size_t mask = slots.size() - 1;
+        for (size_t i = (key * 0x9E3779B97F4A7C15ULL) >> 20 & mask;;
+             i        = (i + 1) & mask)
+        {
+            if (slots[i] == key) return false;
+            if (slots[i] == EMPTY)
+            {
+                slots[i] = key;
+                return true;
+            }
+        }
+    }
+
+    void grow()
+    {
+        std::vector<uint64_t> newSlots(2 * slots_.size(), EMPTY);
+        for (const uint64_t k : slots_)
+            if (k != EMPTY) insertNoGrow(newSlots, k);
+        slots_.swap(newSlots);
+    }
+};
+
+// Indices (out of `idxs`) of the first point found within each voxel:
+std::vector<size_t> voxel_filter(
+    const CPointCloudColoured& pc, const std::vector<size_t>& idxs,
+    float voxelSize)
+{
+    std::vector<size_t> out;
+    // Most voxels hold several points, so start with a smaller set:
+    CellKeySet occupied(idxs.size() / 4);
+
+    for (const size_t i : idxs)
+        if (occupied.insert(cell_key(point_xyz(pc, i), voxelSize)))
+            out.push_back(i);
+
+    return out;
+}
+
+// Keeps `maxPoints` evenly-spaced entries of `idxs`:
+void ratio_filter(std::vector<size_t>& idxs, size_t maxPoints)
+{
+    const size_t N = idxs.size();
+    if (N <= maxPoints) return;
+    for (size_t k = 0; k < maxPoints; k++) idxs[k] = idxs[(k * N) / maxPoints];
+    idxs.resize(maxPoints);
+}
+
+void copy_render_properties(
+    const CPointCloudColoured& src, CPointCloudColoured& dst)
+{
+    dst.setName(src.getName());
+    dst.setPose(src.getCPose());
+    dst.setColor_u8(src.getColor_u8());
+    dst.setPointSize(src.getPointSize());
+    dst.setVisibility(src.isVisible());
+}
+
+// Builds a new cloud with the given subset of points from `src`:
+CPointCloudColoured::Ptr extract_points(
+    const CPointCloudColoured& src, const std::vector<size_t>& idxs)
+{
+    auto out = CPointCloudColoured::Create();
+    copy_render_properties(src, *out);
+    out->resize(idxs.size());
+    for (size_t k = 0; k < idxs.size(); k++)
+        out->setPoint(k, src.getPoint(idxs[k]));
+    return out;
+}
+
+}  // namespace
+
+size_t mola::decimate_point_cloud(
+    CPointCloudColoured& pc, size_t maxPoints, PointCloudDecimation method)
+{
+    const size_t N = pc.size();
+    if (maxPoints == 0 || N <= maxPoints) return N;
+
+    std::vector<size_t> idxs(N);
+    for (size_t i = 0; i < N; i++) idxs[i] = i;
+
+    if (method == PointCloudDecimation::VoxelGrid)
+    {
+        auto bbMin = point_xyz(pc, 0), bbMax = bbMin;
+        for (size_t i = 1; i < N; i++)
+        {
+            const auto p = point_xyz(pc, i);
+            bbMin.x      = std::min(bbMin.x, p.x);
+            bbMin.y      = std::min(bbMin.y, p.y);
+            bbMin.z      = std::min(bbMin.z, p.z);
+            bbMax.x      = std::max(bbMax.x, p.x);
+            bbMax.y      = std::max(bbMax.y, p.y);
+            bbMax.z      = std::max(bbMax.z, p.z);
+        }
+        const float dx = bbMax.x - bbMin.x, dy = bbMax.y - bbMin.y,
+                    dz = bbMax.z - bbMin.z;
+
+        // Initial guess: the voxel size that splits the bounding box into
+        // `maxPoints` cells. Flat dimensions (e.g. a 2D scan) count as one
+        // voxel thick, hence the fixed-point iterations:
+        float voxel = std::cbrt(
+            std::max(dx, 1e-3f) * std::max(dy, 1e-3f) * std::max(dz, 1e-3f) /
+            maxPoints);
+        for (int iter = 0; iter < 5; iter++)
+            voxel = std::cbrt(
+                std::max(dx, voxel) * std::max(dy, voxel) *
+                std::max(dz, voxel) / maxPoints);
+
+        // Occupied voxels are usually far fewer than the bounding box ones,
+        // so this estimate rarely needs to grow:
+        std::vector<size_t> filtered;
+        for (int iter = 0; iter < 8; iter++)
+        {
+            filtered = voxel_filter(pc, idxs, voxel);
+            if (filtered.size() <= maxPoints) break;
+            voxel *= 1.25f;
+        }
+        idxs = std::move(filtered);
+    }
+    ratio_filter(idxs, maxPoints);
+
+    // Compact in place. Since idxs[k] >= k, no point is overwritten before
+    // being read:
+    const size_t M = idxs.size();
+    for (size_t k = 0; k < M; k++)
+        if (idxs[k] != k) pc.setPoint(k, pc.getPoint(idxs[k]));
+    pc.resize(M);
+
+    return M;
+}
+
+mrpt::opengl::CSetOfObjects::Ptr ChunkedPointCloud::update(
+    const CPointCloudColoured& pc, const mrpt::math::TPoint3Df& viewpoint)
+{
+    ASSERT_GT_(params.chunk_size, 0.0f);
+    ASSERT_GT_(params.near_distance, 0.0f);
+    ASSERT_GT_(params.voxel_size, 0.0f);
+
+    const float chunkSize = params.chunk_size;
+    const auto  pose      = pc.getCPose();
+
+    stats_              = {};
+    stats_.input_points = pc.size();
+
+    // Group point indices by chunk:
+    std::unordered_map<uint64_t, std::vector<size_t>>   chunkIdxs;
+    std::unordered_map<uint64_t, mrpt::math::TPoint3Df> chunkCenters;
+    {
+        uint64_t             lastKey  = 0;
+        std::vector<size_t>* lastIdxs = nullptr;
+
+        for (size_t i = 0; i < pc.size(); i++)
+        {
+            const auto     p   = point_xyz(pc, i);
+            const uint64_t key = cell_key(p, chunkSize);
+            // Consecutive points very often fall within the same chunk:
+            if (!lastIdxs || key != lastKey)
+            {
+                auto [it, isNew] = chunkIdxs.try_emplace(key);
+                if (isNew)
+                {
+                    chunkCenters[key] = {
+                        (std::floor(p.x / chunkSize) + 0.5f) * chunkSize,
+                        (std::floor(p.y / chunkSize) + 0.5f) * chunkSize,
+                        (std::floor(p.z / chunkSize) + 0.5f) * chunkSize};
+                }
+                lastKey  = key;
+                lastIdxs = &it->second;
+            }
+            lastIdxs->push_back(i);
+        }
+    }
+
+    // Rendering properties are part of the hash of all chunks:
+    Hasher propsHash;
+    propsHash.add(pose.asTPose());
+    propsHash.add(pc.getColor_u8());
+    propsHash.add(pc.getPointSize());
+    propsHash.add(pc.isVisible());
+
+    auto glChunks = mrpt::opengl::CSetOfObjects::Create();
+    glChunks->setName(pc.getName());
+
+    decltype(chunks_) newChunks;
+    newChunks.reserve(chunkIdxs.size());
+
+    for (auto& [key, idxs] : chunkIdxs)
+    {
+        // LOD level from the distance between the chunk and the viewpoint:
+        const auto c =
+            pose.composePoint(mrpt::math::TPoint3D(chunkCenters[key]));
+        const double d = (c - mrpt::math::TPoint3D(viewpoint)).norm();
+
+        uint8_t level = 0;
+        if (d >= params.near_distance)
+        {
+            level = static_cast<uint8_t>(std::min<double>(
+                params.max_level,
+                1 + std::floor(std::log2(d / params.near_distance))));
+        }
+
+        Hasher h = propsHash;
+        h.add(level);
+        h.add(idxs.size());
+        for (const size_t i : idxs) h.add(pc.getPoint(i));
+
+        Chunk chunk;
+        chunk.hash = h.h;
+
+        if (auto it = chunks_.find(key);
+            it != chunks_.end() && it->second.hash == chunk.hash)
+        {
+            chunk.obj = it->second.obj;
+            stats_.reused_chunks++;
+        }
+        else
+        {
+            if (level > 0)
+            {
+                const float voxel = std::ldexp(params.voxel_size, level - 1);
+                idxs = voxel_filter(pc, idxs, voxel);
+            }
+            chunk.obj = extract_points(pc, idxs);
+        }
+
+        stats_.chunks++;
+        stats_.output_points += chunk.obj->size();
+        glChunks->insert(chunk.obj);
+        newChunks.emplace(key, std::move(chunk));
+    }
+
+    // Chunks not seen this time are forgotten:
+    chunks_.swap(newChunks);
+
+    return glChunks;
+}
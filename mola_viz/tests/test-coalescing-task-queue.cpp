@@ -0,0 +1,260 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-coalescing-task-queue.cpp
+ * @brief  Unit and stress tests for the MolaViz GUI task queue (no display)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_viz/CoalescingTaskQueue.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+
+namespace
+{
+void test_coalescing_order()
+{
+    mola::CoalescingTaskQueue q(10);
+
+    std::vector<std::string> ran, discarded;
+
+    const auto lambdaTask = [&](const std::string& name)
+    {
+        return [&, name](bool run)
+        { (run ? ran : discarded).push_back(name); };
+    };
+
+    q.push("A", lambdaTask("A1"));
+    q.push("B", lambdaTask("B1"));
+    q.push(lambdaTask("u1"));
+    q.push("A", lambdaTask("A2"));  // replaces A1, runs after u1
+    q.push(lambdaTask("u2"));
+
+    ASSERT_EQUAL_(q.size(), 4U);
+    ASSERT_EQUAL_(discarded.size(), 1U);
+    ASSERT_EQUAL_(discarded[0], "A1");
+
+    ASSERT_EQUAL_(q.run_pending(), 4U);
+    const std::vector<std::string> expected = {"B1", "u1", "A2", "u2"};
+    ASSERT_(ran == expected);
+
+    const auto st = q.stats();
+    ASSERT_EQUAL_(st.pushed, 5U);
+    ASSERT_EQUAL_(st.executed, 4U);
+    ASSERT_EQUAL_(st.coalesced, 1U);
+    ASSERT_EQUAL_(st.dropped, 0U);
+    ASSERT_EQUAL_(st.pending, 0U);
+}
+
+void test_capacity()
+{
+    mola::CoalescingTaskQueue q(2);
+
+    std::vector<std::string> ran, discarded;
+
+    const auto lambdaTask = [&](const std::string& name)
+    {
+        return [&, name](bool run)
+        { (run ? ran : discarded).push_back(name); };
+    };
+
+    q.push("A", lambdaTask("A"));
+    q.push(lambdaTask("u"));  // never dropped, not counted in capacity
+    q.push("B", lambdaTask("B"));
+    q.push("C", lambdaTask("C"));  // drops A, the oldest keyed one
+
+    ASSERT_EQUAL_(discarded.size(), 1U);
+    ASSERT_EQUAL_(discarded[0], "A");
+
+    q.run_pending();
+    const std::vector<std::string> expected = {"u", "B", "C"};
+    ASSERT_(ran == expected);
+    ASSERT_EQUAL_(q.stats().dropped, 1U);
+
+    // A zero capacity is rejected, both on construction and later on:
+    bool thrown = false;
+    try
+    {
+        mola::CoalescingTaskQueue q0(0);
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+
+    thrown = false;
+    try
+    {
+        q.setCapacity(0);
+    }
+    catch (const std::exception&)
+    {
+        thrown = true;
+    }
+    ASSERT_(thrown);
+    ASSERT_EQUAL_(q.capacity(), 2U);
+}
+
+// Producers (e.g. sensors at high rate) much faster than the consumer (GUI
+// thread), emulated with an injected executor that takes time per task:
+void test_stress()
+{
+    constexpr size_t NUM_PRODUCERS = 4;
+    constexpr size_t NUM_KEYS      = 5;
+    constexpr size_t NUM_PUSHES    = 20000;  // per producer
+    constexpr size_t CAPACITY      = 16;
+
+    mola::CoalescingTaskQueue q(CAPACITY);
+
+    // Emulates large captured objects (e.g. point clouds):
+    std::atomic<int> alivePayloads{0}, maxAlivePayloads{0};
+    struct Payload
+    {
+        explicit Payload(std::atomic<int>& c, std::atomic<int>& m) : cnt(c)
+        {
+            const int n = ++cnt;
+            for (int prev = m; n > prev && !m.compare_exchange_weak(prev, n);)
+            {
+            }
+        }
+        ~Payload() { --cnt; }
+        std::atomic<int>& cnt;
+    };
+
+    std::atomic<uint64_t> nRun{0}, nDiscarded{0};
+    std::atomic<bool>     orderError{false};
+
+    // Only accessed from the consumer thread:
+    std::map<std::string, size_t> lastSeqPerKey;
+
+    std::vector<std::thread> producers;
+    for (size_t p = 0; p < NUM_PRODUCERS; p++)
+    {
+        producers.emplace_back(
+            [&, p]()
+            {
+                for (size_t i = 0; i < NUM_PUSHES; i++)
+                {
+                    const size_t      k   = (p * 7 + i) % NUM_KEYS;
+                    const std::string key = "win/obj" + std::to_string(k) +
+                                            "/p" + std::to_string(p);
+                    auto payload = std::make_shared<Payload>(
+                        alivePayloads, maxAlivePayloads);
+
+                    auto task = [&, key, i, payload](bool run)
+                    {
+                        if (!run)
+                        {
+                            nDiscarded++;
+                            return;
+                        }
+                        nRun++;
+                        // Per-key order must be kept:
+                        auto it = lastSeqPerKey.find(key);
+                        if (it != lastSeqPerKey.end() && it->second >= i)
+                            orderError = true;
+                        lastSeqPerKey[key] = i;
+                    };
+
+                    // A few non-coalescing tasks (e.g. console messages):
+                    if (i % 1000 == 0) q.push(std::move(task));
+                    else
+                        q.push(key, std::move(task));
+                }
+            });
+    }
+
+    std::atomic<bool> producersDone{false};
+    std::thread       consumer(
+        [&]()
+        {
+            const auto lambdaSlowExecutor =
+                [](mola::CoalescingTaskQueue::task_t& t)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+                t(true);
+            };
+            for (;;)
+            {
+                const bool done = producersDone;
+                q.run_pending(lambdaSlowExecutor);
+                if (done) break;
+                // GUI refresh period:
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        });
+
+    mrpt::system::CTicTac tictac;
+    for (auto& t : producers) t.join();
+    const double tProducers = tictac.Tac();
+    producersDone           = true;
+    consumer.join();
+
+    const auto st = q.stats();
+    std::cout << "[stress] pushed=" << st.pushed << " executed=" << st.executed
+              << " coalesced=" << st.coalesced << " dropped=" << st.dropped
+              << " max_pending=" << st.max_pending
+              << " max_alive_payloads=" << maxAlivePayloads
+              << " producers_time=" << tProducers << " s" << std::endl;
+
+    ASSERT_(!orderError);
+    ASSERT_EQUAL_(st.pushed, NUM_PRODUCERS * NUM_PUSHES);
+    ASSERT_EQUAL_(st.pushed, st.executed + st.coalesced + st.dropped);
+    ASSERT_EQUAL_(nRun.load(), st.executed);
+    ASSERT_EQUAL_(nDiscarded.load(), st.coalesced + st.dropped);
+    ASSERT_EQUAL_(st.pending, 0U);
+    ASSERT_EQUAL_(alivePayloads.load(), 0);
+
+    // Memory is bounded: keyed tasks by the capacity, plus the unkeyed ones
+    // and those in the hands of producers/consumer at any time:
+    const size_t maxUnkeyed = NUM_PRODUCERS * NUM_PUSHES / 1000;
+    ASSERT_LE_(st.max_pending, CAPACITY + maxUnkeyed);
+    ASSERT_LE_(
+        static_cast<size_t>(maxAlivePayloads.load()),
+        2 * (CAPACITY + maxUnkeyed) + 2 * NUM_PRODUCERS);
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_coalescing_order();
+        test_capacity();
+        test_stress();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
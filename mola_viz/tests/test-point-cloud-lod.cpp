@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ *
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * Licensed under the GNU GPL v3 for non-commercial applications.
+ *
+ * This file is part of MOLA.
+ * MOLA is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later
+ * version.
+ *
+ * MOLA is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * MOLA. If not, see <https://www.gnu.org/licenses/>.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-point-cloud-lod.cpp
+ * @brief  Unit tests and headless benchmark of point cloud decimation and LOD
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_viz/PointCloudLOD.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/system/CTicTac.h>
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+namespace
+{
+using mrpt::opengl::CPointCloudColoured;
+
+// Encodes the point index in its color, to check which points survive:
+mrpt::math::TPointXYZfRGBAu8 make_point(float x, float y, float z, size_t idx)
+{
+    return {
+        x,
+        y,
+        z,
+        static_cast<uint8_t>(idx & 0xff),
+        static_cast<uint8_t>((idx >> 8) & 0xff),
+        static_cast<uint8_t>((idx >> 16) & 0xff),
+        static_cast<uint8_t>((idx >> 24) & 0xff)};
+}
+
+size_t point_index(const mrpt::math::TPointXYZfRGBAu8& p)
+{
+    return size_t(p.r) | (size_t(p.g) << 8) | (size_t(p.b) << 16) |
+           (size_t(p.a) << 24);
+}
+
+// A flat-ish "map" of N points over a square of side `size` meters:
+CPointCloudColoured::Ptr make_map(size_t N, float size, unsigned seed = 1)
+{
+    std::mt19937                          rng(seed);
+    std::uniform_real_distribution<float> dxy(-0.5f * size, 0.5f * size);
+    std::uniform_real_distribution<float> dz(0.0f, 3.0f);
+
+    auto pc = CPointCloudColoured::Create();
+    pc->reserve(N);
+    for (size_t i = 0; i < N; i++)
+        pc->insertPoint(make_point(dxy(rng), dxy(rng), dz(rng), i));
+    return pc;
+}
+
+void test_decimation_ratio()
+{
+    CPointCloudColoured pc;
+    for (size_t i = 0; i < 10000; i++)
+        pc.insertPoint(make_point(i * 0.01f, 0, 0, i));
+
+    const size_t n =
+        mola::decimate_point_cloud(pc, 1000, mola::PointCloudDecimation::Ratio);
+    ASSERT_EQUAL_(n, 1000U);
+    ASSERT_EQUAL_(pc.size(), 1000U);
+
+    // Evenly spaced, in order, and untouched:
+    for (size_t k = 0; k < pc.size(); k++)
+    {
+        const auto& p = pc.getPoint(k);
+        ASSERT_EQUAL_(point_index(p), k * 10);
+        ASSERT_NEAR_(p.x, k * 10 * 0.01f, 1e-4f);
+    }
+
+    // Under budget, or no budget: nothing changes
+    ASSERT_EQUAL_(mola::decimate_point_cloud(pc, 5000), 1000U);
+    ASSERT_EQUAL_(mola::decimate_point_cloud(pc, 0), 1000U);
+}
+
+void test_decimation_voxel()
+{
+    const size_t N = 200000, BUDGET = 20000;
+
+    auto         pc   = make_map(N, 50.0f);
+    const auto   orig = *pc;
+    const size_t n    = mola::decimate_point_cloud(*pc, BUDGET);
+
+    ASSERT_EQUAL_(n, pc->size());
+    ASSERT_LE_(n, BUDGET);
+    // The voxel size estimate should not waste most of the budget:
+    ASSERT_GT_(n, BUDGET / 4);
+
+    size_t lastIdx = 0;
+    for (size_t k = 0; k < pc->size(); k++)
+    {
+        const auto&  p   = pc->getPoint(k);
+        const size_t idx = point_index(p);
+        // Original points, in their original order:
+        if (k > 0) ASSERT_GT_(idx, lastIdx);
+        ASSERT_EQUAL_(orig.getPoint(idx).x, p.x);
+        lastIdx = idx;
+    }
+}
+
+void test_chunked_lod()
+{
+    mola::ChunkedPointCloud chunked;
+    chunked.params.chunk_size    = 10.0f;
+    chunked.params.near_distance = 20.0f;
+    chunked.params.voxel_size    = 1.0f;
+
+    auto                        map = make_map(400000, 200.0f);
+    const mrpt::math::TPoint3Df viewpoint(0, 0, 10.0f);
+
+    auto glChunks = chunked.update(*map, viewpoint);
+    auto st       = chunked.lastStats();
+
+    ASSERT_EQUAL_(st.input_points, map->size());
+    ASSERT_EQUAL_(st.chunks, 20U * 20U);
+    ASSERT_EQUAL_(glChunks->size(), st.chunks);
+    ASSERT_EQUAL_(st.reused_chunks, 0U);
+    // Far chunks are decimated:
+    ASSERT_LT_(st.output_points, st.input_points / 4);
+
+    // Near chunks keep all their points (~1000 points per chunk):
+    size_t fullChunks = 0;
+    for (const auto& o : *glChunks)
+    {
+        auto c = std::dynamic_pointer_cast<CPointCloudColoured>(o);
+        ASSERT_(c);
+        if (c->size() > 500) fullChunks++;
+    }
+    ASSERT_GE_(fullChunks, 4U);
+    ASSERT_LT_(fullChunks, 100U);
+
+    // Same input: all chunks (and their objects) are reused:
+    auto glChunks2 = chunked.update(*map, viewpoint);
+    st             = chunked.lastStats();
+    ASSERT_EQUAL_(st.reused_chunks, st.chunks);
+    for (const auto& o : *glChunks2)
+    {
+        bool found = false;
+        for (const auto& o1 : *glChunks) found = found || (o1 == o);
+        ASSERT_(found);
+    }
+
+    // A new point only invalidates its chunk:
+    map->insertPoint(make_point(55.0f, 55.0f, 1.0f, map->size()));
+    chunked.update(*map, viewpoint);
+    st = chunked.lastStats();
+    ASSERT_EQUAL_(st.reused_chunks, st.chunks - 1);
+
+    // Moving the viewpoint changes the LOD level of some chunks only:
+    chunked.update(*map, mrpt::math::TPoint3Df(30.0f, 0, 10.0f));
+    st = chunked.lastStats();
+    ASSERT_GT_(st.reused_chunks, 0U);
+    ASSERT_LT_(st.reused_chunks, st.chunks);
+}
+
+// Headless benchmark: preprocessing time and resulting point counts
+void benchmark()
+{
+    constexpr size_t BUDGET = 200000;
+
+    std::printf(
+        "%-22s %10s %10s %8s %8s\n", "[benchmark] method", "in", "out",
+        "chunks", "ms");
+
+    mrpt::system::CTicTac tictac;
+
+    for (const size_t N : {100000UL, 1000000UL, 4000000UL})
+    {
+        auto map = make_map(N, 300.0f);
+
+        for (const auto method :
+             {mola::PointCloudDecimation::Ratio,
+              mola::PointCloudDecimation::VoxelGrid})
+        {
+            auto pc = *map;
+            tictac.Tic();
+            const size_t n = mola::decimate_point_cloud(pc, BUDGET, method);
+            const double t = tictac.Tac();
+            std::printf(
+                "%-22s %10zu %10zu %8s %8.2f\n",
+                method == mola::PointCloudDecimation::Ratio ? "ratio"
+                                                            : "voxel",
+                N, n, "-", 1e3 * t);
+        }
+
+        mola::ChunkedPointCloud chunked;
+        for (const char* pass : {"chunked LOD (first)", "chunked LOD (again)"})
+        {
+            tictac.Tic();
+            chunked.update(*map, mrpt::math::TPoint3Df(0, 0, 10.0f));
+            const double t  = tictac.Tac();
+            const auto&  st = chunked.lastStats();
+            std::printf(
+                "%-22s %10zu %10zu %8zu %8.2f (reused chunks: %zu)\n", pass,
+                st.input_points, st.output_points, st.chunks, 1e3 * t,
+                st.reused_chunks);
+        }
+    }
+}
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        test_decimation_ratio();
+        test_decimation_voxel();
+        test_chunked_lod();
+        benchmark();
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
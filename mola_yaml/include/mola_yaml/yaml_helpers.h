@@ -32,6 +32,19 @@ struct YAMLParseOptions
     /** If not empty, base reference path which respect to "$include{}"s are
      * specified. Automatically filled in by load_yaml_file() */
     std::string includesBasePath;
+
+    /** If not empty, load_yaml_file() keeps the fully expanded documents in
+     * this directory, and reuses them while none of the files they include,
+     * nor the environment variables they use, change (files are compared by
+     * contents). If empty, the environment variable `MOLA_YAML_CACHE_DIR` is
+     * used instead, if defined. \sa yaml_cache_stats() */
+    std::string cacheDirectory;
+
+    /** Documents with `$(cmd)`s are only cached if this is true, or if the
+     * environment variable `MOLA_YAML_CACHE_CMD_RUNS=1`. Then, commands
+     * are not run again while the rest of the cache entry is valid, so only
+     * enable it for commands with constant outputs. */
+    bool cacheCmdRuns{false};
 };
 
 /** Parses: system run expressions `$(cmd)`, environment variables `${VAR}`.
@@ -55,6 +68,18 @@ struct YAMLParseOptions
     const std::string&      fileName,
     const YAMLParseOptions& opts = YAMLParseOptions());
 
+/** Counters of the cache of expanded documents of load_yaml_file()
+ *  \sa YAMLParseOptions::cacheDirectory */
+struct YAMLCacheStats
+{
+    size_t hits   = 0;  //!< Valid cache entries used
+    size_t misses = 0;  //!< Documents not cached, or with stale entries
+    size_t stores = 0;  //!< Cache entries written
+};
+
+/** Returns the accumulated counters of the YAML cache, for this process */
+[[nodiscard]] YAMLCacheStats yaml_cache_stats();
+
 /** Converts a yaml node into a string
  */
 [[nodiscard]] std::string yaml_to_string(const mrpt::containers::yaml& cfg);
@@ -0,0 +1,415 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   yaml_cache.cpp
+ * @brief  Cache of preprocessed YAML documents
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include "yaml_cache.h"
+
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <random>
+#include <sstream>
+
+#if STD_FS_IS_EXPERIMENTAL
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#else
+#include <filesystem>
+namespace fs = std::filesystem;
+#endif
+
+// Cache file format (native endianness, since caches are not meant to be
+// shared between machines):
+//  - magic "MOLAYMLC", version (u32)
+//  - cache key (string): the root file and parsing options.
+//  - dependencies: files (path, content hash), environment variables
+//    (name, is set, value), and whether `$()`s were run (u8).
+//  - the expanded document, as a tree of tagged nodes.
+
+using mrpt::containers::yaml;
+
+namespace
+{
+constexpr char     CACHE_MAGIC[8] = {'M', 'O', 'L', 'A', 'Y', 'M', 'L', 'C'};
+constexpr uint32_t CACHE_VERSION  = 1;
+
+enum NodeTag : uint8_t
+{
+    TAG_NULL = 0,
+    TAG_SCALAR,
+    TAG_SEQUENCE,
+    TAG_MAP
+};
+
+// What an expanded document depends on:
+struct Dependencies
+{
+    std::map<std::string, uint64_t>                   files;  // => hash
+    std::map<std::string, std::optional<std::string>> envVars;
+    bool                                              cmdRuns   = false;
+    bool                                              cacheable = true;
+};
+
+// Set while a document is being expanded for the cache:
+thread_local Dependencies* recorder = nullptr;
+
+std::atomic<size_t> stats_hits{0}, stats_misses{0}, stats_stores{0};
+
+uint64_t fnv1a(const char* data, size_t len, uint64_t h = 0xcbf29ce484222325)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= static_cast<uint8_t>(data[i]);
+        h *= 0x100000001b3;
+    }
+    return h;
+}
+
+std::optional<uint64_t> hash_file(const std::string& fileName)
+{
+    std::ifstream f(fileName, std::ios::binary);
+    if (!f.is_open()) return {};
+
+    std::stringstream ss;
+    ss << f.rdbuf();
+    const std::string s = ss.str();
+
+    const uint64_t len = s.size();
+    return fnv1a(
+        reinterpret_cast<const char*>(&len), sizeof(len),
+        fnv1a(s.data(), s.size()));
+}
+
+class Writer
+{
+   public:
+    std::string buf;
+
+    template <typename T>
+    void pod(const T& v)
+    {
+        buf.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    void str(const std::string& s)
+    {
+        pod(static_cast<uint32_t>(s.size()));
+        buf.append(s);
+    }
+};
+
+class Reader
+{
+   public:
+    explicit Reader(const std::string& b) : buf_(b) {}
+
+    template <typename T>
+    T pod()
+    {
+        T v;
+        ASSERT_(pos_ + sizeof(T) <= buf_.size());
+        std::memcpy(&v, buf_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return v;
+    }
+    std::string str()
+    {
+        const auto len = pod<uint32_t>();
+        ASSERT_(pos_ + len <= buf_.size());
+        std::string s = buf_.substr(pos_, len);
+        pos_ += len;
+        return s;
+    }
+    bool eof() const { return pos_ == buf_.size(); }
+
+   private:
+    const std::string& buf_;
+    size_t             pos_ = 0;
+};
+
+// Returns false for nodes which cannot be cached (non-string scalars, which
+// are not produced by the YAML parser anyway).
+bool encode_node(const yaml::node_t& n, Writer& w)
+{
+    if (n.isNullNode())
+    {
+        w.pod(TAG_NULL);
+        return true;
+    }
+    if (const auto* a = std::get_if<yaml::scalar_t>(&n.d); a)
+    {
+        const auto* s = std::any_cast<std::string>(a);
+        if (!s) return false;
+        w.pod(TAG_SCALAR);
+        w.str(*s);
+        return true;
+    }
+    if (const auto* seq = std::get_if<yaml::sequence_t>(&n.d); seq)
+    {
+        w.pod(TAG_SEQUENCE);
+        w.pod(static_cast<uint32_t>(seq->size()));
+        for (const auto& e : *seq)
+            if (!encode_node(e, w)) return false;
+        return true;
+    }
+    if (const auto* m = std::get_if<yaml::map_t>(&n.d); m)
+    {
+        w.pod(TAG_MAP);
+        w.pod(static_cast<uint32_t>(m->size()));
+        for (const auto& [k, v] : *m)
+            if (!encode_node(k, w) || !encode_node(v, w)) return false;
+        return true;
+    }
+    return false;
+}
+
+yaml::node_t decode_node(Reader& r, int depth = 0)
+{
+    ASSERT_(depth < 1000);
+
+    yaml::node_t n;
+    switch (r.pod<uint8_t>())
+    {
+        case TAG_NULL:
+            break;
+        case TAG_SCALAR:
+            n.d.emplace<yaml::scalar_t>(r.str());
+            break;
+        case TAG_SEQUENCE:
+        {
+            auto&      seq = n.d.emplace<yaml::sequence_t>();
+            const auto len = r.pod<uint32_t>();
+            for (uint32_t i = 0; i < len; i++)
+                seq.push_back(decode_node(r, depth + 1));
+        }
+        break;
+        case TAG_MAP:
+        {
+            auto&      m   = n.d.emplace<yaml::map_t>();
+            const auto len = r.pod<uint32_t>();
+            for (uint32_t i = 0; i < len; i++)
+            {
+                auto k = decode_node(r, depth + 1);
+                auto v = decode_node(r, depth + 1);
+                m.emplace(std::move(k), std::move(v));
+            }
+        }
+        break;
+        default:
+            THROW_EXCEPTION("Invalid node tag");
+    }
+    return n;
+}
+
+std::string cache_key(
+    const std::string& fileName, const mola::YAMLParseOptions& opts)
+{
+    // Relative paths depend on the working directory:
+    std::error_code ec;
+    return mrpt::format(
+        "%s|%s|%s|%s|%i%i%i", fileName.c_str(),
+        fs::absolute(fileName, ec).string().c_str(),
+        fs::current_path(ec).string().c_str(), opts.includesBasePath.c_str(),
+        opts.doIncludes ? 1 : 0, opts.doCmdRuns ? 1 : 0,
+        opts.doEnvVars ? 1 : 0);
+}
+
+std::optional<yaml> read_cache(
+    const std::string& cacheFile, const std::string& key,
+    const mola::YAMLParseOptions& opts)
+{
+    std::ifstream f(cacheFile, std::ios::binary);
+    if (!f.is_open()) return {};
+
+    try
+    {
+        std::stringstream ss;
+        ss << f.rdbuf();
+        const std::string buf = ss.str();
+
+        Reader r(buf);
+        char   magic[sizeof(CACHE_MAGIC)];
+        for (auto& c : magic) c = r.pod<char>();
+        if (std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0) return {};
+        if (r.pod<uint32_t>() != CACHE_VERSION) return {};
+        if (r.str() != key) return {};  // hash collision
+
+        // Check all dependencies:
+        for (auto nFiles = r.pod<uint32_t>(); nFiles > 0; nFiles--)
+        {
+            const auto file = r.str();
+            const auto hash = r.pod<uint64_t>();
+            if (hash_file(file) != hash) return {};
+        }
+        for (auto nVars = r.pod<uint32_t>(); nVars > 0; nVars--)
+        {
+            const auto  name  = r.str();
+            const bool  isSet = r.pod<uint8_t>() != 0;
+            const auto  value = r.str();
+            const char* v     = ::getenv(name.c_str());
+            if (isSet != (v != nullptr) || (v && value != v)) return {};
+        }
+        const bool cmdRuns = r.pod<uint8_t>() != 0;
+        if (cmdRuns && !opts.cacheCmdRuns) return {};
+
+        yaml doc(decode_node(r));
+        if (!r.eof()) return {};
+        return doc;
+    }
+    catch (const std::exception&)
+    {
+        return {};  // corrupted file
+    }
+}
+
+void write_cache(
+    const std::string& cacheFile, const std::string& key,
+    const Dependencies& deps, const yaml& doc)
+{
+    Writer w;
+    for (const char c : CACHE_MAGIC) w.pod(c);
+    w.pod(CACHE_VERSION);
+    w.str(key);
+
+    w.pod(static_cast<uint32_t>(deps.files.size()));
+    for (const auto& [file, hash] : deps.files)
+    {
+        w.str(file);
+        w.pod(hash);
+    }
+    w.pod(static_cast<uint32_t>(deps.envVars.size()));
+    for (const auto& [name, value] : deps.envVars)
+    {
+        w.str(name);
+        w.pod(static_cast<uint8_t>(value.has_value() ? 1 : 0));
+        w.str(value.value_or(""));
+    }
+    w.pod(static_cast<uint8_t>(deps.cmdRuns ? 1 : 0));
+
+    if (!encode_node(doc.node(), w)) return;
+
+    // Written into a temporary file, then renamed, in case of concurrent
+    // programs:
+    std::error_code ec;
+    fs::create_directories(fs::path(cacheFile).parent_path(), ec);
+
+    const auto tmpFile =
+        cacheFile + ".tmp" + std::to_string(std::random_device()() % 100000);
+    {
+        std::ofstream f(tmpFile, std::ios::binary);
+        if (!f.is_open()) return;
+        f.write(w.buf.data(), static_cast<std::streamsize>(w.buf.size()));
+        if (!f.good())
+        {
+            f.close();
+            std::remove(tmpFile.c_str());
+            return;
+        }
+    }
+    if (0 != std::rename(tmpFile.c_str(), cacheFile.c_str()))
+    {
+        std::remove(tmpFile.c_str());
+        return;
+    }
+    stats_stores++;
+}
+
+}  // namespace
+
+void mola::internal::record_yaml_file_dependency(const std::string& fileName)
+{
+    if (!recorder) return;
+
+    const auto hash = hash_file(fileName);
+    if (hash)
+        recorder->files[fileName] = *hash;
+    else
+        recorder->cacheable = false;
+}
+
+void mola::internal::record_yaml_env_dependency(
+    const std::string& name, const char* value)
+{
+    if (!recorder) return;
+
+    recorder->envVars[name] =
+        value ? std::optional<std::string>(value) : std::nullopt;
+}
+
+void mola::internal::record_yaml_cmd_run()
+{
+    if (!recorder) return;
+    recorder->cmdRuns = true;
+}
+
+mrpt::containers::yaml mola::internal::load_yaml_file_cached(
+    const std::string& fileName, const YAMLParseOptions& opts,
+    const std::string&                             cacheDir,
+    const std::function<mrpt::containers::yaml()>& load)
+{
+    const auto key       = cache_key(fileName, opts);
+    const auto cacheFile = (fs::path(cacheDir) /
+                            mrpt::format(
+                                "%016" PRIx64 ".yamlc",
+                                fnv1a(key.data(), key.size())))
+                               .string();
+
+    if (auto doc = read_cache(cacheFile, key, opts); doc)
+    {
+        stats_hits++;
+        if (getenv("VERBOSE"))
+            std::cout << "[load_yaml_file] Using cached `" << cacheFile
+                      << "` for `" << fileName << "`\n";
+        return *doc;
+    }
+    stats_misses++;
+
+    // Expand the document, recording what it depends on:
+    Dependencies deps;
+    yaml         doc;
+    {
+        Dependencies* prevRecorder = recorder;
+        recorder                   = &deps;
+        try
+        {
+            record_yaml_file_dependency(fileName);
+            doc = load();
+        }
+        catch (...)
+        {
+            recorder = prevRecorder;
+            throw;
+        }
+        recorder = prevRecorder;
+    }
+
+    if (deps.cacheable && (!deps.cmdRuns || opts.cacheCmdRuns))
+        write_cache(cacheFile, key, deps, doc);
+
+    return doc;
+}
+
+mola::YAMLCacheStats mola::yaml_cache_stats()
+{
+    YAMLCacheStats s;
+    s.hits   = stats_hits;
+    s.misses = stats_misses;
+    s.stores = stats_stores;
+    return s;
+}
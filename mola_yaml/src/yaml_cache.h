@@ -0,0 +1,35 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+/**
+ * @file   yaml_cache.h
+ * @brief  Cache of preprocessed YAML documents (internal header)
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+#pragma once
+
+#include <mola_yaml/yaml_helpers.h>
+
+#include <functional>
+#include <string>
+
+namespace mola::internal
+{
+// Called by the YAML preprocessor for each input it depends on. They do
+// nothing unless a document is being expanded for the cache.
+void record_yaml_file_dependency(const std::string& fileName);
+void record_yaml_env_dependency(const std::string& name, const char* value);
+void record_yaml_cmd_run();
+
+/** Returns the cached expansion of `fileName` in `cacheDir`, if it is still
+ * valid. Otherwise, calls `load()` while recording the dependencies of the
+ * document, and stores its result in the cache for the next time. */
+mrpt::containers::yaml load_yaml_file_cached(
+    const std::string& fileName, const YAMLParseOptions& opts,
+    const std::string&                             cacheDir,
+    const std::function<mrpt::containers::yaml()>& load);
+
+}  // namespace mola::internal
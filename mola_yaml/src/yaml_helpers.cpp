@@ -13,6 +13,7 @@
 #include <mola_yaml/yaml_helpers.h>
 #include <mrpt/containers/yaml.h>
 #include <mrpt/core/exceptions.h>
+#include <mrpt/core/get_env.h>
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>
 #include <mrpt/system/string_utils.h>
@@ -21,6 +22,8 @@
 #include <cstdlib>
 #include <iostream>
 
+#include "yaml_cache.h"
+
 #if STD_FS_IS_EXPERIMENTAL
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
@@ -108,6 +111,7 @@ static std::string parseEnvVars(
 
     std::string varvalue;
     const char* v = ::getenv(varname.c_str());
+    mola::internal::record_yaml_env_dependency(varname, v);
     if (v != nullptr)
         varvalue = std::string(v);
     else
@@ -153,6 +157,7 @@ static std::string parseCmdRuns(
     // Launch command and get console output:
     std::string cmdOut;
 
+    mola::internal::record_yaml_cmd_run();
     int ret = mrpt::system::executeCommand(cmd, &cmdOut);
     if (ret != 0)
     {
@@ -219,6 +224,7 @@ static void recursiveParseNodeForIncludes(
             std::cout << "[recursiveParseNodeForIncludes] Including yaml from `"
                       << expr << "`\n";
 
+        mola::internal::record_yaml_file_dependency(expr);
         auto filData = yaml::FromFile(expr);
 
         // Handle possible recursive expressions & replace contents:
@@ -287,12 +293,24 @@ mrpt::containers::yaml mola::load_yaml_file(
     const std::string& fileName, const YAMLParseOptions& opts)
 {
     MRPT_START
-    const auto rawYaml = mrpt::containers::yaml::FromFile(fileName);
 
     auto optsMod             = opts;
     optsMod.includesBasePath = mrpt::system::extractFileDirectory(fileName);
 
-    return mrpt::containers::yaml::FromText(
-        parse_yaml(yaml_to_string(rawYaml), optsMod));
+    const auto load = [&]() {
+        const auto rawYaml = mrpt::containers::yaml::FromFile(fileName);
+        return mrpt::containers::yaml::FromText(
+            parse_yaml(yaml_to_string(rawYaml), optsMod));
+    };
+
+    auto cacheDir = opts.cacheDirectory;
+    if (cacheDir.empty())
+        cacheDir = mrpt::get_env<std::string>("MOLA_YAML_CACHE_DIR");
+    if (cacheDir.empty()) return load();
+
+    optsMod.cacheCmdRuns =
+        opts.cacheCmdRuns || mrpt::get_env<bool>("MOLA_YAML_CACHE_CMD_RUNS");
+
+    return internal::load_yaml_file_cached(fileName, optsMod, cacheDir, load);
     MRPT_END
 }
@@ -0,0 +1,239 @@
+/* -------------------------------------------------------------------------
+ *   A Modular Optimization framework for Localization and mApping  (MOLA)
+ * Copyright (C) 2018-2024 Jose Luis Blanco, University of Almeria
+ * See LICENSE for license information.
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @file   test-yaml-cache.cpp
+ * @brief  Unit tests for the cache of preprocessed YAML files
+ *
+ * @author Jose Luis Blanco Claraco
+ * @date   Oct 18, 2026
+ */
+
+#include <mola_yaml/yaml_helpers.h>
+#include <mrpt/system/filesystem.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+const std::string tmpDir   = mrpt::system::getTempFileName() + "-yaml-cache";
+const std::string cacheDir = tmpDir + "/cache";
+const std::string mainFile = tmpDir + "/main.yaml";
+const std::string incFile  = tmpDir + "/inc.yaml";
+const std::string cmdFile  = tmpDir + "/cmd-output.txt";
+
+void write_file(const std::string& file, const std::string& contents)
+{
+    std::ofstream f(file);
+    ASSERT_(f.is_open());
+    f << contents;
+}
+
+mola::YAMLParseOptions cacheOpts()
+{
+    mola::YAMLParseOptions opts;
+    opts.cacheDirectory = cacheDir;
+    return opts;
+}
+
+// Loads mainFile and checks whether the cache was used:
+mrpt::containers::yaml load(
+    bool expectHit, const mola::YAMLParseOptions& opts = cacheOpts())
+{
+    const auto before = mola::yaml_cache_stats();
+    auto       y      = mola::load_yaml_file(mainFile, opts);
+    const auto after  = mola::yaml_cache_stats();
+
+    ASSERT_EQUAL_(after.hits - before.hits, expectHit ? 1U : 0U);
+    ASSERT_EQUAL_(after.misses - before.misses, expectHit ? 0U : 1U);
+
+    // It must be the same document than without cache:
+    ASSERT_EQUAL_(
+        mola::yaml_to_string(y),
+        mola::yaml_to_string(mola::load_yaml_file(mainFile)));
+    return y;
+}
+
+void write_default_files()
+{
+    write_file(
+        mainFile,
+        "a: 1\n"
+        "b: ${MOLA_TEST_YAML_CACHE_VAR}\n"
+        "c: ${MOLA_TEST_YAML_CACHE_UNSET|def}\n"
+        "inc: $include{inc.yaml}\n"
+        "seq: [x, y, z]\n");
+    write_file(incFile, "foo: bar\nnested:\n  n: 42\n");
+
+    ::setenv("MOLA_TEST_YAML_CACHE_VAR", "v1", 1);
+    ::unsetenv("MOLA_TEST_YAML_CACHE_UNSET");
+}
+
+// Each test starts with the default files and an empty cache:
+void start_test()
+{
+    std::filesystem::remove_all(cacheDir);
+    write_default_files();
+}
+
+void test_no_cache()
+{
+    start_test();
+
+    const auto before = mola::yaml_cache_stats();
+    const auto y      = mola::load_yaml_file(mainFile);
+    const auto after  = mola::yaml_cache_stats();
+    ASSERT_EQUAL_(after.misses, before.misses);
+    ASSERT_EQUAL_(after.stores, before.stores);
+    ASSERT_EQUAL_(y["inc"]["nested"]["n"].as<int>(), 42);
+    ASSERT_(!mrpt::system::directoryExists(cacheDir));
+}
+
+void test_hit()
+{
+    start_test();
+
+    const auto stores = mola::yaml_cache_stats().stores;
+    load(false);
+    ASSERT_EQUAL_(mola::yaml_cache_stats().stores, stores + 1);
+
+    const auto y = load(true);
+    ASSERT_EQUAL_(y["a"].as<int>(), 1);
+    ASSERT_EQUAL_(y["b"].as<std::string>(), "v1");
+    ASSERT_EQUAL_(y["c"].as<std::string>(), "def");
+    ASSERT_EQUAL_(y["inc"]["foo"].as<std::string>(), "bar");
+    ASSERT_EQUAL_(y["inc"]["nested"]["n"].as<int>(), 42);
+    ASSERT_EQUAL_(y["seq"](2).as<std::string>(), "z");
+
+    // Other parsing options have their own cache entries:
+    auto opts      = cacheOpts();
+    opts.doEnvVars = false;
+    load(false, opts);
+    load(true, opts);
+    load(true);
+}
+
+void test_invalidate_files()
+{
+    start_test();
+    load(false);
+    load(true);
+
+    // Rewriting the same contents keeps the cache:
+    write_default_files();
+    load(true);
+
+    write_file(incFile, "foo: baz\nnested:\n  n: 42\n");
+    ASSERT_EQUAL_(load(false)["inc"]["foo"].as<std::string>(), "baz");
+    load(true);
+
+    write_file(
+        mainFile,
+        "a: 2\n"
+        "b: ${MOLA_TEST_YAML_CACHE_VAR}\n"
+        "c: ${MOLA_TEST_YAML_CACHE_UNSET|def}\n"
+        "inc: $include{inc.yaml}\n"
+        "seq: [x, y, z]\n");
+    ASSERT_EQUAL_(load(false)["a"].as<int>(), 2);
+    load(true);
+}
+
+void test_invalidate_env_vars()
+{
+    start_test();
+    load(false);
+    load(true);
+
+    ::setenv("MOLA_TEST_YAML_CACHE_VAR", "v2", 1);
+    ASSERT_EQUAL_(load(false)["b"].as<std::string>(), "v2");
+    load(true);
+
+    // A variable which was not defined, but is now:
+    ::setenv("MOLA_TEST_YAML_CACHE_UNSET", "now-set", 1);
+    ASSERT_EQUAL_(load(false)["c"].as<std::string>(), "now-set");
+    load(true);
+
+    ::unsetenv("MOLA_TEST_YAML_CACHE_UNSET");
+    ASSERT_EQUAL_(load(false)["c"].as<std::string>(), "def");
+}
+
+void test_cmd_runs()
+{
+    start_test();
+    write_file(mainFile, "a: $(cat " + cmdFile + ")\n");
+    write_file(cmdFile, "out1");
+
+    // Not cached, unless requested:
+    const auto stores = mola::yaml_cache_stats().stores;
+    ASSERT_EQUAL_(load(false)["a"].as<std::string>(), "out1");
+    write_file(cmdFile, "out2");
+    ASSERT_EQUAL_(load(false)["a"].as<std::string>(), "out2");
+    ASSERT_EQUAL_(mola::yaml_cache_stats().stores, stores);
+
+    auto opts         = cacheOpts();
+    opts.cacheCmdRuns = true;
+    load(false, opts);
+    ASSERT_EQUAL_(mola::yaml_cache_stats().stores, stores + 1);
+
+    // Cached command outputs are reused, even if they would change now:
+    write_file(cmdFile, "out3");
+    {
+        const auto before = mola::yaml_cache_stats();
+        const auto y      = mola::load_yaml_file(mainFile, opts);
+        ASSERT_EQUAL_(mola::yaml_cache_stats().hits, before.hits + 1);
+        ASSERT_EQUAL_(y["a"].as<std::string>(), "out2");
+    }
+
+    // ...but not by users that did not ask for them:
+    ASSERT_EQUAL_(load(false)["a"].as<std::string>(), "out3");
+
+    // Changing the command itself invalidates the entry:
+    write_file(mainFile, "a: $(cat " + cmdFile + ")\nb: 1\n");
+    ASSERT_EQUAL_(load(false, opts)["a"].as<std::string>(), "out3");
+}
+
+void test_corrupted_cache()
+{
+    start_test();
+    load(false);
+    load(true);
+
+    // Truncate all cache files:
+    for (const auto& e : std::filesystem::directory_iterator(cacheDir))
+        std::filesystem::resize_file(e.path(), 20);
+    load(false);
+    load(true);
+}
+
+}  // namespace
+
+int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
+{
+    try
+    {
+        ::unsetenv("MOLA_YAML_CACHE_DIR");
+        mrpt::system::createDirectory(tmpDir);
+
+        test_no_cache();
+        test_hit();
+        test_invalidate_files();
+        test_invalidate_env_vars();
+        test_cmd_runs();
+        test_corrupted_cache();
+
+        std::filesystem::remove_all(tmpDir);
+
+        std::cout << "Test successful." << std::endl;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}